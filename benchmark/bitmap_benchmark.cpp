@@ -0,0 +1,138 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "common/lang/bitmap.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+/**
+ * 测试位图的查找和统计操作。位图的大小与页面分配表中的一组相当。
+ * 测试参数：range(0) 是被设置的位所占的百分比
+ */
+static constexpr int BITMAP_SIZE = 64 * 1024;
+
+static vector<char> generate_bitmap(int density)
+{
+  vector<char> buf(BITMAP_SIZE / 8);
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  mt19937      random_generator(20261017);
+  for (int i = 0; i < BITMAP_SIZE; i++) {
+    if (static_cast<int>(random_generator() % 100) < density) {
+      bitmap.set_bit(i);
+    }
+  }
+  return buf;
+}
+
+/// 以前逐个字节、逐位查找的实现，作为对比
+static int bytewise_next_setted_bit(const char *buf, int size, int start)
+{
+  for (int i = start; i < size; i++) {
+    if (buf[i / 8] == 0) {
+      i = i / 8 * 8 + 7;
+      continue;
+    }
+    if ((buf[i / 8] & (1 << (i % 8))) != 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void BM_BytewiseNextSettedBit(State &state)
+{
+  vector<char> buf = generate_bitmap(state.range(0));
+  for (auto _ : state) {
+    int count = 0;
+    for (int i = bytewise_next_setted_bit(buf.data(), BITMAP_SIZE, 0); i != -1;
+         i = bytewise_next_setted_bit(buf.data(), BITMAP_SIZE, i + 1)) {
+      count++;
+    }
+    DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+static void BM_NextSettedBit(State &state)
+{
+  vector<char> buf = generate_bitmap(state.range(0));
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  for (auto _ : state) {
+    int count = 0;
+    for (int i = bitmap.next_setted_bit(0); i != -1; i = bitmap.next_setted_bit(i + 1)) {
+      count++;
+    }
+    DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+static void BM_SettedBits(State &state)
+{
+  vector<char> buf = generate_bitmap(state.range(0));
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  vector<int>  indexes(BITMAP_SIZE);
+  for (auto _ : state) {
+    DoNotOptimize(bitmap.setted_bits(0, indexes.data(), BITMAP_SIZE));
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+static void BM_NextUnsettedBit(State &state)
+{
+  // 除了最后一位，其它的位都被设置了，模拟在几乎满了的页面分配表中查找空闲页面
+  vector<char> buf(BITMAP_SIZE / 8, static_cast<char>(0xFF));
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  bitmap.clear_bit(BITMAP_SIZE - 1);
+  for (auto _ : state) {
+    DoNotOptimize(bitmap.next_unsetted_bit(0));
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+static void BM_CountSettedBits(State &state)
+{
+  vector<char> buf = generate_bitmap(state.range(0));
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  for (auto _ : state) {
+    DoNotOptimize(bitmap.count_setted_bits());
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+static void BM_NextUnsettedRun(State &state)
+{
+  vector<char> buf = generate_bitmap(state.range(0));
+  Bitmap       bitmap(buf.data(), BITMAP_SIZE);
+  for (auto _ : state) {
+    DoNotOptimize(bitmap.next_unsetted_run(0, 16));
+  }
+  state.SetItemsProcessed(state.iterations() * BITMAP_SIZE);
+}
+
+BENCHMARK(BM_BytewiseNextSettedBit)->Arg(1)->Arg(50)->Arg(99)->ArgNames({"density"});
+BENCHMARK(BM_NextSettedBit)->Arg(1)->Arg(50)->Arg(99)->ArgNames({"density"});
+BENCHMARK(BM_SettedBits)->Arg(1)->Arg(50)->Arg(99)->ArgNames({"density"});
+BENCHMARK(BM_NextUnsettedBit);
+BENCHMARK(BM_CountSettedBits)->Arg(50)->ArgNames({"density"});
+BENCHMARK(BM_NextUnsettedRun)->Arg(50)->Arg(90)->ArgNames({"density"});
+
+BENCHMARK_MAIN();
@@ -24,8 +24,10 @@ using namespace std;
 using namespace common;
 using namespace benchmark;
 
-once_flag         init_bpm_flag;
-BufferPoolManager bpm{512};
+/// buffer pool 使用的内存。数据量远大于这个值，所以运行时会不断地淘汰页面
+static constexpr int BUFFER_POOL_MEMORY_SIZE = 4 * 1024 * 1024;
+
+unique_ptr<BufferPoolManager> bpm;
 
 struct Stat
 {
@@ -62,7 +64,9 @@ public:
     string btree_filename = this->Name() + ".btree";
     LoggerFactory::init_default(log_name.c_str(), LOG_LEVEL_TRACE);
 
-    std::call_once(init_bpm_flag, []() { BufferPoolManager::set_instance(&bpm); });
+    // 第二个参数是页帧表的分片个数，每次运行都重新创建 buffer pool manager
+    bpm = make_unique<BufferPoolManager>(BUFFER_POOL_MEMORY_SIZE, static_cast<int>(state.range(1)));
+    BufferPoolManager::set_instance(bpm.get());
 
     ::remove(btree_filename.c_str());
 
@@ -86,6 +90,8 @@ public:
     }
 
     handler_.close();
+    BufferPoolManager::set_instance(nullptr);
+    bpm.reset();
     LOG_INFO("test %s teardown done. threads=%d, thread index=%d",
         this->Name().c_str(),
         state.threads(),
@@ -186,6 +192,14 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * 每个测试都使用不同的线程数和页帧表分片数运行，可以观察buffer pool在不同并发度下的扩展性。
+ * 测试参数：range(0) 是数据量，range(1) 是页帧表分片数
+ */
+static const vector<int64_t> FRAME_SHARD_NUMS{1, 16};
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct InsertionBenchmark : public BenchmarkBase
 {
   string Name() const override { return "insertion"; }
@@ -206,7 +220,7 @@ BENCHMARK_DEFINE_F(InsertionBenchmark, Insertion)(State &state)
   state.counters["other"]     = Counter(stat.insert_other_count, Counter::kIsRate);
 }
 
-BENCHMARK_REGISTER_F(InsertionBenchmark, Insertion)->Threads(10);
+BENCHMARK_REGISTER_F(InsertionBenchmark, Insertion)->ArgsProduct({{0}, FRAME_SHARD_NUMS})->ThreadRange(1, 16);
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -245,7 +259,7 @@ BENCHMARK_DEFINE_F(DeletionBenchmark, Deletion)(State &state)
   state.counters["other"]     = Counter(stat.delete_other_count, Counter::kIsRate);
 }
 
-BENCHMARK_REGISTER_F(DeletionBenchmark, Deletion)->Threads(10)->Arg(4 * 10000);
+BENCHMARK_REGISTER_F(DeletionBenchmark, Deletion)->ArgsProduct({{4 * 10000}, FRAME_SHARD_NUMS})->ThreadRange(1, 16);
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -288,7 +302,7 @@ BENCHMARK_DEFINE_F(ScanBenchmark, Scan)(State &state)
   state.counters["other"]                 = Counter(stat.scan_other_count, Counter::kIsRate);
 }
 
-BENCHMARK_REGISTER_F(ScanBenchmark, Scan)->Threads(10)->Arg(4 * 10000);
+BENCHMARK_REGISTER_F(ScanBenchmark, Scan)->ArgsProduct({{4 * 10000}, FRAME_SHARD_NUMS})->ThreadRange(1, 16);
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -342,7 +356,7 @@ BENCHMARK_DEFINE_F(MixtureBenchmark, Mixture)(State &state)
       {"scan_open_failed", Counter(stat.scan_open_failed_count, Counter::kIsRate)}});
 }
 
-BENCHMARK_REGISTER_F(MixtureBenchmark, Mixture)->Threads(10)->Arg(4 * 10000);
+BENCHMARK_REGISTER_F(MixtureBenchmark, Mixture)->ArgsProduct({{4 * 10000}, FRAME_SHARD_NUMS})->ThreadRange(1, 16);
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <cmath>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+/**
+ * 使用不同的页面访问序列测试各个页帧淘汰策略的命中率和每次访问的耗时。
+ * 测试参数：range(0) 是淘汰策略，range(1) 是访问序列
+ */
+static const vector<const char *> REPLACERS{"lru", "clock", "2q"};
+
+enum TraceType
+{
+  ZIPFIAN    = 0,  ///< 按照zipfian分布访问热点页面
+  SCAN_MIXED = 1,  ///< zipfian访问中穿插大范围的顺序扫描
+};
+
+static constexpr int    POOL_NUM      = 4;     // 512 个页帧
+static constexpr int    HOT_PAGE_NUM  = 4096;  // 热点访问的页面范围
+static constexpr int    SCAN_PAGE_NUM = 2048;  // 每次顺序扫描访问的页面数
+static constexpr int    SCAN_INTERVAL = 4096;  // 每隔多少次热点访问做一次扫描
+static constexpr size_t TRACE_LENGTH  = 1 << 20;
+static constexpr double ZIPFIAN_THETA = 0.99;
+
+static vector<PageNum> generate_trace(TraceType trace_type)
+{
+  vector<double> weights(HOT_PAGE_NUM);
+  for (int i = 0; i < HOT_PAGE_NUM; i++) {
+    weights[i] = 1.0 / pow(i + 1, ZIPFIAN_THETA);
+  }
+  discrete_distribution<PageNum> zipfian(weights.begin(), weights.end());
+  mt19937                        random_generator(20231017);
+
+  vector<PageNum> trace;
+  trace.reserve(TRACE_LENGTH);
+
+  PageNum scan_page = HOT_PAGE_NUM;
+  while (trace.size() < TRACE_LENGTH) {
+    for (int i = 0; i < SCAN_INTERVAL && trace.size() < TRACE_LENGTH; i++) {
+      trace.push_back(zipfian(random_generator));
+    }
+
+    if (trace_type == SCAN_MIXED) {
+      // 每次扫描都访问之前没有访问过的冷数据
+      for (int i = 0; i < SCAN_PAGE_NUM && trace.size() < TRACE_LENGTH; i++) {
+        trace.push_back(scan_page++);
+      }
+    }
+  }
+  return trace;
+}
+
+static const vector<PageNum> &get_trace(TraceType trace_type)
+{
+  static const vector<PageNum> zipfian_trace    = generate_trace(ZIPFIAN);
+  static const vector<PageNum> scan_mixed_trace = generate_trace(SCAN_MIXED);
+  return trace_type == ZIPFIAN ? zipfian_trace : scan_mixed_trace;
+}
+
+static void BM_ReplayTrace(State &state)
+{
+  const char            *replacer = REPLACERS[state.range(0)];
+  const vector<PageNum> &trace    = get_trace(static_cast<TraceType>(state.range(1)));
+
+  BPFrameManager frame_manager("ReplacerBenchmark");
+  if (frame_manager.init(POOL_NUM, 1 /*shard_num*/, replacer) != RC::SUCCESS) {
+    state.SkipWithError("failed to init frame manager");
+    return;
+  }
+
+  const int file_desc = 0;
+  auto      purger    = [](Frame *) { return RC::SUCCESS; };
+
+  int64_t hit_count  = 0;
+  int64_t miss_count = 0;
+  size_t  index      = 0;
+  for (auto _ : state) {
+    PageNum page_num = trace[index];
+    index            = (index + 1) % trace.size();
+
+    Frame *frame = frame_manager.get(file_desc, page_num);
+    if (frame != nullptr) {
+      hit_count++;
+    } else {
+      miss_count++;
+      while ((frame = frame_manager.alloc(file_desc, page_num)) == nullptr) {
+        frame_manager.purge_frames(file_desc, page_num, 1 /*count*/, purger);
+      }
+    }
+    frame->unpin();
+  }
+
+  state.SetLabel(replacer);
+  state.counters["hit_ratio"] = static_cast<double>(hit_count) / max<int64_t>(hit_count + miss_count, 1);
+
+  for (Frame *frame : frame_manager.find_list(file_desc)) {
+    frame_manager.free(file_desc, frame->page_num(), frame);
+  }
+  frame_manager.cleanup();
+}
+
+BENCHMARK(BM_ReplayTrace)
+    ->ArgsProduct({{0, 1, 2}, {ZIPFIAN, SCAN_MIXED}})
+    ->ArgNames({"replacer", "trace"})
+    ->Iterations(TRACE_LENGTH);
+
+BENCHMARK_MAIN();
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -77,4 +78,15 @@ int writen(int fd, const void *buf, int size);
  */
 int readn(int fd, void *buf, int size);
 
+/**
+ * @brief 与 writen 相同，但是从指定的位置开始写，不会修改文件的偏移量
+ * @details 多个线程可以同时使用同一个描述符写入不同的位置
+ */
+int pwriten(int fd, const void *buf, int size, int64_t offset);
+
+/**
+ * @brief 与 readn 相同，但是从指定的位置开始读，不会修改文件的偏移量
+ */
+int preadn(int fd, void *buf, int size, int64_t offset);
+
 }  // namespace common
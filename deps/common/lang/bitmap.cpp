@@ -12,31 +12,17 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai on 2021/5/7.
 //
 
-#include "common/lang/bitmap.h"
+#include <string.h>
 
-namespace common {
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-int find_first_zero(char byte, int start)
-{
-  for (int i = start; i < 8; i++) {
-    if ((byte & (1 << i)) == 0) {
-      return i;
-    }
-  }
-  return -1;
-}
+#include "common/lang/bitmap.h"
 
-int find_first_setted(char byte, int start)
-{
-  for (int i = start; i < 8; i++) {
-    if ((byte & (1 << i)) != 0) {
-      return i;
-    }
-  }
-  return -1;
-}
+namespace common {
 
-int bytes(int size)
+static int bytes(int size)
 {
   return size % 8 == 0 ? size / 8 : size / 8 + 1;
 }
@@ -52,7 +38,7 @@ void Bitmap::init(char *bitmap, int size)
   size_ = size;
 }
 
-bool Bitmap::get_bit(int index)
+bool Bitmap::get_bit(int index) const
 {
   char bits = bitmap_[index / 8];
   return (bits & (1 << (index % 8))) != 0;
@@ -70,50 +56,139 @@ void Bitmap::clear_bit(int index)
   bits &= ~(1 << (index % 8));
 }
 
-int Bitmap::next_unsetted_bit(int start)
+uint64_t Bitmap::load_word(int word_index) const
+{
+  // 最后一个字可能不足8个字节，不能越界读取
+  const int offset = word_index * 8;
+  const int remain = bytes(size_) - offset;
+  uint64_t  word   = 0;
+  if (remain >= 8) {
+    memcpy(&word, bitmap_ + offset, 8);
+  } else {
+    memcpy(&word, bitmap_ + offset, remain);
+  }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+uint64_t Bitmap::valid_mask(int word_index) const
 {
-  int ret = -1;
-  int start_in_byte = start % 8;
-  for (int iter = start / 8, end = bytes(size_); iter < end; iter++) {
-    char byte = bitmap_[iter];
-    if (byte != -1) {
-      int index_in_byte = find_first_zero(byte, start_in_byte);
-      if (index_in_byte >= 0) {
-        ret = iter * 8 + index_in_byte;
+  const int valid_bits = size_ - word_index * 64;
+  return valid_bits >= 64 ? ~0ULL : (1ULL << valid_bits) - 1;
+}
+
+template <bool Setted>
+int Bitmap::next_bit(int start) const
+{
+  if (start < 0) {
+    start = 0;
+  }
+  if (start >= size_) {
+    return -1;
+  }
+  // 连续访问时下一位经常就是要找的位
+  if (get_bit(start) == Setted) {
+    return start;
+  }
+
+  const int end_word   = word_count();
+  int       word_index = start / 64;
+  uint64_t  word       = Setted ? load_word(word_index) : ~load_word(word_index);
+  word &= valid_mask(word_index) & (~0ULL << (start % 64));
+  while (word == 0) {
+    word_index++;
+
+#ifdef __AVX2__
+    // 一次检查4个完整的字，全0(查找被设置的位)或者全1(查找没有被设置的位)时直接跳过
+    const int full_words = size_ / 64;
+    while (word_index + 4 <= full_words) {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bitmap_ + word_index * 8));
+      const bool    skip  = Setted ? _mm256_testz_si256(chunk, chunk) : _mm256_testc_si256(chunk, _mm256_set1_epi8(-1));
+      if (!skip) {
         break;
       }
+      word_index += 4;
+    }
+#endif
 
-      start_in_byte = 0;
+    if (word_index >= end_word) {
+      return -1;
     }
+    word = Setted ? load_word(word_index) : ~load_word(word_index);
+    word &= valid_mask(word_index);
   }
+  return word_index * 64 + __builtin_ctzll(word);
+}
+
+int Bitmap::next_unsetted_bit(int start) const
+{
+  return next_bit<false>(start);
+}
+
+int Bitmap::next_setted_bit(int start) const
+{
+  return next_bit<true>(start);
+}
 
-  if (ret >= size_) {
-    ret = -1;
+int Bitmap::count_setted_bits() const
+{
+  int count = 0;
+  for (int word_index = 0, end_word = word_count(); word_index < end_word; word_index++) {
+    count += __builtin_popcountll(load_word(word_index) & valid_mask(word_index));
   }
-  return ret;
+  return count;
 }
 
-int Bitmap::next_setted_bit(int start)
+int Bitmap::setted_bits(int start, int *indexes, int max_count) const
 {
-  int ret = -1;
-  int start_in_byte = start % 8;
-  for (int iter = start / 8, end = bytes(size_); iter < end; iter++) {
-    char byte = bitmap_[iter];
-    if (byte != 0x00) {
-      int index_in_byte = find_first_setted(byte, start_in_byte);
-      if (index_in_byte >= 0) {
-        ret = iter * 8 + index_in_byte;
-        break;
+  if (start < 0) {
+    start = 0;
+  }
+  if (start >= size_ || max_count <= 0) {
+    return 0;
+  }
+
+  int count = 0;
+  int word_index = start / 64;
+  uint64_t word = load_word(word_index) & valid_mask(word_index) & (~0ULL << (start % 64));
+  for (const int end_word = word_count(); ;) {
+    // 每次取出最低的一位，然后把它清掉
+    while (word != 0) {
+      indexes[count++] = word_index * 64 + __builtin_ctzll(word);
+      if (count >= max_count) {
+        return count;
       }
+      word &= word - 1;
+    }
 
-      start_in_byte = 0;
+    if (++word_index >= end_word) {
+      break;
     }
+    word = load_word(word_index) & valid_mask(word_index);
   }
+  return count;
+}
 
-  if (ret >= size_) {
-    ret = -1;
+int Bitmap::next_unsetted_run(int start, int count) const
+{
+  if (count <= 0) {
+    return -1;
   }
-  return ret;
+
+  // 每次找到一段空闲的位之后，跳到这一段后面第一个被设置的位继续查找
+  for (int begin = next_unsetted_bit(start); begin >= 0 && begin + count <= size_;) {
+    int end = next_setted_bit(begin);
+    if (end < 0) {
+      end = size_;
+    }
+    if (end - begin >= count) {
+      return begin;
+    }
+    begin = next_unsetted_bit(end);
+  }
+  return -1;
 }
 
 }  // namespace common
@@ -14,23 +14,57 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <stdint.h>
+
 namespace common {
 
+/**
+ * @brief 位图
+ * @details 第 i 位保存在第 i/8 个字节的第 i%8 位。查找和统计时按照64位的字(小端)处理，
+ * 使用 ctz/popcount 指令，开启 AVX2(编译选项 WITH_AVX2)时一次可以跳过256位全0或全1的数据。
+ * 位图的内存只会访问前 (size+7)/8 个字节，最后一个字节中超出 size 的位会被忽略。
+ */
 class Bitmap {
 public:
   Bitmap();
   Bitmap(char *bitmap, int size);
 
   void init(char *bitmap, int size);
-  bool get_bit(int index);
+  bool get_bit(int index) const;
   void set_bit(int index);
   void clear_bit(int index);
 
   /**
    * @param start 从哪个位开始查找，start是包含在内的
+   * @return 找不到时返回-1
+   */
+  int next_unsetted_bit(int start) const;
+  int next_setted_bit(int start) const;
+
+  /**
+   * @brief 统计有多少个位被设置
+   */
+  int count_setted_bits() const;
+
+  /**
+   * @brief 按照顺序把从 start 开始被设置的位的编号放到 indexes 中
+   * @param max_count indexes 最多可以放多少个编号
+   * @return 放了多少个编号
+   */
+  int setted_bits(int start, int *indexes, int max_count) const;
+
+  /**
+   * @brief 从 start 开始查找连续 count 个没有被设置的位
+   * @return 第一个位的编号，找不到时返回-1
    */
-  int next_unsetted_bit(int start);
-  int next_setted_bit(int start);
+  int next_unsetted_run(int start, int count) const;
+
+private:
+  int      word_count() const { return (size_ + 63) / 64; }
+  uint64_t load_word(int word_index) const;
+  uint64_t valid_mask(int word_index) const;
+  template <bool Setted>
+  int next_bit(int start) const;
 
 private:
   char *bitmap_;
@@ -383,6 +383,11 @@ void RecursiveSharedMutex::unlock_shared()
 void RecursiveSharedMutex::lock()
 {}
 
+bool RecursiveSharedMutex::try_lock()
+{
+  return true;
+}
+
 void RecursiveSharedMutex::unlock()
 {}
 
@@ -431,6 +436,22 @@ void RecursiveSharedMutex::lock()
   exclusive_lock_count_++;
 }
 
+bool RecursiveSharedMutex::try_lock()
+{
+  unique_lock<mutex> lock(mutex_);
+  if (shared_lock_count_ > 0 || exclusive_lock_count_ > 0) {
+    if (recursive_owner_ == this_thread::get_id()) {
+      recursive_count_++;
+      return true;
+    }
+    return false;
+  }
+  recursive_owner_ = this_thread::get_id();
+  recursive_count_ = 1;
+  exclusive_lock_count_++;
+  return true;
+}
+
 void RecursiveSharedMutex::unlock()
 {
   unique_lock<mutex> lock(mutex_);
@@ -311,6 +311,7 @@ class RecursiveSharedMutex
   void unlock_shared();
 
   void lock();
+  bool try_lock();
   void unlock();
 
 private:
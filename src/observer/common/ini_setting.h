@@ -25,3 +25,55 @@ See the Mulan PSL v2 for more details. */
 #define SOCKET_BUFFER_SIZE 8192
 
 #define SESSION_STAGE_NAME "SessionStage"
+
+#define BUFFER_POOL_SECTION "BUFFER_POOL"
+#define FRAME_SHARD_NUM "FRAME_SHARD_NUM"
+#define FRAME_SHARD_NUM_DEFAULT 1
+#define REPLACEMENT_POLICY "REPLACEMENT_POLICY"
+#define REPLACEMENT_POLICY_DEFAULT "lru"
+#define PAGE_CLEANER_NUM "PAGE_CLEANER_NUM"
+#define PAGE_CLEANER_NUM_DEFAULT 0
+#define PAGE_CLEANER_LOW_WATER_MARK "PAGE_CLEANER_LOW_WATER_MARK"
+#define PAGE_CLEANER_LOW_WATER_MARK_DEFAULT 10
+#define PAGE_IO "PAGE_IO"
+#define PAGE_IO_DEFAULT "sync"
+#define READ_AHEAD_MIN_PAGES "READ_AHEAD_MIN_PAGES"
+#define READ_AHEAD_MIN_PAGES_DEFAULT 4
+#define READ_AHEAD_MAX_PAGES "READ_AHEAD_MAX_PAGES"
+#define READ_AHEAD_MAX_PAGES_DEFAULT 64
+#define BUFFER_RING_SIZE "BUFFER_RING_SIZE"
+#define BUFFER_RING_SIZE_DEFAULT 32
+#define BUFFER_RING_THRESHOLD "BUFFER_RING_THRESHOLD"
+#define BUFFER_RING_THRESHOLD_DEFAULT 25
+#define HUGE_PAGE "HUGE_PAGE"
+#define HUGE_PAGE_DEFAULT 0
+#define DIRECT_IO "DIRECT_IO"
+#define DIRECT_IO_DEFAULT 0
+#define WARM_UP "WARM_UP"
+#define WARM_UP_DEFAULT 0
+#define WARM_UP_FILE "WARM_UP_FILE"
+#define WARM_UP_FILE_DEFAULT "miniob/buffer_pool.warm_up"
+#define WARM_UP_DUMP_INTERVAL "WARM_UP_DUMP_INTERVAL"
+#define WARM_UP_DUMP_INTERVAL_DEFAULT 300
+#define SECONDARY_CACHE_FILE "SECONDARY_CACHE_FILE"
+#define SECONDARY_CACHE_FILE_DEFAULT "miniob/buffer_pool.cache"
+#define SECONDARY_CACHE_SIZE_MB "SECONDARY_CACHE_SIZE_MB"
+#define SECONDARY_CACHE_SIZE_MB_DEFAULT 0
+#define NAMED_POOLS "NAMED_POOLS"
+#define NAMED_POOLS_DEFAULT ""
+
+// 有名字的页帧管理器，每个页帧管理器使用一个与名字相同的配置段
+#define POOL_MEMORY_SIZE_MB "MEMORY_SIZE_MB"
+#define POOL_MEMORY_SIZE_MB_DEFAULT 64
+#define POOL_TABLES "TABLES"
+#define POOL_TABLE_INDEXES "TABLE_INDEXES"
+
+#define INDEX_SECTION "INDEX"
+#define BULK_LOAD_FILL_FACTOR "BULK_LOAD_FILL_FACTOR"
+#define BULK_LOAD_FILL_FACTOR_DEFAULT 90
+#define BULK_LOAD_SORT_MEMORY_MB "BULK_LOAD_SORT_MEMORY_MB"
+#define BULK_LOAD_SORT_MEMORY_MB_DEFAULT 64
+
+#define CLOG_SECTION "CLOG"
+#define CHECKPOINT_INTERVAL "CHECKPOINT_INTERVAL"
+#define CHECKPOINT_INTERVAL_DEFAULT 60
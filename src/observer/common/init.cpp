@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "common/init.h"
+#include "common/ini_setting.h"
 
 #include "common/conf/ini.h"
 #include "common/lang/string.h"
@@ -29,6 +30,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/plan_cache/plan_cache_stage.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/default/default_handler.h"
+#include "storage/index/bplus_tree_bulk_loader.h"
 #include "storage/trx/trx.h"
 
 using namespace std;
@@ -137,13 +139,114 @@ int prepare_init_seda()
   return 0;
 }
 
+static void split_names(const string &str, vector<string> &names)
+{
+  vector<string> items;
+  split_string(str, ",", items);
+  for (string &item : items) {
+    strip(item);
+    if (!item.empty()) {
+      names.push_back(item);
+    }
+  }
+}
+
+/**
+ * @brief 创建配置文件中的有名字的页帧管理器，并指定哪些表使用这些页帧管理器
+ */
+static int init_named_pools(Ini &properties, BufferPoolManager &bpm)
+{
+  vector<string> pool_names;
+  split_names(properties.get(NAMED_POOLS, NAMED_POOLS_DEFAULT, BUFFER_POOL_SECTION), pool_names);
+  for (const string &pool_name : pool_names) {
+    int64_t memory_size_mb = POOL_MEMORY_SIZE_MB_DEFAULT;
+    str_to_val(properties.get(POOL_MEMORY_SIZE_MB, to_string(POOL_MEMORY_SIZE_MB_DEFAULT), pool_name), memory_size_mb);
+    const string replacer = properties.get(REPLACEMENT_POLICY, REPLACEMENT_POLICY_DEFAULT, pool_name);
+
+    RC rc = bpm.create_pool(pool_name.c_str(), memory_size_mb * 1024 * 1024, replacer.c_str());
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to create buffer pool. name=%s, memory size=%ldMB, rc=%s",
+                pool_name.c_str(), memory_size_mb, strrc(rc));
+      return -1;
+    }
+
+    vector<string> tables;
+    split_names(properties.get(POOL_TABLES, "", pool_name), tables);
+    for (const string &table : tables) {
+      bpm.set_table_pool(table.c_str(), pool_name.c_str(), false /*index*/);
+    }
+
+    vector<string> index_tables;
+    split_names(properties.get(POOL_TABLE_INDEXES, "", pool_name), index_tables);
+    for (const string &table : index_tables) {
+      bpm.set_table_pool(table.c_str(), pool_name.c_str(), true /*index*/);
+    }
+  }
+  return 0;
+}
+
 int init_global_objects(ProcessParam *process_param, Ini &properties)
 {
-  GCTX.buffer_pool_manager_ = new BufferPoolManager();
+  int frame_shard_num        = FRAME_SHARD_NUM_DEFAULT;
+  int page_cleaner_num       = PAGE_CLEANER_NUM_DEFAULT;
+  int page_cleaner_low_water = PAGE_CLEANER_LOW_WATER_MARK_DEFAULT;
+  int huge_page              = HUGE_PAGE_DEFAULT;
+  int direct_io              = DIRECT_IO_DEFAULT;
+  str_to_val(properties.get(FRAME_SHARD_NUM, to_string(FRAME_SHARD_NUM_DEFAULT), BUFFER_POOL_SECTION),
+             frame_shard_num);
+  str_to_val(properties.get(PAGE_CLEANER_NUM, to_string(PAGE_CLEANER_NUM_DEFAULT), BUFFER_POOL_SECTION),
+             page_cleaner_num);
+  str_to_val(properties.get(PAGE_CLEANER_LOW_WATER_MARK, to_string(PAGE_CLEANER_LOW_WATER_MARK_DEFAULT),
+                 BUFFER_POOL_SECTION),
+             page_cleaner_low_water);
+  str_to_val(properties.get(HUGE_PAGE, to_string(HUGE_PAGE_DEFAULT), BUFFER_POOL_SECTION), huge_page);
+  str_to_val(properties.get(DIRECT_IO, to_string(DIRECT_IO_DEFAULT), BUFFER_POOL_SECTION), direct_io);
+  const string replacer = properties.get(REPLACEMENT_POLICY, REPLACEMENT_POLICY_DEFAULT, BUFFER_POOL_SECTION);
+  const string page_io  = properties.get(PAGE_IO, PAGE_IO_DEFAULT, BUFFER_POOL_SECTION);
+
+  GCTX.buffer_pool_manager_ =
+      new BufferPoolManager(0 /*memory_size*/, frame_shard_num, replacer.c_str(), page_io.c_str(), huge_page != 0);
   BufferPoolManager::set_instance(GCTX.buffer_pool_manager_);
+  GCTX.buffer_pool_manager_->set_direct_io(direct_io != 0);
+  if (init_named_pools(properties, *GCTX.buffer_pool_manager_) != 0) {
+    return -1;
+  }
+  GCTX.buffer_pool_manager_->start_page_cleaner(page_cleaner_num, page_cleaner_low_water);
+
+  BPReadAheadOptions read_ahead_options;
+  read_ahead_options.min_pages = READ_AHEAD_MIN_PAGES_DEFAULT;
+  read_ahead_options.max_pages = READ_AHEAD_MAX_PAGES_DEFAULT;
+  str_to_val(properties.get(READ_AHEAD_MIN_PAGES, to_string(READ_AHEAD_MIN_PAGES_DEFAULT), BUFFER_POOL_SECTION),
+             read_ahead_options.min_pages);
+  str_to_val(properties.get(READ_AHEAD_MAX_PAGES, to_string(READ_AHEAD_MAX_PAGES_DEFAULT), BUFFER_POOL_SECTION),
+             read_ahead_options.max_pages);
+  GCTX.buffer_pool_manager_->set_read_ahead_options(read_ahead_options);
+
+  BPBufferRingOptions buffer_ring_options;
+  buffer_ring_options.size          = BUFFER_RING_SIZE_DEFAULT;
+  buffer_ring_options.threshold_pct = BUFFER_RING_THRESHOLD_DEFAULT;
+  str_to_val(properties.get(BUFFER_RING_SIZE, to_string(BUFFER_RING_SIZE_DEFAULT), BUFFER_POOL_SECTION),
+             buffer_ring_options.size);
+  str_to_val(properties.get(BUFFER_RING_THRESHOLD, to_string(BUFFER_RING_THRESHOLD_DEFAULT), BUFFER_POOL_SECTION),
+             buffer_ring_options.threshold_pct);
+  GCTX.buffer_pool_manager_->set_buffer_ring_options(buffer_ring_options);
+
+  BplusTreeBulkLoadOptions bulk_load_options;
+  bulk_load_options.fill_factor_pct = BULK_LOAD_FILL_FACTOR_DEFAULT;
+  bulk_load_options.sort_memory_mb  = BULK_LOAD_SORT_MEMORY_MB_DEFAULT;
+  str_to_val(properties.get(BULK_LOAD_FILL_FACTOR, to_string(BULK_LOAD_FILL_FACTOR_DEFAULT), INDEX_SECTION),
+             bulk_load_options.fill_factor_pct);
+  str_to_val(properties.get(BULK_LOAD_SORT_MEMORY_MB, to_string(BULK_LOAD_SORT_MEMORY_MB_DEFAULT), INDEX_SECTION),
+             bulk_load_options.sort_memory_mb);
+  BplusTreeBulkLoader::set_default_options(bulk_load_options);
 
   GCTX.handler_ = new DefaultHandler();
 
+  int checkpoint_interval = CHECKPOINT_INTERVAL_DEFAULT;
+  str_to_val(properties.get(CHECKPOINT_INTERVAL, to_string(CHECKPOINT_INTERVAL_DEFAULT), CLOG_SECTION),
+             checkpoint_interval);
+  GCTX.handler_->set_checkpoint_interval(checkpoint_interval);
+
   DefaultHandler::set_default(GCTX.handler_);
 
   int ret = 0;
@@ -159,11 +262,40 @@ int init_global_objects(ProcessParam *process_param, Ini &properties)
     LOG_ERROR("failed to init handler. rc=%s", strrc(rc));
     return -1;
   }
+
+  // 缓存文件与数据库的文件放在同一个目录下时，需要等目录创建出来
+  int64_t secondary_cache_size_mb = SECONDARY_CACHE_SIZE_MB_DEFAULT;
+  str_to_val(properties.get(SECONDARY_CACHE_SIZE_MB, to_string(SECONDARY_CACHE_SIZE_MB_DEFAULT), BUFFER_POOL_SECTION),
+             secondary_cache_size_mb);
+  const string secondary_cache_file =
+      properties.get(SECONDARY_CACHE_FILE, SECONDARY_CACHE_FILE_DEFAULT, BUFFER_POOL_SECTION);
+  rc = GCTX.buffer_pool_manager_->init_secondary_cache(
+      secondary_cache_file.c_str(), secondary_cache_size_mb * 1024 * 1024);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to init secondary cache of buffer pool. file=%s, rc=%s", secondary_cache_file.c_str(), strrc(rc));
+    return -1;
+  }
+
+  // 预热需要在数据库的文件都打开之后再开始
+  int warm_up               = WARM_UP_DEFAULT;
+  int warm_up_dump_interval = WARM_UP_DUMP_INTERVAL_DEFAULT;
+  str_to_val(properties.get(WARM_UP, to_string(WARM_UP_DEFAULT), BUFFER_POOL_SECTION), warm_up);
+  str_to_val(properties.get(WARM_UP_DUMP_INTERVAL, to_string(WARM_UP_DUMP_INTERVAL_DEFAULT), BUFFER_POOL_SECTION),
+             warm_up_dump_interval);
+  const string warm_up_file = properties.get(WARM_UP_FILE, WARM_UP_FILE_DEFAULT, BUFFER_POOL_SECTION);
+  if (warm_up != 0) {
+    GCTX.buffer_pool_manager_->start_warm_up(warm_up_file.c_str(), warm_up_dump_interval);
+  }
   return ret;
 }
 
 int uninit_global_objects()
 {
+  // 在关闭数据库文件之前保存 buffer pool 中的页面列表
+  if (GCTX.buffer_pool_manager_ != nullptr) {
+    GCTX.buffer_pool_manager_->warm_up().stop();
+  }
+
   // TODO use global context
   DefaultHandler *default_handler = &DefaultHandler::get_default();
   if (default_handler != nullptr) {
@@ -174,6 +306,7 @@ int uninit_global_objects()
   BufferPoolManager *bpm = &BufferPoolManager::instance();
   if (bpm != nullptr) {
     BufferPoolManager::set_instance(nullptr);
+    GCTX.buffer_pool_manager_ = nullptr;
     delete bpm;
   }
   return 0;
@@ -28,11 +28,12 @@ BufferedWriter::~BufferedWriter() { close(); }
 
 RC BufferedWriter::close()
 {
+  lock_guard<mutex> guard(lock_);
   if (fd_ < 0) {
     return RC::SUCCESS;
   }
 
-  RC rc = flush();
+  RC rc = flush_locked();
   if (OB_FAIL(rc)) {
     return rc;
   }
@@ -44,22 +45,13 @@ RC BufferedWriter::close()
 
 RC BufferedWriter::write(const char *data, int32_t size, int32_t &write_size)
 {
-  if (fd_ < 0) {
-    return RC::INVALID_ARGUMENT;
-  }
-
-  if (buffer_.remain() == 0) {
-    RC rc = flush_internal(size);
-    if (OB_FAIL(rc)) {
-      return rc;
-    }
-  }
-
-  return buffer_.write(data, size, write_size);
+  lock_guard<mutex> guard(lock_);
+  return write_locked(data, size, write_size);
 }
 
 RC BufferedWriter::writen(const char *data, int32_t size)
 {
+  lock_guard<mutex> guard(lock_);
   if (fd_ < 0) {
     return RC::INVALID_ARGUMENT;
   }
@@ -68,7 +60,7 @@ RC BufferedWriter::writen(const char *data, int32_t size)
   while (write_size < size) {
     int32_t tmp_write_size = 0;
 
-    RC rc = write(data + write_size, size - write_size, tmp_write_size);
+    RC rc = write_locked(data + write_size, size - write_size, tmp_write_size);
     if (OB_FAIL(rc)) {
       return rc;
     }
@@ -80,6 +72,28 @@ RC BufferedWriter::writen(const char *data, int32_t size)
 }
 
 RC BufferedWriter::flush()
+{
+  lock_guard<mutex> guard(lock_);
+  return flush_locked();
+}
+
+RC BufferedWriter::write_locked(const char *data, int32_t size, int32_t &write_size)
+{
+  if (fd_ < 0) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (buffer_.remain() == 0) {
+    RC rc = flush_internal(size);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  return buffer_.write(data, size, write_size);
+}
+
+RC BufferedWriter::flush_locked()
 {
   if (fd_ < 0) {
     return RC::INVALID_ARGUMENT;
@@ -14,13 +14,16 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <mutex>
+
 #include "net/ring_buffer.h"
 
 /**
  * @brief 支持以缓存模式写入数据到文件/socket
  * @details 缓存使用ring buffer实现，当缓存满时会自动刷新缓存。
  * 看起来直接使用fdopen也可以实现缓存写，不过fdopen会在close时直接关闭fd。
- * @note 在执行close时，描述符fd并不会被关闭
+ * @note 在执行close时，描述符fd并不会被关闭。
+ * 同一个连接的请求可能由不同的线程处理，所有的公开接口都会加锁
  */
 class BufferedWriter
 {
@@ -58,6 +61,12 @@ public:
   RC flush();
 
 private:
+  /**
+   * @brief 与 write/flush 相同，调用者需要持有锁
+   */
+  RC write_locked(const char *data, int32_t size, int32_t &write_size);
+  RC flush_locked();
+
   /**
    * @brief 刷新缓存
    * @details 期望缓存可以刷新size大小的数据，实际刷新的数据量可能小于size也可能大于size。
@@ -67,6 +76,7 @@ private:
   RC flush_internal(int32_t size);
 
 private:
+  std::mutex lock_;
   int        fd_ = -1;
   RingBuffer buffer_;
 };
\ No newline at end of file
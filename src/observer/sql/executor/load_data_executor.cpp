@@ -18,9 +18,13 @@ See the Mulan PSL v2 for more details. */
 #include "sql/executor/sql_result.h"
 #include "common/lang/string.h"
 #include "sql/stmt/load_data_stmt.h"
+#include "storage/buffer/buffer_ring.h"
 
 using namespace common;
 
+/// 导入数据时每攒够这么多行批量插入一次，参考 Table::insert_records
+static constexpr int LOAD_DATA_BATCH_SIZE = 1024;
+
 RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 {
   RC rc = RC::SUCCESS;
@@ -33,17 +37,19 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 }
 
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 从文件中导入数据时使用。把解析后的一行数据转换成一条记录，攒够一批之后再插入到表中。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param record 返回转换出来的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(Table *table, 
-                           std::vector<std::string> &file_values, 
-                           std::vector<Value> &record_values, 
-                           std::stringstream &errmsg)
+RC make_record_from_file(Table *table, 
+                         std::vector<std::string> &file_values, 
+                         std::vector<Value> &record_values, 
+                         Record &record,
+                         std::stringstream &errmsg)
 {
 
   const int field_num = record_values.size();
@@ -105,12 +111,9 @@ RC insert_record_from_file(Table *table,
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
       errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
     }
   }
   return rc;
@@ -141,6 +144,27 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult
   int line_num = 0;
   int insertion_count = 0;
   RC rc = RC::SUCCESS;
+  std::unique_ptr<BPBufferRing> ring = table->create_bulk_write_ring();
+
+  std::vector<Record> records;
+  records.reserve(LOAD_DATA_BATCH_SIZE);
+  int batch_first_line = 0;
+  int batch_last_line  = 0;
+  auto flush_records = [&]() {
+    if (records.empty()) {
+      return RC::SUCCESS;
+    }
+    RC rc = table->insert_records(records, ring.get());
+    if (rc != RC::SUCCESS) {
+      result_string << "Line:" << batch_first_line << "-" << batch_last_line
+                    << " insert records failed. error:" << strrc(rc) << std::endl;
+    } else {
+      insertion_count += static_cast<int>(records.size());
+    }
+    records.clear();
+    return rc;
+  };
+
   while (!fs.eof() && RC::SUCCESS == rc) {
     std::getline(fs, line);
     line_num++;
@@ -151,13 +175,27 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult
     file_values.clear();
     common::split_string(line, delim, file_values);
     std::stringstream errmsg;
-    rc = insert_record_from_file(table, file_values, record_values, errmsg);
+    if (records.empty()) {
+      batch_first_line = line_num;
+    }
+    records.emplace_back();
+    rc = make_record_from_file(table, file_values, record_values, records.back(), errmsg);
     if (rc != RC::SUCCESS) {
       result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
                     << std::endl;
-    } else {
-      insertion_count++;
+      // 出错之前的行还是要导入的
+      records.pop_back();
+      flush_records();
+      break;
     }
+
+    batch_last_line = line_num;
+    if (static_cast<int>(records.size()) >= LOAD_DATA_BATCH_SIZE) {
+      rc = flush_records();
+    }
+  }
+  if (RC::SUCCESS == rc) {
+    rc = flush_records();
   }
   fs.close();
 
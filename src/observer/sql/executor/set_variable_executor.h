@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/executor/sql_result.h"
 #include "session/session.h"
 #include "sql/stmt/set_variable_stmt.h"
+#include "storage/buffer/disk_buffer_pool.h"
 
 /**
  * @brief SetVariable语句执行器
@@ -49,6 +50,30 @@ public:
 
       session->set_sql_debug(bool_value);
       LOG_TRACE("set sql_debug to %d", bool_value);
+    } else if (strcasecmp(var_name, "buffer_pool_size") == 0) {
+      // 调整有名字的页帧管理器时，值的格式是 '<pool name>:<size>'，比如 'hot:256M'
+      std::string pool_name;
+      int64_t     memory_size = 0;
+      rc = var_value_to_pool_size(var_value, pool_name, memory_size);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      BufferPoolManager &bpm = BufferPoolManager::instance();
+      rc = bpm.resize(memory_size, pool_name.c_str());
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      // 缩小是逐步完成的，返回当前的大小和还没有回收的页帧个数
+      BPFrameManager *frame_manager = bpm.find_pool(pool_name.c_str());
+      char state[256];
+      snprintf(state, sizeof(state), "buffer pool %s frames: %d, target frames: %d, pending shrink frames: %d",
+               frame_manager->name(), static_cast<int>(frame_manager->total_frame_num()),
+               static_cast<int>(frame_manager->target_frame_num()),
+               static_cast<int>(frame_manager->pending_shrink_frame_num()));
+      sql_event->session_event()->sql_result()->set_state_string(state);
+      LOG_INFO("set buffer_pool_size to %ld. %s", memory_size, state);
     } else {
       rc = RC::VARIABLE_NOT_EXISTS;
     }
@@ -57,6 +82,58 @@ public:
   }
 
 private:
+  /**
+   * @brief 解析内存大小，可以是整数(字节)，也可以是带 K/M/G 单位的字符串，比如 '256M'。
+   * 字符串中可以用 '<pool name>:' 前缀指定页帧管理器，没有前缀时 pool_name 为空，表示默认的页帧管理器
+   */
+  RC var_value_to_pool_size(const Value &var_value, std::string &pool_name, int64_t &size) const
+  {
+    if (var_value.attr_type() == AttrType::INTS) {
+      size = var_value.get_int();
+      return size > 0 ? RC::SUCCESS : RC::VARIABLE_NOT_VALID;
+    }
+
+    if (var_value.attr_type() != AttrType::CHARS) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    std::string str = var_value.get_string();
+    const size_t colon = str.find(':');
+    if (colon != std::string::npos) {
+      pool_name = str.substr(0, colon);
+      str       = str.substr(colon + 1);
+      if (pool_name.empty()) {
+        return RC::VARIABLE_NOT_VALID;
+      }
+    }
+
+    char *end = nullptr;
+    long long value = strtoll(str.c_str(), &end, 10);
+    if (end == str.c_str() || value <= 0) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    int64_t unit = 1;
+    if (*end != '\0') {
+      switch (toupper(*end)) {
+        case 'K': unit = 1024L; break;
+        case 'M': unit = 1024L * 1024; break;
+        case 'G': unit = 1024L * 1024 * 1024; break;
+        default: return RC::VARIABLE_NOT_VALID;
+      }
+      end++;
+      if (toupper(*end) == 'B') {
+        end++;
+      }
+    }
+
+    if (*end != '\0') {
+      return RC::VARIABLE_NOT_VALID;
+    }
+    size = static_cast<int64_t>(value) * unit;
+    return RC::SUCCESS;
+  }
+
   RC var_value_to_boolean(const Value &var_value, bool &bool_value) const
   {
     RC rc = RC::SUCCESS;
@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include "common/rc.h"
+#include "sql/operator/string_list_physical_operator.h"
+#include "event/sql_event.h"
+#include "event/session_event.h"
+#include "sql/executor/sql_result.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+/**
+ * @brief 显示所有页帧管理器的执行器
+ * @ingroup Executor
+ * @details 每个页帧管理器一行，命中率是页面访问中命中缓存的比例。启用了二级缓存时，最后一行是二级缓存
+ */
+class ShowBufferPoolsExecutor
+{
+public:
+  ShowBufferPoolsExecutor() = default;
+  virtual ~ShowBufferPoolsExecutor() = default;
+
+  RC execute(SQLStageEvent *sql_event)
+  {
+    SqlResult *sql_result = sql_event->session_event()->sql_result();
+
+    TupleSchema tuple_schema;
+    for (const char *column : {"Name", "Frames", "Used_frames", "Replacer", "Hits", "Misses", "Evictions", "Hit_ratio"}) {
+      tuple_schema.append_cell(TupleCellSpec("", column, column));
+    }
+    sql_result->set_tuple_schema(tuple_schema);
+
+    auto oper = new StringListPhysicalOperator;
+    for (BPFrameManager *frame_manager : BufferPoolManager::instance().frame_managers()) {
+      BPFrameStats &stats = frame_manager->stats();
+
+      oper->append({frame_manager->name(),
+          std::to_string(frame_manager->total_frame_num()),
+          std::to_string(frame_manager->frame_num()),
+          frame_manager->replacer_name(),
+          std::to_string(stats.hit_count.load()),
+          std::to_string(stats.miss_count.load()),
+          std::to_string(stats.evict_count.load()),
+          hit_ratio(stats.hit_count.load(), stats.miss_count.load())});
+    }
+
+    // 二级缓存也作为一行显示，Frames 是缓存文件中的槽位个数
+    BPSecondaryCache &secondary_cache = BufferPoolManager::instance().secondary_cache();
+    if (secondary_cache.enabled()) {
+      BPSecondaryCacheStats &stats = secondary_cache.stats();
+
+      oper->append({"secondary_cache",
+          std::to_string(secondary_cache.capacity()),
+          std::to_string(secondary_cache.size()),
+          "lru",
+          std::to_string(stats.hit_count.load()),
+          std::to_string(stats.miss_count.load()),
+          std::to_string(stats.evict_count.load()),
+          hit_ratio(stats.hit_count.load(), stats.miss_count.load())});
+    }
+
+    sql_result->set_operator(std::unique_ptr<PhysicalOperator>(oper));
+    return RC::SUCCESS;
+  }
+
+private:
+  static std::string hit_ratio(int64_t hit_count, int64_t miss_count)
+  {
+    char ratio[32];
+    snprintf(ratio, sizeof(ratio), "%.2f%%",
+             hit_count + miss_count == 0 ? 0.0 : hit_count * 100.0 / (hit_count + miss_count));
+    return ratio;
+  }
+};
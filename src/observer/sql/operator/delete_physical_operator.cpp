@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by WangYunlai on 2022/6/27.
 //
 
+#include <vector>
+
 #include "common/log/log.h"
 #include "sql/operator/delete_physical_operator.h"
 #include "storage/record/record.h"
@@ -34,40 +36,53 @@ RC DeletePhysicalOperator::open(Trx *trx)
 
   trx_ = trx;
 
-  return RC::SUCCESS;
-}
-
-RC DeletePhysicalOperator::next()
-{
-  RC rc = RC::SUCCESS;
-  if (children_.empty()) {
-    return RC::RECORD_EOF;
-  }
-
-  PhysicalOperator *child = children_[0].get();
+  // 先把要删除的记录都取出来再删除。下层是索引扫描时，边扫描边删除会修改正在扫描的索引节点，
+  // 导致跳过一些记录。取完之后马上关闭下层算子，放开它持有的索引节点和记录页面的锁，
+  // 否则删除记录时修改同一个页面会等待当前线程自己持有的锁
+  records_.clear();
   while (RC::SUCCESS == (rc = child->next())) {
     Tuple *tuple = child->current_tuple();
     if (nullptr == tuple) {
+      rc = RC::INTERNAL;
       LOG_WARN("failed to get current record: %s", strrc(rc));
-      return rc;
+      break;
     }
 
     RowTuple *row_tuple = static_cast<RowTuple *>(tuple);
     Record &record = row_tuple->record();
+    records_.emplace_back();
+    records_.back().set_rid(record.rid());
+    records_.back().copy_data(record.data(), record.len());
+  }
+
+  child->close();
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to scan records to delete: %s", strrc(rc));
+    records_.clear();
+    return rc;
+  }
+
+  return RC::SUCCESS;
+}
+
+RC DeletePhysicalOperator::next()
+{
+  RC rc = RC::SUCCESS;
+  for (Record &record : records_) {
     rc = trx_->delete_record(table_, record);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to delete record: %s", strrc(rc));
+      records_.clear();
       return rc;
     }
   }
 
+  records_.clear();
   return RC::RECORD_EOF;
 }
 
 RC DeletePhysicalOperator::close()
 {
-  if (!children_.empty()) {
-    children_[0]->close();
-  }
+  records_.clear();
   return RC::SUCCESS;
 }
@@ -14,7 +14,10 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "sql/operator/physical_operator.h"
+#include "storage/record/record.h"
 
 class Trx;
 class DeleteStmt;
@@ -48,4 +51,5 @@ public:
 private:
   Table *table_ = nullptr;
   Trx *trx_ = nullptr;
+  std::vector<Record> records_;  ///< open 时收集的需要删除的记录
 };
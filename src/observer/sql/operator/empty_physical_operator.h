@@ -0,0 +1,55 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 空结果物理算子
+ * @ingroup PhysicalOperator
+ * @details 查询条件互相矛盾时(比如 a > 5 and a < 3)，不需要扫描任何数据，直接返回空结果
+ */
+class EmptyPhysicalOperator : public PhysicalOperator
+{
+public:
+  EmptyPhysicalOperator() = default;
+  virtual ~EmptyPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override
+  {
+    return PhysicalOperatorType::EMPTY;
+  }
+
+  RC open(Trx *) override
+  {
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    return RC::RECORD_EOF;
+  }
+
+  RC close() override
+  {
+    return RC::SUCCESS;
+  }
+
+  Tuple *current_tuple() override
+  {
+    return nullptr;
+  }
+};
@@ -18,21 +18,16 @@ See the Mulan PSL v2 for more details. */
 
 IndexScanPhysicalOperator::IndexScanPhysicalOperator(
     Table *table, Index *index, bool readonly, 
-    const Value *left_value, bool left_inclusive, 
-    const Value *right_value, bool right_inclusive)
+    const std::vector<Value> &left_values, bool left_inclusive, 
+    const std::vector<Value> &right_values, bool right_inclusive)
     : table_(table), 
       index_(index), 
       readonly_(readonly), 
+      left_values_(left_values),
+      right_values_(right_values),
       left_inclusive_(left_inclusive), 
       right_inclusive_(right_inclusive)
-{
-  if (left_value) {
-    left_value_ = *left_value;
-  }
-  if (right_value) {
-    right_value_ = *right_value;
-  }
-}
+{}
 
 RC IndexScanPhysicalOperator::open(Trx *trx)
 {
@@ -40,12 +35,20 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
-      left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
-      right_inclusive_);
+  bool left_inclusive = left_inclusive_;
+  bool right_inclusive = right_inclusive_;
+  make_bound_key(left_values_, left_key_, left_inclusive);
+  make_bound_key(right_values_, right_key_, right_inclusive);
+
+  // 键值的最后多放了一个'\0'，长度中不包含
+  IndexScanner *index_scanner = index_->create_scanner(
+      left_values_.empty() ? nullptr : left_key_.data(),
+      static_cast<int>(left_key_.size()) - 1,
+      left_inclusive,
+      right_values_.empty() ? nullptr : right_key_.data(),
+      static_cast<int>(right_key_.size()) - 1,
+      right_inclusive,
+      descending_);
   if (nullptr == index_scanner) {
     LOG_WARN("failed to create index scanner");
     return RC::INTERNAL;
@@ -61,6 +64,16 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
 
+  const IndexMeta &index_meta = index_->index_meta();
+  key_fields_.clear();
+  int key_offset = 0;
+  for (int i = 0; i < index_meta.field_num(); i++) {
+    const FieldMeta *field_meta = table_->table_meta().field(index_meta.field(i));
+    key_fields_.emplace_back(key_offset, field_meta);
+    key_offset += field_meta->len();
+  }
+  not_all_visible_pages_.clear();
+
   trx_ = trx;
   return RC::SUCCESS;
 }
@@ -74,6 +87,20 @@ RC IndexScanPhysicalOperator::next()
 
   bool filter_result = false;
   while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
+    if (index_only_ && is_page_all_visible(rid.page_num)) {
+      make_index_only_record(rid);
+      tuple_.set_record(&current_record_);
+      rc = filter(tuple_, filter_result);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+
+      if (!filter_result) {
+        continue;
+      }
+      return rc;
+    }
+
     rc = record_handler_->get_record(record_page_handler_, &rid, readonly_, &current_record_);
     if (rc != RC::SUCCESS) {
       return rc;
@@ -102,8 +129,11 @@ RC IndexScanPhysicalOperator::next()
 
 RC IndexScanPhysicalOperator::close()
 {
-  index_scanner_->destroy();
-  index_scanner_ = nullptr;
+  record_page_handler_.cleanup();
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
   return RC::SUCCESS;
 }
 
@@ -139,7 +169,61 @@ RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
   return rc;
 }
 
+void IndexScanPhysicalOperator::make_bound_key(const std::vector<Value> &values, std::vector<char> &key,
+                                               bool &inclusive) const
+{
+  const IndexMeta &index_meta = index_->index_meta();
+  key.clear();
+  for (size_t i = 0; i < values.size(); i++) {
+    const FieldMeta *field_meta = table_->table_meta().field(index_meta.field(static_cast<int>(i)));
+    const Value &value = values[i];
+    const int copy_len = std::min(value.length(), field_meta->len());
+    if (value.length() > field_meta->len()) {
+      inclusive = true;
+    }
+
+    const size_t offset = key.size();
+    key.resize(offset + field_meta->len(), 0);
+    memcpy(key.data() + offset, value.data(), copy_len);
+  }
+  key.push_back(0);
+}
+
+bool IndexScanPhysicalOperator::is_page_all_visible(PageNum page_num)
+{
+  // 全部可见的页面随时可能被修改，每次都要重新判断，只记住不可见的页面
+  if (not_all_visible_pages_.contains(page_num)) {
+    return false;
+  }
+
+  if (trx_->is_page_all_visible(table_, page_num)) {
+    return true;
+  }
+  not_all_visible_pages_.insert(page_num);
+  return false;
+}
+
+void IndexScanPhysicalOperator::make_index_only_record(const RID &rid)
+{
+  const int record_size = table_->table_meta().record_size();
+  char *data = current_record_.alloc_data(record_size);
+  memset(data, 0, record_size);
+
+  const char *key = index_scanner_->current_key();
+  for (const auto &[key_offset, field_meta] : key_fields_) {
+    memcpy(data + field_meta->offset(), key + key_offset, field_meta->len());
+  }
+  current_record_.set_rid(rid);
+}
+
 std::string IndexScanPhysicalOperator::param() const
 {
-  return std::string(index_->index_meta().name()) + " ON " + table_->name();
+  std::string param = std::string(index_->index_meta().name()) + " ON " + table_->name();
+  if (index_only_) {
+    param += ", INDEX ONLY";
+  }
+  if (descending_) {
+    param += ", DESC";
+  }
+  return param;
 }
@@ -14,6 +14,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <unordered_set>
+#include <utility>
+
 #include "sql/operator/physical_operator.h"
 #include "sql/expr/tuple.h"
 #include "storage/record/record_manager.h"
@@ -25,9 +28,13 @@ See the Mulan PSL v2 for more details. */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
 public:
+  /**
+   * @details 组合索引的左右边界可以只包含索引前面几个字段的值，按照索引字段的顺序排列。
+   * 边界值为空表示没有这个边界
+   */
   IndexScanPhysicalOperator(Table *table, Index *index, bool readonly, 
-      const Value *left_value, bool left_inclusive,
-      const Value *right_value, bool right_inclusive);
+      const std::vector<Value> &left_values, bool left_inclusive,
+      const std::vector<Value> &right_values, bool right_inclusive);
 
   virtual ~IndexScanPhysicalOperator() = default;
 
@@ -46,10 +53,38 @@ public:
 
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 使用覆盖索引扫描，直接用索引中的字段值构造记录，不再读取表中的记录
+   * @details 只有查询用到的字段都在索引中时才能使用。记录所在页面不是全部可见时，仍然需要读取记录判断可见性
+   */
+  void set_index_only(bool index_only) { index_only_ = index_only; }
+
+  /**
+   * @brief 按照索引键值从大到小的顺序返回数据
+   * @details 从扫描范围的右边界开始逆序扫描，可以让 ORDER BY ... DESC LIMIT 这样的查询不必读完整个范围
+   */
+  void set_descending(bool descending) { descending_ = descending; }
+
 private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
 
+  /**
+   * @brief 把边界值转换成索引的键值
+   * @details 每个值都按照索引字段的长度存放。字符串超过字段长度时会截断，这时边界需要改成包含边界值
+   */
+  void make_bound_key(const std::vector<Value> &values, std::vector<char> &key, bool &inclusive) const;
+
+  /**
+   * @brief 覆盖索引扫描时，记录所在的页面是否全部可见，不可见的页面在一次扫描中只检查一次
+   */
+  bool is_page_all_visible(PageNum page_num);
+
+  /**
+   * @brief 把索引中当前键值的各个字段放到记录中对应的位置上
+   */
+  void make_index_only_record(const RID &rid);
+
 private:
   Trx * trx_ = nullptr;
   Table *table_ = nullptr;
@@ -62,10 +97,17 @@ private:
   Record current_record_;
   RowTuple tuple_;
 
-  Value left_value_;
-  Value right_value_;
+  std::vector<Value> left_values_;
+  std::vector<Value> right_values_;
+  std::vector<char> left_key_;
+  std::vector<char> right_key_;
   bool left_inclusive_ = false;
   bool right_inclusive_ = false;
 
+  bool index_only_ = false;
+  bool descending_ = false;
+  std::vector<std::pair<int, const FieldMeta *>> key_fields_;  ///< 索引字段在键值中的偏移和字段
+  std::unordered_set<PageNum> not_all_visible_pages_;
+
   std::vector<std::unique_ptr<Expression>> predicates_;
 };
@@ -14,7 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/insert_logical_operator.h"
 
-InsertLogicalOperator::InsertLogicalOperator(Table *table, std::vector<Value> values)
-    : table_(table), values_(values)
+InsertLogicalOperator::InsertLogicalOperator(Table *table, std::vector<std::vector<Value>> rows)
+    : table_(table), rows_(std::move(rows))
 {
 }
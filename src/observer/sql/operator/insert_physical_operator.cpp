@@ -19,20 +19,28 @@ See the Mulan PSL v2 for more details. */
 
 using namespace std;
 
-InsertPhysicalOperator::InsertPhysicalOperator(Table *table, vector<Value> &&values)
-    : table_(table), values_(std::move(values))
+InsertPhysicalOperator::InsertPhysicalOperator(Table *table, vector<vector<Value>> &&rows)
+    : table_(table), rows_(std::move(rows))
 {}
 
 RC InsertPhysicalOperator::open(Trx *trx)
 {
-  Record record;
-  RC rc = table_->make_record(static_cast<int>(values_.size()), values_.data(), record);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to make record. rc=%s", strrc(rc));
-    return rc;
+  vector<Record> records(rows_.size());
+  for (size_t i = 0; i < rows_.size(); i++) {
+    RC rc = table_->make_record(static_cast<int>(rows_[i].size()), rows_[i].data(), records[i]);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to make record. rc=%s", strrc(rc));
+      return rc;
+    }
   }
 
-  rc = trx->insert_record(table_, record);
+  // 一次插入多行时使用批量接口，每个页面只加一次锁、写一条日志
+  RC rc = RC::SUCCESS;
+  if (records.size() == 1) {
+    rc = trx->insert_record(table_, records[0]);
+  } else {
+    rc = trx->insert_records(table_, records);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to insert record by transaction. rc=%s", strrc(rc));
   }
@@ -21,6 +21,8 @@ std::string physical_operator_type_name(PhysicalOperatorType type)
       return "TABLE_SCAN";
     case PhysicalOperatorType::INDEX_SCAN:
       return "INDEX_SCAN";
+    case PhysicalOperatorType::EMPTY:
+      return "EMPTY";
     case PhysicalOperatorType::NESTED_LOOP_JOIN:
       return "NESTED_LOOP_JOIN";
     case PhysicalOperatorType::EXPLAIN:
@@ -35,6 +35,11 @@ public:
   Table *table() const  { return table_; }
   bool readonly() const { return readonly_; }
 
+  /**
+   * @brief 查询中用到的这张表的字段，包括投影和过滤条件中的字段
+   */
+  const std::vector<Field> &fields() const { return fields_; }
+
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
   std::vector<std::unique_ptr<Expression>> &predicates()
   {
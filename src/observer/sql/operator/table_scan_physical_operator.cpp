@@ -25,23 +25,26 @@ RC TableScanPhysicalOperator::open(Trx *trx)
     tuple_.set_schema(table_, table_->table_meta().field_metas());
   }
   trx_ = trx;
+  batch_.clear();
+  batch_index_ = 0;
   return rc;
 }
 
 RC TableScanPhysicalOperator::next()
 {
-  if (!record_scanner_.has_next()) {
-    return RC::RECORD_EOF;
-  }
-
   RC rc = RC::SUCCESS;
   bool filter_result = false;
-  while (record_scanner_.has_next()) {
-    rc = record_scanner_.next(current_record_);
-    if (rc != RC::SUCCESS) {
-      return rc;
+  while (true) {
+    // 一次取一个页面上的所有记录，逐条返回时不再复制记录
+    if (batch_index_ >= batch_.size()) {
+      rc = record_scanner_.next_batch(batch_);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      batch_index_ = 0;
     }
 
+    batch_.get_record(batch_index_++, current_record_);
     tuple_.set_record(&current_record_);
     rc = filter(tuple_, filter_result);
     if (rc != RC::SUCCESS) {
@@ -53,7 +56,6 @@ RC TableScanPhysicalOperator::next()
       break;
     } else {
       sql_debug("a tuple is filtered: %s", tuple_.to_string().c_str());
-      rc = RC::RECORD_EOF;
     }
   }
   return rc;
@@ -61,6 +63,8 @@ RC TableScanPhysicalOperator::next()
 
 RC TableScanPhysicalOperator::close()
 {
+  batch_.clear();
+  batch_index_ = 0;
   return record_scanner_.close_scan();
 }
 
@@ -56,6 +56,8 @@ private:
   Trx *                                    trx_ = nullptr;
   bool                                     readonly_ = false;
   RecordFileScanner                        record_scanner_;
+  RecordBatch                              batch_;            ///< 当前页面上的记录，参考 RecordFileScanner::next_batch
+  int                                      batch_index_ = 0;  ///< 下一条要返回的记录在 batch_ 中的位置
   Record                                   current_record_;
   RowTuple                                 tuple_;
   std::vector<std::unique_ptr<Expression>> predicates_; // TODO chang predicate to table tuple filter
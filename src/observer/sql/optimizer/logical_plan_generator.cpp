@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2023/08/16.
 //
 
+#include <algorithm>
+
 #include "sql/optimizer/logical_plan_generator.h"
 
 #include "sql/operator/logical_operator.h"
@@ -91,6 +93,21 @@ RC LogicalPlanGenerator::create_plan(
       }
     }
 
+    // 过滤条件中用到的字段也要从表中读出来。索引扫描时可以据此判断是否只读索引就够了
+    for (const FilterUnit *filter_unit : select_stmt->filter_stmt()->filter_units()) {
+      for (const FilterObj *filter_obj : {&filter_unit->left(), &filter_unit->right()}) {
+        if (!filter_obj->is_attr || filter_obj->field.table() != table) {
+          continue;
+        }
+        auto iter = std::find_if(fields.begin(), fields.end(), [filter_obj](const Field &field) {
+          return field.meta() == filter_obj->field.meta();
+        });
+        if (iter == fields.end()) {
+          fields.push_back(filter_obj->field);
+        }
+      }
+    }
+
     unique_ptr<LogicalOperator> table_get_oper(new TableGetLogicalOperator(table, fields, true/*readonly*/));
     if (table_oper == nullptr) {
       table_oper = std::move(table_get_oper);
@@ -160,9 +177,7 @@ RC LogicalPlanGenerator::create_plan(
     InsertStmt *insert_stmt, unique_ptr<LogicalOperator> &logical_operator)
 {
   Table *table = insert_stmt->table();
-  vector<Value> values(insert_stmt->values(), insert_stmt->values() + insert_stmt->value_amount());
-
-  InsertLogicalOperator *insert_operator = new InsertLogicalOperator(table, values);
+  InsertLogicalOperator *insert_operator = new InsertLogicalOperator(table, insert_stmt->rows());
   logical_operator.reset(insert_operator);
   return RC::SUCCESS;
 }
@@ -12,12 +12,15 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include <algorithm>
+#include <map>
 #include <utility>
 
 #include "sql/optimizer/physical_plan_generator.h"
 #include "sql/operator/table_get_logical_operator.h"
 #include "sql/operator/table_scan_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/empty_physical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/predicate_physical_operator.h"
 #include "sql/operator/project_logical_operator.h"
@@ -33,6 +36,8 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/calc_logical_operator.h"
 #include "sql/operator/calc_physical_operator.h"
 #include "sql/expr/expression.h"
+#include "storage/table/table.h"
+#include "storage/index/index.h"
 #include "common/log/log.h"
 
 using namespace std;
@@ -81,64 +86,232 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
   return rc;
 }
 
+namespace {
+
+/**
+ * @brief 一个字段上所有比较条件合并之后的取值范围
+ * @details 条件之间是 AND 的关系，取最紧的上下界。low/high 为空表示这一边没有边界
+ */
+struct ValueRange
+{
+  const Value *low            = nullptr;
+  bool         low_inclusive  = false;
+  const Value *high           = nullptr;
+  bool         high_inclusive = false;
+
+  void add(CompOp comp, const Value &value)
+  {
+    switch (comp) {
+      case EQUAL_TO: {
+        tighten_low(value, true);
+        tighten_high(value, true);
+      } break;
+      case GREAT_EQUAL: {
+        tighten_low(value, true);
+      } break;
+      case GREAT_THAN: {
+        tighten_low(value, false);
+      } break;
+      case LESS_EQUAL: {
+        tighten_high(value, true);
+      } break;
+      case LESS_THAN: {
+        tighten_high(value, false);
+      } break;
+      default: {
+        // 不等于等条件不能缩小范围
+      } break;
+    }
+  }
+
+  /**
+   * @brief 范围内没有任何值，比如 a > 5 and a < 3
+   */
+  bool empty() const
+  {
+    if (low == nullptr || high == nullptr) {
+      return false;
+    }
+    const int result = low->compare(*high);
+    return result > 0 || (result == 0 && !(low_inclusive && high_inclusive));
+  }
+
+  /**
+   * @brief 范围内只有一个值，相当于等值条件
+   */
+  bool is_point() const
+  {
+    return low != nullptr && high != nullptr && low_inclusive && high_inclusive && low->compare(*high) == 0;
+  }
+
+  bool bounded() const
+  {
+    return low != nullptr || high != nullptr;
+  }
+
+private:
+  void tighten_low(const Value &value, bool inclusive)
+  {
+    const int result = (low == nullptr) ? 1 : value.compare(*low);
+    if (result > 0) {
+      low = &value;
+      low_inclusive = inclusive;
+    } else if (result == 0) {
+      low_inclusive = low_inclusive && inclusive;
+    }
+  }
+
+  void tighten_high(const Value &value, bool inclusive)
+  {
+    const int result = (high == nullptr) ? -1 : value.compare(*high);
+    if (result < 0) {
+      high = &value;
+      high_inclusive = inclusive;
+    } else if (result == 0) {
+      high_inclusive = high_inclusive && inclusive;
+    }
+  }
+};
+
+/**
+ * @brief 交换比较运算符左右两边的表达式之后，对应的比较运算符
+ */
+CompOp swap_comp_op(CompOp comp)
+{
+  switch (comp) {
+    case LESS_EQUAL: return GREAT_EQUAL;
+    case LESS_THAN: return GREAT_THAN;
+    case GREAT_EQUAL: return LESS_EQUAL;
+    case GREAT_THAN: return LESS_THAN;
+    default: return comp;
+  }
+}
+
+/**
+ * @brief 把 字段 op 常量 形式的比较条件按照字段合并成取值范围
+ */
+void collect_value_ranges(vector<unique_ptr<Expression>> &predicates, map<string, ValueRange> &ranges)
+{
+  for (auto &expr : predicates) {
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
+
+    auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+    unique_ptr<Expression> &left_expr = comparison_expr->left();
+    unique_ptr<Expression> &right_expr = comparison_expr->right();
+
+    const FieldMeta *field = nullptr;
+    const Value *value = nullptr;
+    CompOp comp = comparison_expr->comp();
+    if (left_expr->type() == ExprType::FIELD && right_expr->type() == ExprType::VALUE) {
+      field = static_cast<FieldExpr *>(left_expr.get())->field().meta();
+      value = &static_cast<ValueExpr *>(right_expr.get())->get_value();
+    } else if (left_expr->type() == ExprType::VALUE && right_expr->type() == ExprType::FIELD) {
+      field = static_cast<FieldExpr *>(right_expr.get())->field().meta();
+      value = &static_cast<ValueExpr *>(left_expr.get())->get_value();
+      comp = swap_comp_op(comp);
+    } else {
+      continue;
+    }
+
+    // 类型不一致时，索引中键值的比较方式与表达式不同，不能使用索引
+    if (field->type() != value->attr_type()) {
+      continue;
+    }
+    ranges[field->name()].add(comp, *value);
+  }
+}
+
+}  // namespace
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   // 看看是否有可以用于索引查找的表达式
   Table *table = table_get_oper.table();
 
+  map<string, ValueRange> ranges;
+  collect_value_ranges(predicates, ranges);
+  for (const auto &[field_name, range] : ranges) {
+    if (range.empty()) {
+      oper = make_unique<EmptyPhysicalOperator>();
+      LOG_TRACE("contradictory predicates on field %s, use empty result", field_name.c_str());
+      return RC::SUCCESS;
+    }
+  }
+
+  // 选择索引：索引最左边的若干个字段有等值条件，紧接着的下一个字段可以有范围条件。
+  // 等值条件覆盖的字段越多越好，相同的情况下有范围条件的更好
   Index *index = nullptr;
-  ValueExpr *value_expr = nullptr;
-  for (auto &expr : predicates) {
-    if (expr->type() == ExprType::COMPARISON) {
-      auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
-      // 简单处理，就找等值查询
-      if (comparison_expr->comp() != EQUAL_TO) {
-        continue;
+  int best_score = 0;
+  vector<Value> left_values;
+  vector<Value> right_values;
+  bool left_inclusive = true;
+  bool right_inclusive = true;
+  for (Index *candidate : table->indexes()) {
+    const IndexMeta &index_meta = candidate->index_meta();
+    vector<Value> equal_values;
+    const ValueRange *last_range = nullptr;
+    for (int i = 0; i < index_meta.field_num(); i++) {
+      auto iter = ranges.find(index_meta.field(i));
+      if (iter == ranges.end() || !iter->second.bounded()) {
+        break;
       }
 
-      unique_ptr<Expression> &left_expr = comparison_expr->left();
-      unique_ptr<Expression> &right_expr = comparison_expr->right();
-      // 左右比较的一边最少是一个值
-      if (left_expr->type() != ExprType::VALUE && right_expr->type() != ExprType::VALUE) {
+      if (iter->second.is_point()) {
+        equal_values.push_back(*iter->second.low);
         continue;
       }
 
-      FieldExpr *field_expr = nullptr;
-      if (left_expr->type() == ExprType::FIELD) {
-        ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
-        field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
-      } else if (right_expr->type() == ExprType::FIELD) {
-        ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
-        field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
-      }
+      last_range = &iter->second;
+      break;
+    }
 
-      if (field_expr == nullptr) {
-        continue;
-      }
+    const int score = static_cast<int>(equal_values.size()) * 2 + (last_range != nullptr ? 1 : 0);
+    if (score <= best_score) {
+      continue;
+    }
 
-      const Field &field = field_expr->field();
-      index = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
-        break;
-      }
+    best_score = score;
+    index = candidate;
+    left_values = equal_values;
+    right_values = equal_values;
+    left_inclusive = true;
+    right_inclusive = true;
+    if (last_range != nullptr && last_range->low != nullptr) {
+      left_values.push_back(*last_range->low);
+      left_inclusive = last_range->low_inclusive;
+    }
+    if (last_range != nullptr && last_range->high != nullptr) {
+      right_values.push_back(*last_range->high);
+      right_inclusive = last_range->high_inclusive;
     }
   }
 
   if (index != nullptr) {
-    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
-
-    const Value &value = value_expr->get_value();
     IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(
           table, index, table_get_oper.readonly(), 
-          &value, true /*left_inclusive*/, 
-          &value, true /*right_inclusive*/);
+          left_values, left_inclusive, 
+          right_values, right_inclusive);
           
     index_scan_oper->set_predicates(std::move(predicates));
+
+    // 查询用到的字段都在索引中时，不需要再读取表中的记录。修改数据时需要完整的记录，不能使用
+    const IndexMeta &index_meta = index->index_meta();
+    const vector<Field> &fields = table_get_oper.fields();
+    const bool covered = all_of(fields.begin(), fields.end(), [&index_meta](const Field &field) {
+      for (int i = 0; i < index_meta.field_num(); i++) {
+        if (0 == strcmp(index_meta.field(i), field.field_name())) {
+          return true;
+        }
+      }
+      return false;
+    });
+    index_scan_oper->set_index_only(table_get_oper.readonly() && covered);
+
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
-    LOG_TRACE("use index scan");
+    LOG_TRACE("use index scan. index only=%d", table_get_oper.readonly() && covered);
   } else {
     auto table_scan_oper = new TableScanPhysicalOperator(table, table_get_oper.readonly());
     table_scan_oper->set_predicates(std::move(predicates));
@@ -207,8 +380,8 @@ RC PhysicalPlanGenerator::create_plan(ProjectLogicalOperator &project_oper, uniq
 RC PhysicalPlanGenerator::create_plan(InsertLogicalOperator &insert_oper, unique_ptr<PhysicalOperator> &oper)
 {
   Table *table = insert_oper.table();
-  vector<Value> &values = insert_oper.values();
-  InsertPhysicalOperator *insert_phy_oper = new InsertPhysicalOperator(table, std::move(values));
+  vector<vector<Value>> &rows = insert_oper.rows();
+  InsertPhysicalOperator *insert_phy_oper = new InsertPhysicalOperator(table, std::move(rows));
   oper.reset(insert_phy_oper);
   return RC::SUCCESS;
 }
@@ -112,8 +112,8 @@ struct CalcSqlNode
  */
 struct InsertSqlNode
 {
-  std::string        relation_name;  ///< Relation to insert into
-  std::vector<Value> values;         ///< 要插入的值
+  std::string                     relation_name;  ///< Relation to insert into
+  std::vector<std::vector<Value>> rows;           ///< 要插入的值，每一行是一条记录
 };
 
 /**
@@ -161,6 +161,7 @@ struct CreateTableSqlNode
 {
   std::string                  relation_name;         ///< Relation name
   std::vector<AttrInfoSqlNode> attr_infos;            ///< attributes
+  std::string                  row_format;            ///< 记录的存放格式，为空时使用定长格式
 };
 
 /**
@@ -176,13 +177,13 @@ struct DropTableSqlNode
  * @brief 描述一个create index语句
  * @ingroup SQLParser
  * @details 创建索引时，需要指定索引名，表名，字段名。
- * 正常的SQL语句中，一个索引可能包含了多个字段，这里仅支持一个字段。
+ * 一个索引可以包含多个字段，即组合索引，字段的顺序就是索引键值中字段的顺序。
  */
 struct CreateIndexSqlNode
 {
-  std::string index_name;      ///< Index name
-  std::string relation_name;   ///< Relation name
-  std::string attribute_name;  ///< Attribute name
+  std::string index_name;                   ///< Index name
+  std::string relation_name;                ///< Relation name
+  std::vector<std::string> attribute_names; ///< Attribute names, 组合索引有多个字段
 };
 
 /**
@@ -271,6 +272,7 @@ enum SqlCommandFlag
   SCF_DROP_INDEX,
   SCF_SYNC,
   SCF_SHOW_TABLES,
+  SCF_SHOW_BUFFER_POOLS, ///< 显示所有的页帧管理器
   SCF_DESC_TABLE,
   SCF_BEGIN,        ///< 事务开始语句，可以在这里扩展只读事务
   SCF_COMMIT,
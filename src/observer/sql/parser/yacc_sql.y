@@ -110,6 +110,7 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
   Expression *                      expression;
   std::vector<Expression *> *       expression_list;
   std::vector<Value> *              value_list;
+  std::vector<std::vector<Value>> * value_rows;
   std::vector<ConditionSqlNode> *   condition_list;
   std::vector<RelAttrSqlNode> *     rel_attr_list;
   std::vector<std::string> *        relation_list;
@@ -133,11 +134,15 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
 %type <rel_attr>            rel_attr
 %type <attr_infos>          attr_def_list
 %type <attr_info>           attr_def
+%type <string>              row_format_option
 %type <value_list>          value_list
+%type <value_list>          value_row
+%type <value_rows>          value_row_list
 %type <condition_list>      where
 %type <condition_list>      condition_list
 %type <rel_attr_list>       select_attr
 %type <relation_list>       rel_list
+%type <relation_list>       index_attr_list
 %type <rel_attr_list>       attr_list
 %type <expression>          expression
 %type <expression_list>     expression_list
@@ -246,6 +251,16 @@ show_tables_stmt:
     SHOW TABLES {
       $$ = new ParsedSqlNode(SCF_SHOW_TABLES);
     }
+    /* 词法分析中没有 BUFFER_POOLS 关键字，作为标识符解析 */
+    | SHOW ID {
+      if (0 != strcasecmp($2, "buffer_pools")) {
+        free($2);
+        yyerror(&@$, sql_string, sql_result, scanner, "unknown show statement");
+        YYERROR;
+      }
+      $$ = new ParsedSqlNode(SCF_SHOW_BUFFER_POOLS);
+      free($2);
+    }
     ;
 
 desc_table_stmt:
@@ -257,19 +272,40 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE INDEX ID ON ID LBRACE ID index_attr_list RBRACE
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
       create_index.index_name = $3;
       create_index.relation_name = $5;
-      create_index.attribute_name = $7;
+      create_index.attribute_names.push_back($7);
+      if ($8 != nullptr) {
+        create_index.attribute_names.insert(create_index.attribute_names.end(), $8->rbegin(), $8->rend());
+        delete $8;
+      }
       free($3);
       free($5);
       free($7);
     }
     ;
 
+index_attr_list:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | COMMA ID index_attr_list
+    {
+      if ($3 != nullptr) {
+        $$ = $3;
+      } else {
+        $$ = new std::vector<std::string>;
+      }
+      $$->push_back($2);
+      free($2);
+    }
+    ;
+
 drop_index_stmt:      /*drop index 语句的语法解析树*/
     DROP INDEX ID ON ID
     {
@@ -281,13 +317,18 @@ drop_index_stmt:      /*drop index 语句的语法解析树*/
     }
     ;
 create_table_stmt:    /*create table 语句的语法解析树*/
-    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE
+    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE row_format_option
     {
       $$ = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = $$->create_table;
       create_table.relation_name = $3;
       free($3);
 
+      if ($8 != nullptr) {
+        create_table.row_format = $8;
+        free($8);
+      }
+
       std::vector<AttrInfoSqlNode> *src_attrs = $6;
 
       if (src_attrs != nullptr) {
@@ -298,6 +339,24 @@ create_table_stmt:    /*create table 语句的语法解析树*/
       delete $5;
     }
     ;
+/* 词法分析中没有 ROW_FORMAT 关键字，作为标识符解析，比如 row_format=slotted */
+row_format_option:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | ID EQ ID
+    {
+      if (0 != strcasecmp($1, "row_format")) {
+        free($1);
+        free($3);
+        yyerror(&@$, sql_string, sql_result, scanner, "unknown table option");
+        YYERROR;
+      }
+      free($1);
+      $$ = $3;
+    }
+    ;
 attr_def_list:
     /* empty */
     {
@@ -342,20 +401,51 @@ type:
     | FLOAT_T  { $$=FLOATS; }
     ;
 insert_stmt:        /*insert   语句的语法解析树*/
-    INSERT INTO ID VALUES LBRACE value value_list RBRACE 
+    INSERT INTO ID VALUES value_row value_row_list
     {
       $$ = new ParsedSqlNode(SCF_INSERT);
       $$->insertion.relation_name = $3;
-      if ($7 != nullptr) {
-        $$->insertion.values.swap(*$7);
+      if ($6 != nullptr) {
+        $$->insertion.rows.swap(*$6);
+        delete $6;
       }
-      $$->insertion.values.emplace_back(*$6);
-      std::reverse($$->insertion.values.begin(), $$->insertion.values.end());
-      delete $6;
+      $$->insertion.rows.emplace_back(std::move(*$5));
+      std::reverse($$->insertion.rows.begin(), $$->insertion.rows.end());
+      delete $5;
       free($3);
     }
     ;
 
+value_row:
+    LBRACE value value_list RBRACE
+    {
+      if ($3 != nullptr) {
+        $$ = $3;
+      } else {
+        $$ = new std::vector<Value>;
+      }
+      $$->emplace_back(*$2);
+      std::reverse($$->begin(), $$->end());
+      delete $2;
+    }
+    ;
+
+value_row_list:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | COMMA value_row value_row_list {
+      if ($3 != nullptr) {
+        $$ = $3;
+      } else {
+        $$ = new std::vector<std::vector<Value>>;
+      }
+      $$->emplace_back(std::move(*$2));
+      delete $2;
+    }
+    ;
+
 value_list:
     /* empty */
     {
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/stmt/create_index_stmt.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
+#include "storage/index/bplus_tree.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 
@@ -26,9 +27,9 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
   stmt = nullptr;
 
   const char *table_name = create_index.relation_name.c_str();
-  if (is_blank(table_name) || is_blank(create_index.index_name.c_str()) || is_blank(create_index.attribute_name.c_str())) {
-    LOG_WARN("invalid argument. db=%p, table_name=%p, index name=%s, attribute name=%s",
-        db, table_name, create_index.index_name.c_str(), create_index.attribute_name.c_str());
+  if (is_blank(table_name) || is_blank(create_index.index_name.c_str()) || create_index.attribute_names.empty()) {
+    LOG_WARN("invalid argument. db=%p, table_name=%p, index name=%s, attribute num=%d",
+        db, table_name, create_index.index_name.c_str(), static_cast<int>(create_index.attribute_names.size()));
     return RC::INVALID_ARGUMENT;
   }
 
@@ -39,11 +40,34 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_TABLE_NOT_EXIST;
   }
 
-  const FieldMeta *field_meta = table->table_meta().field(create_index.attribute_name.c_str());
-  if (nullptr == field_meta) {
-    LOG_WARN("no such field in table. db=%s, table=%s, field name=%s", 
-             db->name(), table_name, create_index.attribute_name.c_str());
-    return RC::SCHEMA_FIELD_NOT_EXIST;   
+  vector<FieldMeta> field_metas;
+  for (const string &attribute_name : create_index.attribute_names) {
+    if (is_blank(attribute_name.c_str())) {
+      LOG_WARN("invalid argument. attribute name is blank. db=%s, table=%s", db->name(), table_name);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    const FieldMeta *field_meta = table->table_meta().field(attribute_name.c_str());
+    if (nullptr == field_meta) {
+      LOG_WARN("no such field in table. db=%s, table=%s, field name=%s", 
+               db->name(), table_name, attribute_name.c_str());
+      return RC::SCHEMA_FIELD_NOT_EXIST;   
+    }
+
+    for (const FieldMeta &exists_field : field_metas) {
+      if (0 == strcmp(exists_field.name(), field_meta->name())) {
+        LOG_WARN("duplicate field in index. db=%s, table=%s, field name=%s",
+                 db->name(), table_name, attribute_name.c_str());
+        return RC::INVALID_ARGUMENT;
+      }
+    }
+    field_metas.push_back(*field_meta);
+  }
+
+  if (field_metas.size() > static_cast<size_t>(IndexFileHeader::MAX_ATTR_NUM)) {
+    LOG_WARN("too many fields in index. db=%s, table=%s, field num=%d, max=%d",
+             db->name(), table_name, static_cast<int>(field_metas.size()), IndexFileHeader::MAX_ATTR_NUM);
+    return RC::INVALID_ARGUMENT;
   }
 
   Index *index = table->find_index(create_index.index_name.c_str());
@@ -52,6 +76,6 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_INDEX_NAME_REPEAT;
   }
 
-  stmt = new CreateIndexStmt(table, field_meta, create_index.index_name);
+  stmt = new CreateIndexStmt(table, field_metas, create_index.index_name);
   return RC::SUCCESS;
 }
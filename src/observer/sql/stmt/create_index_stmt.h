@@ -15,12 +15,13 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "sql/stmt/stmt.h"
+#include "storage/field/field_meta.h"
 
 struct CreateIndexSqlNode;
 class Table;
-class FieldMeta;
 
 /**
  * @brief 创建索引的语句
@@ -29,9 +30,9 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const std::string &index_name)
+  CreateIndexStmt(Table *table, const std::vector<FieldMeta> &field_metas, const std::string &index_name)
         : table_(table),
-          field_meta_(field_meta),
+          field_metas_(field_metas),
           index_name_(index_name)
   {}
 
@@ -40,7 +41,7 @@ public:
   StmtType type() const override { return StmtType::CREATE_INDEX; }
 
   Table *table() const { return table_; }
-  const FieldMeta *field_meta() const { return field_meta_; }
+  const std::vector<FieldMeta> &field_metas() const { return field_metas_; }
   const std::string &index_name() const { return index_name_; }
 
 public:
@@ -48,6 +49,6 @@ public:
 
 private:
   Table *table_ = nullptr;
-  const FieldMeta *field_meta_ = nullptr;
+  std::vector<FieldMeta> field_metas_;
   std::string index_name_;
 };
@@ -14,10 +14,20 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/stmt/create_table_stmt.h"
 #include "event/sql_debug.h"
+#include "common/log/log.h"
 
 RC CreateTableStmt::create(Db *db, const CreateTableSqlNode &create_table, Stmt *&stmt)
 {
-  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos);
-  sql_debug("create table statement: table name %s", create_table.relation_name.c_str());
+  RecordFormat row_format = RecordFormat::FIXED;
+  if (!create_table.row_format.empty() &&
+      record_format_from_name(create_table.row_format.c_str(), row_format) != RC::SUCCESS) {
+    LOG_WARN("unknown row format. table=%s, row format=%s",
+             create_table.relation_name.c_str(), create_table.row_format.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos, row_format);
+  sql_debug("create table statement: table name %s, row format %s",
+            create_table.relation_name.c_str(), record_format_name(row_format));
   return RC::SUCCESS;
 }
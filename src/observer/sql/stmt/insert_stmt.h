@@ -28,7 +28,7 @@ class InsertStmt : public Stmt
 {
 public:
   InsertStmt() = default;
-  InsertStmt(Table *table, const Value *values, int value_amount);
+  InsertStmt(Table *table, const std::vector<std::vector<Value>> *rows);
 
   StmtType type() const override
   {
@@ -43,17 +43,15 @@ public:
   {
     return table_;
   }
-  const Value *values() const
+  /**
+   * @brief 要插入的值，每一行是一条记录
+   */
+  const std::vector<std::vector<Value>> &rows() const
   {
-    return values_;
-  }
-  int value_amount() const
-  {
-    return value_amount_;
+    return *rows_;
   }
 
 private:
   Table *table_ = nullptr;
-  const Value *values_ = nullptr;
-  int value_amount_ = 0;
+  const std::vector<std::vector<Value>> *rows_ = nullptr;
 };
@@ -0,0 +1,66 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <deque>
+
+#include "storage/buffer/frame.h"
+
+/**
+ * @brief 大范围扫描使用的私有页帧环
+ * @ingroup BufferPool
+ * @details 参考 PostgreSQL 的 buffer access strategy。扫描一个很大的表时，如果所有的页面都按照正常的方式
+ * 进入缓存，就会把其它会话的热点页面都挤出去。使用页帧环时：
+ * - 扫描读入的页面放在淘汰策略中最先被淘汰的位置，命中的页面也不会调整它在淘汰策略中的位置；
+ * - 扫描最多占用 capacity 个页帧，超过时先释放环中最早读入的页面，脏页会先写到磁盘。
+ * 这样扫描只会在一小部分页帧中循环使用，不会影响其它会话的缓存。
+ * 页帧环只记录页面的标识，页帧本身依然在共享的页帧表中，其它会话也可以访问这些页面。
+ * 一个页帧环只能在一个线程中使用。
+ */
+class BPBufferRing
+{
+public:
+  explicit BPBufferRing(int capacity) : capacity_(capacity) {}
+
+  int  capacity() const { return capacity_; }
+  int  size() const { return static_cast<int>(frame_ids_.size()); }
+  bool full() const { return size() >= capacity_; }
+
+  /**
+   * @brief 环中读入了一个新的页面
+   */
+  void push(const FrameId &frame_id) { frame_ids_.push_back(frame_id); }
+
+  /**
+   * @brief 取出最早读入的页面，调用方负责释放它的页帧
+   */
+  FrameId pop()
+  {
+    FrameId frame_id = frame_ids_.front();
+    frame_ids_.pop_front();
+    return frame_id;
+  }
+
+  /**
+   * @brief 在环中循环使用的页帧个数
+   */
+  int64_t recycled_count() const { return recycled_count_; }
+  void    inc_recycled_count() { recycled_count_++; }
+
+private:
+  int                 capacity_ = 0;
+  std::deque<FrameId> frame_ids_;
+  int64_t             recycled_count_ = 0;
+};
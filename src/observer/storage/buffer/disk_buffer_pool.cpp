@@ -12,13 +12,16 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include <errno.h>
+#include <algorithm>
+#include <limits>
 #include <string.h>
+#include <unistd.h>
 
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/lang/mutex.h"
+#include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/os/os.h"
-#include "common/io/io.h"
 
 using namespace common;
 using namespace std;
@@ -37,59 +40,333 @@ string BPFileHeader::to_string() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-BPFrameManager::BPFrameManager(const char *name) : allocator_(name)
+BPFrameManager::BPFrameManager(const char *name) : tag_(name)
 {}
 
-RC BPFrameManager::init(int pool_num)
+RC BPFrameManager::init(
+    int pool_num, int shard_num /* = 1 */, const char *replacer /* = "lru" */, bool huge_page /* = false */)
 {
-  int ret = allocator_.init(false, pool_num);
-  if (ret == 0) {
-    return RC::SUCCESS;
+  if (shard_num <= 0) {
+    shard_num = 1;
+  }
+
+  // 每个分片都按照 pool_num 个内存池来分配，只是每个内存池中的页帧个数变少了
+  const int item_num_per_pool = std::max((DEFAULT_ITEM_NUM_PER_POOL + shard_num - 1) / shard_num, 1);
+  const int frame_num_per_shard = pool_num * item_num_per_pool;
+
+  auto arena = std::make_unique<BPFrameArena>();
+  RC rc = arena->init(frame_num_per_shard * shard_num, huge_page);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to init frame arena. frame num=%d, rc=%s", frame_num_per_shard * shard_num, strrc(rc));
+    return rc;
+  }
+
+  shards_.reserve(shard_num);
+  for (int i = 0; i < shard_num; i++) {
+    auto shard = std::make_unique<Shard>(read_ahead_stats_);
+    shard->capacity_        = frame_num_per_shard;
+    shard->target_capacity_ = frame_num_per_shard;
+    shard->free_frames_.reserve(frame_num_per_shard);
+    for (int j = frame_num_per_shard - 1; j >= 0; j--) {
+      shard->free_frames_.push_back(arena->frame(i * frame_num_per_shard + j));
+    }
+
+    shard->replacer_.reset(FrameReplacer::create(replacer, shard->capacity_));
+    if (shard->replacer_ == nullptr) {
+      LOG_ERROR("failed to create frame replacer. name=%s", replacer);
+      shards_.clear();
+      return RC::INVALID_ARGUMENT;
+    }
+    shards_.push_back(std::move(shard));
+  }
+
+  use_huge_page_ = huge_page;
+  huge_page_     = arena->huge_page();
+  arenas_.push_back(std::move(arena));
+
+  LOG_INFO("frame manager init done. tag=%s, shard num=%d, frames per shard=%d, replacer=%s",
+           tag_.c_str(), shard_num, pool_num * item_num_per_pool, replacer_name());
+  return RC::SUCCESS;
+}
+
+RC BPFrameManager::resize(int frame_num)
+{
+  if (frame_num <= 0 || shards_.empty()) {
+    LOG_WARN("invalid frame num to resize. frame num=%d", frame_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  std::lock_guard resize_guard(resize_lock_);
+
+  const int shard_num       = this->shard_num();
+  const int target_capacity = (frame_num + shard_num - 1) / shard_num;
+
+  // 先在分片内部调整：变大时重新启用回收的页帧，变小时回收空闲的页帧
+  std::vector<int> lack_nums(shard_num, 0);
+  int              lack_total = 0;
+  for (int i = 0; i < shard_num; i++) {
+    Shard &shard = *shards_[i];
+    std::lock_guard lock_guard(shard.lock_);
+
+    shard.target_capacity_ = target_capacity;
+    while (shard.capacity_ < target_capacity && !shard.retired_frames_.empty()) {
+      shard.free_frames_.push_back(shard.retired_frames_.back());
+      shard.retired_frames_.pop_back();
+      shard.capacity_++;
+    }
+
+    while (shard.capacity_ > target_capacity && !shard.free_frames_.empty()) {
+      Frame *frame = shard.free_frames_.back();
+      shard.free_frames_.pop_back();
+      shard.retire_internal(frame);
+    }
+
+    shard.replacer_->resize(shard.capacity_);
+    lack_nums[i] = std::max(target_capacity - shard.capacity_.load(), 0);
+    lack_total += lack_nums[i];
+  }
+
+  // 还不够的页帧从新的内存中分配
+  if (lack_total > 0) {
+    auto arena = std::make_unique<BPFrameArena>();
+    RC   rc    = arena->init(lack_total, use_huge_page_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init frame arena to grow frames. frame num=%d, rc=%s", lack_total, strrc(rc));
+      for (auto &shard : shards_) {
+        std::lock_guard lock_guard(shard->lock_);
+        shard->target_capacity_ = std::min(shard->target_capacity_.load(), shard->capacity_.load());
+      }
+      return rc;
+    }
+
+    int frame_index = 0;
+    for (int i = 0; i < shard_num; i++) {
+      if (lack_nums[i] == 0) {
+        continue;
+      }
+
+      Shard &shard = *shards_[i];
+      std::lock_guard lock_guard(shard.lock_);
+      for (int j = 0; j < lack_nums[i]; j++) {
+        shard.free_frames_.push_back(arena->frame(frame_index++));
+      }
+      shard.capacity_ += lack_nums[i];
+      shard.replacer_->resize(shard.capacity_);
+    }
+    arenas_.push_back(std::move(arena));
   }
-  return RC::NOMEM;
+
+  LOG_INFO("frame manager resized. tag=%s, target frame num=%d, frame num=%d, pending shrink frame num=%d",
+           tag_.c_str(), (int)target_frame_num(), (int)total_frame_num(), (int)pending_shrink_frame_num());
+  return RC::SUCCESS;
+}
+
+int BPFrameManager::shrink_shard(int shard_index, int max_count, std::function<RC(Frame *frame)> purger)
+{
+  if (shard_index < 0 || shard_index >= shard_num()) {
+    return 0;
+  }
+
+  Shard &shard = *shards_[shard_index];
+
+  // 把页帧从分片中移除并回收，调用之前页帧需要被pin住一次
+  auto retire_frame = [&shard](Frame *frame) {
+    shard.free_internal(frame->frame_id(), frame);
+    shard.free_frames_.pop_back();
+    shard.retire_internal(frame);
+  };
+
+  int                  retired_count = 0;
+  std::vector<Frame *> dirty_frames;
+  {
+    std::lock_guard lock_guard(shard.lock_);
+    const int excess = std::min(shard.capacity_ - shard.target_capacity_, max_count);
+    if (excess <= 0) {
+      return 0;
+    }
+
+    while (retired_count < excess && !shard.free_frames_.empty()) {
+      Frame *frame = shard.free_frames_.back();
+      shard.free_frames_.pop_back();
+      shard.retire_internal(frame);
+      retired_count++;
+    }
+
+    std::vector<Frame *> clean_frames;
+    auto shrink_finder = [&clean_frames, &dirty_frames, retired_count, excess](Frame *frame) {
+      if (frame->can_purge()) {
+        frame->pin();
+        if (frame->dirty()) {
+          dirty_frames.push_back(frame);
+        } else {
+          clean_frames.push_back(frame);
+        }
+      }
+      return retired_count + static_cast<int>(clean_frames.size() + dirty_frames.size()) < excess;
+    };
+    if (retired_count < excess) {
+      shard.replacer_->foreach_victim(shrink_finder);
+    }
+
+    for (Frame *frame : clean_frames) {
+      if (secondary_cache_ != nullptr) {
+        secondary_cache_->write_page(frame->file_desc(), frame->page_num(), &frame->page());
+      }
+      retire_frame(frame);
+      retired_count++;
+    }
+    shard.replacer_->resize(shard.capacity_);
+  }
+
+  if (dirty_frames.empty()) {
+    return retired_count;
+  }
+
+  // 写脏页比较耗时，不持有分片的锁，不影响这个分片上的其它查询
+  std::vector<Frame *> flushed_frames;
+  for (Frame *frame : dirty_frames) {
+    RC rc = purger(frame);
+    if (OB_SUCC(rc)) {
+      flushed_frames.push_back(frame);
+    } else {
+      frame->unpin();
+      LOG_WARN("failed to flush frame while shrinking. frame_id=%s, rc=%s",
+               to_string(frame->frame_id()).c_str(), strrc(rc));
+    }
+  }
+
+  std::lock_guard lock_guard(shard.lock_);
+  for (Frame *frame : flushed_frames) {
+    // 写磁盘的过程中页面可能又被访问或者修改了，或者 buffer pool 又变大了
+    if (frame->pin_count() == 1 && !frame->dirty() && shard.capacity_ > shard.target_capacity_) {
+      retire_frame(frame);
+      retired_count++;
+    } else {
+      frame->unpin();
+    }
+  }
+  shard.replacer_->resize(shard.capacity_);
+  return retired_count;
 }
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::INTERNAL;
   }
 
-  frames_.destroy();
+  for (auto &shard : shards_) {
+    shard->frames_.clear();
+  }
   return RC::SUCCESS;
 }
 
-int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purger)
+const char *BPFrameManager::replacer_name() const
+{
+  return shards_.empty() ? "" : shards_.front()->replacer_->name();
+}
+
+bool BPFrameManager::huge_page() const
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
+  return huge_page_;
+}
+
+BPFrameManager::Shard &BPFrameManager::shard(const FrameId &frame_id)
+{
+  return *shards_[frame_id.hash() % shards_.size()];
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (const auto &shard : shards_) {
+    num += shard->frames_.size();
+  }
+  return num;
+}
+
+size_t BPFrameManager::total_frame_num() const
+{
+  size_t num = 0;
+  for (const auto &shard : shards_) {
+    num += shard->capacity_;
+  }
+  return num;
+}
+
+size_t BPFrameManager::target_frame_num() const
+{
+  size_t num = 0;
+  for (const auto &shard : shards_) {
+    num += shard->target_capacity_;
+  }
+  return num;
+}
+
+size_t BPFrameManager::pending_shrink_frame_num() const
+{
+  size_t num = 0;
+  for (const auto &shard : shards_) {
+    num += std::max(shard->capacity_ - shard->target_capacity_, 0);
+  }
+  return num;
+}
+
+int BPFrameManager::purge_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> purger)
+{
+  Shard &shard = this->shard(FrameId(file_desc, page_num));
+  std::lock_guard lock_guard(shard.lock_);
 
-  std::vector<Frame *> frames_can_purge;
   if (count <= 0) {
     count = 1;
   }
-  frames_can_purge.reserve(count);
 
-  auto purge_finder = [&frames_can_purge, count](const FrameId &frame_id, Frame *const frame) {
+  // 优先淘汰干净的页帧，它们不需要写磁盘。脏页帧先记下来，干净的页帧不够时再使用
+  std::vector<Frame *> clean_frames;
+  std::vector<Frame *> dirty_frames;
+  clean_frames.reserve(count);
+  dirty_frames.reserve(count);
+
+  auto purge_finder = [&clean_frames, &dirty_frames, count](Frame *frame) {
     if (frame->can_purge()) {
-      frame->pin();
-      frames_can_purge.push_back(frame);
-      if (frames_can_purge.size() >= static_cast<size_t>(count)) {
-        return false;  // false to break the progress
+      if (!frame->dirty()) {
+        frame->pin();
+        clean_frames.push_back(frame);
+        if (clean_frames.size() >= static_cast<size_t>(count)) {
+          return false;  // false to break the progress
+        }
+      } else if (dirty_frames.size() < static_cast<size_t>(count)) {
+        frame->pin();
+        dirty_frames.push_back(frame);
       }
     }
     return true;  // true continue to look up
   };
 
-  frames_.foreach_reverse(purge_finder);
-  LOG_INFO("purge frames find %ld pages total", frames_can_purge.size());
+  shard.replacer_->foreach_victim(purge_finder);
+  LOG_INFO("purge frames find %ld clean pages and %ld dirty pages", clean_frames.size(), dirty_frames.size());
 
-  /// 当前还在frameManager的锁内，而 purger 是一个非常耗时的操作
-  /// 他需要把脏页数据刷新到磁盘上去，所以这里会极大地降低并发度
   int freed_count = 0;
-  for (Frame *frame : frames_can_purge) {
+  for (Frame *frame : clean_frames) {
+    if (secondary_cache_ != nullptr) {
+      secondary_cache_->write_page(frame->file_desc(), frame->page_num(), &frame->page());
+    }
+    shard.free_internal(frame->frame_id(), frame);
+    freed_count++;
+  }
+
+  /// 当前还在分片的锁内，而 purger 是一个非常耗时的操作
+  /// 他需要把脏页数据刷新到磁盘上去，所以这里会降低这个分片的并发度。
+  /// 后台刷脏页线程会尽量保证这里不需要淘汰脏页
+  for (Frame *frame : dirty_frames) {
+    if (freed_count >= count) {
+      frame->unpin();
+      continue;
+    }
+
     RC rc = purger(frame);
     if (RC::SUCCESS == rc) {
-      free_internal(frame->frame_id(), frame);
+      shard.free_internal(frame->frame_id(), frame);
       freed_count++;
     } else {
       frame->unpin();
@@ -98,82 +375,316 @@ int BPFrameManager::purge_frames(int count, std::function<RC(Frame *frame)> purg
     }
   }
   LOG_INFO("purge frame done. number=%d", freed_count);
+  stats_.evict_count += freed_count;
   return freed_count;
 }
 
-Frame *BPFrameManager::get(int file_desc, PageNum page_num)
+std::vector<Frame *> BPFrameManager::find_dirty_victims(int shard_index, int low_water_mark_pct)
+{
+  std::vector<Frame *> dirty_frames;
+  if (shard_index < 0 || shard_index >= shard_num()) {
+    return dirty_frames;
+  }
+
+  Shard &shard = *shards_[shard_index];
+  std::shared_lock lock_guard(shard.lock_);
+
+  const int capacity   = shard.capacity_;
+  const int low_water  = std::max(capacity * low_water_mark_pct / 100, 1);
+  int       free_count = capacity - static_cast<int>(shard.frames_.size());
+  if (free_count >= low_water) {
+    return dirty_frames;
+  }
+
+  auto dirty_finder = [&dirty_frames, &free_count, low_water](Frame *frame) {
+    if (frame->can_purge()) {
+      if (!frame->dirty()) {
+        free_count++;
+      } else {
+        frame->pin();
+        dirty_frames.push_back(frame);
+      }
+    }
+    return free_count + static_cast<int>(dirty_frames.size()) < low_water;
+  };
+
+  shard.replacer_->peek_victims(dirty_finder);
+  return dirty_frames;
+}
+
+std::vector<Frame *> BPFrameManager::find_dirty_frames(int shard_index, LSN lsn)
+{
+  std::vector<Frame *> dirty_frames;
+  if (shard_index < 0 || shard_index >= shard_num()) {
+    return dirty_frames;
+  }
+
+  Shard &shard = *shards_[shard_index];
+  std::shared_lock lock_guard(shard.lock_);
+  for (auto &item : shard.frames_) {
+    Frame *frame = item.second;
+    if (frame->dirty() && frame->recovery_lsn() < lsn) {
+      frame->pin();
+      dirty_frames.push_back(frame);
+    }
+  }
+  return dirty_frames;
+}
+
+std::vector<std::pair<FrameId, LSN>> BPFrameManager::dirty_page_table()
+{
+  std::vector<std::pair<FrameId, LSN>> dirty_pages;
+  for (std::unique_ptr<Shard> &shard : shards_) {
+    std::shared_lock lock_guard(shard->lock_);
+    for (auto &item : shard->frames_) {
+      const Frame *frame = item.second;
+      if (frame->dirty()) {
+        dirty_pages.emplace_back(item.first, frame->recovery_lsn());
+      }
+    }
+  }
+  return dirty_pages;
+}
+
+std::vector<FrameId> BPFrameManager::hot_frames()
+{
+  std::vector<std::vector<FrameId>> shard_frames(shards_.size());
+  for (size_t i = 0; i < shards_.size(); i++) {
+    Shard &shard = *shards_[i];
+    std::shared_lock lock_guard(shard.lock_);
+
+    std::vector<FrameId> &frame_ids = shard_frames[i];
+    shard.replacer_->peek_victims([&frame_ids](Frame *frame) {
+      frame_ids.push_back(frame->frame_id());
+      return true;
+    });
+    std::reverse(frame_ids.begin(), frame_ids.end());
+  }
+
+  std::vector<FrameId> frame_ids;
+  for (size_t index = 0; ; index++) {
+    bool found = false;
+    for (const std::vector<FrameId> &ids : shard_frames) {
+      if (index < ids.size()) {
+        frame_ids.push_back(ids[index]);
+        found = true;
+      }
+    }
+    if (!found) {
+      break;
+    }
+  }
+  return frame_ids;
+}
+
+Frame *BPFrameManager::get(int file_desc, PageNum page_num, bool touch /* = true */)
 {
   FrameId frame_id(file_desc, page_num);
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  Shard &shard = this->shard(frame_id);
+  if (!touch || shard.replacer_->concurrent_touch()) {
+    std::shared_lock lock_guard(shard.lock_);
+    return shard.get_internal(frame_id, touch);
+  }
+
+  std::lock_guard lock_guard(shard.lock_);
+  return shard.get_internal(frame_id, touch);
 }
 
-Frame *BPFrameManager::get_internal(const FrameId &frame_id)
+Frame *BPFrameManager::Shard::get_internal(const FrameId &frame_id, bool touch /* = true */)
 {
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end()) {
+    return nullptr;
+  }
+
+  Frame *frame = iter->second;
+  frame->pin();
+  if (touch) {
+    replacer_->touch(frame);
+  }
+  if (frame->clear_prefetched()) {
+    read_ahead_stats_.hit_count++;
+  }
+  return frame;
+}
+
+Frame *BPFrameManager::Shard::alloc_internal(const FrameId &frame_id, bool cold)
+{
+  // 读取失败的页帧等所有人都放开之后才能再使用
+  for (size_t i = 0; i < discarded_frames_.size();) {
+    if (discarded_frames_[i]->pin_count() == 0) {
+      free_frames_.push_back(discarded_frames_[i]);
+      discarded_frames_[i] = discarded_frames_.back();
+      discarded_frames_.pop_back();
+    } else {
+      i++;
+    }
+  }
+
   Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
+  if (!free_frames_.empty()) {
+    frame = free_frames_.back();
+    free_frames_.pop_back();
+    ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", 
+           to_string(*frame).c_str());
+    frame->set_file_desc(frame_id.file_desc());
+    frame->set_page_num(frame_id.page_num());
+    frame->set_prefetched(false);
+    frame->clear_dirty();
+    frame->begin_load();
     frame->pin();
+    frames_.emplace(frame_id, frame);
+    if (cold) {
+      replacer_->insert_cold(frame);
+    } else {
+      replacer_->insert(frame);
+    }
   }
   return frame;
 }
 
-Frame *BPFrameManager::alloc(int file_desc, PageNum page_num)
+Frame *BPFrameManager::alloc(int file_desc, PageNum page_num, bool cold /* = false */)
 {
   FrameId frame_id(file_desc, page_num);
+  Shard &shard = this->shard(frame_id);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame *frame = get_internal(frame_id);
+  std::lock_guard lock_guard(shard.lock_);
+  Frame *frame = shard.get_internal(frame_id, !cold);
   if (frame != nullptr) {
     return frame;
   }
 
-  frame = allocator_.alloc();
+  return shard.alloc_internal(frame_id, cold);
+}
+
+Frame *BPFrameManager::alloc_free(int file_desc, PageNum page_num, bool &cached, bool cold /* = false */)
+{
+  FrameId frame_id(file_desc, page_num);
+  Shard &shard = this->shard(frame_id);
+
+  std::lock_guard lock_guard(shard.lock_);
+  cached = (shard.frames_.find(frame_id) != shard.frames_.end());
+  if (cached) {
+    return nullptr;
+  }
+
+  Frame *frame = shard.alloc_internal(frame_id, cold);
   if (frame != nullptr) {
-    ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", 
-           to_string(*frame).c_str());
-    frame->set_page_num(page_num);
-    frame->pin();
-    frames_.put(frame_id, frame);
+    frame->set_prefetched(true);
   }
   return frame;
 }
 
+bool BPFrameManager::purge_frame(const FrameId &frame_id, std::function<RC(Frame *frame)> purger)
+{
+  Shard &shard = this->shard(frame_id);
+  std::lock_guard lock_guard(shard.lock_);
+
+  auto iter = shard.frames_.find(frame_id);
+  if (iter == shard.frames_.end() || !iter->second->can_purge()) {
+    return false;
+  }
+
+  Frame *frame = iter->second;
+  frame->pin();
+  if (frame->dirty()) {
+    RC rc = purger(frame);
+    if (OB_FAIL(rc)) {
+      frame->unpin();
+      LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", to_string(frame_id).c_str(), strrc(rc));
+      return false;
+    }
+  }
+
+  shard.free_internal(frame_id, frame);
+  stats_.evict_count++;
+  return true;
+}
+
 RC BPFrameManager::free(int file_desc, PageNum page_num, Frame *frame)
 {
   FrameId frame_id(file_desc, page_num);
+  Shard &shard = this->shard(frame_id);
+
+  std::lock_guard lock_guard(shard.lock_);
+  return shard.free_internal(frame_id, frame);
+}
+
+void BPFrameManager::discard(int file_desc, PageNum page_num, Frame *frame)
+{
+  FrameId frame_id(file_desc, page_num);
+  Shard &shard = this->shard(frame_id);
+
+  std::lock_guard lock_guard(shard.lock_);
+  auto iter = shard.frames_.find(frame_id);
+  if (iter != shard.frames_.end() && iter->second == frame) {
+    shard.replacer_->remove(frame);
+    shard.frames_.erase(iter);
+  }
+  frame->clear_prefetched();
+  frame->set_page_num(page_num);
+
+  // 先从哈希表中删除再唤醒等待的线程，它们重试时就不会再拿到这个页帧
+  frame->end_load(false /*success*/);
+  if (frame->unpin() == 0) {
+    shard.free_frames_.push_back(frame);
+  } else {
+    shard.discarded_frames_.push_back(frame);
+  }
+}
+
+RC BPFrameManager::free_unused(int file_desc, PageNum page_num, Frame *frame)
+{
+  FrameId frame_id(file_desc, page_num);
+  Shard &shard = this->shard(frame_id);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  std::lock_guard lock_guard(shard.lock_);
+  if (frame->pin_count() > 1) {
+    frame->unpin();
+    return RC::LOCKED_UNLOCK;
+  }
+  return shard.free_internal(frame_id, frame);
 }
 
-RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+RC BPFrameManager::Shard::free_internal(const FrameId &frame_id, Frame *frame)
 {
-  Frame *frame_source = nullptr;
-  [[maybe_unused]] bool found = frames_.get(frame_id, frame_source);
+  auto iter = frames_.find(frame_id);
+  [[maybe_unused]] bool found = (iter != frames_.end());
+  [[maybe_unused]] Frame *frame_source = found ? iter->second : nullptr;
   ASSERT(found && frame == frame_source && frame->pin_count() == 1,
          "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
          found, to_string(frame_id).c_str(), frame_source, frame, frame->pin_count(), lbt());
 
+  if (frame->clear_prefetched()) {
+    read_ahead_stats_.wasted_count++;
+  }
+
   frame->unpin();
-  frames_.remove(frame_id);
-  allocator_.free(frame);
+  replacer_->remove(frame);
+  frames_.erase(iter);
+  free_frames_.push_back(frame);
   return RC::SUCCESS;
 }
 
-std::list<Frame *> BPFrameManager::find_list(int file_desc)
+void BPFrameManager::Shard::retire_internal(Frame *frame)
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
+  BPFrameArena::release_page(*frame);
+  retired_frames_.push_back(frame);
+  capacity_--;
+}
 
+std::list<Frame *> BPFrameManager::find_list(int file_desc)
+{
   std::list<Frame *> frames;
-  auto fetcher = [&frames, file_desc](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (file_desc == frame_id.file_desc()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (auto &shard : shards_) {
+    std::lock_guard lock_guard(shard->lock_);
+    for (auto &[frame_id, frame] : shard->frames_) {
+      if (file_desc == frame_id.file_desc()) {
+        frame->pin();
+        frames.push_back(frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
@@ -184,7 +695,7 @@ BufferPoolIterator::~BufferPoolIterator()
 {}
 RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
 {
-  bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
+  bp_ = &bp;
   if (start_page <= 0) {
     current_page_num_ = 0;
   } else {
@@ -195,13 +706,13 @@ RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
 
 bool BufferPoolIterator::has_next()
 {
-  return bitmap_.next_setted_bit(current_page_num_ + 1) != -1;
+  return bp_->next_allocated_page(current_page_num_ + 1) != BP_INVALID_PAGE_NUM;
 }
 
 PageNum BufferPoolIterator::next()
 {
-  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
-  if (next_page != -1) {
+  PageNum next_page = bp_->next_allocated_page(current_page_num_ + 1);
+  if (next_page != BP_INVALID_PAGE_NUM) {
     current_page_num_ = next_page;
   }
   return next_page;
@@ -226,7 +737,18 @@ DiskBufferPool::~DiskBufferPool()
 
 RC DiskBufferPool::open_file(const char *file_name)
 {
-  int fd = open(file_name, O_RDWR);
+  int fd = -1;
+  if (bp_manager_.direct_io()) {
+    // 页帧的内存是4K对齐的，页面大小也是4K的整数倍，满足 O_DIRECT 的要求
+    fd = open(file_name, O_RDWR | O_DIRECT);
+    if (fd < 0 && errno == EINVAL) {
+      LOG_WARN("file system does not support O_DIRECT, open file without it. file=%s", file_name);
+    }
+  }
+
+  if (fd < 0) {
+    fd = open(file_name, O_RDWR);
+  }
   if (fd < 0) {
     LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
     return RC::IOERR_ACCESS;
@@ -250,7 +772,7 @@ RC DiskBufferPool::open_file(const char *file_name)
 
   if ((rc = load_page(BP_HEADER_PAGE, hdr_frame_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to load first page of %s, due to %s.", file_name, strerror(errno));
-    purge_frame(BP_HEADER_PAGE, hdr_frame_);
+    hdr_frame_ = nullptr;
     close(fd);
     file_desc_ = -1;
     return rc;
@@ -258,6 +780,27 @@ RC DiskBufferPool::open_file(const char *file_name)
 
   file_header_ = (BPFileHeader *)hdr_frame_->data();
 
+  // 位图页面与文件头一样，一直pin在内存中
+  space_map_.init(file_header_);
+  map_frames_.push_back(hdr_frame_);
+  for (int group = 1; BPSpaceMap::group_start(group) < file_header_->page_count; group++) {
+    Frame *map_frame = nullptr;
+    rc = get_this_page(BPSpaceMap::group_start(group), &map_frame);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to load space map page of %s. group=%d, rc=%s", file_name, group, strrc(rc));
+      for (Frame *frame : map_frames_) {
+        frame->unpin();
+      }
+      map_frames_.clear();
+      purge_all_pages();
+      close(fd);
+      file_desc_ = -1;
+      return rc;
+    }
+    space_map_.add_group(map_frame->data(), false /*created*/);
+    map_frames_.push_back(map_frame);
+  }
+
   LOG_INFO("Successfully open %s. file_desc=%d, hdr_frame=%p, file header=%s",
            file_name, file_desc_, hdr_frame_, file_header_->to_string().c_str());
   return RC::SUCCESS;
@@ -270,7 +813,10 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
-  hdr_frame_->unpin();
+  for (Frame *frame : map_frames_) {
+    frame->unpin();
+  }
+  map_frames_.clear();
 
   // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
   rc = purge_all_pages();
@@ -280,6 +826,7 @@ RC DiskBufferPool::close_file()
   }
 
   disposed_pages_.clear();
+  bp_manager_.secondary_cache().invalidate_file(file_desc_);
 
   if (close(file_desc_) < 0) {
     LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_desc_, file_name_.c_str(), strerror(errno));
@@ -292,23 +839,32 @@ RC DiskBufferPool::close_file()
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
+RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame, BPBufferRing *ring /* = nullptr */)
 {
   RC rc = RC::SUCCESS;
   *frame = nullptr;
 
-  Frame *used_match_frame = frame_manager_.get(file_desc_, page_num);
+  // 使用页帧环扫描时，命中的页面不调整它在淘汰策略中的位置
+  Frame *used_match_frame = frame_manager_.get(file_desc_, page_num, ring == nullptr /*touch*/);
+  // 页面可能正在被其它线程读入。读取失败时页帧已经从哈希表中删除，重新读取就可以
+  if (used_match_frame != nullptr && !used_match_frame->wait_loaded()) {
+    used_match_frame->unpin();
+    used_match_frame = nullptr;
+  }
   if (used_match_frame != nullptr) {
     used_match_frame->access();
+    frame_manager_.stats().hit_count++;
     *frame = used_match_frame;
     return RC::SUCCESS;
   }
 
+  frame_manager_.stats().miss_count++;
+
   std::scoped_lock lock_guard(lock_); // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
 
   // Allocate one page and load the data into this page
   Frame *allocated_frame = nullptr;
-  rc = allocate_frame(page_num, &allocated_frame);
+  rc = allocate_frame(page_num, &allocated_frame, ring);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
     return rc;
@@ -318,9 +874,14 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   // allocated_frame->pin(); // pined in manager::get
   allocated_frame->access();
 
+  // 等待这把锁的时候，其它线程可能已经读入了这个页面。页面都是加着这把锁读入的，所以它已经读取完成了
+  if (!allocated_frame->loading()) {
+    *frame = allocated_frame;
+    return RC::SUCCESS;
+  }
+
   if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
     LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
-    purge_frame(page_num, allocated_frame);
     return rc;
   }
 
@@ -328,60 +889,56 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_page(Frame **frame)
+RC DiskBufferPool::allocate_page(Frame **frame, BPBufferRing *ring /* = nullptr */)
 {
   RC rc = RC::SUCCESS;
 
   lock_.lock();
-  
-  int byte = 0, bit = 0;
-  if ((file_header_->allocated_pages) < (file_header_->page_count)) {
-    // There is one free page
-    for (int i = 0; i < file_header_->page_count; i++) {
-      byte = i / 8;
-      bit = i % 8;
-      if (((file_header_->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_header_->allocated_pages)++;
-        file_header_->bitmap[byte] |= (1 << bit);
-        // TODO,  do we need clean the loaded page's data?
-        hdr_frame_->mark_dirty();
-
-        lock_.unlock();
-        return get_this_page(i, frame);
-      }
-    }
-  }
 
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
-    LOG_WARN("file buffer pool is full. page count %d, max page count %d",
-        file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
+  PageNum page_num = space_map_.allocate_free();
+  if (page_num != BP_INVALID_PAGE_NUM) {
+    // TODO,  do we need clean the loaded page's data?
+    mark_space_map_dirty(page_num);
+
     lock_.unlock();
-    return RC::BUFFERPOOL_NOBUF;
+    return get_this_page(page_num, frame, ring);
   }
 
-  PageNum page_num = file_header_->page_count;
+  // 没有空闲页面了，在文件末尾增加一个。新的页面是下一组的第一个页面时，先创建这一组的位图页面
+  if (space_map_.need_new_group()) {
+    rc = create_map_page(space_map_.group_num());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create space map page. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+      lock_.unlock();
+      return rc;
+    }
+  }
+
+  page_num = file_header_->page_count;
   Frame *allocated_frame = nullptr;
-  if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
+  if ((rc = allocate_frame(page_num, &allocated_frame, ring)) != RC::SUCCESS) {
     LOG_ERROR("Failed to allocate frame %s, due to no free page.", file_name_.c_str());
     lock_.unlock();
     return rc;
   }
 
+  if (space_map_.allocate_new() != page_num) {
+    LOG_WARN("file buffer pool is full. file=%s, page count %d", file_name_.c_str(), file_header_->page_count);
+    frame_manager_.discard(file_desc_, page_num, allocated_frame);
+    lock_.unlock();
+    return RC::BUFFERPOOL_NOBUF;
+  }
+
   LOG_INFO("allocate new page. file=%s, pageNum=%d, pin=%d",
            file_name_.c_str(), page_num, allocated_frame->pin_count());
 
-  file_header_->allocated_pages++;
-  file_header_->page_count++;
-
-  byte = page_num / 8;
-  bit = page_num % 8;
-  file_header_->bitmap[byte] |= (1 << bit);
-  hdr_frame_->mark_dirty();
+  mark_space_map_dirty(page_num);
 
   allocated_frame->set_file_desc(file_desc_);
   allocated_frame->access();
   allocated_frame->clear_page();
-  allocated_frame->set_page_num(file_header_->page_count - 1);
+  allocated_frame->set_page_num(page_num);
+  allocated_frame->end_load(true /*success*/);
 
   // Use flush operation to extension file
   if ((rc = flush_page_internal(*allocated_frame)) != RC::SUCCESS) {
@@ -398,20 +955,23 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
 RC DiskBufferPool::dispose_page(PageNum page_num)
 {
+  // 后台线程pin住的页帧会留在缓存里，参考 BPFrameManager::free_unused
+  std::unique_lock clean_guard(clean_lock_);
   std::scoped_lock lock_guard(lock_);
+  // 调用者通常已经放开了这个页面，页帧可能已经被淘汰，这时只需要在位图中释放页面
   Frame *used_frame = frame_manager_.get(file_desc_, page_num);
   if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", to_string(*used_frame).c_str());
-    frame_manager_.free(file_desc_, page_num, used_frame);
-  } else {
-    LOG_WARN("failed to fetch the page while disposing it. pageNum=%d", page_num);
-    return RC::NOTFOUND;
+    RC rc = frame_manager_.free_unused(file_desc_, page_num, used_frame);
+    if (rc == RC::LOCKED_UNLOCK) {
+      // 乐观读者还pin着这个页面，它们的版本号校验会失败，页帧就留在缓存里
+      LOG_TRACE("the page to dispose is pinned by optimistic readers. frame:%s", to_string(*used_frame).c_str());
+    }
   }
 
-  hdr_frame_->mark_dirty();
-  file_header_->allocated_pages--;
-  char tmp = 1 << (page_num % 8);
-  file_header_->bitmap[page_num / 8] &= ~tmp;
+  bp_manager_.secondary_cache().invalidate(file_desc_, page_num);
+  if (space_map_.mark_free(page_num)) {
+    mark_space_map_dirty(page_num);
+  }
   return RC::SUCCESS;
 }
 
@@ -444,6 +1004,7 @@ RC DiskBufferPool::purge_frame(PageNum page_num, Frame *buf)
 
 RC DiskBufferPool::purge_page(PageNum page_num)
 {
+  std::unique_lock clean_guard(clean_lock_);
   std::scoped_lock lock_guard(lock_);
   Frame *used_frame = frame_manager_.get(file_desc_, page_num);
   if (used_frame != nullptr) {
@@ -455,6 +1016,8 @@ RC DiskBufferPool::purge_page(PageNum page_num)
 
 RC DiskBufferPool::purge_all_pages()
 {
+  // 等待后台刷脏页线程放开它pin住的页帧
+  std::unique_lock cleaner_guard(bp_manager_.page_cleaner().batch_lock());
   std::list<Frame *> used = frame_manager_.find_list(file_desc_);
 
   std::scoped_lock lock_guard(lock_);
@@ -493,62 +1056,201 @@ RC DiskBufferPool::flush_page(Frame &frame)
 
 RC DiskBufferPool::flush_page_internal(Frame &frame)
 {
-  // The better way is use mmap the block into memory,
-  // so it is easier to flush data to file.
-
   Page &page = frame.page();
-  int64_t offset = ((int64_t)page.page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == offset - 1) {
-    LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
+  // 修改页面的日志落盘之后才能写页面(WAL)
+  RC rc = bp_manager_.flush_log(page.lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush log before flushing page %d of %d. lsn=%d, rc=%s",
+             page.page_num, file_desc_, page.lsn, strrc(rc));
+    return rc;
   }
 
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to flush page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_WRITE;
+  // 先取LSN再写页面，写入之后的修改产生的日志都不会早于这个LSN
+  const LSN recovery_lsn = bp_manager_.next_lsn();
+
+  rc = bp_manager_.page_io().write_page(file_desc_, page.page_num, &page);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush page %d of %d. rc=%s", page.page_num, file_desc_, strrc(rc));
+    return rc;
   }
   frame.clear_dirty();
+  frame.set_recovery_lsn(recovery_lsn);
+  // 脏页不写二级缓存(write-around)，二级缓存中的旧页面已经失效了
+  bp_manager_.secondary_cache().invalidate(file_desc_, page.page_num);
   LOG_DEBUG("Flush block. file desc=%d, pageNum=%d, pin count=%d", file_desc_, page.page_num, frame.pin_count());
 
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::flush_frames_internal(const std::vector<Frame *> &frames)
+{
+  if (frames.empty()) {
+    return RC::SUCCESS;
+  }
+
+  // 一批页面只需要等待其中最大的LSN落盘一次
+  LSN max_lsn = 0;
+  for (Frame *frame : frames) {
+    max_lsn = std::max(max_lsn, frame->lsn());
+  }
+  RC rc = bp_manager_.flush_log(max_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush log before flushing frames of %s. lsn=%d, rc=%s", file_name_.c_str(), max_lsn, strrc(rc));
+    return rc;
+  }
+
+  const LSN recovery_lsn = bp_manager_.next_lsn();
+
+  std::vector<PageIORequest> requests(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    requests[i].file_desc = file_desc_;
+    requests[i].page_num  = frames[i]->page_num();
+    requests[i].page      = &frames[i]->page();
+  }
+
+  rc = bp_manager_.page_io().write_pages(requests.data(), static_cast<int>(requests.size()));
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (OB_SUCC(requests[i].rc)) {
+      frames[i]->clear_dirty();
+      frames[i]->set_recovery_lsn(recovery_lsn);
+      bp_manager_.secondary_cache().invalidate(file_desc_, requests[i].page_num);
+    }
+  }
+
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush some frames of %s. frame num=%d, rc=%s",
+             file_name_.c_str(), static_cast<int>(frames.size()), strrc(rc));
+  }
+  return rc;
+}
+
+int DiskBufferPool::clean_frames(const std::vector<Frame *> &frames)
+{
+  std::shared_lock clean_guard(clean_lock_);
+  std::vector<Frame *> latched_frames;
+  std::vector<Frame *> dirty_frames;
+  for (Frame *frame : frames) {
+    // 拿不到读锁说明有人正在修改这个页面，下次再处理
+    if (!frame->try_read_latch()) {
+      continue;
+    }
+
+    latched_frames.push_back(frame);
+    if (frame->dirty()) {
+      dirty_frames.push_back(frame);
+    }
+  }
+
+  // 这一批页面一次提交
+  (void)flush_frames_internal(dirty_frames);
+
+  int cleaned_count = 0;
+  for (Frame *frame : dirty_frames) {
+    cleaned_count += frame->dirty() ? 0 : 1;
+  }
+
+  for (Frame *frame : latched_frames) {
+    frame->read_unlatch();
+  }
+  return cleaned_count;
+}
+
 RC DiskBufferPool::flush_all_pages()
 {
   std::list<Frame *> used = frame_manager_.find_list(file_desc_);
-  for (Frame *frame : used) {
-    RC rc = flush_page(*frame);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to flush all pages");
+  std::vector<Frame *> frames(used.begin(), used.end());
+
+  RC rc = RC::SUCCESS;
+  {
+    std::scoped_lock lock_guard(lock_);
+    rc = flush_frames_internal(frames);
+  }
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush all pages");
+  }
+  return rc;
+}
+
+RC DiskBufferPool::recover_page(PageNum page_num)
+{
+  std::scoped_lock lock_guard(lock_);
+
+  // 文件可能还没有扩展到这个页面，先把中间缺少的位图页面都创建出来
+  const int group = BPSpaceMap::group_of(page_num);
+  while (space_map_.group_num() <= group) {
+    RC rc = create_map_page(space_map_.group_num());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create space map page while recovering page. file=%s, page num=%d, rc=%s",
+               file_name_.c_str(), page_num, strrc(rc));
       return rc;
     }
   }
+
+  if (space_map_.mark_allocated(page_num)) {
+    mark_space_map_dirty(page_num);
+  }
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::recover_page(PageNum page_num)
+RC DiskBufferPool::create_map_page(int group)
 {
-  int byte = 0, bit = 0;
-  byte = page_num / 8;
-  bit = page_num % 8;
+  const PageNum page_num = BPSpaceMap::group_start(group);
 
-  std::scoped_lock lock_guard(lock_);
-  if (!(file_header_->bitmap[byte] & (1 << bit))) {
-    file_header_->bitmap[byte] |= (1 << bit);
-    file_header_->allocated_pages++;
-    file_header_->page_count++;
-    hdr_frame_->mark_dirty();
+  Frame *map_frame = nullptr;
+  RC     rc        = allocate_frame(page_num, &map_frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to allocate frame for space map page. file=%s, page num=%d, rc=%s",
+              file_name_.c_str(), page_num, strrc(rc));
+    return rc;
   }
+
+  map_frame->set_file_desc(file_desc_);
+  map_frame->access();
+  map_frame->clear_page();
+  map_frame->set_page_num(page_num);
+  map_frame->end_load(true /*success*/);
+
+  space_map_.add_group(map_frame->data(), true /*created*/);
+  space_map_.mark_allocated(page_num);
+  map_frames_.push_back(map_frame);
+  mark_space_map_dirty(page_num);
+
+  // 与新分配的页面一样，写一次磁盘来扩展文件
+  if ((rc = flush_page_internal(*map_frame)) != RC::SUCCESS) {
+    LOG_WARN("failed to flush space map page. file=%s, page num=%d, rc=%s", file_name_.c_str(), page_num, strrc(rc));
+  }
+
+  LOG_INFO("create space map page. file=%s, group=%d, page num=%d", file_name_.c_str(), group, page_num);
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
+void DiskBufferPool::mark_space_map_dirty(PageNum page_num)
+{
+  hdr_frame_->mark_dirty();
+  map_frames_[BPSpaceMap::group_of(page_num)]->mark_dirty();
+}
+
+PageNum DiskBufferPool::next_allocated_page(PageNum start)
+{
+  std::scoped_lock lock_guard(lock_);
+  return space_map_.next_allocated(start);
+}
+
+RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer, BPBufferRing *ring /* = nullptr */)
 {
   auto purger = [this](Frame *frame) {
     if (!frame->dirty()) {
       return RC::SUCCESS;
     }
 
+    // 不得不在前台写脏页，说明后台刷脏页线程跟不上了
+    bp_manager_.page_cleaner().wakeup();
+
     RC rc = RC::SUCCESS;
     if (frame->file_desc() == file_desc_) {
       rc = this->flush_page_internal(*frame);
@@ -562,26 +1264,45 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
     return rc;
   };
 
+  // 页帧环满了就先释放环中最早读入的页面，扫描只在环中循环使用页帧
+  if (ring != nullptr && ring->full()) {
+    recycle_ring_frame(*ring);
+  }
+
   while (true) {
-    Frame *frame = frame_manager_.alloc(file_desc_, page_num);
+    Frame *frame = frame_manager_.alloc(file_desc_, page_num, ring != nullptr /*cold*/);
     if (frame != nullptr) {
+      if (ring != nullptr) {
+        ring->push(frame->frame_id());
+      }
       *buffer = frame;
       return RC::SUCCESS;
     }
 
     LOG_TRACE("frames are all allocated, so we should purge some frames to get one free frame");
-    (void)frame_manager_.purge_frames(1/*count*/, purger);
+    (void)frame_manager_.purge_frames(file_desc_, page_num, 1/*count*/, purger);
   }
   return RC::BUFFERPOOL_NOBUF;
 }
 
+void DiskBufferPool::recycle_ring_frame(BPBufferRing &ring)
+{
+  // 环中的页面都属于当前文件
+  auto purger = [this](Frame *frame) { return this->flush_page_internal(*frame); };
+
+  FrameId frame_id = ring.pop();
+  if (frame_manager_.purge_frame(frame_id, purger)) {
+    ring.inc_recycled_count();
+  }
+}
+
 RC DiskBufferPool::check_page_num(PageNum page_num)
 {
   if (page_num >= file_header_->page_count) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
-  if ((file_header_->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+  if (!space_map_.allocated(page_num)) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
@@ -590,41 +1311,161 @@ RC DiskBufferPool::check_page_num(PageNum page_num)
 
 RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
 {
-  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
+  frame->set_recovery_lsn(bp_manager_.next_lsn());
 
-    return RC::IOERR_SEEK;
+  // 先查二级缓存，没有时再读数据文件
+  RC rc = RC::SUCCESS;
+  if (!bp_manager_.secondary_cache().read_page(file_desc_, page_num, &frame->page())) {
+    rc = bp_manager_.page_io().read_page(file_desc_, page_num, &frame->page());
   }
-
-  Page &page = frame->page();
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
-  if (ret != 0) {
-    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
-              file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
-    return RC::IOERR_READ;
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, rc=%s, page count=%d",
+              file_name_.c_str(), file_desc_, page_num, strrc(rc), file_header_ == nullptr ? 0 : file_header_->allocated_pages);
+    frame_manager_.discard(file_desc_, page_num, frame);
+    return rc;
   }
+
+  // 日志回放时跳过的页面从来没有写过，读出来的数据都是0
+  frame->set_page_num(page_num);
+  frame->end_load(true /*success*/);
   return RC::SUCCESS;
 }
 
+int DiskBufferPool::prefetch_pages(const PageNum *page_nums, int count, BPBufferRing *ring /* = nullptr */)
+{
+  std::scoped_lock lock_guard(lock_);
+
+  int cached_count = 0;
+  std::vector<Frame *>       frames;
+  std::vector<PageIORequest> requests;
+  for (int i = 0; i < count; i++) {
+    if (!space_map_.allocated(page_nums[i])) {
+      continue;
+    }
+
+    if (ring != nullptr && ring->full()) {
+      recycle_ring_frame(*ring);
+    }
+
+    bool   cached = false;
+    Frame *frame  = frame_manager_.alloc_free(file_desc_, page_nums[i], cached, ring != nullptr /*cold*/);
+    if (cached) {
+      cached_count++;
+      continue;
+    }
+
+    if (frame == nullptr) {
+      break;  // 没有空闲的页帧了
+    }
+
+    if (ring != nullptr) {
+      ring->push(frame->frame_id());
+    }
+
+    // 页帧一分配出来就处于读取状态，读取完成之前，其它线程即使拿到这个页帧也要等待，参考 Frame::wait_loaded
+    frame->set_recovery_lsn(bp_manager_.next_lsn());
+    frames.push_back(frame);
+
+    PageIORequest request;
+    request.file_desc = file_desc_;
+    request.page_num  = page_nums[i];
+    request.page      = &frame->page();
+    requests.push_back(request);
+  }
+
+  if (!requests.empty()) {
+    bp_manager_.page_io().read_pages(requests.data(), static_cast<int>(requests.size()));
+  }
+
+  int loaded_count = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    Frame *frame = frames[i];
+    if (OB_SUCC(requests[i].rc)) {
+      frame->set_page_num(requests[i].page_num);
+      frame->end_load(true /*success*/);
+      frame->access();
+      frame->unpin();
+      loaded_count++;
+    } else {
+      // 等待这个页面的线程会重新读取，不能让读取失败的数据留在缓存中
+      LOG_WARN("failed to prefetch page. file=%s, page num=%d, rc=%s",
+               file_name_.c_str(), requests[i].page_num, strrc(requests[i].rc));
+      frame_manager_.discard(file_desc_, requests[i].page_num, frame);
+    }
+  }
+
+  frame_manager_.read_ahead_stats().prefetch_count += loaded_count;
+  LOG_DEBUG("prefetch pages done. file=%s, count=%d, cached=%d, loaded=%d",
+            file_name_.c_str(), count, cached_count, loaded_count);
+  return cached_count + loaded_count;
+}
+
+const BPReadAheadOptions &DiskBufferPool::read_ahead_options() const
+{
+  return bp_manager_.read_ahead_options();
+}
+
+unique_ptr<BPBufferRing> DiskBufferPool::create_scan_ring() const
+{
+  const BPBufferRingOptions &options = bp_manager_.buffer_ring_options();
+  if (options.size <= 0 || file_header_ == nullptr) {
+    return nullptr;
+  }
+
+  const int64_t page_count = file_header_->page_count;
+  if (page_count * 100 <= static_cast<int64_t>(frame_manager_.total_frame_num()) * options.threshold_pct) {
+    return nullptr;
+  }
+
+  LOG_DEBUG("use buffer ring to scan %s. page count=%ld, ring size=%d", file_name_.c_str(), page_count, options.size);
+  return make_unique<BPBufferRing>(options.size);
+}
+
+unique_ptr<BPBufferRing> DiskBufferPool::create_bulk_write_ring() const
+{
+  const BPBufferRingOptions &options = bp_manager_.buffer_ring_options();
+  if (options.size <= 0) {
+    return nullptr;
+  }
+  return make_unique<BPBufferRing>(options.size);
+}
+
 int DiskBufferPool::file_desc() const
 {
   return file_desc_;
 }
 ////////////////////////////////////////////////////////////////////////////////
-BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
+BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */, int frame_shard_num /* = 1 */,
+    const char *replacer /* = "lru" */, const char *page_io /* = "sync" */, bool huge_page /* = false */)
 {
+  page_io_ = PageIO::create(page_io);
+  if (page_io_ == nullptr) {
+    LOG_WARN("failed to create page io %s, use sync instead", page_io);
+    page_io_ = PageIO::create("sync");
+  }
+
   if (memory_size <= 0) {
     memory_size = MEM_POOL_ITEM_NUM * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
   }
   const int pool_num = std::max(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1);
-  frame_manager_.init(pool_num);
-  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d",
-           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num);
+  huge_page_ = huge_page;
+  frame_manager_.set_secondary_cache(&secondary_cache_);
+  RC rc = frame_manager_.init(pool_num, frame_shard_num, replacer, huge_page);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init frame manager with replacer %s, use lru instead. rc=%s", replacer, strrc(rc));
+    frame_manager_.init(pool_num, frame_shard_num, "lru", huge_page);
+  }
+  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d, "
+           "frame shard num: %d, replacer: %s, page io: %s, huge page: %d",
+           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num,
+           frame_manager_.shard_num(), frame_manager_.replacer_name(), page_io_->name(), frame_manager_.huge_page());
 }
 
 BufferPoolManager::~BufferPoolManager()
 {
+  page_cleaner_.stop();
+  warm_up_.stop();
+
   std::unordered_map<std::string, DiskBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
 
@@ -661,16 +1502,11 @@ RC BufferPoolManager::create_file(const char *file_name)
 
   char *bitmap = file_header->bitmap;
   bitmap[0] |= 0x01;
-  if (lseek(fd, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(fd, (char *)&page, BP_PAGE_SIZE) != 0) {
-    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
+  RC rc = page_io_->write_page(fd, BP_HEADER_PAGE, &page);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strrc(rc));
     close(fd);
-    return RC::IOERR_WRITE;
+    return rc;
   }
 
   close(fd);
@@ -678,17 +1514,23 @@ RC BufferPoolManager::create_file(const char *file_name)
   return RC::SUCCESS;
 }
 
-RC BufferPoolManager::open_file(const char *_file_name, DiskBufferPool *&_bp)
+RC BufferPoolManager::open_file(const char *_file_name, DiskBufferPool *&_bp, const char *pool_name /* = nullptr */)
 {
   std::string file_name(_file_name);
 
+  BPFrameManager *frame_manager = find_pool(pool_name);
+  if (frame_manager == nullptr) {
+    LOG_WARN("no such buffer pool, use the default one instead. pool=%s, file name=%s", pool_name, _file_name);
+    frame_manager = &frame_manager_;
+  }
+
   std::scoped_lock lock_guard(lock_);
   if (buffer_pools_.find(file_name) != buffer_pools_.end()) {
     LOG_WARN("file already opened. file name=%s", _file_name);
     return RC::BUFFERPOOL_OPEN;
   }
 
-  DiskBufferPool *bp = new DiskBufferPool(*this, frame_manager_);
+  DiskBufferPool *bp = new DiskBufferPool(*this, *frame_manager);
   RC rc = bp->open_file(_file_name);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to open file name");
@@ -752,6 +1594,260 @@ RC BufferPoolManager::flush_page(Frame &frame)
   return bp->flush_page(frame);
 }
 
+int BufferPoolManager::clean_frames(int file_desc, const std::vector<Frame *> &frames)
+{
+  // 调用者持有 batch_lock 的共享锁，文件不会被关闭。写磁盘时不持有 lock_，
+  // 淘汰脏页的线程会在持有 DiskBufferPool 锁的情况下来加 lock_
+  DiskBufferPool *bp = nullptr;
+  {
+    std::scoped_lock lock_guard(lock_);
+    auto iter = fd_buffer_pools_.find(file_desc);
+    if (iter == fd_buffer_pools_.end()) {
+      LOG_WARN("unknown buffer pool of fd %d", file_desc);
+      return 0;
+    }
+    bp = iter->second;
+  }
+
+  return bp->clean_frames(frames);
+}
+
+RC BufferPoolManager::create_pool(const char *name, int64_t memory_size, const char *replacer)
+{
+  if (common::is_blank(name) || find_pool(name) != nullptr) {
+    LOG_WARN("invalid buffer pool name or the pool already exists. name=%s", name);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int64_t frame_num = std::max(memory_size / BP_PAGE_SIZE, static_cast<int64_t>(DEFAULT_ITEM_NUM_PER_POOL));
+  if (memory_size <= 0 || frame_num / DEFAULT_ITEM_NUM_PER_POOL > std::numeric_limits<int>::max()) {
+    LOG_WARN("invalid buffer pool memory size. name=%s, memory size=%ld", name, memory_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int pool_num      = static_cast<int>(frame_num / DEFAULT_ITEM_NUM_PER_POOL);
+  auto      frame_manager = std::make_unique<BPFrameManager>(name);
+  frame_manager->set_secondary_cache(&secondary_cache_);
+  RC        rc            = frame_manager->init(pool_num, frame_manager_.shard_num(), replacer, huge_page_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init buffer pool. name=%s, replacer=%s, rc=%s", name, replacer, strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("create buffer pool %s. page num=%d, replacer=%s",
+           name, static_cast<int>(frame_manager->total_frame_num()), frame_manager->replacer_name());
+  std::scoped_lock lock_guard(lock_);
+  named_pools_.push_back(std::move(frame_manager));
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::init_secondary_cache(const char *file_name, int64_t size)
+{
+  return secondary_cache_.init(file_name, size);
+}
+
+BPFrameManager *BufferPoolManager::find_pool(const char *name)
+{
+  if (common::is_blank(name) || 0 == strcmp(name, DEFAULT_POOL_NAME)) {
+    return &frame_manager_;
+  }
+
+  std::scoped_lock lock_guard(lock_);
+  for (std::unique_ptr<BPFrameManager> &frame_manager : named_pools_) {
+    if (0 == strcmp(frame_manager->name(), name)) {
+      return frame_manager.get();
+    }
+  }
+  return nullptr;
+}
+
+std::vector<BPFrameManager *> BufferPoolManager::frame_managers()
+{
+  std::vector<BPFrameManager *> frame_managers{&frame_manager_};
+
+  std::scoped_lock lock_guard(lock_);
+  for (std::unique_ptr<BPFrameManager> &frame_manager : named_pools_) {
+    frame_managers.push_back(frame_manager.get());
+  }
+  return frame_managers;
+}
+
+void BufferPoolManager::set_table_pool(const char *table_name, const char *pool_name, bool index)
+{
+  std::scoped_lock lock_guard(lock_);
+  std::unordered_map<std::string, std::string> &table_pools = index ? table_index_pools_ : table_pools_;
+  table_pools[table_name] = pool_name;
+}
+
+std::string BufferPoolManager::table_pool(const char *table_name, bool index)
+{
+  std::scoped_lock lock_guard(lock_);
+  std::unordered_map<std::string, std::string> &table_pools = index ? table_index_pools_ : table_pools_;
+  auto iter = table_pools.find(table_name);
+  return iter == table_pools.end() ? std::string() : iter->second;
+}
+
+std::vector<std::pair<FrameId, LSN>> BufferPoolManager::dirty_page_table()
+{
+  std::vector<std::pair<FrameId, LSN>> dirty_pages;
+  for (BPFrameManager *frame_manager : frame_managers()) {
+    std::vector<std::pair<FrameId, LSN>> pool_dirty_pages = frame_manager->dirty_page_table();
+    dirty_pages.insert(dirty_pages.end(), pool_dirty_pages.begin(), pool_dirty_pages.end());
+  }
+  return dirty_pages;
+}
+
+RC BufferPoolManager::flush_dirty_pages(LSN lsn)
+{
+  int remain_count = 0;
+  page_cleaner_.clean_before(lsn, remain_count);
+  if (remain_count > 0) {
+    LOG_INFO("some dirty pages before lsn %d are in use and cannot be flushed. count=%d", lsn, remain_count);
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::sync_files()
+{
+  // 持有 batch_lock 的共享锁防止文件被关闭，同步文件时不持有 lock_，不会阻塞其它线程写页面
+  std::shared_lock cleaner_guard(page_cleaner_.batch_lock());
+
+  std::vector<int> file_descs;
+  {
+    std::scoped_lock lock_guard(lock_);
+    for (const auto &item : fd_buffer_pools_) {
+      file_descs.push_back(item.first);
+    }
+  }
+
+  for (int file_desc : file_descs) {
+    if (fsync(file_desc) != 0) {
+      LOG_ERROR("failed to sync file. fd=%d, error=%s", file_desc, strerror(errno));
+      return RC::IOERR_SYNC;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::start_page_cleaner(int thread_num, int low_water_mark_pct)
+{
+  return page_cleaner_.start(thread_num, low_water_mark_pct);
+}
+
+RC BufferPoolManager::resize(int64_t memory_size, const char *pool_name)
+{
+  const int64_t frame_num = std::max(memory_size / BP_PAGE_SIZE, static_cast<int64_t>(DEFAULT_ITEM_NUM_PER_POOL));
+  if (memory_size <= 0 || frame_num > std::numeric_limits<int>::max()) {
+    LOG_WARN("invalid buffer pool memory size %ld", memory_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  BPFrameManager *frame_manager = find_pool(pool_name);
+  if (frame_manager == nullptr) {
+    LOG_WARN("no such buffer pool. name=%s", pool_name);
+    return RC::NOTFOUND;
+  }
+
+  RC rc = frame_manager->resize(static_cast<int>(frame_num));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (frame_manager->pending_shrink_frame_num() == 0) {
+    return RC::SUCCESS;
+  }
+
+  if (page_cleaner_.running()) {
+    page_cleaner_.wakeup();
+    return RC::SUCCESS;
+  }
+
+  // 没有后台线程，只能在当前线程中回收
+  while (frame_manager->pending_shrink_frame_num() > 0) {
+    if (shrink_frames(SHRINK_BATCH_FRAMES) == 0) {
+      LOG_WARN("cannot shrink buffer pool because frames are in use. name=%s, pending frame num=%d",
+               frame_manager->name(), static_cast<int>(frame_manager->pending_shrink_frame_num()));
+      break;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+int BufferPoolManager::shrink_frames(int max_count)
+{
+  std::vector<BPFrameManager *> shrinking_pools;
+  for (BPFrameManager *frame_manager : frame_managers()) {
+    if (frame_manager->pending_shrink_frame_num() > 0) {
+      shrinking_pools.push_back(frame_manager);
+    }
+  }
+  if (shrinking_pools.empty()) {
+    return 0;
+  }
+
+  // 回收脏页帧时会pin住它们写磁盘，关闭文件时需要等待
+  std::shared_lock cleaner_guard(page_cleaner_.batch_lock());
+
+  // 与后台刷脏页一样，持有页面的读锁写磁盘并清除脏标记，这期间页面不会被修改。
+  // 页面正在被修改时跳过，之后再回收
+  auto purger = [this](Frame *frame) {
+    return clean_frames(frame->file_desc(), {frame}) > 0 ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
+  };
+
+  int shrunk_count = 0;
+  for (BPFrameManager *frame_manager : shrinking_pools) {
+    int pool_shrunk_count = 0;
+    for (int i = 0; i < frame_manager->shard_num() && shrunk_count + pool_shrunk_count < max_count; i++) {
+      pool_shrunk_count += frame_manager->shrink_shard(i, max_count - shrunk_count - pool_shrunk_count, purger);
+    }
+
+    if (pool_shrunk_count > 0) {
+      LOG_INFO("buffer pool shrink progress: name=%s, shrunk %d frames, frame num=%d, target frame num=%d, pending=%d",
+               frame_manager->name(), pool_shrunk_count, static_cast<int>(frame_manager->total_frame_num()),
+               static_cast<int>(frame_manager->target_frame_num()),
+               static_cast<int>(frame_manager->pending_shrink_frame_num()));
+    }
+    shrunk_count += pool_shrunk_count;
+  }
+  return shrunk_count;
+}
+
+std::unordered_map<int, std::string> BufferPoolManager::opened_files()
+{
+  std::unordered_map<int, std::string> files;
+
+  std::scoped_lock lock_guard(lock_);
+  for (const auto &[file_name, bp] : buffer_pools_) {
+    files.emplace(bp->file_desc(), file_name);
+  }
+  return files;
+}
+
+int BufferPoolManager::warm_up_pages(const char *file_name, const PageNum *page_nums, int count)
+{
+  // 关闭文件时需要拿到 batch_lock 的排它锁，持有共享锁可以防止读取的过程中文件被关闭。
+  // 不能持有 lock_ 去读取页面，淘汰页面的线程会在持有 DiskBufferPool 锁的情况下来加 lock_
+  std::shared_lock cleaner_guard(page_cleaner_.batch_lock());
+
+  DiskBufferPool *bp = nullptr;
+  {
+    std::scoped_lock lock_guard(lock_);
+    auto iter = buffer_pools_.find(file_name);
+    if (iter == buffer_pools_.end()) {
+      return -1;
+    }
+    bp = iter->second;
+  }
+
+  return bp->prefetch_pages(page_nums, count);
+}
+
+RC BufferPoolManager::start_warm_up(const char *file_name, int dump_interval)
+{
+  return warm_up_.start(file_name, dump_interval);
+}
+
 static BufferPoolManager *default_bpm = nullptr;
 void BufferPoolManager::set_instance(BufferPoolManager *bpm)
 {
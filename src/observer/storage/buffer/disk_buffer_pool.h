@@ -20,19 +20,31 @@ See the Mulan PSL v2 for more details. */
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <atomic>
 #include <string>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "common/rc.h"
 #include "common/types.h"
 #include "common/lang/mutex.h"
 #include "common/mm/mem_pool.h"
-#include "common/lang/lru_cache.h"
 #include "common/lang/bitmap.h"
 #include "storage/buffer/page.h"
 #include "storage/buffer/frame.h"
+#include "storage/buffer/frame_arena.h"
+#include "storage/buffer/buffer_ring.h"
+#include "storage/buffer/frame_replacer.h"
+#include "storage/buffer/log_handler.h"
+#include "storage/buffer/page_cleaner.h"
+#include "storage/buffer/page_io.h"
+#include "storage/buffer/secondary_cache.h"
+#include "storage/buffer/space_map.h"
+#include "storage/buffer/warm_up.h"
 
 class BufferPoolManager;
 class DiskBufferPool;
@@ -45,30 +57,70 @@ class DiskBufferPool;
 #define BP_FILE_SUB_HDR_SIZE (sizeof(BPFileSubHeader))
 
 /**
- * @brief BufferPool的文件第一个页面，存放一些元数据信息，包括了后面每页的分配信息。
+ * @brief BufferPool的文件第一个页面，存放一些元数据信息，包括了前面一部分页面的分配信息。
  * @ingroup BufferPool
- * @details
- * @code
- * TODO 1. 当前的做法，只能分配比较少的页面，你可以扩展一下，支持更多的页面或无限多的页面吗？
- *         可以参考Linux ext(n)和Windows NTFS等文件系统
- *      2. 当前使用bitmap存放页面分配情况，但是这种方法在页面非常多的时候，查找空闲页面的
- *         效率非常低，你有办法优化吗？
- * @endcode
+ * @details 文件头中的位图只能管理 MAX_PAGE_NUM 个页面，后面的页面由位图页面管理，参考 BPSpaceMap
  */
 struct BPFileHeader 
 {
-  int32_t page_count;       //! 当前文件一共有多少个页面
-  int32_t allocated_pages;  //! 已经分配了多少个页面
+  int32_t page_count;       //! 当前文件一共有多少个页面，包括文件头和位图页面
+  int32_t allocated_pages;  //! 已经分配了多少个页面，包括文件头和位图页面
   char bitmap[0];           //! 页面分配位图, 第0个页面(就是当前页面)，总是1
 
   /**
-   * 能够分配的最大的页面个数，即bitmap的字节数 乘以8
+   * 文件头中的位图能够管理的页面个数，即bitmap的字节数 乘以8
    */
   static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
 
   std::string to_string() const;
 };
 
+/**
+ * @brief 预读的统计信息
+ * @ingroup BufferPool
+ */
+struct BPReadAheadStats
+{
+  std::atomic<int64_t> prefetch_count{0};  ///< 一共预读了多少个页面
+  std::atomic<int64_t> hit_count{0};       ///< 预读的页面后来被访问到了
+  std::atomic<int64_t> wasted_count{0};    ///< 预读的页面还没有被访问就被淘汰或释放了
+};
+
+/**
+ * @brief 页帧的命中与淘汰统计，每个 BPFrameManager 一份
+ * @ingroup BufferPool
+ */
+struct BPFrameStats
+{
+  std::atomic<int64_t> hit_count{0};    ///< 访问的页面已经在内存中
+  std::atomic<int64_t> miss_count{0};   ///< 访问的页面需要从磁盘读取
+  std::atomic<int64_t> evict_count{0};  ///< 为了腾出页帧淘汰了多少个页面
+};
+
+/**
+ * @brief 预读的配置
+ * @ingroup BufferPool
+ * @details 每次预读的页面个数从 min_pages 开始，连续的顺序访问时翻倍，直到 max_pages。
+ * max_pages 小于等于0表示不预读
+ */
+struct BPReadAheadOptions
+{
+  int min_pages = 4;
+  int max_pages = 64;
+};
+
+/**
+ * @brief 页帧环的配置，参考 BPBufferRing
+ * @ingroup BufferPool
+ * @details 文件的页面个数超过 buffer pool 页帧个数的 threshold_pct% 时，扫描使用页帧环。
+ * size 小于等于0表示不使用页帧环
+ */
+struct BPBufferRingOptions
+{
+  int size          = 32;
+  int threshold_pct = 25;
+};
+
 /**
  * @brief 管理页面Frame
  * @ingroup BufferPool
@@ -76,13 +128,25 @@ struct BPFileHeader
  * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
  * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的BufferPool磁盘文件
  * 在访问时都使用这个管理器映射到内存。
+ *
+ * 为了避免所有的页面访问都竞争同一把锁，页帧表按照 FrameId::hash() 拆分成多个分片(shard)，
+ * 每个分片有自己的锁、淘汰策略和页帧分配器。一个页面只会出现在它所属的分片中，淘汰页面时
+ * 也只在该分片内部查找。淘汰策略可以参考 FrameReplacer。
  */
 class BPFrameManager 
 {
 public:
   BPFrameManager(const char *tag);
 
-  RC init(int pool_num);
+  /**
+   * @brief 初始化
+   *
+   * @param pool_num  页帧内存池的个数，每个内存池包含 DEFAULT_ITEM_NUM_PER_POOL 个页帧
+   * @param shard_num 页帧表拆分成多少个分片。所有的页帧会平均分给各个分片
+   * @param replacer  页帧淘汰策略的名字，参考 FrameReplacer::create
+   * @param huge_page 页面内存是否使用大页，参考 BPFrameArena
+   */
+  RC init(int pool_num, int shard_num = 1, const char *replacer = "lru", bool huge_page = false);
   RC cleanup();
 
   /**
@@ -90,9 +154,10 @@ public:
    * 
    * @param file_desc 文件描述符，也可以当做buffer pool文件的标识
    * @param page_num  页面号
+   * @param touch     是否通知淘汰策略页面被访问了。使用 BPBufferRing 扫描时不通知
    * @return Frame* 页帧指针
    */
-  Frame *get(int file_desc, PageNum page_num);
+  Frame *get(int file_desc, PageNum page_num, bool touch = true);
 
   /**
    * @brief 列出所有指定文件的页面
@@ -107,9 +172,17 @@ public:
    * 
    * @param file_desc 文件描述符
    * @param page_num 页面编号
+   * @param cold     放在淘汰策略中最先被淘汰的位置，参考 FrameReplacer::insert_cold
    * @return Frame* 页帧指针
    */
-  Frame *alloc(int file_desc, PageNum page_num);
+  Frame *alloc(int file_desc, PageNum page_num, bool cold = false);
+
+  /**
+   * @brief 预读使用，只从空闲的页帧中分配，不会淘汰其它页面
+   * @param cached 返回页面是否已经在内存中
+   * @return 页面已经在内存中或者没有空闲的页帧时，返回nullptr
+   */
+  Frame *alloc_free(int file_desc, PageNum page_num, bool &cached, bool cold = false);
 
   /**
    * 尽管frame中已经包含了file_desc和page_num，但是依然要求
@@ -117,31 +190,130 @@ public:
    */
   RC free(int file_desc, PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 丢弃一个读取失败的页帧
+   * @details 页帧马上从哈希表中删除，之后再访问这个页面时会重新读取。其它线程可能已经拿到了这个页帧，
+   * 它们在 Frame::wait_loaded 返回失败之后会放开页帧，页帧在没有人pin住之后才回到空闲列表。
+   * 调用者pin住的那一次引用计数也在这里释放
+   */
+  void discard(int file_desc, PageNum page_num, Frame *frame);
+
+  /**
+   * @brief 释放一个被删除的页面所使用的页帧
+   * @details 乐观读只会pin住页帧而不加锁，删除页面时可能还有乐观读者pin着这个页帧。
+   * 这时只释放调用者的引用计数，页帧留在缓存中，等乐观读者校验失败后释放，之后像普通页面一样被淘汰。
+   * @return 页帧还被其他人pin着时返回 RC::LOCKED_UNLOCK
+   */
+  RC free_unused(int file_desc, PageNum page_num, Frame *frame);
+
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
-   * 尝试从pin count=0的页面中淘汰一些
+   * 尝试从pin count=0的页面中淘汰一些。
+   * 优先淘汰干净的页帧，只有干净的页帧不够时，才会淘汰脏页帧，这时需要调用purger
+   * @param file_desc 想要分配页帧的文件
+   * @param page_num  想要分配页帧的页面。只会在这个页面所属的分片中淘汰页帧
    * @param count 想要purge多少个页面
-   * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘
+   * @param purger 淘汰脏页帧之前需要做的操作。当前是刷新脏数据到磁盘
    * @return 返回本次清理了多少个页面
    */
-  int purge_frames(int count, std::function<RC(Frame *frame)> purger);
+  int purge_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> purger);
 
-  size_t frame_num() const
-  {
-    return frames_.count();
-  }
+  /**
+   * @brief 淘汰指定的页面，页面正在被使用时不淘汰
+   * @param purger 参考 purge_frames
+   * @return 是否淘汰了这个页面
+   */
+  bool purge_frame(const FrameId &frame_id, std::function<RC(Frame *frame)> purger);
 
   /**
-   * 测试使用。返回已经从内存申请的个数
+   * @brief 后台刷脏页线程使用，找到某个分片中即将被淘汰的脏页帧
+   * @details 如果分片中空闲的页帧和即将被淘汰的干净页帧不足 low_water_mark_pct 比例，
+   * 就返回即将被淘汰的脏页帧，把它们刷到磁盘之后，就可以有足够的干净页帧了。
+   * 返回的页帧都已经pin住，使用完需要unpin
+   * @param shard_index        分片编号
+   * @param low_water_mark_pct 干净页帧最少要占多少比例(百分比)
    */
-  size_t total_frame_num() const
-  {
-    return allocator_.get_size();
-  }
+  std::vector<Frame *> find_dirty_victims(int shard_index, int low_water_mark_pct);
 
-private:
-  Frame *get_internal(const FrameId &frame_id);
-  RC     free_internal(const FrameId &frame_id, Frame *frame);
+  /**
+   * @brief 做检查点时使用，找到某个分片中恢复LSN早于指定值的脏页帧
+   * @details 返回的页帧都已经pin住，使用完需要unpin
+   * @param shard_index 分片编号
+   * @param lsn         恢复LSN小于这个值的脏页帧
+   */
+  std::vector<Frame *> find_dirty_frames(int shard_index, LSN lsn);
+
+  /**
+   * @brief 脏页表：当前所有的脏页帧，以及它们的恢复LSN，参考 Frame::recovery_lsn
+   * @details 逐个分片加共享锁遍历，不会阻塞修改页面的线程。遍历过程中页面可能又变脏或者被写回，
+   * 所以这只是一个大概的快照
+   */
+  std::vector<std::pair<FrameId, LSN>> dirty_page_table();
+
+  /**
+   * @brief 列出缓存中的页面，最近访问的页面在前面，参考 BPWarmUp
+   * @details 按照淘汰策略的顺序反向遍历每个分片，各个分片的页面交替排列
+   */
+  std::vector<FrameId> hot_frames();
+
+  /**
+   * @brief 调整页帧的个数
+   * @details 变大时立即生效：先重新启用之前回收的页帧，不够时再申请新的 BPFrameArena。
+   * 变小时只设置每个分片的目标容量，并立即回收空闲的页帧。正在使用的页帧不能马上回收，
+   * 需要之后调用 shrink_shard 逐步淘汰，这样不会长时间阻塞正在执行的查询。
+   * 回收的页帧会释放页面内存，参考 BPFrameArena::release_page
+   * @param frame_num 调整之后的页帧个数，会向上对齐到分片个数的整数倍
+   */
+  RC resize(int frame_num);
+
+  /**
+   * @brief 在某个分片中淘汰并回收超出目标容量的页帧
+   * @details 优先回收空闲的和干净的页帧。脏页帧会在放开分片锁之后调用purger写到磁盘，然后再回收
+   * @param shard_index 分片编号
+   * @param max_count   最多回收多少个页帧
+   * @param purger      写脏页的操作。需要持有页面的读锁写磁盘并清除脏标记，参考 DiskBufferPool::clean_frames
+   * @return 本次回收了多少个页帧
+   */
+  int shrink_shard(int shard_index, int max_count, std::function<RC(Frame *frame)> purger);
+
+  size_t frame_num() const;
+
+  /**
+   * @brief 一共有多少个页帧，缩小的过程中包括还没有回收的页帧
+   */
+  size_t total_frame_num() const;
+
+  /**
+   * @brief 调整大小之后的目标页帧个数
+   */
+  size_t target_frame_num() const;
+
+  /**
+   * @brief 缩小时还有多少个页帧等待回收
+   */
+  size_t pending_shrink_frame_num() const;
+
+  int shard_num() const { return static_cast<int>(shards_.size()); }
+
+  const char *replacer_name() const;
+
+  /**
+   * @brief 页面内存是否使用了 hugetlb 大页
+   */
+  bool huge_page() const;
+
+  BPReadAheadStats &read_ahead_stats() { return read_ahead_stats_; }
+  BPFrameStats     &stats() { return stats_; }
+
+  /**
+   * @brief 设置二级缓存，淘汰干净的页面时写到二级缓存中，参考 BPSecondaryCache
+   */
+  void set_secondary_cache(BPSecondaryCache *secondary_cache) { secondary_cache_ = secondary_cache; }
+
+  /**
+   * @brief 名字，参考 BufferPoolManager::create_pool
+   */
+  const char *name() const { return tag_.c_str(); }
 
 private:
   class BPFrameIdHasher {
@@ -152,12 +324,51 @@ private:
     }
   };
 
-  using FrameLruCache = common::LruCache<FrameId, Frame *, BPFrameIdHasher>;
-  using FrameAllocator = common::MemPoolSimple<Frame>;
+  using FrameTable = std::unordered_map<FrameId, Frame *, BPFrameIdHasher>;
+
+  /**
+   * @brief 页帧表的一个分片
+   * @details 分片之间互不影响，每个分片只管理 BPFrameArena 中分配给自己的那一部分页帧。
+   * 如果淘汰策略支持并发touch(比如CLOCK)，那么页面命中时只需要加共享锁
+   */
+  class Shard
+  {
+  public:
+    explicit Shard(BPReadAheadStats &read_ahead_stats) : read_ahead_stats_(read_ahead_stats) {}
+
+    Frame *get_internal(const FrameId &frame_id, bool touch = true);
+    /**
+     * @brief 从空闲列表中分配一个页帧并放到哈希表中
+     * @details 返回的页帧处于读取状态，参考 Frame::begin_load
+     */
+    Frame *alloc_internal(const FrameId &frame_id, bool cold);
+    RC     free_internal(const FrameId &frame_id, Frame *frame);
+    void   retire_internal(Frame *frame);
 
-  std::mutex lock_;
-  FrameLruCache  frames_;
-  FrameAllocator allocator_;
+  public:
+    std::shared_mutex              lock_;
+    FrameTable                     frames_;
+    std::unique_ptr<FrameReplacer> replacer_;
+    std::vector<Frame *>           free_frames_;         ///< 空闲的页帧
+    std::vector<Frame *>           retired_frames_;      ///< 缩小时回收的页帧，页面内存已经释放
+    std::vector<Frame *>           discarded_frames_;    ///< 读取失败并且还被pin着的页帧，没有人pin之后放回空闲列表
+    std::atomic<int>               capacity_{0};         ///< 分片中一共有多少个页帧，不包括回收的页帧
+    std::atomic<int>               target_capacity_{0};  ///< 调整大小之后分片中应该有多少个页帧
+    BPReadAheadStats              &read_ahead_stats_;
+  };
+
+  Shard &shard(const FrameId &frame_id);
+
+private:
+  std::string                                tag_;
+  std::mutex                                 resize_lock_;  ///< 保护 arenas_，调整大小时不能并发
+  std::vector<std::unique_ptr<BPFrameArena>> arenas_;
+  bool                                       use_huge_page_ = false;  ///< 申请页帧内存时是否使用大页
+  bool                                       huge_page_     = false;  ///< 第一块页帧内存是否使用了 hugetlb 大页
+  std::vector<std::unique_ptr<Shard>>        shards_;
+  BPReadAheadStats                           read_ahead_stats_;
+  BPFrameStats                               stats_;
+  BPSecondaryCache                          *secondary_cache_ = nullptr;
 };
 
 /**
@@ -176,7 +387,7 @@ public:
   RC reset();
 
 private:
-  common::Bitmap bitmap_;
+  DiskBufferPool *bp_ = nullptr;
   PageNum current_page_num_ = -1;
 };
 
@@ -207,19 +418,21 @@ public:
 
   /**
    * 根据文件ID和页号获取指定页面到缓冲区，返回页面句柄指针。
+   * @param ring 大范围扫描时使用的页帧环，参考 BPBufferRing。为空时按照正常的方式缓存页面
    */
-  RC get_this_page(PageNum page_num, Frame **frame);
+  RC get_this_page(PageNum page_num, Frame **frame, BPBufferRing *ring = nullptr);
 
   /**
    * 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
    * 分配页面时，如果文件中有空闲页，就直接分配一个空闲页；
    * 如果文件中没有空闲页，则扩展文件规模来增加新的空闲页。
+   * @param ring 批量写入时使用的页帧环，参考 BPBufferRing
    */
-  RC allocate_page(Frame **frame);
+  RC allocate_page(Frame **frame, BPBufferRing *ring = nullptr);
 
   /**
    * @brief 释放某个页面，将此页面设置为未分配状态
-   * 
+   * @details 页面不在缓存中时也会在位图中释放，并让二级缓存中的副本失效
    * @param page_num 待释放的页面
    */
   RC dispose_page(PageNum page_num);
@@ -263,8 +476,43 @@ public:
    */
   RC recover_page(PageNum page_num);
 
+  /**
+   * @brief 把一批页面预读到空闲的页帧中，所有的页面一次提交读取
+   * @details 已经在内存中的页面和没有分配的页面会跳过。没有空闲页帧时就停止，不会为了预读淘汰其它页面
+   * @param page_nums 要预读的页面
+   * @param count     页面个数
+   * @return 返回有多少个页面已经在内存中了，包括本次读取的和原来就在内存中的
+   */
+  int prefetch_pages(const PageNum *page_nums, int count, BPBufferRing *ring = nullptr);
+
+  const BPReadAheadOptions &read_ahead_options() const;
+
+  /**
+   * @brief 扫描整个文件时是否应该使用页帧环
+   * @details 文件的页面个数超过 buffer pool 页帧个数的一定比例时使用，参考 BPBufferRingOptions
+   * @return 需要时返回一个新的页帧环，否则返回空
+   */
+  std::unique_ptr<BPBufferRing> create_scan_ring() const;
+
+  /**
+   * @brief 批量写入时使用的页帧环，没有开启时返回空
+   */
+  std::unique_ptr<BPBufferRing> create_bulk_write_ring() const;
+
+  /**
+   * @brief 后台刷脏页线程使用，把一批脏页刷到磁盘
+   * @details 页帧已经被调用方pin住。正在被修改(拿不到读锁)的页面会被跳过
+   * @return 返回刷新了多少个页面
+   */
+  int clean_frames(const std::vector<Frame *> &frames);
+
 protected:
-  RC allocate_frame(PageNum page_num, Frame **buf);
+  RC allocate_frame(PageNum page_num, Frame **buf, BPBufferRing *ring = nullptr);
+
+  /**
+   * @brief 页帧环满了时，释放环中最早读入的页面
+   */
+  void recycle_ring_frame(BPBufferRing &ring);
 
   /**
    * 刷新指定页面到磁盘(flush)，并且释放关联的Frame
@@ -274,6 +522,7 @@ protected:
 
   /**
    * 加载指定页面的数据到内存中
+   * @details 结束页帧的读取状态，参考 Frame::begin_load。读取失败时页帧会被丢弃，调用者不能再使用它
    */
   RC load_page(PageNum page_num, Frame *frame);
 
@@ -282,6 +531,27 @@ protected:
    */
   RC flush_page_internal(Frame &frame);
 
+  /**
+   * @brief 把一批页面一次提交写入磁盘，写入成功的页面会清除脏标识
+   */
+  RC flush_frames_internal(const std::vector<Frame *> &frames);
+
+  /**
+   * @brief 创建一组页面的位图页面，参考 BPSpaceMap
+   * @details 位图页面与文件头一样，在文件关闭之前一直pin在内存中
+   */
+  RC create_map_page(int group);
+
+  /**
+   * @brief 页面的分配信息修改了，标记文件头和页面所在组的位图页面为脏页
+   */
+  void mark_space_map_dirty(PageNum page_num);
+
+  /**
+   * @brief 找到大于等于 start 的第一个已分配的数据页面，BufferPoolIterator 使用
+   */
+  PageNum next_allocated_page(PageNum start);
+
 private:
   BufferPoolManager &  bp_manager_;
   BPFrameManager &     frame_manager_;
@@ -290,9 +560,15 @@ private:
   int                  file_desc_ = -1;
   Frame *              hdr_frame_ = nullptr;
   BPFileHeader *       file_header_ = nullptr;
+  BPSpaceMap           space_map_;
+  std::vector<Frame *> map_frames_;  ///< 每一组的位图页面，第0组就是文件头
   std::set<PageNum>    disposed_pages_;
 
   common::Mutex        lock_;
+
+  /// 刷脏页时持有共享锁，释放页面时持有排它锁。只等待这个文件正在写的一批页面，
+  /// 不用等待整个后台刷脏页批次(batch_lock)结束
+  std::shared_mutex    clean_lock_;
 private:
   friend class BufferPoolIterator;
 };
@@ -300,25 +576,229 @@ private:
 /**
  * @brief BufferPool的管理类
  * @ingroup BufferPool
+ * @details 默认所有的文件共用一个页帧管理器(default)。也可以创建多个有名字的页帧管理器，
+ * 各自有自己的大小和淘汰策略，把某些表的数据或者索引放到单独的页帧管理器中，
+ * 这样大范围扫描归档表时，不会把其它表的热点页面淘汰出去。参考 create_pool
  */
 class BufferPoolManager 
 {
 public:
-  BufferPoolManager(int memory_size = 0);
+  /// 默认页帧管理器的名字
+  static constexpr const char *DEFAULT_POOL_NAME = "default";
+
+  /**
+   * @param memory_size     buffer pool 可以使用的内存大小，单位字节。小于等于0时使用默认值
+   * @param frame_shard_num 页帧表的分片个数，参考 BPFrameManager
+   * @param replacer        页帧淘汰策略，参考 FrameReplacer::create
+   * @param page_io         页面读写的方式，参考 PageIO::create
+   * @param huge_page       页面内存是否使用大页，参考 BPFrameArena
+   */
+  BufferPoolManager(int memory_size = 0, int frame_shard_num = 1, const char *replacer = "lru",
+                    const char *page_io = "sync", bool huge_page = false);
   ~BufferPoolManager();
 
   RC create_file(const char *file_name);
-  RC open_file(const char *file_name, DiskBufferPool *&bp);
+
+  /**
+   * @brief 打开文件
+   * @param pool_name 文件的页面放在哪个页帧管理器中，为空时使用默认的页帧管理器。
+   *                  没有这个名字的页帧管理器时也使用默认的页帧管理器
+   */
+  RC open_file(const char *file_name, DiskBufferPool *&bp, const char *pool_name = nullptr);
   RC close_file(const char *file_name);
 
+  /**
+   * @brief 创建一个有名字的页帧管理器
+   * @details 只能在启动时打开文件之前调用，创建之后就不会再删除。分片个数和是否使用大页与默认的页帧管理器相同。
+   * 可以在线调整大小，参考 resize
+   * @param name        名字，不能与已有的重复
+   * @param memory_size 可以使用的内存大小，单位字节。最少 DEFAULT_ITEM_NUM_PER_POOL 个页帧
+   * @param replacer    页帧淘汰策略，参考 FrameReplacer::create
+   */
+  RC create_pool(const char *name, int64_t memory_size, const char *replacer);
+
+  /**
+   * @brief 按照名字查找页帧管理器，名字为空时返回默认的页帧管理器，找不到时返回空
+   */
+  BPFrameManager *find_pool(const char *name);
+
+  /**
+   * @brief 所有的页帧管理器，第一个是默认的页帧管理器
+   */
+  std::vector<BPFrameManager *> frame_managers();
+
+  /**
+   * @brief 指定一张表的数据或者索引文件使用的页帧管理器，需要在打开表之前设置
+   * @param table_name 表名
+   * @param pool_name  页帧管理器的名字，参考 create_pool
+   * @param index      设置的是索引文件还是数据文件
+   */
+  void set_table_pool(const char *table_name, const char *pool_name, bool index);
+
+  /**
+   * @brief 一张表的数据或者索引文件使用的页帧管理器的名字，没有指定时返回空字符串
+   */
+  std::string table_pool(const char *table_name, bool index);
+
   RC flush_page(Frame &frame);
 
+  /**
+   * @brief 把属于同一个文件的一批脏页刷到磁盘，参考 DiskBufferPool::clean_frames
+   */
+  int clean_frames(int file_desc, const std::vector<Frame *> &frames);
+
+  /**
+   * @brief 启动后台刷脏页线程
+   * @param thread_num         线程个数，小于等于0表示不启动
+   * @param low_water_mark_pct 每个分片中至少保留多少比例的干净页帧
+   */
+  RC start_page_cleaner(int thread_num, int low_water_mark_pct);
+
+  /**
+   * @brief 加载预热文件中的页面，并定期保存缓存中的页面列表，参考 BPWarmUp
+   * @param file_name     预热文件的名字
+   * @param dump_interval 每隔多少秒保存一次页面列表，小于等于0表示只在关闭时保存
+   */
+  RC start_warm_up(const char *file_name, int dump_interval);
+
+  /**
+   * @brief 当前打开的所有文件，文件描述符 -> 文件名
+   */
+  std::unordered_map<int, std::string> opened_files();
+
+  /**
+   * @brief 把一个已经打开的文件的一批页面读到空闲的页帧中，参考 DiskBufferPool::prefetch_pages
+   * @return 文件没有打开时返回-1，否则返回有多少个页面已经在内存中了
+   */
+  int warm_up_pages(const char *file_name, const PageNum *page_nums, int count);
+
+  /**
+   * @brief 设置日志模块，页面读入或者写回时会从这里获取LSN，参考 BPLogHandler
+   * @details 需要在打开文件之前设置。日志模块销毁之前需要设置为空
+   */
+  void set_log_handler(BPLogHandler *log_handler) { log_handler_.store(log_handler); }
+
+  /**
+   * @brief 下一条日志将要使用的LSN，没有设置日志模块时返回0
+   */
+  LSN next_lsn() const
+  {
+    BPLogHandler *log_handler = log_handler_.load();
+    return log_handler == nullptr ? 0 : log_handler->next_lsn();
+  }
+
+  /**
+   * @brief 写回页面之前保证LSN不超过 lsn 的日志已经落盘(WAL)，参考 BPLogHandler::flush_log
+   * @details 没有设置日志模块或者页面没有被记录过日志的修改(lsn为0)时什么都不做
+   */
+  RC flush_log(LSN lsn)
+  {
+    BPLogHandler *log_handler = log_handler_.load();
+    return (log_handler == nullptr || lsn <= 0) ? RC::SUCCESS : log_handler->flush_log(lsn);
+  }
+
+  /**
+   * @brief 所有页帧管理器的脏页表，参考 BPFrameManager::dirty_page_table
+   */
+  std::vector<std::pair<FrameId, LSN>> dirty_page_table();
+
+  /**
+   * @brief 把恢复LSN早于 lsn 的脏页写回磁盘，做检查点时调用，参考 BPPageCleaner::clean_before
+   * @return 有页面正在被修改没有写回时返回 LOCKED_CONCURRENCY_CONFLICT
+   */
+  RC flush_dirty_pages(LSN lsn);
+
+  /**
+   * @brief 把所有打开的文件同步到磁盘
+   * @details 写页面只是写到了操作系统的缓存中，写检查点之前需要保证这些页面已经落盘了
+   */
+  RC sync_files();
+
+  BPPageCleaner    &page_cleaner() { return page_cleaner_; }
+  BPWarmUp         &warm_up() { return warm_up_; }
+  PageIO           &page_io() { return *page_io_; }
+  BPSecondaryCache &secondary_cache() { return secondary_cache_; }
+
+  /**
+   * @brief 启用二级缓存，参考 BPSecondaryCache
+   * @details 二级缓存中只会放之后淘汰的干净页面，所以在打开文件之后再启用也没有关系
+   * @param file_name 缓存文件的名字，最好放在本地SSD上
+   * @param size      缓存文件的大小，单位字节。小于一个页面时不启用
+   */
+  RC init_secondary_cache(const char *file_name, int64_t size);
+
+  void                      set_read_ahead_options(const BPReadAheadOptions &options) { read_ahead_options_ = options; }
+  const BPReadAheadOptions &read_ahead_options() const { return read_ahead_options_; }
+  const BPReadAheadStats   &read_ahead_stats() { return frame_manager_.read_ahead_stats(); }
+
+  void set_buffer_ring_options(const BPBufferRingOptions &options) { buffer_ring_options_ = options; }
+  const BPBufferRingOptions &buffer_ring_options() const { return buffer_ring_options_; }
+
+  /**
+   * @brief 之后打开的文件是否使用 O_DIRECT 读写
+   * @details 页面已经缓存在 buffer pool 中了，使用 O_DIRECT 可以避免操作系统的 page cache 再缓存一份。
+   * 文件系统不支持 O_DIRECT 时(比如 tmpfs)依然使用普通的方式打开文件
+   */
+  void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+  bool direct_io() const { return direct_io_; }
+
+  /**
+   * @brief 在线调整 buffer pool 的大小
+   * @details 变大立即生效。变小时先回收空闲的页帧，正在使用的页帧由后台刷脏页线程逐步淘汰回收，
+   * 每次只处理一批，不会长时间阻塞正在执行的查询。没有启动后台线程时，在当前线程中完成回收。
+   * 被pin住的页帧不能回收，这时回收会一直处于等待状态，参考 pending_shrink_frames
+   * @param memory_size 调整之后的内存大小，单位字节。最少 DEFAULT_ITEM_NUM_PER_POOL 个页帧
+   * @param pool_name   调整哪个页帧管理器，为空时调整默认的页帧管理器。没有这个名字的页帧管理器时返回 NOTFOUND
+   */
+  RC resize(int64_t memory_size, const char *pool_name = nullptr);
+
+  /**
+   * @brief 缩小 buffer pool 时每一批回收多少个页帧
+   */
+  static constexpr int SHRINK_BATCH_FRAMES = 256;
+
+  /**
+   * @brief 缩小时回收一批超出目标大小的页帧，返回回收了多少个页帧
+   * @details 所有的页帧管理器都会检查，包括有名字的页帧管理器
+   */
+  int shrink_frames(int max_count);
+
+  /**
+   * @brief 默认的页帧管理器当前有多少个页帧，缩小的过程中包括还没有回收的页帧
+   */
+  int frame_capacity() const { return static_cast<int>(frame_manager_.total_frame_num()); }
+
+  /**
+   * @brief 调整大小之后默认的页帧管理器应该有多少个页帧
+   */
+  int target_frame_capacity() const { return static_cast<int>(frame_manager_.target_frame_num()); }
+
+  /**
+   * @brief 缩小时默认的页帧管理器还有多少个页帧等待回收，0表示没有正在进行的调整
+   */
+  int pending_shrink_frames() const { return static_cast<int>(frame_manager_.pending_shrink_frame_num()); }
+
 public:
   static void set_instance(BufferPoolManager *bpm); // TODO 优化全局变量的表示方法
   static BufferPoolManager &instance();
 
 private:
-  BPFrameManager frame_manager_{"BufPool"};
+  BPSecondaryCache secondary_cache_;  ///< 页帧管理器会引用它，所以放在前面
+  BPFrameManager frame_manager_{DEFAULT_POOL_NAME};
+  BPPageCleaner  page_cleaner_{*this};
+  BPWarmUp       warm_up_{*this};
+
+  /// 有名字的页帧管理器，只在启动时创建，之后不会再修改
+  std::vector<std::unique_ptr<BPFrameManager>> named_pools_;
+  std::unordered_map<std::string, std::string> table_pools_;        ///< 表名 -> 数据文件使用的页帧管理器
+  std::unordered_map<std::string, std::string> table_index_pools_;  ///< 表名 -> 索引文件使用的页帧管理器
+
+  std::unique_ptr<PageIO> page_io_;
+  BPReadAheadOptions      read_ahead_options_;
+  BPBufferRingOptions     buffer_ring_options_;
+  bool                    direct_io_ = false;
+  bool                    huge_page_ = false;  ///< 页帧内存是否使用大页，有名字的页帧管理器也使用相同的配置
+  std::atomic<BPLogHandler *> log_handler_{nullptr};
 
   common::Mutex  lock_;
   std::unordered_map<std::string, DiskBufferPool *> buffer_pools_;
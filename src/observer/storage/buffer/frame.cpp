@@ -55,21 +55,20 @@ string to_string(const FrameId &frame_id)
 ////////////////////////////////////////////////////////////////////////////////
 intptr_t get_default_debug_xid()
 {
-  #if 0
-  ThreadData *thd = ThreadData::current();
-  intptr_t xid = (thd == nullptr) ? 
-                 // pthread_self的返回值类型是pthread_t，pthread_t在linux和mac上不同
-                 // 在Linux上是一个整数类型，而在mac上是一个指针。为了能在两个平台上都编译通过，
-                 // 就将pthread_self返回值转换两次
-                 reinterpret_cast<intptr_t>(reinterpret_cast<void*>(pthread_self())) : 
-                 reinterpret_cast<intptr_t>(thd);
-  #endif
+#ifdef DEBUG
   Session *session = Session::current_session();
   if (session == nullptr) {
+    // pthread_self的返回值类型是pthread_t，pthread_t在linux和mac上不同
+    // 在Linux上是一个整数类型，而在mac上是一个指针。为了能在两个平台上都编译通过，
+    // 就将pthread_self返回值转换两次
     return reinterpret_cast<intptr_t>(reinterpret_cast<void*>(pthread_self()));
   } else {
     return reinterpret_cast<intptr_t>(session);
   }
+#else  // DEBUG
+  // 非调试模式下不记录加锁者，也就不需要去查找当前的会话
+  return 0;
+#endif // DEBUG
 }
 
 void Frame::write_latch()
@@ -79,26 +78,70 @@ void Frame::write_latch()
 
 void Frame::write_latch(intptr_t xid)
 {
+#ifdef DEBUG
   {
     scoped_lock debug_lock(debug_lock_);
     ASSERT(pin_count_.load() > 0,
            "frame lock. write lock failed while pin count is invalid. "
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
     ASSERT(read_lockers_.find(xid) == read_lockers_.end(),
            "frame lock write while holding the read lock."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
   }
+#endif // DEBUG
 
   lock_.lock();
+  if (++write_recursive_count_ == 1) {
+    // 版本号变成奇数，乐观读的校验会失败。栅栏保证后面对页面的修改不会排到版本号修改的前面
+    version_.fetch_add(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+  }
+
+#ifdef DEBUG
   write_locker_ = xid;
-  write_recursive_count_++;
+  LOG_DEBUG("frame write lock success."
+            "this=%p, pin=%d, pageNum=%d, write locker=%lx(recursive=%d), fd=%d, xid=%lx, lbt=%s",
+            this, pin_count_.load(), page_->page_num, write_locker_, write_recursive_count_, file_desc_, xid, lbt());
+#endif // DEBUG
+}
 
+bool Frame::try_write_latch()
+{
+#ifdef DEBUG
+  intptr_t xid = get_default_debug_xid();
+  {
+    scoped_lock debug_lock(debug_lock_);
+    ASSERT(pin_count_.load() > 0,
+           "frame try lock. write lock failed while pin count is invalid. "
+           "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
+
+    ASSERT(read_lockers_.find(xid) == read_lockers_.end(),
+           "frame try to lock write while holding the read lock."
+           "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
+  }
+#endif // DEBUG
+
+  if (!lock_.try_lock()) {
+    return false;
+  }
+
+  if (++write_recursive_count_ == 1) {
+    version_.fetch_add(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+  }
+
+#ifdef DEBUG
+  write_locker_ = xid;
   LOG_DEBUG("frame write lock success."
             "this=%p, pin=%d, pageNum=%d, write locker=%lx(recursive=%d), fd=%d, xid=%lx, lbt=%s",
-            this, pin_count_.load(), page_.page_num, write_locker_, write_recursive_count_, file_desc_, xid, lbt());
+            this, pin_count_.load(), page_->page_num, write_locker_, write_recursive_count_, file_desc_, xid, lbt());
+#endif // DEBUG
+  return true;
 }
 
 void Frame::write_unlatch()
@@ -108,26 +151,33 @@ void Frame::write_unlatch()
 
 void Frame::write_unlatch(intptr_t xid)
 {
+#ifdef DEBUG
   // 因为当前已经加着写锁，而且写锁只有一个，所以不再加debug_lock来做校验
   debug_lock_.lock();
 
   ASSERT(pin_count_.load() > 0, 
         "frame lock. write unlock failed while pin count is invalid."
         "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-         this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+         this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
   ASSERT(write_locker_ == xid,
          "frame unlock write while not the owner."
          "write_locker=%lx, this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-         write_locker_, this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+         write_locker_, this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
   LOG_DEBUG("frame write unlock success. this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-            this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+            this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
-  if (--write_recursive_count_ == 0) {
+  if (write_recursive_count_ == 1) {
     write_locker_ = 0;
   }
   debug_lock_.unlock();
+#endif // DEBUG
+
+  if (--write_recursive_count_ == 0) {
+    // 版本号重新变成偶数，并且在释放写锁之前发布对页面的修改
+    version_.fetch_add(1, memory_order_release);
+  }
   
   lock_.unlock();
 }
@@ -139,53 +189,62 @@ void Frame::read_latch()
 
 void Frame::read_latch(intptr_t xid) 
 {
+#ifdef DEBUG
   {
     std::scoped_lock debug_lock(debug_lock_);
     ASSERT(pin_count_ > 0, "frame lock. read lock failed while pin count is invalid."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
     ASSERT(xid != write_locker_,
            "frame lock read while holding the write lock."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
   }
+#endif // DEBUG
 
   lock_.lock_shared();
 
+#ifdef DEBUG
   {
     scoped_lock debug_lock(debug_lock_);
     int recursive_count = ++read_lockers_[xid];
     LOG_DEBUG("frame read lock success."
               "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, recursive=%d, lbt=%s",
-              this, pin_count_.load(), page_.page_num, file_desc_, xid, recursive_count, lbt());
+              this, pin_count_.load(), page_->page_num, file_desc_, xid, recursive_count, lbt());
   }
+#endif // DEBUG
 }
 
 bool Frame::try_read_latch()
 {
+#ifdef DEBUG
   intptr_t xid = get_default_debug_xid();
   {
     std::scoped_lock debug_lock(debug_lock_);
     ASSERT(pin_count_ > 0, "frame try lock. read lock failed while pin count is invalid."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
     ASSERT(xid != write_locker_,
            "frame try to lock read while holding the write lock."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
   }
+#endif // DEBUG
 
   bool ret = lock_.try_lock_shared();
+
+#ifdef DEBUG
   if (ret) {
     debug_lock_.lock();
     int recursive_count = ++read_lockers_[xid];
     LOG_DEBUG("frame read lock success."
               "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, recursive=%d, lbt=%s",
-              this, pin_count_.load(), page_.page_num, file_desc_, xid, recursive_count, lbt());
+              this, pin_count_.load(), page_->page_num, file_desc_, xid, recursive_count, lbt());
     debug_lock_.unlock();
   }
+#endif // DEBUG
 
   return ret;
 }
@@ -197,38 +256,64 @@ void Frame::read_unlatch()
 
 void Frame::read_unlatch(intptr_t xid)
 {
+#ifdef DEBUG
   {
     std::scoped_lock debug_lock(debug_lock_);
     ASSERT(pin_count_.load() > 0,
             "frame lock. read unlock failed while pin count is invalid."
             "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
 
-#if DEBUG
     auto read_lock_iter = read_lockers_.find(xid);
     int recursive_count = read_lock_iter != read_lockers_.end() ? read_lock_iter->second : 0;
     ASSERT(recursive_count > 0,
            "frame unlock while not holding read lock."
            "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, recursive=%d, lbt=%s",
-           this, pin_count_.load(), page_.page_num, file_desc_, xid, recursive_count, lbt());
+           this, pin_count_.load(), page_->page_num, file_desc_, xid, recursive_count, lbt());
 
     if (1 == recursive_count) {
       read_lockers_.erase(xid);
+    } else {
+      read_lock_iter->second--;
     }
-
-#endif // DEBUG
-
   }
 
   LOG_DEBUG("frame read unlock success."
             "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-            this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+            this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
+#endif // DEBUG
 
   lock_.unlock_shared();
 }
 
+bool Frame::optimistic_read_begin(uint64_t &version) const
+{
+  version = version_.load(memory_order_acquire);
+  return (version & 1) == 0;
+}
+
+bool Frame::optimistic_read_validate(uint64_t version) const
+{
+  // 保证前面对页面的读取不会排到版本号读取的后面
+  atomic_thread_fence(memory_order_acquire);
+  return version_.load(memory_order_relaxed) == version;
+}
+
+void Frame::end_load(bool success)
+{
+  load_state_.store(success ? LOADED : LOAD_FAILED);
+  load_state_.notify_all();
+}
+
+bool Frame::wait_loaded() const
+{
+  load_state_.wait(LOADING);
+  return load_state_.load() == LOADED;
+}
+
 void Frame::pin()
 {
+#ifdef DEBUG
   std::scoped_lock debug_lock(debug_lock_);
 
   intptr_t xid = get_default_debug_xid();
@@ -237,17 +322,21 @@ void Frame::pin()
   LOG_DEBUG("after frame pin. "
             "this=%p, write locker=%lx, read locker has xid %d? pin=%d, fd=%d, pageNum=%d, xid=%lx, lbt=%s",
             this, write_locker_, read_lockers_.find(xid) != read_lockers_.end(), 
-            pin_count, file_desc_, page_.page_num, xid, lbt());
+            pin_count, file_desc_, page_->page_num, xid, lbt());
+#else  // DEBUG
+  ++pin_count_;
+#endif // DEBUG
 }
 
 int Frame::unpin()
 {
+#ifdef DEBUG
   intptr_t xid = get_default_debug_xid();
 
   ASSERT(pin_count_.load() > 0,
          "try to unpin a frame that pin count <= 0."
          "this=%p, pin=%d, pageNum=%d, fd=%d, xid=%lx, lbt=%s",
-         this, pin_count_.load(), page_.page_num, file_desc_, xid, lbt());
+         this, pin_count_.load(), page_->page_num, file_desc_, xid, lbt());
   
   std::scoped_lock debug_lock(debug_lock_);
 
@@ -256,17 +345,20 @@ int Frame::unpin()
   LOG_DEBUG("after frame unpin. "
             "this=%p, write locker=%lx, read locker has xid? %d, pin=%d, fd=%d, pageNum=%d, xid=%lx, lbt=%s",
             this, write_locker_, read_lockers_.find(xid) != read_lockers_.end(), 
-            pin_count, file_desc_, page_.page_num, xid, lbt());
+            pin_count, file_desc_, page_->page_num, xid, lbt());
   
   if (0 == pin_count) {
     ASSERT(write_locker_ == 0,
            "frame unpin to 0 failed while someone hold the write lock. write locker=%lx, pageNum=%d, fd=%d, xid=%lx",
-           write_locker_, page_.page_num, file_desc_, xid);
+           write_locker_, page_->page_num, file_desc_, xid);
     ASSERT(read_lockers_.empty(),
            "frame unpin to 0 failed while someone hold the read locks. reader num=%d, pageNum=%d, fd=%d, xid=%lx",
-           read_lockers_.size(), page_.page_num, file_desc_, xid);
+           read_lockers_.size(), page_->page_num, file_desc_, xid);
   }
   return pin_count;
+#else  // DEBUG
+  return --pin_count_;
+#endif // DEBUG
 }
 
 
@@ -20,6 +20,8 @@ See the Mulan PSL v2 for more details. */
 #include <mutex>
 #include <set>
 #include <atomic>
+#include <memory>
+#include <unordered_map>
 
 #include "storage/buffer/page.h"
 #include "common/log/log.h"
@@ -57,10 +59,22 @@ private:
  * 
  * 为了防止在使用过程中页面被淘汰，这里使用了pin count，当页面被使用时，pin count会增加，
  * 当页面不再使用时，pin count会减少。当pin count为0时，页面可以被淘汰。
+ *
+ * 页帧的元数据按照CPU cache line对齐，页面的内存与元数据分开存放，参考 BPFrameArena。
  */
-class Frame
+class alignas(64) Frame
 {
 public:
+  /**
+   * @brief 页面的内存由页帧自己申请，不经过 BPFrameArena 时(比如单元测试)使用
+   */
+  Frame() : owned_page_(std::make_unique<Page>()), page_(owned_page_.get()) {}
+
+  /**
+   * @param page 页面的内存，由 BPFrameArena 统一申请
+   */
+  explicit Frame(Page *page) : page_(page) {}
+
   ~Frame()
   {
     // LOG_DEBUG("deallocate frame. this=%p, lbt=%s", this, common::lbt());
@@ -78,17 +92,22 @@ public:
   
   void clear_page()
   {
-    memset(&page_, 0, sizeof(page_));
+    memset(page_, 0, sizeof(Page));
   }
 
   int     file_desc() const { return file_desc_; }
   void    set_file_desc(int fd) { file_desc_ = fd; }
-  Page &  page() { return page_; }
-  PageNum page_num() const { return page_.page_num; }
-  void    set_page_num(PageNum page_num) { page_.page_num = page_num; }
-  FrameId frame_id() const { return FrameId(file_desc_, page_.page_num); }
-  LSN     lsn() const { return page_.lsn; }
-  void    set_lsn(LSN lsn) { page_.lsn = lsn; }
+  Page &  page() { return *page_; }
+  PageNum page_num() const { return page_->page_num; }
+  void    set_page_num(PageNum page_num) { page_->page_num = page_num; }
+  FrameId frame_id() const { return FrameId(file_desc_, page_->page_num); }
+
+  /**
+   * @brief 页面LSN，最后一次修改这个页面的日志LSN，随页面一起保存到磁盘上
+   * @details 页面写回磁盘之前，这个LSN之前的日志都需要先落盘(WAL)。没有日志的修改不会改变这个值
+   */
+  LSN  lsn() const { return page_->lsn; }
+  void set_lsn(LSN lsn) { page_->lsn = lsn; }
 
   /// 刷新访问时间 TODO touch is better?
   void access();
@@ -101,7 +120,45 @@ public:
   void clear_dirty() { dirty_ = false; }
   bool dirty() const { return dirty_; }
 
-  char *data() { return page_.data; }
+  /**
+   * @brief 页面的恢复LSN
+   * @details 页面与磁盘上的内容一致时(刚读入或者刚写回)，记录下一条日志将要使用的LSN。
+   * 之后对页面的修改产生的日志都不会早于这个LSN，所以页面变脏之后，从这个LSN开始重做日志就能恢复这个页面。
+   * 所有脏页帧的恢复LSN就是脏页表，参考 BufferPoolManager::dirty_page_table
+   */
+  LSN  recovery_lsn() const { return recovery_lsn_.load(); }
+  void set_recovery_lsn(LSN lsn) { recovery_lsn_.store(lsn); }
+
+  char *data() { return page_->data; }
+
+  /**
+   * @brief 页面是否是预读进来的，并且还没有被访问过
+   * @details 用来统计预读的命中情况，参考 BPReadAhead
+   */
+  void set_prefetched(bool prefetched) { prefetched_.store(prefetched); }
+  bool prefetched() const { return prefetched_.load(); }
+  bool clear_prefetched() { return prefetched_.exchange(false); }
+
+  /**
+   * @brief 标记页面数据正在读入
+   * @details 页帧分配出来时就放到了页帧管理器的哈希表中，这时页面数据还没有读入，其它线程也可能拿到这个页帧。
+   * 拿到页帧的线程需要先调用 wait_loaded 等待读取结束。
+   * 分配页帧的线程读入页面或者初始化新页面之后，需要调用 end_load
+   */
+  void begin_load() { load_state_.store(LOADING); }
+
+  /**
+   * @brief 页面读取结束，唤醒等待的线程
+   * @details 读取失败时，调用者还需要把页帧从哈希表中删掉，参考 BPFrameManager::discard
+   */
+  void end_load(bool success);
+
+  /**
+   * @brief 等待页面读取结束
+   * @return 读取失败时返回false。调用者需要放开这个页帧，再重新获取页面
+   */
+  bool wait_loaded() const;
+  bool loading() const { return load_state_.load() == LOADING; }
 
   bool can_purge() { return pin_count_.load() == 0; }
 
@@ -120,6 +177,7 @@ public:
 
   void write_latch();
   void write_latch(intptr_t xid);
+  bool try_write_latch();
 
   void write_unlatch();
   void write_unlatch(intptr_t xid);
@@ -131,25 +189,59 @@ public:
   void read_unlatch();
   void read_unlatch(intptr_t xid);
 
+  /**
+   * @brief 乐观读开始，记录当前页帧的版本号
+   * @details 乐观读不加锁，也不修改页帧上的任何共享数据，适合根节点、内部节点这种读多写少的热点页面。
+   * 写锁加锁与解锁时都会增加版本号，因此版本号是奇数时表示有人正持有写锁。
+   * 调用者需要先pin住页帧，读取完数据后使用 optimistic_read_validate 校验版本号，
+   * 校验失败说明读到的数据可能不一致，需要丢弃并重新读取或者退回到加读锁的方式。
+   * @param[out] version 当前的版本号
+   * @return 有人正在持有写锁时返回false
+   */
+  bool optimistic_read_begin(uint64_t &version) const;
+
+  /**
+   * @brief 校验乐观读期间页帧是否被修改过
+   * @param version optimistic_read_begin 返回的版本号
+   */
+  bool optimistic_read_validate(uint64_t version) const;
+
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
   friend std::string to_string(const Frame &frame);
 
 private:
   friend class  BufferPool;
 
+  static constexpr int LOADED      = 0;
+  static constexpr int LOADING     = 1;
+  static constexpr int LOAD_FAILED = 2;
+
   bool              dirty_     = false;
   std::atomic<int>  pin_count_{0};
+  std::atomic<bool> prefetched_{false};
+  std::atomic<int>  load_state_{LOADED};  ///< 页面数据是否已经读入，参考 begin_load
+  std::atomic<LSN>  recovery_lsn_{0};
   unsigned long     acc_time_  = 0;
   int               file_desc_ = -1;
-  Page              page_;
+
+  std::unique_ptr<Page> owned_page_;
+  Page                 *page_ = nullptr;
 
   /// 在非并发编译时，加锁解锁动作将什么都不做
   common::RecursiveSharedMutex     lock_;
 
+  /// 写锁的重入次数，只在第一次加锁和最后一次解锁时修改版本号
+  int                   write_recursive_count_ = 0;
+  /// 乐观读使用的版本号，奇数表示有人正持有写锁
+  std::atomic<uint64_t> version_{0};
+
+#ifdef DEBUG
   /// 使用一些手段来做测试，提前检测出头疼的死锁问题
-  /// 如果编译时没有增加调试选项，这些代码什么都不做
+  /// 这些记录只在调试模式下编译，非调试模式下读锁就不需要再修改哈希表了
   common::DebugMutex  debug_lock_;
   intptr_t            write_locker_ = 0;
-  int                 write_recursive_count_ = 0;
   std::unordered_map<intptr_t, int>  read_lockers_;
+#endif // DEBUG
 };
 
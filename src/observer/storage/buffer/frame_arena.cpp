@@ -0,0 +1,111 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <new>
+
+#include "storage/buffer/frame_arena.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+static_assert(sizeof(Page) % 4096 == 0, "pages in frame arena should be 4K aligned");
+
+BPFrameArena::~BPFrameArena() { cleanup(); }
+
+RC BPFrameArena::init(int frame_num, bool huge_page)
+{
+  if (frames_ != nullptr) {
+    LOG_WARN("frame arena has been initialized");
+    return RC::INTERNAL;
+  }
+
+  if (frame_num <= 0) {
+    LOG_ERROR("invalid frame num %d", frame_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  size_t memory_size = static_cast<size_t>(frame_num) * sizeof(Page);
+  void  *pages       = MAP_FAILED;
+  if (huge_page) {
+    memory_size = (memory_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    pages = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (pages == MAP_FAILED) {
+      LOG_INFO("failed to map huge pages, use transparent huge pages instead. memory size=%ld, error=%s",
+               memory_size, strerror(errno));
+    }
+#endif
+    huge_page_ = (pages != MAP_FAILED);
+  }
+
+  if (pages == MAP_FAILED) {
+    pages = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+      LOG_ERROR("failed to map memory for frames. memory size=%ld, error=%s", memory_size, strerror(errno));
+      return RC::NOMEM;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (huge_page && madvise(pages, memory_size, MADV_HUGEPAGE) != 0) {
+      LOG_WARN("failed to advise huge page. memory size=%ld, error=%s", memory_size, strerror(errno));
+    }
+#endif
+  }
+
+  frames_ = static_cast<Frame *>(::operator new(sizeof(Frame) * frame_num, align_val_t(alignof(Frame))));
+
+  pages_            = static_cast<char *>(pages);
+  page_memory_size_ = memory_size;
+  frame_num_        = frame_num;
+  for (int i = 0; i < frame_num; i++) {
+    new (&frames_[i]) Frame(reinterpret_cast<Page *>(pages_ + static_cast<size_t>(i) * sizeof(Page)));
+  }
+
+  LOG_INFO("frame arena init done. frame num=%d, page memory size=%ld, huge page=%d",
+           frame_num, page_memory_size_, huge_page_);
+  return RC::SUCCESS;
+}
+
+void BPFrameArena::cleanup()
+{
+  if (frames_ == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < frame_num_; i++) {
+    frames_[i].~Frame();
+  }
+  ::operator delete(frames_, align_val_t(alignof(Frame)));
+  frames_ = nullptr;
+
+  munmap(pages_, page_memory_size_);
+  pages_            = nullptr;
+  page_memory_size_ = 0;
+  frame_num_        = 0;
+  huge_page_        = false;
+}
+
+void BPFrameArena::release_page(Frame &frame)
+{
+#ifdef MADV_DONTNEED
+  if (madvise(&frame.page(), sizeof(Page), MADV_DONTNEED) != 0) {
+    LOG_DEBUG("failed to release page memory of frame. frame=%s, error=%s", to_string(frame).c_str(), strerror(errno));
+  }
+#endif
+}
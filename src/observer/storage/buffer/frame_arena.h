@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <stddef.h>
+
+#include "common/rc.h"
+#include "storage/buffer/frame.h"
+
+/**
+ * @brief 页帧内存
+ * @ingroup BufferPool
+ * @details 启动时一次性申请 buffer pool 所有的页帧，运行过程中不再申请和释放内存。
+ * 页帧的元数据(锁、pin count等)和页面数据分开存放：
+ * - 元数据放在一个按照 cache line 对齐的数组中；
+ * - 页面数据放在一块连续的匿名映射内存中，每个页面都是4K对齐的，可以直接用于 O_DIRECT 读写。
+ *   开启大页时先尝试使用 2M 的 hugetlb 大页，系统没有预留大页时退化成透明大页(THP)。
+ * 大页可以减少大内存 buffer pool 的 TLB miss。
+ * buffer pool 变大时会再申请新的 BPFrameArena，变小时只释放页面内存，参考 BPFrameManager::resize。
+ */
+class BPFrameArena
+{
+public:
+  BPFrameArena() = default;
+  ~BPFrameArena();
+
+  BPFrameArena(const BPFrameArena &)            = delete;
+  BPFrameArena &operator=(const BPFrameArena &) = delete;
+
+  /**
+   * @param frame_num 页帧的个数
+   * @param huge_page 页面数据是否使用大页
+   */
+  RC   init(int frame_num, bool huge_page);
+  void cleanup();
+
+  int    frame_num() const { return frame_num_; }
+  Frame *frame(int index) { return &frames_[index]; }
+
+  /**
+   * @brief 页面数据是否真的使用了 hugetlb 大页
+   */
+  bool huge_page() const { return huge_page_; }
+
+  /**
+   * @brief 页面数据占用的内存大小
+   */
+  size_t page_memory_size() const { return page_memory_size_; }
+
+  /**
+   * @brief 把一个不再使用的页帧的页面内存还给操作系统
+   * @details buffer pool 缩小时使用。虚拟地址依然保留，页帧再次使用时操作系统会重新分配清零的内存。
+   * hugetlb 大页不能按照4K释放，这时什么都不做
+   */
+  static void release_page(Frame &frame);
+
+private:
+  Frame *frames_           = nullptr;
+  char  *pages_            = nullptr;
+  size_t page_memory_size_ = 0;
+  int    frame_num_        = 0;
+  bool   huge_page_        = false;
+};
@@ -0,0 +1,292 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <strings.h>
+
+#include "storage/buffer/frame_replacer.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+FrameReplacer *FrameReplacer::create(const char *name, int capacity)
+{
+  if (common::is_blank(name) || 0 == strcasecmp(name, "lru")) {
+    return new LruFrameReplacer();
+  }
+
+  if (0 == strcasecmp(name, "clock")) {
+    return new ClockFrameReplacer(capacity);
+  }
+
+  if (0 == strcasecmp(name, "2q")) {
+    return new TwoQueueFrameReplacer(capacity);
+  }
+
+  LOG_ERROR("unknown frame replacer name. name=%s", name);
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LruFrameReplacer::insert(Frame *frame)
+{
+  lru_list_.push_front(frame);
+  positions_[frame] = lru_list_.begin();
+}
+
+void LruFrameReplacer::insert_cold(Frame *frame)
+{
+  lru_list_.push_back(frame);
+  positions_[frame] = std::prev(lru_list_.end());
+}
+
+void LruFrameReplacer::touch(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  }
+}
+
+void LruFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.erase(iter->second);
+    positions_.erase(iter);
+  }
+}
+
+void LruFrameReplacer::foreach_victim(function<bool(Frame *)> func)
+{
+  for (auto iter = lru_list_.rbegin(); iter != lru_list_.rend(); ++iter) {
+    if (!func(*iter)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClockFrameReplacer::ClockFrameReplacer(int capacity)
+    : slots_(max(capacity, 1), nullptr), referenced_(new atomic<bool>[max(capacity, 1)])
+{
+  free_slots_.reserve(slots_.size());
+  for (int i = static_cast<int>(slots_.size()) - 1; i >= 0; i--) {
+    referenced_[i].store(false, memory_order_relaxed);
+    free_slots_.push_back(i);
+  }
+}
+
+void ClockFrameReplacer::insert(Frame *frame)
+{
+  ASSERT(!free_slots_.empty(), "no free slot in clock replacer. capacity=%d", static_cast<int>(slots_.size()));
+
+  int slot = free_slots_.back();
+  free_slots_.pop_back();
+
+  slots_[slot] = frame;
+  referenced_[slot].store(true, memory_order_relaxed);
+  positions_[frame] = slot;
+}
+
+void ClockFrameReplacer::insert_cold(Frame *frame)
+{
+  // 没有访问标识，时钟指针经过时就会被淘汰
+  insert(frame);
+  referenced_[positions_[frame]].store(false, memory_order_relaxed);
+}
+
+void ClockFrameReplacer::touch(Frame *frame)
+{
+  // 只读访问 positions_，可以与其它的 touch 并发
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    referenced_[iter->second].store(true, memory_order_relaxed);
+  }
+}
+
+void ClockFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    slots_[iter->second] = nullptr;
+    free_slots_.push_back(iter->second);
+    positions_.erase(iter);
+  }
+}
+
+void ClockFrameReplacer::foreach_victim(function<bool(Frame *)> func)
+{
+  // 最多转两圈：第一圈清除访问标识，第二圈一定能访问到所有的页帧
+  const int slot_num = static_cast<int>(slots_.size());
+  for (int i = 0; i < slot_num * 2; i++) {
+    int    slot  = hand_;
+    Frame *frame = slots_[slot];
+    hand_        = (hand_ + 1) % slot_num;
+
+    if (frame == nullptr) {
+      continue;
+    }
+
+    if (referenced_[slot].exchange(false, memory_order_relaxed)) {
+      continue;
+    }
+
+    if (!func(frame)) {
+      break;
+    }
+  }
+}
+
+void ClockFrameReplacer::peek_victims(function<bool(Frame *)> func)
+{
+  // 不移动时钟指针也不清除访问标识。先访问没有访问标识的页帧，它们会最先被淘汰
+  const int slot_num = static_cast<int>(slots_.size());
+  for (int round = 0; round < 2; round++) {
+    const bool referenced = (round == 1);
+    for (int i = 0; i < slot_num; i++) {
+      int    slot  = (hand_ + i) % slot_num;
+      Frame *frame = slots_[slot];
+      if (frame == nullptr || referenced_[slot].load(memory_order_relaxed) != referenced) {
+        continue;
+      }
+
+      if (!func(frame)) {
+        return;
+      }
+    }
+  }
+}
+
+void ClockFrameReplacer::resize(int capacity)
+{
+  // 环只会变大。缩小时空出来的槽位留着，时钟指针经过时跳过
+  const int old_slot_num = static_cast<int>(slots_.size());
+  if (capacity <= old_slot_num) {
+    return;
+  }
+
+  unique_ptr<atomic<bool>[]> referenced(new atomic<bool>[capacity]);
+  for (int i = 0; i < capacity; i++) {
+    referenced[i].store(i < old_slot_num && referenced_[i].load(memory_order_relaxed), memory_order_relaxed);
+  }
+  referenced_.swap(referenced);
+
+  slots_.resize(capacity, nullptr);
+  for (int i = capacity - 1; i >= old_slot_num; i--) {
+    free_slots_.push_back(i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TwoQueueFrameReplacer::TwoQueueFrameReplacer(int capacity)
+{
+  resize(capacity);
+}
+
+void TwoQueueFrameReplacer::resize(int capacity)
+{
+  // 论文中推荐的参数：A1in 占用25%的空间，A1out 记录50%的页帧标识
+  a1in_max_size_  = max(capacity / 4, 1);
+  a1out_max_size_ = max(capacity / 2, 1);
+
+  while (a1out_.size() > a1out_max_size_) {
+    a1out_positions_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
+
+void TwoQueueFrameReplacer::insert(Frame *frame)
+{
+  auto ghost_iter = a1out_positions_.find(frame->frame_id());
+  if (ghost_iter != a1out_positions_.end()) {
+    // 最近被淘汰过又被访问到了，说明是一个热点页面
+    a1out_.erase(ghost_iter->second);
+    a1out_positions_.erase(ghost_iter);
+
+    am_.push_front(frame);
+    positions_[frame] = Position{true, false, am_.begin()};
+  } else {
+    a1in_.push_front(frame);
+    positions_[frame] = Position{false, false, a1in_.begin()};
+  }
+}
+
+void TwoQueueFrameReplacer::insert_cold(Frame *frame)
+{
+  // 不认为是热点页面，即使它刚刚被淘汰过
+  a1in_.push_back(frame);
+  positions_[frame] = Position{false, true, std::prev(a1in_.end())};
+}
+
+void TwoQueueFrameReplacer::touch(Frame *frame)
+{
+  // 在 A1in 中的页面再次访问，不做调整。这样一次扫描访问多次的页面也不会进入 Am
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end() && iter->second.in_am) {
+    am_.splice(am_.begin(), am_, iter->second.iter);
+  }
+}
+
+void TwoQueueFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  if (iter->second.in_am) {
+    am_.erase(iter->second.iter);
+  } else {
+    a1in_.erase(iter->second.iter);
+
+    FrameId frame_id = frame->frame_id();
+    if (!iter->second.cold && a1out_positions_.find(frame_id) == a1out_positions_.end()) {
+      a1out_.push_front(frame_id);
+      a1out_positions_.emplace(frame_id, a1out_.begin());
+    }
+
+    while (a1out_.size() > a1out_max_size_) {
+      a1out_positions_.erase(a1out_.back());
+      a1out_.pop_back();
+    }
+  }
+  positions_.erase(iter);
+}
+
+void TwoQueueFrameReplacer::foreach_victim(function<bool(Frame *)> func)
+{
+  auto visit = [&func](list<Frame *> &frames) {
+    for (auto iter = frames.rbegin(); iter != frames.rend(); ++iter) {
+      if (!func(*iter)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // A1in 超过了它的配额时优先从 A1in 中淘汰，否则从 Am 中淘汰
+  if (a1in_.size() > a1in_max_size_) {
+    if (visit(a1in_)) {
+      visit(am_);
+    }
+  } else {
+    if (visit(am_)) {
+      visit(a1in_);
+    }
+  }
+}
@@ -0,0 +1,188 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/buffer/frame.h"
+
+/**
+ * @brief 页帧淘汰策略
+ * @ingroup BufferPool
+ * @details 决定内存不够用时先淘汰哪个页帧。BPFrameManager 的每个分片都有一个自己的淘汰策略对象，
+ * 所有的接口都在分片的锁保护下调用。如果 concurrent_touch 返回 true，touch 只会加分片的共享锁，
+ * 所以这时 touch 的实现需要自己保证线程安全，并且不能修改数据结构。
+ */
+class FrameReplacer
+{
+public:
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * @brief 新的页帧加入缓存
+   */
+  virtual void insert(Frame *frame) = 0;
+
+  /**
+   * @brief 新的页帧加入缓存，但是放在最先被淘汰的位置
+   * @details 大范围扫描读入的页面使用这个接口，参考 BPBufferRing
+   */
+  virtual void insert_cold(Frame *frame) { insert(frame); }
+
+  /**
+   * @brief 页帧被访问到了(命中)
+   */
+  virtual void touch(Frame *frame) = 0;
+
+  /**
+   * @brief 页帧从缓存中移除，可能是被淘汰了，也可能是页面被释放了
+   */
+  virtual void remove(Frame *frame) = 0;
+
+  /**
+   * @brief 按照淘汰的优先级遍历页帧，最应该被淘汰的页帧最先访问
+   * @param func 返回false表示停止遍历。func 中不能调用 insert/remove
+   */
+  virtual void foreach_victim(std::function<bool(Frame *)> func) = 0;
+
+  /**
+   * @brief 与 foreach_victim 类似，但是不能修改任何状态，在只加分片共享锁的情况下调用
+   * @details 后台刷脏页线程使用这个接口查看哪些页帧即将被淘汰，不应该影响淘汰的顺序
+   */
+  virtual void peek_victims(std::function<bool(Frame *)> func) { foreach_victim(func); }
+
+  /**
+   * @brief buffer pool 调整大小之后，分片中最多会有 capacity 个页帧
+   * @details 在分片的排它锁下调用。缩小时页帧是逐步回收的，所以只会在页帧都回收之后才会用更小的值调用
+   */
+  virtual void resize(int capacity) {}
+
+  /**
+   * @brief touch 是否可以在只加共享锁的情况下并发调用
+   */
+  virtual bool concurrent_touch() const { return false; }
+
+  virtual const char *name() const = 0;
+
+public:
+  /**
+   * @brief 根据名字创建淘汰策略
+   * @param name     lru/clock/2q，为空时使用lru
+   * @param capacity 最多会有多少个页帧
+   */
+  static FrameReplacer *create(const char *name, int capacity);
+};
+
+/**
+ * @brief 最经典的LRU淘汰策略
+ * @ingroup BufferPool
+ * @details 每次命中都需要调整链表，所以需要加分片的排它锁
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame) override;
+  void insert_cold(Frame *frame) override;
+  void touch(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> func) override;
+
+  const char *name() const override { return "lru"; }
+
+private:
+  std::list<Frame *>                                     lru_list_;  ///< 最近访问的在前面
+  std::unordered_map<Frame *, std::list<Frame *>::iterator> positions_;
+};
+
+/**
+ * @brief CLOCK(second chance)淘汰策略
+ * @ingroup BufferPool
+ * @details 所有的页帧放在一个环上，命中时仅设置一个访问标识，不需要调整任何数据结构。
+ * 淘汰时时钟指针沿着环移动，跳过有访问标识的页帧并清除其标识。
+ */
+class ClockFrameReplacer : public FrameReplacer
+{
+public:
+  explicit ClockFrameReplacer(int capacity);
+
+  void insert(Frame *frame) override;
+  void insert_cold(Frame *frame) override;
+  void touch(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> func) override;
+  void peek_victims(std::function<bool(Frame *)> func) override;
+  void resize(int capacity) override;
+  bool concurrent_touch() const override { return true; }
+
+  const char *name() const override { return "clock"; }
+
+private:
+  std::vector<Frame *>                    slots_;
+  std::unique_ptr<std::atomic<bool>[]>    referenced_;
+  std::unordered_map<Frame *, int>        positions_;
+  std::vector<int>                        free_slots_;
+  int                                     hand_ = 0;
+};
+
+/**
+ * @brief 2Q淘汰策略，可以防止一次大范围的顺序扫描把热点页面都淘汰出去
+ * @ingroup BufferPool
+ * @details 参考 2Q: A Low Overhead High Performance Buffer Management Replacement Algorithm。
+ * 第一次访问的页面放在先进先出的 A1in 队列中，A1in 中淘汰的页面只记录页帧标识，放在 A1out 队列中。
+ * 只有在 A1out 中的页面再次被访问时，才会进入按照LRU管理的 Am 队列。
+ */
+class TwoQueueFrameReplacer : public FrameReplacer
+{
+public:
+  explicit TwoQueueFrameReplacer(int capacity);
+
+  void insert(Frame *frame) override;
+  void insert_cold(Frame *frame) override;
+  void touch(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(std::function<bool(Frame *)> func) override;
+  void resize(int capacity) override;
+
+  const char *name() const override { return "2q"; }
+
+private:
+  class FrameIdHasher
+  {
+  public:
+    size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
+  };
+
+  struct Position
+  {
+    bool                         in_am;
+    bool                         cold;  ///< 使用 insert_cold 加入的页帧，淘汰时不记录到 A1out 中
+    std::list<Frame *>::iterator iter;
+  };
+
+  size_t a1in_max_size_  = 0;
+  size_t a1out_max_size_ = 0;
+
+  std::list<Frame *>                     a1in_;  ///< 最近加入的在前面
+  std::list<Frame *>                     am_;    ///< 最近访问的在前面
+  std::unordered_map<Frame *, Position>  positions_;
+
+  std::list<FrameId>                                                           a1out_;
+  std::unordered_map<FrameId, std::list<FrameId>::iterator, FrameIdHasher>     a1out_positions_;
+};
@@ -0,0 +1,44 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include "common/rc.h"
+#include "common/types.h"
+
+/**
+ * @brief buffer pool 与日志模块之间的接口
+ * @ingroup BufferPool
+ * @details buffer pool 不直接依赖日志模块。页面读入或者写回磁盘时，需要知道日志当前写到了哪里，
+ * 用来记录页面的恢复LSN，参考 Frame::recovery_lsn。没有设置日志模块时(比如单元测试)，LSN都是0。
+ * 页面写回磁盘之前，修改这个页面的日志必须先落盘(WAL)，参考 flush_log。
+ */
+class BPLogHandler
+{
+public:
+  virtual ~BPLogHandler() = default;
+
+  /**
+   * @brief 下一条日志将要使用的LSN
+   */
+  virtual LSN next_lsn() const = 0;
+
+  /**
+   * @brief 保证LSN不超过 lsn 的日志都已经写到了磁盘上
+   * @details 脏页写回磁盘之前调用，lsn 就是页面上最后一次修改对应的日志LSN(Frame::lsn)。
+   * 日志已经落盘时直接返回，不需要每次都同步整个日志
+   */
+  virtual RC flush_log(LSN lsn) = 0;
+};
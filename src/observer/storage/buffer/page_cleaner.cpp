@@ -0,0 +1,206 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <algorithm>
+#include <chrono>
+
+#include "storage/buffer/page_cleaner.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+/// 没有被唤醒时，后台线程多久检查一次
+static constexpr chrono::milliseconds CLEANER_INTERVAL(100);
+
+BPPageCleaner::BPPageCleaner(BufferPoolManager &bp_manager) : bp_manager_(bp_manager)
+{}
+
+BPPageCleaner::~BPPageCleaner()
+{
+  stop();
+}
+
+RC BPPageCleaner::start(int thread_num, int low_water_mark_pct)
+{
+  if (running_) {
+    LOG_WARN("page cleaner has been started");
+    return RC::INTERNAL;
+  }
+
+  if (thread_num <= 0 || low_water_mark_pct <= 0) {
+    LOG_INFO("page cleaner is disabled. thread num=%d, low water mark=%d%%", thread_num, low_water_mark_pct);
+    return RC::SUCCESS;
+  }
+
+#ifdef CONCURRENCY
+  int max_shard_num = 1;
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    max_shard_num = max(max_shard_num, frame_manager->shard_num());
+  }
+
+  thread_num_         = min(thread_num, max_shard_num);
+  low_water_mark_pct_ = min(low_water_mark_pct, 100);
+  running_            = true;
+  for (int i = 0; i < thread_num_; i++) {
+    threads_.emplace_back(&BPPageCleaner::run, this, i);
+  }
+  LOG_INFO("page cleaner started. thread num=%d, low water mark=%d%%", thread_num_, low_water_mark_pct_);
+#else
+  LOG_WARN("page cleaner is disabled because the observer is not compiled with CONCURRENCY");
+#endif
+  return RC::SUCCESS;
+}
+
+void BPPageCleaner::stop()
+{
+  {
+    lock_guard guard(lock_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cond_.notify_all();
+
+  for (thread &t : threads_) {
+    t.join();
+  }
+  threads_.clear();
+  LOG_INFO("page cleaner stopped. cleaned page count=%ld", cleaned_page_count_.load());
+}
+
+void BPPageCleaner::wakeup()
+{
+  {
+    lock_guard guard(lock_);
+    if (!running_) {
+      return;
+    }
+    wakeup_signal_ = true;
+  }
+  cond_.notify_all();
+}
+
+bool BPPageCleaner::running()
+{
+  lock_guard guard(lock_);
+  return running_;
+}
+
+void BPPageCleaner::run(int thread_index)
+{
+  LOG_INFO("page cleaner thread %d started", thread_index);
+  while (true) {
+    {
+      unique_lock guard(lock_);
+      cond_.wait_for(guard, CLEANER_INTERVAL, [this]() { return !running_ || wakeup_signal_; });
+      if (!running_) {
+        break;
+      }
+      wakeup_signal_ = false;
+    }
+
+    clean_shards(thread_index, thread_num_, low_water_mark_pct_);
+
+    // 在线缩小 buffer pool 时，每一轮回收一批页帧
+    if (thread_index == 0 && bp_manager_.shrink_frames(BufferPoolManager::SHRINK_BATCH_FRAMES) > 0) {
+      wakeup();
+    }
+  }
+  LOG_INFO("page cleaner thread %d stopped", thread_index);
+}
+
+int BPPageCleaner::clean(int low_water_mark_pct)
+{
+  return clean_shards(0, 1, low_water_mark_pct);
+}
+
+int BPPageCleaner::clean_shards(int first_shard, int shard_step, int low_water_mark_pct)
+{
+  shared_lock batch_guard(batch_lock_);
+
+  vector<Frame *> frames;
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    for (int shard_index = first_shard; shard_index < frame_manager->shard_num(); shard_index += shard_step) {
+      vector<Frame *> dirty_frames = frame_manager->find_dirty_victims(shard_index, low_water_mark_pct);
+      frames.insert(frames.end(), dirty_frames.begin(), dirty_frames.end());
+    }
+  }
+
+  const int cleaned_count = clean_frames(frames);
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+
+  LOG_DEBUG("page cleaner cleaned %d pages from shard %d step %d, dirty frames=%d",
+            cleaned_count, first_shard, shard_step, (int)frames.size());
+  return cleaned_count;
+}
+
+int BPPageCleaner::clean_before(LSN lsn, int &remain_count)
+{
+  shared_lock batch_guard(batch_lock_);
+
+  vector<Frame *> frames;
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    for (int shard_index = 0; shard_index < frame_manager->shard_num(); shard_index++) {
+      vector<Frame *> dirty_frames = frame_manager->find_dirty_frames(shard_index, lsn);
+      frames.insert(frames.end(), dirty_frames.begin(), dirty_frames.end());
+    }
+  }
+
+  const int cleaned_count = clean_frames(frames);
+
+  // 写回之后又被修改的页面，恢复LSN不会早于 lsn，仍然早于 lsn 的就是没能写回的页面
+  remain_count = 0;
+  for (Frame *frame : frames) {
+    if (frame->dirty() && frame->recovery_lsn() < lsn) {
+      remain_count++;
+    }
+    frame->unpin();
+  }
+
+  LOG_INFO("clean dirty pages before lsn %d. dirty frames=%d, cleaned=%d, remain=%d",
+           lsn, (int)frames.size(), cleaned_count, remain_count);
+  return cleaned_count;
+}
+
+int BPPageCleaner::clean_frames(vector<Frame *> &frames)
+{
+  if (frames.empty()) {
+    return 0;
+  }
+
+  // 同一个文件的页面放在一起，按照页号顺序写入
+  sort(frames.begin(), frames.end(), [](const Frame *f1, const Frame *f2) {
+    if (f1->file_desc() != f2->file_desc()) {
+      return f1->file_desc() < f2->file_desc();
+    }
+    return f1->page_num() < f2->page_num();
+  });
+
+  int cleaned_count = 0;
+  for (size_t begin = 0, end = 0; begin < frames.size(); begin = end) {
+    const int file_desc = frames[begin]->file_desc();
+    for (end = begin; end < frames.size() && frames[end]->file_desc() == file_desc; end++) {
+    }
+
+    vector<Frame *> file_frames(frames.begin() + begin, frames.begin() + end);
+    cleaned_count += bp_manager_.clean_frames(file_desc, file_frames);
+  }
+
+  cleaned_page_count_ += cleaned_count;
+  return cleaned_count;
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "common/rc.h"
+#include "common/types.h"
+
+class BufferPoolManager;
+class BPFrameManager;
+class Frame;
+
+/**
+ * @brief 后台刷脏页线程
+ * @ingroup BufferPool
+ * @details 如果淘汰页面时遇到的都是脏页，那前台的查询就要等待页面写入磁盘之后才能继续。
+ * 后台线程定期检查每个分片中即将被淘汰的页帧，保证其中至少有 low water mark 个可以直接淘汰的干净页帧。
+ * 不够时就把这些页帧中的脏页写到磁盘上，同一个文件的页面按照页号顺序写入。
+ * 这样前台查询需要页帧时，通常只需要丢弃干净的页帧。
+ * 所有的页帧管理器都由这些线程负责，参考 BufferPoolManager::create_pool。
+ * 在线缩小 buffer pool 时，也由后台线程逐步回收多出来的页帧，参考 BufferPoolManager::resize。
+ */
+class BPPageCleaner
+{
+public:
+  explicit BPPageCleaner(BufferPoolManager &bp_manager);
+  ~BPPageCleaner();
+
+  /**
+   * @brief 启动后台线程
+   * @details 后台线程会与前台线程并发访问页面，所以只有在 CONCURRENCY 编译模式下才会真正启动
+   *
+   * @param thread_num          后台线程的个数，每个线程负责每个页帧管理器中的一部分分片
+   * @param low_water_mark_pct  每个分片中至少要保留多少比例(百分比)的干净页帧
+   */
+  RC   start(int thread_num, int low_water_mark_pct);
+  void stop();
+
+  /**
+   * @brief 唤醒后台线程，在前台淘汰页面时遇到脏页时调用
+   */
+  void wakeup();
+
+  /**
+   * @brief 后台线程是否已经启动
+   */
+  bool running();
+
+  /**
+   * @brief 后台线程在写一批页面时会持有这把锁的共享锁
+   * @details 后台线程写页面时会pin住页帧。关闭文件或者释放页面时，要求页帧不能被其它人pin住，
+   * 所以需要先拿到这把锁的排它锁，等待后台线程写完当前这一批页面。
+   * 加锁顺序：这把锁要在 DiskBufferPool 的锁之前。
+   */
+  std::shared_mutex &batch_lock() { return batch_lock_; }
+
+  /**
+   * @brief 在调用者的线程中检查一遍所有的分片，返回刷新了多少个页面
+   * @details 不需要启动后台线程，单元测试使用
+   */
+  int clean(int low_water_mark_pct);
+
+  /**
+   * @brief 在调用者的线程中把恢复LSN早于 lsn 的脏页都写到磁盘上，返回写了多少个页面
+   * @details 做检查点时调用。一直被访问的热点页面不会被淘汰，后台线程也就不会写它们，
+   * 如果不主动写回，这些页面的恢复LSN会让检查点一直无法前进。正在被修改的页面会跳过
+   * @param lsn          恢复LSN小于这个值的脏页
+   * @param remain_count 有多少个页面因为正在被修改而没有写回
+   */
+  int clean_before(LSN lsn, int &remain_count);
+
+  /**
+   * @brief 后台线程一共写了多少个页面
+   */
+  int64_t cleaned_page_count() const { return cleaned_page_count_.load(); }
+
+private:
+  void run(int thread_index);
+  int  clean_shards(int first_shard, int shard_step, int low_water_mark_pct);
+  int  clean_frames(std::vector<Frame *> &frames);
+
+private:
+  BufferPoolManager &bp_manager_;
+
+  int thread_num_         = 0;
+  int low_water_mark_pct_ = 0;
+
+  std::vector<std::thread> threads_;
+  std::mutex               lock_;
+  std::condition_variable  cond_;
+  bool                     running_       = false;
+  bool                     wakeup_signal_ = false;
+
+  std::shared_mutex    batch_lock_;
+  std::atomic<int64_t> cleaned_page_count_{0};
+};
@@ -0,0 +1,334 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <vector>
+
+#include "storage/buffer/page_io.h"
+#include "common/io/io.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+/// io_uring 的队列深度，一次最多提交这么多请求
+static constexpr int IO_URING_QUEUE_DEPTH = 64;
+
+static int64_t page_offset(PageNum page_num)
+{
+  return static_cast<int64_t>(page_num) * BP_PAGE_SIZE;
+}
+
+unique_ptr<PageIO> PageIO::create(const char *name)
+{
+  if (is_blank(name) || 0 == strcasecmp(name, "sync")) {
+    return make_unique<SyncPageIO>();
+  }
+
+  if (0 == strcasecmp(name, "io_uring")) {
+#ifdef WITH_IO_URING
+    auto page_io = make_unique<IoUringPageIO>();
+    RC   rc      = page_io->init(IO_URING_QUEUE_DEPTH);
+    if (OB_SUCC(rc)) {
+      return page_io;
+    }
+    LOG_WARN("failed to init io_uring, use sync page io instead. rc=%s", strrc(rc));
+#else
+    LOG_WARN("io_uring is not compiled, use sync page io instead");
+#endif
+    return make_unique<SyncPageIO>();
+  }
+
+  LOG_ERROR("unknown page io name. name=%s", name);
+  return nullptr;
+}
+
+RC PageIO::read_page(int file_desc, PageNum page_num, Page *page)
+{
+  PageIORequest request;
+  request.file_desc = file_desc;
+  request.page_num  = page_num;
+  request.page      = page;
+  return read_pages(&request, 1);
+}
+
+RC PageIO::write_page(int file_desc, PageNum page_num, Page *page)
+{
+  PageIORequest request;
+  request.file_desc = file_desc;
+  request.page_num  = page_num;
+  request.page      = page;
+  return write_pages(&request, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RC SyncPageIO::read_pages(PageIORequest *requests, int count)
+{
+  RC first_rc = RC::SUCCESS;
+  for (int i = 0; i < count; i++) {
+    PageIORequest &request = requests[i];
+    int ret = preadn(request.file_desc, request.page, BP_PAGE_SIZE, page_offset(request.page_num));
+    if (ret != 0) {
+      LOG_ERROR("failed to read page. file_desc=%d, page num=%d, ret=%d, error=%s",
+                request.file_desc, request.page_num, ret, strerror(errno));
+      request.rc = RC::IOERR_READ;
+    } else {
+      request.rc = RC::SUCCESS;
+    }
+
+    if (OB_FAIL(request.rc) && OB_SUCC(first_rc)) {
+      first_rc = request.rc;
+    }
+  }
+  return first_rc;
+}
+
+RC SyncPageIO::write_pages(PageIORequest *requests, int count)
+{
+  RC first_rc = RC::SUCCESS;
+  for (int i = 0; i < count; i++) {
+    PageIORequest &request = requests[i];
+    int ret = pwriten(request.file_desc, request.page, BP_PAGE_SIZE, page_offset(request.page_num));
+    if (ret != 0) {
+      LOG_ERROR("failed to write page. file_desc=%d, page num=%d, error=%s",
+                request.file_desc, request.page_num, strerror(ret));
+      request.rc = RC::IOERR_WRITE;
+    } else {
+      request.rc = RC::SUCCESS;
+    }
+
+    if (OB_FAIL(request.rc) && OB_SUCC(first_rc)) {
+      first_rc = request.rc;
+    }
+  }
+  return first_rc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef WITH_IO_URING
+IoUringPageIO::~IoUringPageIO()
+{
+  if (inited_) {
+    io_uring_queue_exit(&ring_);
+    inited_ = false;
+  }
+}
+
+RC IoUringPageIO::init(int queue_depth)
+{
+  int ret = io_uring_queue_init(queue_depth, &ring_, 0 /*flags*/);
+  if (ret < 0) {
+    LOG_WARN("failed to init io_uring. queue depth=%d, error=%s", queue_depth, strerror(-ret));
+    return RC::IOERR_OPEN;
+  }
+
+  queue_depth_ = queue_depth;
+  inited_      = true;
+  LOG_INFO("io_uring page io init done. queue depth=%d", queue_depth);
+  return RC::SUCCESS;
+}
+
+RC IoUringPageIO::read_pages(PageIORequest *requests, int count)
+{
+  return submit(requests, count, false /*write*/);
+}
+
+RC IoUringPageIO::write_pages(PageIORequest *requests, int count)
+{
+  return submit(requests, count, true /*write*/);
+}
+
+RC IoUringPageIO::submit(PageIORequest *requests, int count, bool write)
+{
+  SyncPageIO sync_io;
+  RC         first_rc = RC::SUCCESS;
+
+  lock_guard guard(lock_);
+  if (!inited_) {
+    return write ? sync_io.write_pages(requests, count) : sync_io.read_pages(requests, count);
+  }
+
+  for (int begin = 0; begin < count; begin += queue_depth_) {
+    const int batch_size = min(queue_depth_, count - begin);
+    PageIORequest *batch = requests + begin;
+    for (int i = 0; i < batch_size; i++) {
+      PageIORequest &request = batch[i];
+      request.rc = write ? RC::IOERR_WRITE : RC::IOERR_READ;
+
+      struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+      if (write) {
+        io_uring_prep_write(sqe, request.file_desc, request.page, BP_PAGE_SIZE, page_offset(request.page_num));
+      } else {
+        io_uring_prep_read(sqe, request.file_desc, request.page, BP_PAGE_SIZE, page_offset(request.page_num));
+      }
+      io_uring_sqe_set_data(sqe, &request);
+    }
+
+    // 提交出错时 SQ 中可能还留着没有提交的 SQE，需要重建 ring 把它们丢弃
+    bool broken    = false;
+    int  submitted = 0;
+    while (io_uring_sq_ready(&ring_) > 0) {
+      int ret = io_uring_submit(&ring_);
+      if (ret > 0) {
+        submitted += ret;
+      } else if (ret == 0 || (ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)) {
+        LOG_WARN("failed to submit io_uring requests. count=%d, submitted=%d, error=%s",
+                 batch_size, submitted, strerror(-ret));
+        broken = true;
+        break;
+      }
+    }
+
+    // 已经提交的请求都要等到完成事件，否则下一批请求会取到这一批的完成事件
+    vector<bool> done(batch_size, false);
+    int          in_flight = submitted;
+    if (OB_FAIL(wait_completions(batch, done, in_flight, write))) {
+      broken = true;
+
+      // 还有请求在内核中执行，内核可能还在向这些页面写数据。先取消这些请求，再等到它们的完成事件，
+      // 之后才能关闭 ring 并使用同步的方式重新读写这些页面
+      cancel_in_flight(batch, done, submitted);
+      (void)wait_completions(batch, done, in_flight, write);
+    }
+
+    if (broken) {
+      reset_ring();
+    }
+
+    // 没有提交或者没有等到完成事件的请求，使用同步的方式处理。
+    // 前 submitted 个请求已经提交，如果一直没有等到完成事件，就不能确定内核是否还在使用这个页面，
+    // 只能按照失败处理
+    for (int i = 0; i < batch_size; i++) {
+      if (done[i]) {
+        continue;
+      }
+
+      if (i < submitted) {
+        LOG_ERROR("io_uring request is still in flight after the ring was recreated. file_desc=%d, page num=%d",
+                  batch[i].file_desc, batch[i].page_num);
+        batch[i].rc = write ? RC::IOERR_WRITE : RC::IOERR_READ;
+      } else {
+        batch[i].rc = write ? sync_io.write_pages(&batch[i], 1) : sync_io.read_pages(&batch[i], 1);
+      }
+    }
+
+    for (int i = 0; i < batch_size; i++) {
+      if (OB_FAIL(batch[i].rc) && OB_SUCC(first_rc)) {
+        first_rc = batch[i].rc;
+      }
+    }
+
+    if (!inited_) {
+      // ring 重建失败，剩下的请求都使用同步的方式处理
+      const int rest = count - begin - batch_size;
+      if (rest > 0) {
+        PageIORequest *rest_requests = batch + batch_size;
+        RC rc = write ? sync_io.write_pages(rest_requests, rest) : sync_io.read_pages(rest_requests, rest);
+        if (OB_FAIL(rc) && OB_SUCC(first_rc)) {
+          first_rc = rc;
+        }
+      }
+      break;
+    }
+  }
+  return first_rc;
+}
+
+RC IoUringPageIO::wait_completions(PageIORequest *batch, vector<bool> &done, int &in_flight, bool write)
+{
+  SyncPageIO sync_io;
+  while (in_flight > 0) {
+    struct io_uring_cqe *cqe = nullptr;
+    int ret = io_uring_wait_cqe(&ring_, &cqe);
+    if (ret == -EINTR || ret == -EAGAIN) {
+      continue;
+    }
+    if (ret < 0) {
+      LOG_WARN("failed to wait io_uring completion. in flight=%d, error=%s", in_flight, strerror(-ret));
+      return write ? RC::IOERR_WRITE : RC::IOERR_READ;
+    }
+
+    void     *data = io_uring_cqe_get_data(cqe);
+    const int res  = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+    if (data == nullptr) {
+      continue;  // 取消请求自己的完成事件
+    }
+
+    // 出错、被取消或者只完成了一部分，都使用同步的方式再执行一次。
+    // 有了完成事件，内核就不会再访问这个页面了
+    PageIORequest &request = *static_cast<PageIORequest *>(data);
+    in_flight--;
+    done[&request - batch] = true;
+    request.rc = (res == BP_PAGE_SIZE) ? RC::SUCCESS
+                 : write               ? sync_io.write_pages(&request, 1)
+                                       : sync_io.read_pages(&request, 1);
+  }
+  return RC::SUCCESS;
+}
+
+void IoUringPageIO::cancel_in_flight(PageIORequest *batch, const vector<bool> &done, int submitted)
+{
+  // SQ 中还有没提交的 SQE 时，提交取消请求会把它们一起提交，这时只等待完成事件
+  if (io_uring_sq_ready(&ring_) > 0) {
+    return;
+  }
+
+  int cancel_count = 0;
+  for (int i = 0; i < submitted; i++) {
+    if (done[i]) {
+      continue;
+    }
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    if (sqe == nullptr) {
+      break;
+    }
+    io_uring_prep_cancel(sqe, &batch[i], 0 /*flags*/);
+    io_uring_sqe_set_data(sqe, nullptr);
+    cancel_count++;
+  }
+
+  while (io_uring_sq_ready(&ring_) > 0) {
+    int ret = io_uring_submit(&ring_);
+    if (ret == 0 || (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY)) {
+      // 取消不了就只能等这些请求自己完成
+      LOG_WARN("failed to cancel in flight io_uring requests. count=%d, error=%s", cancel_count, strerror(-ret));
+      break;
+    }
+  }
+}
+
+void IoUringPageIO::reset_ring()
+{
+  // 关闭 ring 会丢弃没有提交的 SQE 和没有处理的完成事件。
+  // 关闭之后内核在后台取消已经提交的请求，不会等它们结束，所以调用前需要先等到这些请求的完成事件
+  io_uring_queue_exit(&ring_);
+  inited_ = false;
+
+  int ret = io_uring_queue_init(queue_depth_, &ring_, 0 /*flags*/);
+  if (ret < 0) {
+    LOG_ERROR("failed to recreate io_uring, use sync io instead. queue depth=%d, error=%s",
+              queue_depth_, strerror(-ret));
+    return;
+  }
+  inited_ = true;
+  LOG_WARN("io_uring recreated after an error. queue depth=%d", queue_depth_);
+}
+#endif  // WITH_IO_URING
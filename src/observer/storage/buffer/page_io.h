@@ -0,0 +1,141 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef WITH_IO_URING
+#include <liburing.h>
+#endif
+
+#include "common/rc.h"
+#include "common/types.h"
+#include "storage/buffer/page.h"
+
+/**
+ * @brief 一次页面读写请求
+ * @ingroup BufferPool
+ */
+struct PageIORequest
+{
+  int     file_desc = -1;
+  PageNum page_num  = -1;
+  Page   *page      = nullptr;     ///< 读取时是目标内存，写入时是要写的数据
+  RC      rc        = RC::SUCCESS; ///< 这个请求的执行结果
+};
+
+/**
+ * @brief 页面读写接口
+ * @ingroup BufferPool
+ * @details DiskBufferPool 通过这个接口读写磁盘上的页面。所有的读写都使用带偏移量的接口，
+ * 不依赖文件描述符上的偏移量，所以多个线程可以同时读写同一个文件。
+ * 一批请求会尽量一次提交，比如后台刷脏页线程一次写入多个页面。
+ */
+class PageIO
+{
+public:
+  virtual ~PageIO() = default;
+
+  /**
+   * @brief 读取一批页面
+   * @details 每个请求的结果记录在请求的rc中。如果有请求失败，返回第一个失败的错误码
+   */
+  virtual RC read_pages(PageIORequest *requests, int count) = 0;
+
+  /**
+   * @brief 写入一批页面，参考 read_pages
+   */
+  virtual RC write_pages(PageIORequest *requests, int count) = 0;
+
+  virtual const char *name() const = 0;
+
+  RC read_page(int file_desc, PageNum page_num, Page *page);
+  RC write_page(int file_desc, PageNum page_num, Page *page);
+
+public:
+  /**
+   * @brief 根据名字创建页面读写对象
+   * @details 如果没有编译 io_uring 或者初始化失败，会使用同步的方式读写页面
+   * @param name sync/io_uring，为空时使用sync
+   */
+  static std::unique_ptr<PageIO> create(const char *name);
+};
+
+/**
+ * @brief 使用 pread/pwrite 同步读写页面，一次系统调用处理一个页面
+ * @ingroup BufferPool
+ */
+class SyncPageIO : public PageIO
+{
+public:
+  RC read_pages(PageIORequest *requests, int count) override;
+  RC write_pages(PageIORequest *requests, int count) override;
+
+  const char *name() const override { return "sync"; }
+};
+
+#ifdef WITH_IO_URING
+/**
+ * @brief 使用 io_uring 读写页面，一批请求只需要一次提交
+ * @ingroup BufferPool
+ * @details 所有的线程共享一个 ring，提交和等待结果的过程需要加锁。
+ * 如果某个请求只完成了一部分，剩下的部分使用同步的方式完成。
+ * 提交或等待结果出错时，ring 中可能还留着指向调用者请求的 SQE 或者完成事件，这时会取消还在执行的请求，
+ * 等到它们的完成事件之后重建 ring，保证返回之后 ring 和内核都不再引用这一批请求
+ */
+class IoUringPageIO : public PageIO
+{
+public:
+  ~IoUringPageIO() override;
+
+  RC init(int queue_depth);
+
+  RC read_pages(PageIORequest *requests, int count) override;
+  RC write_pages(PageIORequest *requests, int count) override;
+
+  const char *name() const override { return "io_uring"; }
+
+private:
+  RC submit(PageIORequest *requests, int count, bool write);
+
+  /**
+   * @brief 等待已经提交的请求的完成事件，直到没有请求还在内核中执行
+   * @details 没有完全成功的请求会使用同步的方式再执行一次。返回失败时，in_flight 是还没有等到完成事件的请求个数
+   * @param batch 这一批请求，完成事件中的数据指向其中的请求
+   * @param done 记录哪些请求已经等到了完成事件
+   */
+  RC wait_completions(PageIORequest *batch, std::vector<bool> &done, int &in_flight, bool write);
+
+  /**
+   * @brief 取消这一批中前 submitted 个已经提交但是还没有完成事件的请求
+   * @details 被取消的请求仍然会产生完成事件，需要再调用 wait_completions 等待
+   */
+  void cancel_in_flight(PageIORequest *batch, const std::vector<bool> &done, int submitted);
+
+  /**
+   * @brief 丢弃 ring 中所有未提交的 SQE 和未处理的完成事件，重新创建 ring
+   * @details 重建失败时后面的请求都使用同步的方式处理
+   */
+  void reset_ring();
+
+private:
+  std::mutex      lock_;
+  struct io_uring ring_;
+  int             queue_depth_ = 0;
+  bool            inited_      = false;
+};
+#endif  // WITH_IO_URING
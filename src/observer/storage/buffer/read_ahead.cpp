@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "storage/buffer/read_ahead.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+/// 连续顺序访问这么多个页面之后才开始预读，避免点查询等场景浪费内存
+static constexpr int SEQUENTIAL_THRESHOLD = 2;
+
+void BPReadAhead::init(DiskBufferPool &buffer_pool, BPBufferRing *ring /* = nullptr */)
+{
+  buffer_pool_      = &buffer_pool;
+  ring_             = ring;
+  options_          = buffer_pool.read_ahead_options();
+  if (ring_ != nullptr) {
+    options_.max_pages = min(options_.max_pages, ring_->capacity() / 2);
+  }
+  last_page_        = -1;
+  sequential_count_ = 0;
+  window_           = 0;
+  trigger_page_     = -1;
+  prefetched_end_   = -1;
+}
+
+void BPReadAhead::access(PageNum page_num)
+{
+  if (buffer_pool_ == nullptr || options_.max_pages <= 0) {
+    return;
+  }
+
+  if (page_num > last_page_) {
+    sequential_count_++;
+  } else {
+    // 不是顺序访问了，重新开始
+    sequential_count_ = 1;
+    window_           = 0;
+    trigger_page_     = -1;
+    prefetched_end_   = -1;
+  }
+  last_page_ = page_num;
+
+  if (sequential_count_ < SEQUENTIAL_THRESHOLD) {
+    return;
+  }
+
+  if (page_num < trigger_page_ && page_num <= prefetched_end_) {
+    return;
+  }
+
+  prefetch(max(page_num, prefetched_end_));
+}
+
+void BPReadAhead::prefetch(PageNum start_page)
+{
+  window_ = (window_ == 0) ? max(options_.min_pages, 1) : min(window_ * 2, options_.max_pages);
+  window_ = min(window_, options_.max_pages);
+
+  BufferPoolIterator iterator;
+  iterator.init(*buffer_pool_, start_page);
+
+  vector<PageNum> page_nums;
+  page_nums.reserve(window_);
+  while (static_cast<int>(page_nums.size()) < window_ && iterator.has_next()) {
+    page_nums.push_back(iterator.next());
+  }
+
+  if (page_nums.empty()) {
+    // 已经到文件末尾了，不需要再预读
+    trigger_page_   = numeric_limits<PageNum>::max();
+    prefetched_end_ = numeric_limits<PageNum>::max();
+    return;
+  }
+
+  const int count  = static_cast<int>(page_nums.size());
+  const int cached = buffer_pool_->prefetch_pages(page_nums.data(), count, ring_);
+  if (cached < count) {
+    // 空闲的页帧不够了，预读太多只会把别人需要的页面挤出去
+    window_ = max(options_.min_pages, cached);
+  }
+
+  // prefetch_pages 在没有空闲页帧时就停止了，只有前面的页面在内存中
+  trigger_page_   = page_nums.front();
+  prefetched_end_ = page_nums[max(cached, 1) - 1];
+  LOG_DEBUG("read ahead. start page=%d, count=%d, cached=%d, next window=%d", start_page, count, cached, window_);
+}
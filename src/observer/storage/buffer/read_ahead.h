@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include "storage/buffer/disk_buffer_pool.h"
+
+/**
+ * @brief 顺序扫描时的预读
+ * @ingroup BufferPool
+ * @details 扫描的时候每访问一个页面就告诉预读器。连续几次访问的页面编号都是递增的，
+ * 就认为是在顺序扫描，把后面的若干个已分配的页面一次性读到空闲的页帧中。
+ * 当访问到上一次预读的第一个页面时，再发起下一次预读，这样扫描到的页面通常都已经在内存中了。
+ * 每次预读的页面个数从 BPReadAheadOptions::min_pages 开始翻倍增长，没有空闲页帧时会缩小。
+ */
+class BPReadAhead
+{
+public:
+  BPReadAhead() = default;
+
+  /**
+   * @param ring 扫描使用的页帧环，预读的页面也放在环中。为了不把还没有访问的页面挤出去，
+   *             每次预读的页面个数不会超过环的一半
+   */
+  void init(DiskBufferPool &buffer_pool, BPBufferRing *ring = nullptr);
+
+  /**
+   * @brief 扫描访问了某个页面，在访问页面之前调用
+   */
+  void access(PageNum page_num);
+
+  /**
+   * @brief 下一次预读的页面个数
+   */
+  int window() const { return window_; }
+
+private:
+  void prefetch(PageNum start_page);
+
+private:
+  DiskBufferPool    *buffer_pool_ = nullptr;
+  BPBufferRing      *ring_        = nullptr;
+  BPReadAheadOptions options_;
+
+  PageNum last_page_        = -1;
+  int     sequential_count_ = 0;   ///< 连续顺序访问了多少个页面
+  int     window_           = 0;
+  PageNum trigger_page_     = -1;  ///< 访问到这个页面时发起下一次预读
+  PageNum prefetched_end_   = -1;  ///< 已经预读到了哪个页面
+};
@@ -0,0 +1,210 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "storage/buffer/secondary_cache.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+BPSecondaryCache::~BPSecondaryCache()
+{
+  close();
+}
+
+RC BPSecondaryCache::init(const char *file_name, int64_t size)
+{
+  if (enabled()) {
+    LOG_WARN("secondary cache has been inited. file=%s", file_name_.c_str());
+    return RC::INTERNAL;
+  }
+
+  const int64_t slot_num = size / BP_PAGE_SIZE;
+  if (slot_num <= 0) {
+    LOG_INFO("secondary cache is disabled. size=%ld", size);
+    return RC::SUCCESS;
+  }
+
+  // 缓存文件中的页面在重启之后就没有意义了，每次都重新开始
+  int fd = ::open(file_name, O_RDWR | O_CREAT | O_TRUNC, S_IREAD | S_IWRITE);
+  if (fd < 0) {
+    LOG_ERROR("failed to open secondary cache file. file=%s, error=%s", file_name, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  if (ftruncate(fd, slot_num * BP_PAGE_SIZE) != 0) {
+    LOG_ERROR("failed to truncate secondary cache file. file=%s, size=%ld, error=%s",
+              file_name, slot_num * BP_PAGE_SIZE, strerror(errno));
+    ::close(fd);
+    return RC::IOERR_WRITE;
+  }
+
+  lock_guard guard(lock_);
+  file_name_ = file_name;
+  file_desc_ = fd;
+  slots_.assign(slot_num, FrameId(-1, BP_INVALID_PAGE_NUM));
+  lru_iters_.assign(slot_num, lru_list_.end());
+  free_slots_.reserve(slot_num);
+  for (int64_t slot = slot_num - 1; slot >= 0; slot--) {
+    free_slots_.push_back(static_cast<int>(slot));
+  }
+
+  LOG_INFO("secondary cache inited. file=%s, slot num=%ld", file_name, slot_num);
+  return RC::SUCCESS;
+}
+
+void BPSecondaryCache::close()
+{
+  lock_guard guard(lock_);
+  if (file_desc_ < 0) {
+    return;
+  }
+
+  LOG_INFO("secondary cache closed. file=%s, hit=%ld, miss=%ld, write=%ld, evict=%ld",
+           file_name_.c_str(), stats_.hit_count.load(), stats_.miss_count.load(),
+           stats_.write_count.load(), stats_.evict_count.load());
+  ::close(file_desc_);
+  file_desc_ = -1;
+  slot_map_.clear();
+  slots_.clear();
+  lru_list_.clear();
+  lru_iters_.clear();
+  free_slots_.clear();
+}
+
+void BPSecondaryCache::write_page(int file_desc, PageNum page_num, Page *page)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  lock_guard guard(lock_);
+  if (file_desc_ < 0) {
+    return;
+  }
+
+  FrameId frame_id(file_desc, page_num);
+  int     slot = -1;
+
+  auto iter = slot_map_.find(frame_id);
+  if (iter != slot_map_.end()) {
+    // 缓存文件中的页面与数据文件一致，干净的页面不需要重新写
+    slot = iter->second;
+    lru_list_.splice(lru_list_.begin(), lru_list_, lru_iters_[slot]);
+    return;
+  }
+
+  if (free_slots_.empty()) {
+    const int victim = lru_list_.back();
+    drop_slot_internal(victim);
+    stats_.evict_count++;
+  }
+
+  slot = free_slots_.back();
+  free_slots_.pop_back();
+
+  RC rc = page_io_.write_page(file_desc_, slot, page);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write page to secondary cache. frame=%s, slot=%d, rc=%s",
+             to_string(frame_id).c_str(), slot, strrc(rc));
+    free_slots_.push_back(slot);
+    return;
+  }
+
+  slots_[slot] = frame_id;
+  slot_map_.emplace(frame_id, slot);
+  lru_list_.push_front(slot);
+  lru_iters_[slot] = lru_list_.begin();
+  stats_.write_count++;
+}
+
+bool BPSecondaryCache::read_page(int file_desc, PageNum page_num, Page *page)
+{
+  if (!enabled()) {
+    return false;
+  }
+
+  lock_guard guard(lock_);
+  if (file_desc_ < 0) {
+    return false;
+  }
+
+  auto iter = slot_map_.find(FrameId(file_desc, page_num));
+  if (iter == slot_map_.end()) {
+    stats_.miss_count++;
+    return false;
+  }
+
+  const int slot = iter->second;
+  RC rc = page_io_.read_page(file_desc_, slot, page);
+  if (OB_FAIL(rc) || page->page_num != page_num) {
+    LOG_WARN("failed to read page from secondary cache. file desc=%d, page num=%d, slot=%d, rc=%s",
+             file_desc, page_num, slot, strrc(rc));
+    drop_slot_internal(slot);
+    stats_.miss_count++;
+    return false;
+  }
+
+  lru_list_.splice(lru_list_.begin(), lru_list_, lru_iters_[slot]);
+  stats_.hit_count++;
+  return true;
+}
+
+void BPSecondaryCache::invalidate(int file_desc, PageNum page_num)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  lock_guard guard(lock_);
+  auto iter = slot_map_.find(FrameId(file_desc, page_num));
+  if (iter != slot_map_.end()) {
+    drop_slot_internal(iter->second);
+  }
+}
+
+void BPSecondaryCache::invalidate_file(int file_desc)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  lock_guard guard(lock_);
+  for (int slot = 0; slot < static_cast<int>(slots_.size()); slot++) {
+    if (slots_[slot].file_desc() == file_desc) {
+      drop_slot_internal(slot);
+    }
+  }
+}
+
+int BPSecondaryCache::size()
+{
+  lock_guard guard(lock_);
+  return static_cast<int>(slot_map_.size());
+}
+
+void BPSecondaryCache::drop_slot_internal(int slot)
+{
+  slot_map_.erase(slots_[slot]);
+  slots_[slot] = FrameId(-1, BP_INVALID_PAGE_NUM);
+  lru_list_.erase(lru_iters_[slot]);
+  lru_iters_[slot] = lru_list_.end();
+  free_slots_.push_back(slot);
+}
@@ -0,0 +1,125 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/rc.h"
+#include "storage/buffer/frame.h"
+#include "storage/buffer/page_io.h"
+
+/**
+ * @brief 二级缓存的统计信息
+ * @ingroup BufferPool
+ */
+struct BPSecondaryCacheStats
+{
+  std::atomic<int64_t> hit_count{0};    ///< 从缓存文件中读到了页面
+  std::atomic<int64_t> miss_count{0};   ///< 缓存文件中没有，需要读数据文件
+  std::atomic<int64_t> write_count{0};  ///< 写入缓存文件的页面个数
+  std::atomic<int64_t> evict_count{0};  ///< 缓存文件满了之后淘汰的页面个数
+};
+
+/**
+ * @brief buffer pool 的二级缓存，页面放在本地SSD上的一个缓存文件中
+ * @ingroup BufferPool
+ * @details 数据文件放在比较慢的网络盘上时，内存放不下的页面每次都要重新读网络盘。
+ * 页帧管理器淘汰干净的页面时，把页面写到本地的缓存文件里，之后再读这个页面时先查缓存文件。
+ * 脏页直接写数据文件(write-around)，不写缓存文件，同时让缓存文件中的旧页面失效。
+ * 因此缓存文件中的页面总是与数据文件中的一致，缓存文件丢了也没关系，每次启动时都会清空。
+ *
+ * 缓存文件按照页面大小划分成槽位，内存中记录(文件描述符, 页号)到槽位的映射，
+ * 满了之后按照LRU淘汰。读写缓存文件时持有一把锁，不会同时写同一个槽位。
+ * 文件描述符在关闭之后可能被复用，所以关闭文件时要让这个文件的所有页面失效。
+ */
+class BPSecondaryCache
+{
+public:
+  BPSecondaryCache() = default;
+  ~BPSecondaryCache();
+
+  /**
+   * @brief 创建缓存文件
+   * @param file_name 缓存文件的名字，已经存在时会被清空
+   * @param size      缓存文件的大小，单位字节。小于一个页面时不启用二级缓存
+   */
+  RC   init(const char *file_name, int64_t size);
+  void close();
+
+  bool enabled() const { return file_desc_ >= 0; }
+
+  /**
+   * @brief 把一个被淘汰的干净页面写到缓存文件中
+   */
+  void write_page(int file_desc, PageNum page_num, Page *page);
+
+  /**
+   * @brief 从缓存文件中读取页面，缓存文件中没有时返回false
+   */
+  bool read_page(int file_desc, PageNum page_num, Page *page);
+
+  /**
+   * @brief 页面写到数据文件或者被释放之后，缓存文件中的页面就失效了
+   */
+  void invalidate(int file_desc, PageNum page_num);
+
+  /**
+   * @brief 关闭数据文件时，让这个文件的所有页面失效
+   */
+  void invalidate_file(int file_desc);
+
+  const char *file_name() const { return file_name_.c_str(); }
+
+  /**
+   * @brief 一共有多少个槽位
+   */
+  int capacity() const { return static_cast<int>(slots_.size()); }
+
+  /**
+   * @brief 有多少个槽位已经放了页面
+   */
+  int size();
+
+  BPSecondaryCacheStats &stats() { return stats_; }
+
+private:
+  void drop_slot_internal(int slot);
+
+private:
+  class FrameIdHasher
+  {
+  public:
+    size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
+  };
+
+  std::string file_name_;
+  int         file_desc_ = -1;
+  SyncPageIO  page_io_;  ///< 槽位编号就是缓存文件中的页号
+
+  std::mutex                                    lock_;
+  std::unordered_map<FrameId, int, FrameIdHasher> slot_map_;   ///< 页面 -> 槽位
+  std::vector<FrameId>                          slots_;      ///< 槽位 -> 页面
+  std::list<int>                                lru_list_;   ///< 放了页面的槽位，最近使用的在前面
+  std::vector<std::list<int>::iterator>         lru_iters_;  ///< 槽位在 lru_list_ 中的位置
+  std::vector<int>                              free_slots_;
+
+  BPSecondaryCacheStats stats_;
+};
@@ -0,0 +1,192 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <limits>
+
+#include "storage/buffer/space_map.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "common/lang/bitmap.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+const int BPSpaceMap::HEADER_GROUP_PAGE_NUM = BPFileHeader::MAX_PAGE_NUM;
+
+int BPSpaceMap::group_of(PageNum page_num)
+{
+  if (page_num < HEADER_GROUP_PAGE_NUM) {
+    return 0;
+  }
+  return 1 + (page_num - HEADER_GROUP_PAGE_NUM) / GROUP_PAGE_NUM;
+}
+
+PageNum BPSpaceMap::group_start(int group)
+{
+  if (group == 0) {
+    return 0;
+  }
+  return HEADER_GROUP_PAGE_NUM + static_cast<PageNum>(group - 1) * GROUP_PAGE_NUM;
+}
+
+void BPSpaceMap::init(BPFileHeader *header)
+{
+  header_ = header;
+  groups_.clear();
+  first_free_group_ = 0;
+  add_group(header->bitmap, false /*created*/);
+}
+
+int BPSpaceMap::group_size(int group) const
+{
+  const int capacity = (group == 0) ? HEADER_GROUP_PAGE_NUM : GROUP_PAGE_NUM;
+  const int64_t size = static_cast<int64_t>(header_->page_count) - group_start(group);
+  return static_cast<int>(max<int64_t>(0, min<int64_t>(capacity, size)));
+}
+
+void BPSpaceMap::add_group(char *bitmap, bool created)
+{
+  const int group = group_num();
+  groups_.emplace_back();
+  Group &new_group = groups_.back();
+  new_group.bitmap = bitmap;
+
+  const int size = group_size(group);
+  if (created) {
+    new_group.free_count = size;
+    return;
+  }
+
+  new_group.free_count = size - Bitmap(bitmap, size).count_setted_bits();
+}
+
+bool BPSpaceMap::allocated(PageNum page_num) const
+{
+  if (page_num < 0 || page_num >= header_->page_count) {
+    return false;
+  }
+
+  const int group = group_of(page_num);
+  if (group >= group_num()) {
+    return false;
+  }
+  return Bitmap(groups_[group].bitmap, GROUP_PAGE_NUM).get_bit(page_num - group_start(group));
+}
+
+PageNum BPSpaceMap::allocate_free()
+{
+  while (first_free_group_ < group_num() && groups_[first_free_group_].free_count == 0) {
+    first_free_group_++;
+  }
+  if (first_free_group_ >= group_num()) {
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  Group &group = groups_[first_free_group_];
+  Bitmap group_bitmap(group.bitmap, group_size(first_free_group_));
+  const int index = group_bitmap.next_unsetted_bit(group.search_hint);
+  ASSERT(index >= 0, "space map group %d has %d free pages but no unset bit found", first_free_group_, group.free_count);
+
+  const PageNum page_num = group_start(first_free_group_) + index;
+  group.search_hint = index + 1;
+  set_allocated(page_num);
+  return page_num;
+}
+
+bool BPSpaceMap::need_new_group() const
+{
+  return group_of(header_->page_count) >= group_num();
+}
+
+PageNum BPSpaceMap::allocate_new()
+{
+  if (header_->page_count == numeric_limits<PageNum>::max()) {
+    LOG_WARN("file is full. page count=%d", header_->page_count);
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  const PageNum page_num = header_->page_count;
+  mark_allocated(page_num);
+  return page_num;
+}
+
+bool BPSpaceMap::mark_allocated(PageNum page_num)
+{
+  const int group = group_of(page_num);
+  ASSERT(group < group_num(), "space map page of group %d should be created first", group);
+
+  if (page_num >= header_->page_count) {
+    // 文件变大了，新增的页面先作为空闲页面加到各自的组中
+    const PageNum old_count = header_->page_count;
+    header_->page_count     = page_num + 1;
+    for (int i = group_of(old_count); i <= group; i++) {
+      const PageNum begin = max(old_count, group_start(i));
+      const PageNum end   = group_start(i) + group_size(i);
+      if (end > begin) {
+        groups_[i].free_count += end - begin;
+        first_free_group_ = min(first_free_group_, i);
+      }
+    }
+  }
+
+  if (allocated(page_num)) {
+    return false;
+  }
+  set_allocated(page_num);
+  return true;
+}
+
+void BPSpaceMap::set_allocated(PageNum page_num)
+{
+  const int group = group_of(page_num);
+  Bitmap(groups_[group].bitmap, GROUP_PAGE_NUM).set_bit(page_num - group_start(group));
+  groups_[group].free_count--;
+  header_->allocated_pages++;
+}
+
+bool BPSpaceMap::mark_free(PageNum page_num)
+{
+  if (page_num <= 0 || is_map_page(page_num) || !allocated(page_num)) {
+    return false;
+  }
+
+  const int group = group_of(page_num);
+  const int index = page_num - group_start(group);
+  Group &target = groups_[group];
+  Bitmap(target.bitmap, GROUP_PAGE_NUM).clear_bit(index);
+  target.free_count++;
+  target.search_hint = min(target.search_hint, index);
+  first_free_group_  = min(first_free_group_, group);
+  header_->allocated_pages--;
+  return true;
+}
+
+PageNum BPSpaceMap::next_allocated(PageNum start) const
+{
+  for (int group = group_of(max(start, 0)); group < group_num(); group++) {
+    const PageNum first = group_start(group);
+    Bitmap group_bitmap(groups_[group].bitmap, group_size(group));
+
+    int index = (start > first) ? start - first : 0;
+    if (index == 0) {
+      index = 1;  // 跳过文件头或者位图页面
+    }
+
+    index = group_bitmap.next_setted_bit(index);
+    if (index >= 0) {
+      return first + index;
+    }
+  }
+  return BP_INVALID_PAGE_NUM;
+}
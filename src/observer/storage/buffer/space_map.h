@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "common/types.h"
+#include "storage/buffer/page.h"
+
+struct BPFileHeader;
+
+/**
+ * @brief 文件的页面分配表
+ * @ingroup BufferPool
+ * @details 文件按照页面编号分成多个组，每组的页面分配情况使用一个位图记录：
+ * - 第0组的位图就在文件头页面(BPFileHeader)中，与以前只有一个位图的文件格式兼容；
+ * - 后面每一组的第一个页面是这一组的位图页面(space map page)，位图的第0位就是它自己。
+ * 位图页面在文件增长到这一组时创建，它的位置可以直接计算出来，所以不需要额外的目录页面。
+ * 每组大约6万个页面(512M)，文件的大小只受 PageNum 的范围限制。
+ *
+ * 内存中记录每组还有多少个空闲的页面，以及每组中从哪里开始查找空闲页面，分配页面时不需要
+ * 从头扫描所有的位图。这个类只维护位图的内容，位图所在的页帧由 DiskBufferPool 管理。
+ */
+class BPSpaceMap
+{
+public:
+  /// 文件头中的位图可以管理的页面个数
+  static const int HEADER_GROUP_PAGE_NUM;
+  /// 位图页面可以管理的页面个数
+  static constexpr int GROUP_PAGE_NUM = BP_PAGE_DATA_SIZE * 8;
+
+  /**
+   * @brief 页面属于哪一组
+   */
+  static int group_of(PageNum page_num);
+
+  /**
+   * @brief 这一组的第一个页面。第0组是文件头页面，其它组是它们的位图页面
+   */
+  static PageNum group_start(int group);
+
+  /**
+   * @brief 是否是第0组之外的位图页面
+   */
+  static bool is_map_page(PageNum page_num) { return page_num > 0 && group_start(group_of(page_num)) == page_num; }
+
+public:
+  /**
+   * @brief 使用文件头初始化，文件头中的位图就是第0组
+   */
+  void init(BPFileHeader *header);
+
+  /**
+   * @brief 加入下一组的位图，位图页面是从磁盘读取或者新创建的
+   * @param bitmap  位图页面的数据
+   * @param created 是否是新创建的位图页面。新创建的位图页面由调用方使用 mark_allocated 把它自己标记为已分配
+   */
+  void add_group(char *bitmap, bool created);
+
+  int group_num() const { return static_cast<int>(groups_.size()); }
+
+  bool allocated(PageNum page_num) const;
+
+  /**
+   * @brief 从文件已有的空闲页面中分配一个
+   * @return 没有空闲页面时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum allocate_free();
+
+  /**
+   * @brief 在文件末尾增加一个页面并分配出去
+   * @details 如果 need_new_group 返回true，调用方需要先创建下一组的位图页面
+   * @return 文件已经达到最大的页面个数时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum allocate_new();
+
+  /**
+   * @brief 下一个新页面是否需要先创建一个新的位图页面
+   */
+  bool need_new_group() const;
+
+  /**
+   * @brief 把指定的页面标记为已分配
+   * @details 页面可以超出文件现在的大小，中间的页面都作为空闲页面。创建位图页面和日志回放时使用
+   * @return 页面之前是否是空闲的
+   */
+  bool mark_allocated(PageNum page_num);
+
+  /**
+   * @brief 释放页面
+   * @return 页面之前是否已经分配
+   */
+  bool mark_free(PageNum page_num);
+
+  /**
+   * @brief 查找大于等于 start 的第一个已分配的页面，跳过文件头和位图页面
+   * @return 找不到时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum next_allocated(PageNum start) const;
+
+private:
+  struct Group
+  {
+    char *bitmap      = nullptr;
+    int   free_count  = 0;  ///< 文件中已经存在但是没有分配的页面个数
+    int   search_hint = 0;  ///< 这个位置之前没有空闲页面
+  };
+
+  /// 这一组在文件中已经存在的页面个数
+  int  group_size(int group) const;
+  void set_allocated(PageNum page_num);
+
+private:
+  BPFileHeader      *header_ = nullptr;
+  std::vector<Group> groups_;
+  int                first_free_group_ = 0;  ///< 这一组之前没有空闲页面
+};
@@ -0,0 +1,267 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/buffer/warm_up.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+/// 每次提交读取多少个页面
+static constexpr int WARM_UP_BATCH_PAGES = 64;
+
+BPWarmUp::BPWarmUp(BufferPoolManager &bp_manager) : bp_manager_(bp_manager)
+{}
+
+BPWarmUp::~BPWarmUp()
+{
+  stop();
+}
+
+RC BPWarmUp::start(const char *file_name, int dump_interval)
+{
+  {
+    lock_guard guard(lock_);
+    if (started_) {
+      LOG_WARN("buffer pool warm up has been started");
+      return RC::INTERNAL;
+    }
+    file_name_ = file_name;
+    started_   = true;
+    stopping_  = false;
+  }
+
+#ifdef CONCURRENCY
+  thread_ = thread(&BPWarmUp::run, this, dump_interval);
+  LOG_INFO("buffer pool warm up started. file=%s, dump interval=%ds", file_name, dump_interval);
+#else
+  if (dump_interval > 0) {
+    LOG_WARN("periodic dump of buffer pool warm up is disabled because the observer is not compiled with CONCURRENCY");
+  }
+  load(file_name);
+#endif
+  return RC::SUCCESS;
+}
+
+void BPWarmUp::stop()
+{
+  {
+    lock_guard guard(lock_);
+    if (!started_) {
+      return;
+    }
+    started_  = false;
+    stopping_ = true;
+  }
+  cond_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  dump(file_name_.c_str());
+}
+
+bool BPWarmUp::stopping()
+{
+  lock_guard guard(lock_);
+  return stopping_;
+}
+
+void BPWarmUp::run(int dump_interval)
+{
+  load(file_name_.c_str());
+
+  if (dump_interval <= 0) {
+    return;
+  }
+
+  while (true) {
+    {
+      unique_lock guard(lock_);
+      cond_.wait_for(guard, chrono::seconds(dump_interval), [this]() { return stopping_; });
+      if (stopping_) {
+        break;
+      }
+    }
+
+    dump(file_name_.c_str());
+  }
+}
+
+RC BPWarmUp::dump(const char *file_name)
+{
+  vector<FrameId>            frame_ids;
+  unordered_map<int, string> file_names = bp_manager_.opened_files();
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    vector<FrameId> pool_frame_ids = frame_manager->hot_frames();
+    frame_ids.insert(frame_ids.end(), pool_frame_ids.begin(), pool_frame_ids.end());
+  }
+
+  // 先写临时文件再重命名，防止文件内容不完整
+  string  tmp_file = string(file_name) + ".tmp";
+  fstream fs;
+  fs.open(tmp_file, ios_base::out | ios_base::trunc);
+  if (!fs.is_open()) {
+    LOG_WARN("failed to open buffer pool warm up file for write. file=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  unordered_map<int, int> file_ids;  // 文件描述符 -> 预热文件中的文件编号
+  int                     page_count = 0;
+  for (const FrameId &frame_id : frame_ids) {
+    auto name_iter = file_names.find(frame_id.file_desc());
+    if (name_iter == file_names.end()) {
+      continue;  // 文件已经关闭了
+    }
+
+    auto id_iter = file_ids.find(frame_id.file_desc());
+    if (id_iter == file_ids.end()) {
+      id_iter = file_ids.emplace(frame_id.file_desc(), static_cast<int>(file_ids.size())).first;
+      fs << "F " << id_iter->second << " " << name_iter->second << "\n";
+    }
+    fs << "P " << id_iter->second << " " << frame_id.page_num() << "\n";
+    page_count++;
+  }
+
+  fs.close();
+  if (fs.fail()) {
+    LOG_WARN("failed to write buffer pool warm up file. file=%s", tmp_file.c_str());
+    return RC::IOERR_WRITE;
+  }
+
+  if (rename(tmp_file.c_str(), file_name) != 0) {
+    LOG_WARN("failed to rename buffer pool warm up file from %s to %s. errmsg=%s",
+             tmp_file.c_str(), file_name, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  LOG_INFO("dump buffer pool warm up file done. file=%s, file num=%d, page num=%d",
+           file_name, static_cast<int>(file_ids.size()), page_count);
+  return RC::SUCCESS;
+}
+
+RC BPWarmUp::load(const char *file_name)
+{
+  ifstream fs(file_name);
+  if (!fs.is_open()) {
+    LOG_INFO("no buffer pool warm up file. file=%s", file_name);
+    return RC::FILE_NOT_EXIST;
+  }
+
+  // 预热文件中最近访问的页面在前面。页帧不够时，只加载前面的页面
+  size_t max_page_num = 0;
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    max_page_num += frame_manager->total_frame_num();
+  }
+
+  unordered_map<int, string>   file_names;
+  map<int, vector<PageNum>>    file_pages;  // 文件编号 -> 页号。先出现的文件编号小
+  size_t                       page_count = 0;
+  string                       line;
+  while (page_count < max_page_num && getline(fs, line)) {
+    istringstream is(line);
+    char          type = 0;
+    int           file_id = -1;
+    is >> type >> file_id;
+    if (type == 'F') {
+      string name;
+      is.get();  // 文件编号后面的空格
+      getline(is, name);
+      file_names[file_id] = name;
+    } else if (type == 'P') {
+      PageNum page_num = -1;
+      is >> page_num;
+      if (!is.fail()) {
+        file_pages[file_id].push_back(page_num);
+        page_count++;
+      }
+    }
+  }
+
+  total_page_count_  = static_cast<int64_t>(page_count);
+  done_page_count_   = 0;
+  loaded_page_count_ = 0;
+  loading_           = true;
+  LOG_INFO("buffer pool warm up begin. file=%s, page num=%d", file_name, static_cast<int>(page_count));
+
+  int64_t next_report = page_count / 10;  // 每完成10%打印一次进度
+  bool    full        = false;
+  for (auto &[file_id, page_nums] : file_pages) {
+    if (full || stopping()) {
+      break;
+    }
+
+    // 同一个文件的页面按照页号顺序读取
+    sort(page_nums.begin(), page_nums.end());
+    page_nums.erase(unique(page_nums.begin(), page_nums.end()), page_nums.end());
+
+    const string &name = file_names[file_id];
+    for (size_t begin = 0; begin < page_nums.size(); begin += WARM_UP_BATCH_PAGES) {
+      if (stopping()) {
+        break;
+      }
+
+      const int count  = static_cast<int>(min(page_nums.size() - begin, static_cast<size_t>(WARM_UP_BATCH_PAGES)));
+      const int loaded = bp_manager_.warm_up_pages(name.c_str(), page_nums.data() + begin, count);
+      if (loaded < 0) {
+        LOG_INFO("skip pages of file which is not opened. file=%s, page num=%d",
+                 name.c_str(), static_cast<int>(page_nums.size()));
+        done_page_count_ += static_cast<int64_t>(page_nums.size() - begin);
+        break;
+      }
+
+      loaded_page_count_ += loaded;
+      done_page_count_ += count;
+      if (done_page_count_ >= next_report) {
+        LOG_INFO("buffer pool warm up progress: %ld/%ld pages (%ld%%), loaded %ld pages",
+                 done_page_count_.load(), total_page_count_.load(),
+                 done_page_count_.load() * 100 / max(total_page_count_.load(), int64_t(1)), loaded_page_count_.load());
+        next_report = done_page_count_ + max(total_page_count_.load() / 10, int64_t(1));
+      }
+
+      if (all_pools_full()) {
+        LOG_INFO("no free frames for buffer pool warm up");
+        full = true;
+        break;
+      }
+    }
+  }
+
+  loading_ = false;
+  LOG_INFO("buffer pool warm up done. file=%s, total=%ld, loaded=%ld",
+           file_name, total_page_count_.load(), loaded_page_count_.load());
+  return RC::SUCCESS;
+}
+
+bool BPWarmUp::all_pools_full()
+{
+  for (BPFrameManager *frame_manager : bp_manager_.frame_managers()) {
+    if (frame_manager->frame_num() < frame_manager->total_frame_num()) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/rc.h"
+
+class BufferPoolManager;
+class BPFrameManager;
+
+/**
+ * @brief buffer pool 预热
+ * @ingroup BufferPool
+ * @details 重启之后 buffer pool 是空的，刚开始的一段时间所有的查询都要读磁盘。
+ * 正常关闭时(以及后台线程定期)把缓存中的页面列表写到一个文件中，最近访问的页面在前面。
+ * 因为文件描述符在重启之后会变化，文件中记录的是文件名和页号。
+ * 启动时读取这个文件，在后台把这些页面读到空闲的页帧中，同时服务已经可以接受请求了。
+ * 读取时同一个文件的页面按照页号排序，批量提交读取。预热只使用空闲的页帧，不会淘汰任何页面。
+ * 页面列表包含所有页帧管理器中的页面，读取时每个页面放回它的文件所在的页帧管理器中。
+ *
+ * 文件格式是文本，每一行是：
+ * - F <文件编号> <文件名>
+ * - P <文件编号> <页号>
+ */
+class BPWarmUp
+{
+public:
+  explicit BPWarmUp(BufferPoolManager &bp_manager);
+  ~BPWarmUp();
+
+  /**
+   * @brief 加载预热文件中的页面，并启动定期保存页面列表的后台线程
+   * @details 后台线程会与前台线程并发访问页面，只有在 CONCURRENCY 编译模式下才会启动后台线程。
+   * 否则在当前线程中加载完页面再返回，也不会定期保存页面列表
+   *
+   * @param file_name     预热文件的名字
+   * @param dump_interval 每隔多少秒保存一次页面列表，小于等于0表示只在关闭时保存
+   */
+  RC   start(const char *file_name, int dump_interval);
+  /**
+   * @brief 停止后台线程，并保存一次页面列表
+   */
+  void stop();
+
+  /**
+   * @brief 把缓存中的页面列表写到文件中
+   * @details 先写一个临时文件再重命名，中途崩溃也不会留下一个不完整的文件
+   */
+  RC dump(const char *file_name);
+
+  /**
+   * @brief 在当前线程中把文件中记录的页面读到 buffer pool 中
+   * @details 只会加载已经打开的文件的页面，没有空闲页帧时就停止
+   */
+  RC load(const char *file_name);
+
+  /**
+   * @brief 预热进度：一共要加载多少个页面，已经处理了多少个页面，以及实际读入了多少个页面
+   */
+  int64_t total_page_count() const { return total_page_count_.load(); }
+  int64_t done_page_count() const { return done_page_count_.load(); }
+  int64_t loaded_page_count() const { return loaded_page_count_.load(); }
+  bool    loading() const { return loading_.load(); }
+
+private:
+  void run(int dump_interval);
+  bool stopping();
+
+  /**
+   * @brief 是否所有的页帧管理器都没有空闲的页帧了
+   */
+  bool all_pools_full();
+
+private:
+  BufferPoolManager &bp_manager_;
+
+  std::string             file_name_;
+  std::thread             thread_;
+  std::mutex              lock_;
+  std::condition_variable cond_;
+  bool                    started_ = false;
+  bool                    stopping_ = false;
+
+  std::atomic<bool>    loading_{false};
+  std::atomic<int64_t> total_page_count_{0};
+  std::atomic<int64_t> done_page_count_{0};
+  std::atomic<int64_t> loaded_page_count_{0};
+};
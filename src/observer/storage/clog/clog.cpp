@@ -12,6 +12,11 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <sstream>
 #include <vector>
 
@@ -29,6 +34,32 @@ using namespace common;
  */
 const char *CLOG_FILE_NAME = "clog";
 
+/**
+ * @brief 保存检查点的控制文件
+ */
+const char *CLOG_CONTROL_FILE_NAME = "clog.ctl";
+
+/// 控制文件的魔数
+static const int32_t CLOG_CONTROL_MAGIC = 0x434b5054;
+
+/**
+ * @brief 控制文件中的数据
+ */
+struct CLogControlData
+{
+  int32_t magic_      = CLOG_CONTROL_MAGIC;
+  int32_t lsn_        = 0;
+  int32_t max_trx_id_ = 0;
+  int32_t reserved_   = 0;
+  int64_t offset_     = 0;
+};
+
+/// 写日志时每隔多少字节记录一次日志的LSN与位置，参考 CLogBuffer::lsn_offset
+static const int64_t CLOG_LSN_INDEX_INTERVAL = 64 * 1024;
+
+/// 回收日志文件空间时按照这个大小对齐
+static const int64_t CLOG_RECLAIM_ALIGN = 4096;
+
 const char *clog_type_name(CLogType type)
 {
   #define DEFINE_CLOG_TYPE(name)  case CLogType::name: return #name;
@@ -204,7 +235,7 @@ CLogBuffer::CLogBuffer()
 CLogBuffer::~CLogBuffer()
 {}
 
-RC CLogBuffer::append_log_record(CLogRecord *log_record)
+RC CLogBuffer::append_log_record(CLogRecord *log_record, LSN *lsn)
 {
   if (nullptr == log_record) {
     return RC::INVALID_ARGUMENT;
@@ -216,6 +247,10 @@ RC CLogBuffer::append_log_record(CLogRecord *log_record)
   }
 
   lock_guard<Mutex> lock_guard(lock_);
+  log_record->header().lsn_ = next_lsn_++;
+  if (lsn != nullptr) {
+    *lsn = log_record->header().lsn_;
+  }
   log_records_.emplace_back(log_record);
   total_size_ += log_record->logrec_len();
   LOG_DEBUG("append log. log_record={%s}", log_record->to_string().c_str());
@@ -229,8 +264,9 @@ RC CLogBuffer::flush_buffer(CLogFile &log_file)
   while (!log_records_.empty()) {
     lock_.lock();
     if (log_records_.empty()) {
+      // 其它线程刚刚取走了剩下的日志，下面的sync也会把它们同步到磁盘
       lock_.unlock();
-      return RC::SUCCESS;
+      break;
     }
 
     // log buffer 需要支持并发，所以要考虑加锁
@@ -238,18 +274,80 @@ RC CLogBuffer::flush_buffer(CLogFile &log_file)
     unique_ptr<CLogRecord> log_record = std::move(log_records_.front());
     log_records_.pop_front();
 
+    const int64_t offset = log_file.write_offset();
     rc = write_log_record(log_file, log_record.get());
     // 当前无法处理日志写不完整的情况，所以直接粗暴退出
     ASSERT(rc == RC::SUCCESS, "failed to write log record. log_record=%s, rc=%s",
            log_record->to_string().c_str(), strrc(rc));
 
+    const LSN lsn = log_record->header().lsn_;
+    if (lsn_offsets_.empty() || offset - lsn_offsets_.back().second >= CLOG_LSN_INDEX_INTERVAL) {
+      lsn_offsets_.emplace_back(lsn, offset);
+    }
+    written_lsn_ = lsn + 1;
+
     lock_.unlock();
     total_size_ -= log_record->logrec_len();
     count++;
   }
 
   LOG_WARN("flush log buffer done. write log record number=%d", count);
-  return log_file.sync();
+
+  // 同步之前写入文件的日志在同步之后都落盘了，包括其它线程写入的
+  lock_.lock();
+  const LSN written_lsn = written_lsn_;
+  lock_.unlock();
+
+  rc = log_file.sync();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  LSN flushed_lsn = flushed_lsn_.load();
+  while (flushed_lsn < written_lsn && !flushed_lsn_.compare_exchange_weak(flushed_lsn, written_lsn)) {
+  }
+  return rc;
+}
+
+void CLogBuffer::mark_flushed(LSN lsn)
+{
+  LSN flushed_lsn = flushed_lsn_.load();
+  while (flushed_lsn < lsn && !flushed_lsn_.compare_exchange_weak(flushed_lsn, lsn)) {
+  }
+}
+
+void CLogBuffer::reset(LSN next_lsn, int64_t offset)
+{
+  lock_guard<Mutex> lock_guard(lock_);
+  next_lsn_    = next_lsn;
+  written_lsn_ = next_lsn;
+  flushed_lsn_ = next_lsn;
+  lsn_offsets_.clear();
+  // 这个位置之后的日志，LSN可能比 next_lsn 小，所以用0表示任何LSN都可以从这里开始读取
+  lsn_offsets_.emplace_back(0, offset);
+}
+
+int64_t CLogBuffer::lsn_offset(LSN lsn, const CLogFile &log_file)
+{
+  lock_guard<Mutex> lock_guard(lock_);
+  if (lsn >= written_lsn_ || lsn_offsets_.empty()) {
+    return log_file.write_offset();
+  }
+
+  auto iter = upper_bound(lsn_offsets_.begin(), lsn_offsets_.end(), lsn,
+      [](LSN lsn, const pair<LSN, int64_t> &item) { return lsn < item.first; });
+  if (iter != lsn_offsets_.begin()) {
+    --iter;
+  }
+  return iter->second;
+}
+
+void CLogBuffer::trim_lsn_offsets(LSN lsn)
+{
+  lock_guard<Mutex> lock_guard(lock_);
+  while (lsn_offsets_.size() > 1 && lsn_offsets_[1].first <= lsn) {
+    lsn_offsets_.pop_front();
+  }
 }
 
 RC CLogBuffer::write_log_record(CLogFile &log_file, CLogRecord *log_record)
@@ -305,9 +403,17 @@ RC CLogFile::init(const char *path)
     return rc;
   }
 
-  filename_ = clog_file_path;
-  fd_       = fd;
-  LOG_INFO("open clog file success. file=%s, fd=%d", filename_.c_str(), fd_);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG_WARN("failed to stat clog file. filename=%s, error=%s", clog_file_path.c_str(), strerror(errno));
+    ::close(fd);
+    return RC::IOERR_ACCESS;
+  }
+
+  filename_     = clog_file_path;
+  fd_           = fd;
+  write_offset_ = static_cast<int64_t>(st.st_size);
+  LOG_INFO("open clog file success. file=%s, fd=%d, size=%ld", filename_.c_str(), fd_, write_offset_);
   return rc;
 }
 
@@ -327,6 +433,7 @@ RC CLogFile::write(const char *data, int len)
     LOG_WARN("failed to write data to file. filename=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
     return RC::IOERR_WRITE;
   }
+  write_offset_ += len;
   return RC::SUCCESS;
 }
 
@@ -367,6 +474,38 @@ RC CLogFile::offset(int64_t &off) const
   return RC::SUCCESS;
 }
 
+RC CLogFile::seek(int64_t off)
+{
+  if (lseek(fd_, static_cast<off_t>(off), SEEK_SET) == -1) {
+    LOG_WARN("failed to seek. file=%s, offset=%ld, error=%s", filename_.c_str(), off, strerror(errno));
+    return RC::IOERR_SEEK;
+  }
+
+  eof_ = false;
+  return RC::SUCCESS;
+}
+
+RC CLogFile::reclaim(int64_t off)
+{
+  const int64_t aligned_offset = off / CLOG_RECLAIM_ALIGN * CLOG_RECLAIM_ALIGN;
+  if (aligned_offset <= reclaimed_offset_) {
+    return RC::SUCCESS;
+  }
+
+#ifdef FALLOC_FL_PUNCH_HOLE
+  int ret = fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      static_cast<off_t>(reclaimed_offset_), static_cast<off_t>(aligned_offset - reclaimed_offset_));
+  if (ret != 0) {
+    LOG_WARN("failed to reclaim clog file. file=%s, offset=%ld, error=%s", filename_.c_str(), off, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+#endif
+
+  LOG_INFO("reclaim clog file. file=%s, from %ld to %ld", filename_.c_str(), reclaimed_offset_, aligned_offset);
+  reclaimed_offset_ = aligned_offset;
+  return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 RC CLogRecordIterator::init(CLogFile &log_file)
 {
@@ -424,11 +563,34 @@ const CLogRecord &CLogRecordIterator::log_record()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+string CLogCheckpoint::to_string() const
+{
+  stringstream ss;
+  ss << "lsn:" << lsn_ << ", offset:" << offset_ << ", max_trx_id:" << max_trx_id_;
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 RC CLogManager::init(const char *path)
 {
+  path_       = path;
   log_buffer_ = new CLogBuffer();
   log_file_   = new CLogFile();
-  return log_file_->init(path);
+  RC rc = log_file_->init(path);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = read_checkpoint();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to read clog checkpoint. path=%s, rc=%s", path, strrc(rc));
+    return rc;
+  }
+
+  max_trx_id_ = checkpoint_.max_trx_id_;
+  log_buffer_->reset(std::max(checkpoint_.lsn_, 1), checkpoint_.offset_);
+  return rc;
 }
 
 CLogManager::~CLogManager()
@@ -450,19 +612,31 @@ RC CLogManager::append_log(CLogType type,
                 const RID &rid, 
                 int32_t data_len, 
                 int32_t data_offset, 
-                const char *data)
+                const char *data,
+                LSN *lsn)
 {
   CLogRecord *log_record = CLogRecord::build_data_record(type, trx_id, table_id, rid, data_len, data_offset, data);
   if (nullptr == log_record) {
     LOG_WARN("failed to create log record");
     return RC::NOMEM;
   }
-  return append_log(log_record);
+  return append_log(log_record, lsn);
 }
 
 RC CLogManager::begin_trx(int32_t trx_id)
 {
-  return append_log(CLogRecord::build_mtr_record(CLogType::MTR_BEGIN, trx_id));
+  // 事务开始日志的LSN不会比现在的 next_lsn 小，检查点不能超过这个位置
+  {
+    lock_guard<Mutex> lock_guard(trx_lock_);
+    active_trxes_.emplace(trx_id, log_buffer_->next_lsn());
+  }
+
+  RC rc = append_log(CLogRecord::build_mtr_record(CLogType::MTR_BEGIN, trx_id));
+  if (OB_FAIL(rc)) {
+    lock_guard<Mutex> lock_guard(trx_lock_);
+    active_trxes_.erase(trx_id);
+  }
+  return rc;
 }
 
 RC CLogManager::commit_trx(int32_t trx_id, int32_t commit_xid)
@@ -473,21 +647,32 @@ RC CLogManager::commit_trx(int32_t trx_id, int32_t commit_xid)
     return rc;
   }
 
+  {
+    lock_guard<Mutex> lock_guard(trx_lock_);
+    active_trxes_.erase(trx_id);
+  }
+
   rc = sync(); // 事务提交时需要把当前事务关联的日志，都写入到磁盘中，这样做是保证不丢数据
   return rc;
 }
 
 RC CLogManager::rollback_trx(int32_t trx_id)
 {
-  return append_log(CLogRecord::build_mtr_record(CLogType::MTR_ROLLBACK, trx_id));
+  RC rc = append_log(CLogRecord::build_mtr_record(CLogType::MTR_ROLLBACK, trx_id));
+
+  lock_guard<Mutex> lock_guard(trx_lock_);
+  active_trxes_.erase(trx_id);
+  return rc;
 }
 
-RC CLogManager::append_log(CLogRecord *log_record)
+RC CLogManager::append_log(CLogRecord *log_record, LSN *lsn)
 {
   if (nullptr == log_record) {
     return RC::INVALID_ARGUMENT;
   }
-  return log_buffer_->append_log_record(log_record);
+  // 追加之后日志可能马上就被刷到磁盘并释放掉了，所以先更新事务编号
+  update_max_trx_id(*log_record);
+  return log_buffer_->append_log_record(log_record, lsn);
 }
 
 RC CLogManager::sync()
@@ -495,10 +680,158 @@ RC CLogManager::sync()
   return log_buffer_->flush_buffer(*log_file_);
 }
 
+LSN CLogManager::next_lsn() const
+{
+  return log_buffer_->next_lsn();
+}
+
+LSN CLogManager::flushed_lsn() const
+{
+  return log_buffer_->flushed_lsn();
+}
+
+RC CLogManager::flush_log(LSN lsn)
+{
+  if (lsn < log_buffer_->flushed_lsn()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = sync();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync clog. lsn=%d, rc=%s", lsn, strrc(rc));
+    return rc;
+  }
+
+  if (lsn >= log_buffer_->flushed_lsn()) {
+    // 页面上的LSN总是来自已经追加的日志，不会走到这里
+    LOG_ERROR("log is not flushed after sync. lsn=%d, flushed lsn=%d", lsn, log_buffer_->flushed_lsn());
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+LSN CLogManager::checkpoint_lsn_limit()
+{
+  lock_guard<Mutex> lock_guard(trx_lock_);
+  LSN lsn = log_buffer_->next_lsn();
+  for (const auto &[trx_id, begin_lsn] : active_trxes_) {
+    lsn = std::min(lsn, begin_lsn);
+  }
+  return lsn;
+}
+
+RC CLogManager::checkpoint(LSN lsn)
+{
+  if (lsn <= checkpoint_.lsn_) {
+    LOG_DEBUG("checkpoint does not move forward. lsn=%d, last checkpoint={%s}", lsn, checkpoint_.to_string().c_str());
+    return RC::SUCCESS;
+  }
+
+  CLogCheckpoint checkpoint;
+  checkpoint.lsn_        = lsn;
+  checkpoint.offset_     = log_buffer_->lsn_offset(lsn, *log_file_);
+  checkpoint.max_trx_id_ = max_trx_id_.load();
+
+  RC rc = write_checkpoint(checkpoint);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write clog checkpoint. checkpoint={%s}, rc=%s", checkpoint.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  checkpoint_ = checkpoint;
+  log_buffer_->trim_lsn_offsets(lsn);
+  LOG_INFO("clog checkpoint done. checkpoint={%s}", checkpoint_.to_string().c_str());
+
+  // 回收失败不影响检查点，下次还会再尝试
+  rc = log_file_->reclaim(checkpoint_.offset_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to reclaim clog space. checkpoint={%s}, rc=%s", checkpoint_.to_string().c_str(), strrc(rc));
+  }
+  return RC::SUCCESS;
+}
+
+RC CLogManager::read_checkpoint()
+{
+  std::string file_name = path_ + common::FILE_PATH_SPLIT_STR + CLOG_CONTROL_FILE_NAME;
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      LOG_INFO("no clog checkpoint, will redo all logs. file=%s", file_name.c_str());
+      checkpoint_ = CLogCheckpoint();
+      return RC::SUCCESS;
+    }
+    LOG_WARN("failed to open clog control file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  CLogControlData data;
+  int ret = readn(fd, reinterpret_cast<char *>(&data), sizeof(data));
+  ::close(fd);
+  if (ret != 0 || data.magic_ != CLOG_CONTROL_MAGIC) {
+    LOG_ERROR("invalid clog control file. file=%s, magic=%x", file_name.c_str(), data.magic_);
+    return RC::IOERR_READ;
+  }
+
+  checkpoint_.lsn_        = data.lsn_;
+  checkpoint_.offset_     = data.offset_;
+  checkpoint_.max_trx_id_ = data.max_trx_id_;
+  LOG_INFO("read clog checkpoint. checkpoint={%s}", checkpoint_.to_string().c_str());
+  return RC::SUCCESS;
+}
+
+RC CLogManager::write_checkpoint(const CLogCheckpoint &checkpoint)
+{
+  std::string file_name = path_ + common::FILE_PATH_SPLIT_STR + CLOG_CONTROL_FILE_NAME;
+  std::string tmp_file  = file_name + ".tmp";
+
+  int fd = ::open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to open clog control file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  CLogControlData data;
+  data.lsn_        = checkpoint.lsn_;
+  data.max_trx_id_ = checkpoint.max_trx_id_;
+  data.offset_     = checkpoint.offset_;
+  int ret = writen(fd, reinterpret_cast<const char *>(&data), sizeof(data));
+  if (ret != 0 || fsync(fd) != 0) {
+    LOG_WARN("failed to write clog control file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    ::close(fd);
+    return RC::IOERR_WRITE;
+  }
+  ::close(fd);
+
+  if (::rename(tmp_file.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to rename clog control file. from=%s, to=%s, error=%s",
+             tmp_file.c_str(), file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  return RC::SUCCESS;
+}
+
+void CLogManager::update_max_trx_id(const CLogRecord &log_record)
+{
+  int32_t trx_id = log_record.trx_id();
+  if (log_record.log_type() == CLogType::MTR_COMMIT) {
+    trx_id = std::max(trx_id, log_record.commit_record().commit_xid_);
+  }
+
+  int32_t max_trx_id = max_trx_id_.load();
+  while (max_trx_id < trx_id && !max_trx_id_.compare_exchange_weak(max_trx_id, trx_id)) {
+  }
+}
+
 RC CLogManager::recover(Db *db)
 {
+  RC rc = log_file_->seek(checkpoint_.offset_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to seek to clog checkpoint. checkpoint={%s}, rc=%s", checkpoint_.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
   CLogRecordIterator log_record_iterator;
-  RC rc = log_record_iterator.init(*log_file_);
+  rc = log_record_iterator.init(*log_file_);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to init log record iterator. rc=%s", strrc(rc));
     return rc;
@@ -507,10 +840,24 @@ RC CLogManager::recover(Db *db)
   TrxKit *trx_manager = GCTX.trx_kit_;
   ASSERT(trx_manager != nullptr, "cannot do recover that trx_manager is null");
 
-  /// 遍历所有的日志，然后做redo
+  // 有检查点时，检查点之前开始的事务都已经结束了，修改也都写到了数据文件中，找不到事务的日志就跳过
+  const LSN checkpoint_lsn   = checkpoint_.lsn_;
+  const bool has_checkpoint  = checkpoint_lsn > 0;
+  LSN        max_lsn         = 0;
+  int        skipped_count   = 0;
+
+  /// 遍历检查点之后的日志，然后做redo
   // 在做redo时，需要记录处理的事务。在所有的日志都重做完成时，如果有事务没有结束，那这些事务就需要回滚
   for (rc = log_record_iterator.next(); OB_SUCC(rc) && log_record_iterator.valid(); rc = log_record_iterator.next()) {
     const CLogRecord &log_record = log_record_iterator.log_record();
+    max_lsn = std::max(max_lsn, log_record.header().lsn_);
+    log_buffer_->mark_flushed(log_record.header().lsn_ + 1);
+    update_max_trx_id(log_record);
+    if (has_checkpoint && log_record.header().lsn_ < checkpoint_lsn) {
+      skipped_count++;
+      continue;
+    }
+
     LOG_TRACE("begin to redo log={%s}", log_record.to_string().c_str());
     switch (log_record.log_type()) {
       case CLogType::MTR_BEGIN: {
@@ -524,6 +871,10 @@ RC CLogManager::recover(Db *db)
       case CLogType::MTR_COMMIT: 
       case CLogType::MTR_ROLLBACK: {
         Trx *trx = trx_manager->find_trx(log_record.trx_id());
+        if (nullptr == trx && has_checkpoint) {
+          skipped_count++;
+          break;
+        }
         if (nullptr == trx) {
           LOG_WARN("no such trx. trx id=%d, log_record={%s}", log_record.trx_id(), log_record.to_string().c_str());
           return RC::INTERNAL;
@@ -539,6 +890,10 @@ RC CLogManager::recover(Db *db)
 
       default: {
         Trx *trx = GCTX.trx_kit_->find_trx(log_record.trx_id());
+        if (nullptr == trx && has_checkpoint) {
+          skipped_count++;
+          break;
+        }
         ASSERT(trx != nullptr,
               "cannot find such trx. trx id=%d, log_record={%s}",
               log_record.trx_id(),
@@ -564,6 +919,12 @@ RC CLogManager::recover(Db *db)
 
   LOG_TRACE("recover redo log done");
 
+  // 之后的日志接着检查点之后的日志继续编号
+  log_buffer_->reset(std::max({checkpoint_lsn, max_lsn + 1, 1}), checkpoint_.offset_);
+  trx_manager->recover_trx_id(max_trx_id_.load());
+  LOG_INFO("recover from clog checkpoint={%s}, skipped log records=%d, next lsn=%d",
+           checkpoint_.to_string().c_str(), skipped_count, log_buffer_->next_lsn());
+
   vector<Trx *> uncommitted_trxes;
   trx_manager->all_trxes(uncommitted_trxes);
   LOG_INFO("find %d uncommitted trx", uncommitted_trxes.size());
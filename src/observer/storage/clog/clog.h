@@ -25,7 +25,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/record/record.h"
 #include "storage/persist/persist.h"
+#include "storage/buffer/log_handler.h"
 #include "common/lang/mutex.h"
+#include "common/types.h"
 
 class CLogManager;
 class CLogBuffer;
@@ -55,7 +57,8 @@ class Db;
   DEFINE_CLOG_TYPE(MTR_COMMIT)        \
   DEFINE_CLOG_TYPE(MTR_ROLLBACK)      \
   DEFINE_CLOG_TYPE(INSERT)            \
-  DEFINE_CLOG_TYPE(DELETE)
+  DEFINE_CLOG_TYPE(DELETE)            \
+  DEFINE_CLOG_TYPE(BATCH_INSERT)
 
 enum class CLogType 
 { 
@@ -87,7 +90,7 @@ CLogType clog_type_from_integer(int32_t value);
  */
 struct CLogRecordHeader 
 {
-  int32_t lsn_ = -1;     ///< log sequence number。当前没有使用
+  int32_t lsn_ = -1;     ///< log sequence number。追加到日志缓存时分配，从1开始单调递增
   int32_t trx_id_ = -1;  ///< 日志所属事务的编号
   int32_t type_ = clog_type_to_integer(CLogType::ERROR); ///< 日志类型
   int32_t logrec_len_ = 0;  ///< record的长度，不包含header长度
@@ -146,6 +149,26 @@ struct CLogRecordData
   const static int32_t HEADER_SIZE;  ///< 指RecordData的头长度，即不包含data_的长度
 };
 
+/**
+ * @brief BATCH_INSERT 日志的数据格式
+ * @ingroup CLog
+ * @details 一次插入到同一个页面上的多条记录只写一条日志。CLogRecordData::rid_ 中是第一条记录的位置，
+ * data_ 中先是这个结构，然后是 record_num_ 个槽位号(SlotNum)，最后是 record_num_ 条记录的数据。
+ */
+struct CLogBatchInsertHeader
+{
+  int32_t record_num_ = 0;  ///< 记录的条数
+  int32_t record_len_ = 0;  ///< 每条记录的长度
+
+  /**
+   * @brief 一批记录的日志数据有多长
+   */
+  static int32_t data_len(int32_t record_num, int32_t record_len)
+  {
+    return sizeof(CLogBatchInsertHeader) + record_num * (sizeof(SlotNum) + record_len);
+  }
+};
+
 /**
  * @brief 表示一条日志记录
  * @ingroup CLog
@@ -242,9 +265,10 @@ public:
 
   /**
    * @brief 增加一条日志
-   * @details 如果当前的日志达到一定量，就会刷新数据
+   * @details 如果当前的日志达到一定量，就会刷新数据。追加成功时会给日志分配LSN
+   * @param[out] lsn 如果不为空，返回分配给这条日志的LSN
    */
-  RC append_log_record(CLogRecord *log_record);
+  RC append_log_record(CLogRecord *log_record, LSN *lsn = nullptr);
 
   /**
    * @brief 将当前的日志都刷新到日志文件中
@@ -253,6 +277,43 @@ public:
    */
   RC flush_buffer(CLogFile &log_file);
 
+  /**
+   * @brief 下一条日志将要使用的LSN
+   */
+  LSN next_lsn() const { return next_lsn_.load(); }
+
+  /**
+   * @brief LSN小于这个值的日志都已经同步到了磁盘上
+   */
+  LSN flushed_lsn() const { return flushed_lsn_.load(); }
+
+  /**
+   * @brief 重新设置LSN与日志位置的信息，在启动和恢复之后调用
+   * @param next_lsn 下一条日志使用的LSN
+   * @param offset   日志文件中从这个位置开始的日志都还可能被读取，参考 lsn_offset
+   */
+  void reset(LSN next_lsn, int64_t offset);
+
+  /**
+   * @brief LSN小于 lsn 的日志都已经在磁盘上了
+   * @details 恢复时从日志文件中读出来的日志都已经落盘。重做会把日志的LSN写到页面上，
+   * 这些页面在恢复过程中被淘汰时，写回磁盘之前不需要再同步日志
+   */
+  void mark_flushed(LSN lsn);
+
+  /**
+   * @brief 找到日志文件中的一个位置，从这里开始读取不会漏掉LSN不小于 lsn 的日志
+   * @details 写日志时每隔 CLOG_LSN_INDEX_INTERVAL 字节记录一次日志的LSN与位置，
+   * 这里返回LSN不超过 lsn 的最后一个位置，所以可能会多读一些更早的日志。
+   * lsn 还没有写入日志文件时，返回日志文件的结尾
+   */
+  int64_t lsn_offset(LSN lsn, const CLogFile &log_file);
+
+  /**
+   * @brief 丢弃 lsn 之前不会再用到的位置信息，做完检查点之后调用
+   */
+  void trim_lsn_offsets(LSN lsn);
+
 private:
   /**
    * @brief 将日志记录写入到日志文件中
@@ -266,6 +327,11 @@ private:
   common::Mutex lock_;  ///< 加锁支持多线程并发写入
   std::deque<std::unique_ptr<CLogRecord>> log_records_;  ///< 当前等待刷数据的日志记录
   std::atomic_int32_t total_size_;  ///< 当前缓存中的日志记录的总大小
+
+  std::atomic<LSN> next_lsn_{1};     ///< 下一条日志使用的LSN
+  LSN              written_lsn_ = 1; ///< 还没有写入日志文件的第一条日志的LSN
+  std::atomic<LSN> flushed_lsn_{1};  ///< 还没有同步到磁盘的第一条日志的LSN
+  std::deque<std::pair<LSN, int64_t>> lsn_offsets_;  ///< 一些日志的LSN以及它们在日志文件中的位置，LSN递增
 };
 
 /**
@@ -314,6 +380,23 @@ public:
    */
   RC offset(int64_t &off) const;
 
+  /**
+   * @brief 设置读取的文件位置。写入总是追加到文件尾，不受影响
+   */
+  RC seek(int64_t off);
+
+  /**
+   * @brief 下一次写入的位置，也就是文件的大小
+   */
+  int64_t write_offset() const { return write_offset_; }
+
+  /**
+   * @brief 回收 off 之前的文件空间
+   * @details 使用 fallocate 在文件中打洞，释放磁盘空间但是不改变文件大小，日志的位置也就不会变化。
+   * 只回收按照4K对齐的部分。不支持打洞的系统或者文件系统上什么都不做
+   */
+  RC reclaim(int64_t off);
+
   /**
    * @brief 当前是否已经读取到文件尾
    */
@@ -323,6 +406,22 @@ protected:
   std::string filename_;  ///< 日志文件名。总是init函数参数path路径下的clog文件
   int fd_ = -1;           ///< 操作的文件描述符
   bool eof_ = false;      ///< 是否已经读取到文件尾
+  int64_t write_offset_ = 0;      ///< 下一次写入的位置
+  int64_t reclaimed_offset_ = 0;  ///< 这个位置之前的空间已经回收了
+};
+
+/**
+ * @brief 检查点
+ * @ingroup CLog
+ * @details 保存在日志目录下的控制文件(clog.ctl)中。重启时从检查点开始重做日志，之前的日志可以回收。
+ */
+struct CLogCheckpoint
+{
+  LSN     lsn_        = 0;  ///< 从这个LSN开始重做日志。之前结束的事务所做的修改都已经写到了数据文件中
+  int64_t offset_     = 0;  ///< 日志文件中的位置，从这里开始读取不会漏掉LSN不小于 lsn_ 的日志
+  int32_t max_trx_id_ = 0;  ///< 做检查点时日志中出现过的最大事务编号，重启之后事务编号不能比它小
+
+  std::string to_string() const;
 };
 
 /**
@@ -353,21 +452,22 @@ private:
  * @details 一个日志管理器属于某一个DB（当前仅有一个DB sys）。
  * 管理器负责写日志（运行时）、读日志与恢复（启动时）
  */
-class CLogManager 
+class CLogManager : public BPLogHandler
 {
 public:
   CLogManager() = default;
-  ~CLogManager();
+  virtual ~CLogManager();
 
   /**
    * @brief 初始化日志管理器
-   * 
+   * @details 如果日志目录下有控制文件，会读取上次的检查点
    * @param path 日志都放在这个目录下。当前就是数据库的目录
    */
   RC init(const char *path);
 
   /**
    * @brief 新增一条数据更新的日志
+   * @param[out] lsn 如果不为空，返回这条日志的LSN，修改的页面需要记录下来，参考 Frame::lsn
    */
   RC append_log(CLogType type,
                 int32_t trx_id,
@@ -375,7 +475,8 @@ public:
                 const RID &rid,
                 int32_t data_len,
                 int32_t data_offset,
-                const char *data);
+                const char *data,
+                LSN *lsn = nullptr);
 
   /**
    * @brief 开启一个事务
@@ -402,7 +503,7 @@ public:
   /**
    * @brief 也可以调用这个函数直接增加一条日志
    */
-  RC append_log(CLogRecord *log_record);
+  RC append_log(CLogRecord *log_record, LSN *lsn = nullptr);
 
   /**
    * @brief 刷新日志到磁盘
@@ -411,12 +512,57 @@ public:
 
   /**
    * @brief 重做
-   * @details 当前会重做所有日志。也就是说，所有buffer pool页面都不会写入到磁盘中，
-   * 否则可能无法恢复成功。
+   * @details 从上次的检查点开始重做日志。检查点之前开始的事务在检查点之前就已经结束了，
+   * 它们的修改都已经写到数据文件中，所以遇到这些事务的日志时直接跳过。
+   * 没有检查点时会重做所有日志，这时所有buffer pool页面都不能写入到磁盘中，否则可能无法恢复成功。
    */
   RC recover(Db *db);
 
+  LSN next_lsn() const override;
+
+  /**
+   * @brief LSN小于这个值的日志都已经同步到了磁盘上
+   */
+  LSN flushed_lsn() const;
+
+  /**
+   * @brief 保证LSN不超过 lsn 的日志都已经落盘，buffer pool 写回脏页之前调用
+   * @details 日志已经落盘时直接返回，否则把当前缓存的日志都刷到磁盘
+   */
+  RC flush_log(LSN lsn) override;
+
+  /**
+   * @brief 可以用来做检查点的LSN
+   * @details 还没有结束的事务中最早的开始位置，没有事务时就是下一条日志的LSN。
+   * 重做日志时需要从事务开始的地方重做，所以检查点不能超过这个位置
+   */
+  LSN checkpoint_lsn_limit();
+
+  /**
+   * @brief 写一个检查点，并回收检查点之前的日志文件空间
+   * @details 调用者需要保证在此之前结束的事务所做的修改都已经写到了数据文件中并且同步到了磁盘上，
+   * 参考 Db::checkpoint。检查点先写到一个临时文件再重命名，中途崩溃不会留下不完整的控制文件
+   * @param lsn 检查点的LSN，不能超过 checkpoint_lsn_limit 返回的值
+   */
+  RC checkpoint(LSN lsn);
+
+  /**
+   * @brief 上次写入或者启动时读取的检查点
+   */
+  const CLogCheckpoint &last_checkpoint() const { return checkpoint_; }
+
+private:
+  RC read_checkpoint();
+  RC write_checkpoint(const CLogCheckpoint &checkpoint);
+  void update_max_trx_id(const CLogRecord &log_record);
+
 private:
   CLogBuffer *log_buffer_ = nullptr;   ///< 日志缓存。新增日志时先放到内存，也就是这个buffer中
   CLogFile *  log_file_   = nullptr;   ///< 管理日志，比如读写日志
+
+  std::string    path_;                      ///< 日志目录，控制文件也放在这里
+  CLogCheckpoint checkpoint_;                ///< 最近的检查点
+  common::Mutex  trx_lock_;                  ///< 保护 active_trxes_
+  std::unordered_map<int32_t, LSN> active_trxes_;  ///< 还没有结束的事务，事务编号 -> 事务开始时的LSN
+  std::atomic<int32_t> max_trx_id_{0};       ///< 日志中出现过的最大事务编号，包括提交时使用的编号
 };
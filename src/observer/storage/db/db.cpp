@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <chrono>
 #include <vector>
 
 #include "common/log/log.h"
@@ -26,12 +27,22 @@ See the Mulan PSL v2 for more details. */
 #include "storage/common/meta_util.h"
 #include "storage/trx/trx.h"
 #include "storage/clog/clog.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace std;
 
 Db::~Db()
 {
+  stop_checkpoint();
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
+
+  // 关闭表时还会写页面，之后日志模块就要销毁了
+  if (clog_manager_ != nullptr) {
+    BufferPoolManager::instance().set_log_handler(nullptr);
+  }
   LOG_INFO("Db has been closed: %s", name_.c_str());
 }
 
@@ -59,6 +70,9 @@ RC Db::init(const char *name, const char *dbpath)
     return rc;
   }
 
+  // 页面读入和写回时需要记录日志的位置，用来做检查点
+  BufferPoolManager::instance().set_log_handler(clog_manager_.get());
+
   name_ = name;
   path_ = dbpath;
 
@@ -76,7 +90,8 @@ RC Db::init(const char *name, const char *dbpath)
   return rc;
 }
 
-RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes)
+RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes,
+    RecordFormat row_format /* = RecordFormat::FIXED */)
 {
   RC rc = RC::SUCCESS;
   // check table_name
@@ -89,7 +104,8 @@ RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoS
   std::string table_file_path = table_meta_file(path_.c_str(), table_name);
   Table *table = new Table();
   int32_t table_id = next_table_id_++;
-  rc = table->create(table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes);
+  rc = table->create(
+      table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes, row_format);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s.", table_name);
     delete table;
@@ -181,6 +197,12 @@ RC Db::sync()
     }
     LOG_INFO("Successfully sync table db:%s, table:%s.", name_.c_str(), table->name());
   }
+
+  rc = checkpoint();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to do checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
   return rc;
 }
@@ -190,6 +212,93 @@ RC Db::recover()
   return clog_manager_->recover(this);
 }
 
+RC Db::checkpoint()
+{
+  lock_guard guard(checkpoint_lock_);
+
+  // 在这之前开始的事务都已经结束了，它们产生的日志都在 next_lsn 之前，
+  // 修改过的页面要么已经写回，要么是恢复LSN早于 next_lsn 的脏页
+  const LSN checkpoint_lsn = clog_manager_->checkpoint_lsn_limit();
+  const LSN next_lsn       = clog_manager_->next_lsn();
+
+  // 写页面之前先把日志写到磁盘上
+  RC rc = clog_manager_->sync();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync clog before checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  rc = bpm.flush_dirty_pages(next_lsn);
+  if (rc == RC::LOCKED_CONCURRENCY_CONFLICT) {
+    LOG_INFO("some dirty pages are in use, checkpoint does not move forward this time. db=%s", name_.c_str());
+    return RC::SUCCESS;
+  }
+
+  rc = bpm.sync_files();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync data files before checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  return clog_manager_->checkpoint(checkpoint_lsn);
+}
+
+RC Db::start_checkpoint(int interval)
+{
+  if (interval <= 0) {
+    LOG_INFO("periodic checkpoint is disabled. db=%s", name_.c_str());
+    return RC::SUCCESS;
+  }
+
+#ifdef CONCURRENCY
+  lock_guard guard(checkpoint_thread_lock_);
+  if (checkpoint_running_) {
+    LOG_WARN("checkpoint thread has been started. db=%s", name_.c_str());
+    return RC::INTERNAL;
+  }
+  checkpoint_running_ = true;
+  checkpoint_thread_  = thread(&Db::run_checkpoint, this, interval);
+  LOG_INFO("checkpoint thread started. db=%s, interval=%ds", name_.c_str(), interval);
+#else
+  LOG_WARN("periodic checkpoint is disabled because the observer is not compiled with CONCURRENCY");
+#endif
+  return RC::SUCCESS;
+}
+
+void Db::stop_checkpoint()
+{
+  {
+    lock_guard guard(checkpoint_thread_lock_);
+    if (!checkpoint_running_) {
+      return;
+    }
+    checkpoint_running_ = false;
+  }
+  checkpoint_cond_.notify_all();
+
+  checkpoint_thread_.join();
+  LOG_INFO("checkpoint thread stopped. db=%s", name_.c_str());
+}
+
+void Db::run_checkpoint(int interval)
+{
+  while (true) {
+    {
+      unique_lock guard(checkpoint_thread_lock_);
+      checkpoint_cond_.wait_for(guard, chrono::seconds(interval), [this]() { return !checkpoint_running_; });
+      if (!checkpoint_running_) {
+        break;
+      }
+    }
+
+    RC rc = checkpoint();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to do checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    }
+  }
+}
+
 CLogManager *Db::clog_manager()
 {
   return clog_manager_.get();
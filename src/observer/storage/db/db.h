@@ -17,10 +17,14 @@ See the Mulan PSL v2 for more details. */
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "common/rc.h"
 #include "sql/parser/parse_defs.h"
+#include "storage/record/record.h"
 
 class Table;
 class CLogManager;
@@ -45,7 +49,8 @@ public:
    */
   RC init(const char *name, const char *dbpath);
 
-  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes);
+  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes,
+      RecordFormat row_format = RecordFormat::FIXED);
 
   Table *find_table(const char *table_name) const;
   Table *find_table(int32_t table_id) const;
@@ -54,14 +59,35 @@ public:
 
   void all_tables(std::vector<std::string> &table_names) const;
 
+  /**
+   * @brief 把所有表的数据写到磁盘上，然后做一次检查点，下次启动时不需要再重做日志
+   */
   RC sync();
 
   RC recover();
 
+  /**
+   * @brief 做一次模糊检查点
+   * @details 不会阻塞正在修改数据的事务。先找到检查点的位置，也就是还没有结束的事务中最早的开始位置，
+   * 在此之前结束的事务的修改都在恢复LSN早于当前日志位置的脏页中。把这些脏页写回并同步到磁盘之后，
+   * 就可以把检查点写到日志的控制文件中，参考 CLogManager::checkpoint。
+   * 如果有些脏页正在被修改无法写回，这次就不推进检查点
+   */
+  RC checkpoint();
+
+  /**
+   * @brief 启动定期做检查点的后台线程
+   * @details 后台线程会与前台线程并发访问页面，只有在 CONCURRENCY 编译模式下才会启动
+   * @param interval 每隔多少秒做一次检查点，小于等于0表示不启动
+   */
+  RC   start_checkpoint(int interval);
+  void stop_checkpoint();
+
   CLogManager *clog_manager();
 
 private:
   RC open_all_tables();
+  void run_checkpoint(int interval);
 
 private:
   std::string name_;
@@ -71,4 +97,10 @@ private:
 
   /// 给每个table都分配一个ID，用来记录日志。这里假设所有的DDL都不会并发操作，所以相关的数据都不上锁
   int32_t next_table_id_ = 0;
+
+  std::mutex              checkpoint_lock_;  ///< 同时只能有一个检查点
+  std::thread             checkpoint_thread_;
+  std::mutex              checkpoint_thread_lock_;
+  std::condition_variable checkpoint_cond_;
+  bool                    checkpoint_running_ = false;
 };
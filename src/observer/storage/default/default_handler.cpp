@@ -144,6 +144,7 @@ RC DefaultHandler::open_db(const char *dbname)
     delete db;
   } else {
     opened_dbs_[dbname] = db;
+    db->start_checkpoint(checkpoint_interval_);
   }
   return ret;
 }
@@ -95,6 +95,11 @@ public:
 
   RC sync();
 
+  /**
+   * @brief 之后打开的数据库每隔多少秒做一次检查点，小于等于0表示不定期做检查点，参考 Db::start_checkpoint
+   */
+  void set_checkpoint_interval(int interval) { checkpoint_interval_ = interval; }
+
 public:
   static void set_default(DefaultHandler *handler);
   static DefaultHandler &get_default();
@@ -103,4 +108,5 @@ private:
   std::string base_dir_;
   std::string db_dir_;
   std::map<std::string, Db *> opened_dbs_;
+  int checkpoint_interval_ = 0;
 };  // class Handler
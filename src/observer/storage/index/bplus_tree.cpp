@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Xie Meiyi
 // Rewritten by Longda & Wangyunlai
 //
+#include <algorithm>
+
 #include "storage/index/bplus_tree.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/log/log.h"
@@ -21,6 +23,9 @@ See the Mulan PSL v2 for more details. */
 using namespace std;
 using namespace common;
 
+/// 乐观读查找叶子节点时最多重试几次，之后就退回到加读锁的方式
+static constexpr int OPTIMISTIC_READ_RETRY_TIMES = 3;
+
 #define FIRST_INDEX_PAGE 1
 
 int calc_internal_page_capacity(int attr_length)
@@ -174,6 +179,7 @@ LeafIndexNodeHandler::LeafIndexNodeHandler(const IndexFileHeader &header, Frame
 void LeafIndexNodeHandler::init_empty()
 {
   IndexNodeHandler::init_empty(true);
+  leaf_node_->prev_brother = BP_INVALID_PAGE_NUM;
   leaf_node_->next_brother = BP_INVALID_PAGE_NUM;
 }
 
@@ -187,6 +193,16 @@ PageNum LeafIndexNodeHandler::next_page() const
   return leaf_node_->next_brother;
 }
 
+void LeafIndexNodeHandler::set_prev_page(PageNum page_num)
+{
+  leaf_node_->prev_brother = page_num;
+}
+
+PageNum LeafIndexNodeHandler::prev_page() const
+{
+  return leaf_node_->prev_brother;
+}
+
 char *LeafIndexNodeHandler::key_at(int index)
 {
   assert(index >= 0 && index < size());
@@ -310,6 +326,7 @@ std::string to_string(const LeafIndexNodeHandler &handler, const KeyPrinter &pri
 {
   std::stringstream ss;
   ss << to_string((const IndexNodeHandler &)handler)
+     << ",prev page:" << handler.prev_page()
      << ",next page:" << handler.next_page();
   ss << ",values=[" << printer(handler.__key_at(0));
   for (int i = 1; i < handler.size(); i++) {
@@ -478,6 +495,53 @@ int InternalIndexNodeHandler::lookup(const KeyComparator &comparator, const char
   return ret;
 }
 
+PageNum InternalIndexNodeHandler::child_page(const KeyComparator &comparator, const char *key) const
+{
+  // 只读取一次节点大小，并且使用文件头中的最大值来检查，因为节点上的数据都可能是不一致的
+  const int size = this->size();
+  if (size <= 0 || size > header_.internal_max_size) {
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
+  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
+  common::BinaryIterator<char> iter = common::lower_bound(iter_begin, iter_end, key, comparator);
+  int index = static_cast<int>(iter - iter_begin) + 1;
+  if (index >= size || comparator(key, __key_at(index)) < 0) {
+    index--;
+  }
+  return *(PageNum *)__value_at(index);
+}
+
+PageNum InternalIndexNodeHandler::child_page_at(int index) const
+{
+  const int size = this->size();
+  if (index < 0 || index >= size || size > header_.internal_max_size) {
+    return BP_INVALID_PAGE_NUM;
+  }
+  return *(PageNum *)__value_at(index);
+}
+
+PageNum InternalIndexNodeHandler::child_page_before(
+    const KeyComparator &comparator, const char *key, const char *&separator) const
+{
+  separator = nullptr;
+  const int size = this->size();
+  if (size <= 0 || size > header_.internal_max_size) {
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  // 第i个子节点中的键值都不小于第i个分隔键，比key小的键值只会出现在最后一个比key小的分隔键对应的子节点及其前面
+  common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
+  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
+  common::BinaryIterator<char> iter = common::lower_bound(iter_begin, iter_end, key, comparator);
+  const int index = static_cast<int>(iter - iter_begin);
+  if (index > 0) {
+    separator = __key_at(index);
+  }
+  return *(PageNum *)__value_at(index);
+}
+
 char *InternalIndexNodeHandler::key_at(int index)
 {
   assert(index >= 0 && index < size());
@@ -585,6 +649,11 @@ RC InternalIndexNodeHandler::append(const char *item, DiskBufferPool *bp)
   return this->copy_from(item, 1, bp);
 }
 
+RC InternalIndexNodeHandler::append_children(const char *items, int num, DiskBufferPool *bp)
+{
+  return this->copy_from(items, num, bp);
+}
+
 RC InternalIndexNodeHandler::preappend(const char *item, DiskBufferPool *bp)
 {
   PageNum child_page_num = *(PageNum *)(item + key_size());
@@ -746,8 +815,27 @@ RC BplusTreeHandler::sync()
 }
 
 RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length, int internal_max_size /* = -1*/,
-    int leaf_max_size /* = -1 */)
+    int leaf_max_size /* = -1 */, const char *pool_name /* = nullptr */)
+{
+  return create(file_name, vector<AttrType>{attr_type}, vector<int32_t>{attr_length},
+                internal_max_size, leaf_max_size, pool_name);
+}
+
+RC BplusTreeHandler::create(const char *file_name, const vector<AttrType> &attr_types, const vector<int32_t> &attr_lengths,
+    int internal_max_size /* = -1*/, int leaf_max_size /* = -1 */, const char *pool_name /* = nullptr */)
 {
+  const int attr_num = static_cast<int>(attr_types.size());
+  if (attr_num <= 0 || attr_num > IndexFileHeader::MAX_ATTR_NUM || attr_lengths.size() != attr_types.size()) {
+    LOG_WARN("invalid index attributes. file name=%s, attr num=%d, max=%d",
+             file_name, attr_num, IndexFileHeader::MAX_ATTR_NUM);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int attr_length = 0;
+  for (int32_t length : attr_lengths) {
+    attr_length += length;
+  }
+
   BufferPoolManager &bpm = BufferPoolManager::instance();
   RC rc = bpm.create_file(file_name);
   if (rc != RC::SUCCESS) {
@@ -757,7 +845,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   LOG_INFO("Successfully create index file:%s", file_name);
 
   DiskBufferPool *bp = nullptr;
-  rc = bpm.open_file(file_name, bp);
+  rc = bpm.open_file(file_name, bp, pool_name);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to open file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
     return rc;
@@ -790,10 +878,16 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   IndexFileHeader *file_header = (IndexFileHeader *)pdata;
   file_header->attr_length = attr_length;
   file_header->key_length = attr_length + sizeof(RID);
-  file_header->attr_type = attr_type;
+  file_header->attr_type = attr_types[0];
+  file_header->attr_num = attr_num;
+  for (int i = 0; i < attr_num; i++) {
+    file_header->attr_types[i] = attr_types[i];
+    file_header->attr_lengths[i] = attr_lengths[i];
+  }
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size = leaf_max_size;
   file_header->root_page = BP_INVALID_PAGE_NUM;
+  file_header->version = IndexFileHeader::CURRENT_VERSION;
 
   header_frame->mark_dirty();
 
@@ -810,8 +904,8 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
     return RC::NOMEM;
   }
 
-  key_comparator_.init(file_header->attr_type, file_header->attr_length);
-  key_printer_.init(file_header->attr_type, file_header->attr_length);
+  key_comparator_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
+  key_printer_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
 
   this->sync();
 
@@ -819,7 +913,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::open(const char *file_name)
+RC BplusTreeHandler::open(const char *file_name, const char *pool_name /* = nullptr */)
 {
   if (disk_buffer_pool_ != nullptr) {
     LOG_WARN("%s has been opened before index.open.", file_name);
@@ -828,7 +922,7 @@ RC BplusTreeHandler::open(const char *file_name)
 
   BufferPoolManager &bpm = BufferPoolManager::instance();
   DiskBufferPool *disk_buffer_pool;
-  RC rc = bpm.open_file(file_name, disk_buffer_pool);
+  RC rc = bpm.open_file(file_name, disk_buffer_pool, pool_name);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to open file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
     return rc;
@@ -844,6 +938,15 @@ RC BplusTreeHandler::open(const char *file_name)
 
   char *pdata = frame->data();
   memcpy(&file_header_, pdata, sizeof(IndexFileHeader));
+  disk_buffer_pool->unpin_page(frame);
+  if (file_header_.version != IndexFileHeader::CURRENT_VERSION) {
+    // 老版本的叶子节点格式不同，按照当前的格式访问会读到错误的数据，需要重建索引
+    LOG_WARN("unsupported index file version. file name=%s, version=%d, current version=%d",
+             file_name, file_header_.version, IndexFileHeader::CURRENT_VERSION);
+    bpm.close_file(file_name);
+    return RC::INDEX_VERSION_MISMATCH;
+  }
+
   header_dirty_ = false;
   disk_buffer_pool_ = disk_buffer_pool;
 
@@ -854,11 +957,8 @@ RC BplusTreeHandler::open(const char *file_name)
     return RC::NOMEM;
   }
 
-  // close old page_handle
-  disk_buffer_pool->unpin_page(frame);
-
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  key_comparator_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
+  key_printer_.init(file_header_.attr_num, file_header_.attr_types, file_header_.attr_lengths);
   LOG_INFO("Successfully open index %s", file_name);
   return RC::SUCCESS;
 }
@@ -1022,6 +1122,12 @@ bool BplusTreeHandler::validate_leaf_link(LatchMemo &latch_memo)
 
   LeafIndexNodeHandler leaf_node(file_header_, frame);
   PageNum next_page_num = leaf_node.next_page();
+  PageNum prev_page_num = frame->page_num();
+  if (leaf_node.prev_page() != BP_INVALID_PAGE_NUM) {
+    LOG_WARN("invalid page. left most page has a prev page. page num=%d, prev page=%d",
+             prev_page_num, leaf_node.prev_page());
+    return false;
+  }
 
   MemPoolItem::unique_ptr prev_key = mem_pool_item_->alloc_unique_ptr();
   memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1), file_header_.key_length);
@@ -1039,7 +1145,13 @@ bool BplusTreeHandler::validate_leaf_link(LatchMemo &latch_memo)
       LOG_WARN("invalid page. current first key is not bigger than last");
       result = false;
     }
+    if (leaf_node.prev_page() != prev_page_num) {
+      LOG_WARN("invalid page. prev page does not link to the left page. page num=%d, prev page=%d, left page=%d",
+               frame->page_num(), leaf_node.prev_page(), prev_page_num);
+      result = false;
+    }
 
+    prev_page_num = frame->page_num();
     next_page_num = leaf_node.next_page();
     memcpy(prev_key.get(), leaf_node.key_at(leaf_node.size() - 1), file_header_.key_length);
   }
@@ -1080,14 +1192,22 @@ bool BplusTreeHandler::is_empty() const
 RC BplusTreeHandler::find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op, const char *key, Frame *&frame)
 {
   auto child_page_getter = [this, key](InternalIndexNodeHandler &internal_node) {
-        return internal_node.value_at(internal_node.lookup(key_comparator_, key));
+        return internal_node.child_page(key_comparator_, key);
       };
   return find_leaf_internal(latch_memo, op, child_page_getter, frame);
 }
 
 RC BplusTreeHandler::left_most_page(LatchMemo &latch_memo, Frame *&frame)
 {
-  auto child_page_getter = [](InternalIndexNodeHandler &internal_node) { return internal_node.value_at(0); };
+  auto child_page_getter = [](InternalIndexNodeHandler &internal_node) { return internal_node.child_page_at(0); };
+  return find_leaf_internal(latch_memo, BplusTreeOperationType::READ, child_page_getter, frame);
+}
+
+RC BplusTreeHandler::right_most_page(LatchMemo &latch_memo, Frame *&frame)
+{
+  auto child_page_getter = [](InternalIndexNodeHandler &internal_node) {
+    return internal_node.child_page_at(internal_node.size() - 1);
+  };
   return find_leaf_internal(latch_memo, BplusTreeOperationType::READ, child_page_getter, frame);
 }
 
@@ -1096,6 +1216,18 @@ RC BplusTreeHandler::find_leaf_internal(
     const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
     Frame *&frame)
 {
+  // 读操作先尝试乐观读，冲突次数多了就退回到加锁的方式
+  if (op == BplusTreeOperationType::READ) {
+    for (int i = 0; i < OPTIMISTIC_READ_RETRY_TIMES; i++) {
+      RC rc = optimistic_find_leaf(latch_memo, child_page_getter, frame);
+      if (rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+        return rc;
+      }
+
+      latch_memo.release_to(latch_memo.memo_point());
+    }
+  }
+
   // root locked
   if (op != BplusTreeOperationType::READ) {
     latch_memo.xlatch(&root_lock_);
@@ -1129,6 +1261,59 @@ RC BplusTreeHandler::find_leaf_internal(
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::optimistic_find_leaf(LatchMemo &latch_memo, 
+                                          const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
+                                          Frame *&frame)
+{
+  // 根节点锁保证根节点的页面号不会变化
+  latch_memo.slatch(&root_lock_);
+
+  if (is_empty()) {
+    return RC::EMPTY;
+  }
+
+  Frame   *parent_frame   = nullptr;
+  uint64_t parent_version = 0;
+  PageNum  page_num       = file_header_.root_page;
+  while (true) {
+    const int memo_point = latch_memo.memo_point();
+    RC rc = latch_memo.get_page(page_num, frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get frame. pageNum=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    // 父节点的版本号没有变化，说明刚才读到的子节点页面号是有效的
+    uint64_t version = 0;
+    if (!frame->optimistic_read_begin(version) ||
+        (parent_frame != nullptr && !parent_frame->optimistic_read_validate(parent_version))) {
+      return RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+
+    IndexNodeHandler index_node(file_header_, frame);
+    if (index_node.is_leaf()) {
+      // 叶子节点加上读锁后再校验一次，防止在加锁之前它已经分裂或合并了
+      latch_memo.slatch(frame);
+      if (!frame->optimistic_read_validate(version)) {
+        return RC::LOCKED_CONCURRENCY_CONFLICT;
+      }
+
+      latch_memo.release_to(memo_point);  // 只保留叶子节点的pin和读锁
+      return RC::SUCCESS;
+    }
+
+    InternalIndexNodeHandler internal_node(file_header_, frame);
+    PageNum child_page_num = child_page_getter(internal_node);
+    if (child_page_num == BP_INVALID_PAGE_NUM || !frame->optimistic_read_validate(version)) {
+      return RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+
+    parent_frame   = frame;
+    parent_version = version;
+    page_num       = child_page_num;
+  }
+}
+
 RC BplusTreeHandler::crabing_protocal_fetch_page(LatchMemo &latch_memo, 
                                                  BplusTreeOperationType op, 
                                                  PageNum page_num, 
@@ -1177,9 +1362,11 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *f
   }
 
   LeafIndexNodeHandler new_index_node(file_header_, new_frame);
+  new_index_node.set_prev_page(frame->page_num());
   new_index_node.set_next_page(leaf_node.next_page());
   new_index_node.set_parent_page_num(leaf_node.parent_page_num());
   leaf_node.set_next_page(new_frame->page_num());
+  link_prev_page(latch_memo, new_index_node.next_page(), new_frame->page_num());
 
   if (insert_position < leaf_node.size()) {
     leaf_node.insert(insert_position, key, (const char *)rid);
@@ -1190,6 +1377,29 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *f
   return insert_entry_into_parent(latch_memo, frame, new_frame, new_index_node.key_at(0));
 }
 
+void BplusTreeHandler::link_prev_page(LatchMemo &latch_memo, PageNum page_num, PageNum prev_page_num)
+{
+  if (page_num == BP_INVALID_PAGE_NUM) {
+    return;
+  }
+
+  Frame *frame = nullptr;
+  RC rc = latch_memo.get_page(page_num, frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to fetch right brother page. page num=%d, rc=%s", page_num, strrc(rc));
+    return;
+  }
+
+  if (!latch_memo.try_xlatch(frame)) {
+    LOG_TRACE("right brother page is busy, leave its prev page stale. page num=%d, prev page=%d",
+              page_num, prev_page_num);
+    return;
+  }
+
+  LeafIndexNodeHandler(file_header_, frame).set_prev_page(prev_page_num);
+  frame->mark_dirty();
+}
+
 RC BplusTreeHandler::insert_entry_into_parent(LatchMemo &latch_memo, Frame *frame, Frame *new_frame, const char *key)
 {
   RC rc = RC::SUCCESS;
@@ -1319,6 +1529,18 @@ void BplusTreeHandler::update_root_page_num_locked(PageNum root_page_num)
   file_header_.root_page = root_page_num;
   header_dirty_ = true;
   LOG_DEBUG("set root page to %d", root_page_num);
+
+  // 检查点只写回脏页，根页面变化时就写到头页面上，否则检查点之后崩溃会找不到整棵树
+  Frame *frame = nullptr;
+  RC rc = disk_buffer_pool_->get_this_page(FIRST_INDEX_PAGE, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get index header page. file_desc=%d, rc=%s", disk_buffer_pool_->file_desc(), strrc(rc));
+    return;
+  }
+  memcpy(frame->data(), &file_header_, sizeof(file_header_));
+  frame->mark_dirty();
+  disk_buffer_pool_->unpin_page(frame);
+  header_dirty_ = false;
 }
 
 RC BplusTreeHandler::create_new_tree(const char *key, const RID *rid)
@@ -1404,6 +1626,141 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 批量构建时一层需要多少个节点
+ * @details 每个节点放 max_size * fill_factor_pct% 个 key，但是不能少于 min_size。
+ * 最后一个节点可能放不满，所以这一层的 key 会平均分给每个节点
+ */
+static int bulk_build_node_num(int64_t item_num, int max_size, int fill_factor_pct)
+{
+  const int min_size = max_size - max_size / 2;
+  const int per_node = std::clamp(static_cast<int>(static_cast<int64_t>(max_size) * fill_factor_pct / 100), min_size, max_size);
+
+  int64_t node_num = (item_num + per_node - 1) / per_node;
+  if (node_num > 1 && item_num / node_num < min_size) {
+    node_num = std::max<int64_t>(1, item_num / min_size);
+  }
+  return static_cast<int>(node_num);
+}
+
+RC BplusTreeHandler::bulk_build(int64_t entry_num, const std::function<RC(const char *&key)> &next_key,
+                                int fill_factor_pct)
+{
+  if (!is_empty()) {
+    LOG_WARN("cannot bulk build a tree that is not empty. root page=%d", file_header_.root_page);
+    return RC::INTERNAL;
+  }
+  if (entry_num <= 0) {
+    return RC::SUCCESS;
+  }
+
+  // 叶子节点从左到右依次写入，同时记录每个叶子节点的第一个 key，用来构建上一层
+  const int key_length = file_header_.key_length;
+  const int child_item_size = key_length + static_cast<int>(sizeof(PageNum));
+  const int leaf_num = bulk_build_node_num(entry_num, file_header_.leaf_max_size, fill_factor_pct);
+
+  std::vector<char> children(static_cast<size_t>(leaf_num) * child_item_size);
+  int64_t remain_num = entry_num;
+  Frame *prev_frame = nullptr;
+  RC rc = RC::SUCCESS;
+  for (int i = 0; i < leaf_num && OB_SUCC(rc); i++) {
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate leaf page while bulk building. rc=%s", strrc(rc));
+      break;
+    }
+
+    LeafIndexNodeHandler leaf_node(file_header_, frame);
+    leaf_node.init_empty();
+    const int key_num = static_cast<int>(remain_num / (leaf_num - i));
+    for (int k = 0; k < key_num; k++) {
+      const char *key = nullptr;
+      rc = next_key(key);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get next key while bulk building. rc=%s", strrc(rc));
+        break;
+      }
+      leaf_node.insert(k, key, key + file_header_.attr_length);
+    }
+    frame->mark_dirty();
+    if (OB_FAIL(rc)) {
+      disk_buffer_pool_->unpin_page(frame);
+      break;
+    }
+    remain_num -= key_num;
+
+    const PageNum page_num = frame->page_num();
+    char *child_item = children.data() + static_cast<size_t>(i) * child_item_size;
+    memcpy(child_item, leaf_node.key_at(0), key_length);
+    memcpy(child_item + key_length, &page_num, sizeof(PageNum));
+
+    if (prev_frame != nullptr) {
+      leaf_node.set_prev_page(prev_frame->page_num());
+      LeafIndexNodeHandler(file_header_, prev_frame).set_next_page(frame->page_num());
+      disk_buffer_pool_->unpin_page(prev_frame);
+    }
+    prev_frame = frame;
+  }
+  if (prev_frame != nullptr) {
+    disk_buffer_pool_->unpin_page(prev_frame);
+  }
+
+  while (OB_SUCC(rc) && children.size() > static_cast<size_t>(child_item_size)) {
+    rc = bulk_build_internal_level(children, fill_factor_pct);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  PageNum root_page = BP_INVALID_PAGE_NUM;
+  memcpy(&root_page, children.data() + key_length, sizeof(PageNum));
+  update_root_page_num_locked(root_page);
+  LOG_INFO("bulk build bplus tree done. entry num=%ld, leaf num=%d, root page=%d", entry_num, leaf_num, root_page);
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::bulk_build_internal_level(std::vector<char> &children, int fill_factor_pct)
+{
+  const int key_length = file_header_.key_length;
+  const int child_item_size = key_length + static_cast<int>(sizeof(PageNum));
+  const int child_num = static_cast<int>(children.size() / child_item_size);
+  const int node_num = bulk_build_node_num(child_num, file_header_.internal_max_size, fill_factor_pct);
+
+  std::vector<char> parents(static_cast<size_t>(node_num) * child_item_size);
+  int child_index = 0;
+  for (int i = 0; i < node_num; i++) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate internal page while bulk building. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    // 与分裂出来的节点一样，内部节点的第一个 key 也保留子树中最小的 key，删除时会用它在父节点中查找
+    const char *first_child = children.data() + static_cast<size_t>(child_index) * child_item_size;
+    char *parent_item = parents.data() + static_cast<size_t>(i) * child_item_size;
+    memcpy(parent_item, first_child, key_length);
+    const PageNum page_num = frame->page_num();
+    memcpy(parent_item + key_length, &page_num, sizeof(PageNum));
+
+    InternalIndexNodeHandler internal_node(file_header_, frame);
+    internal_node.init_empty();
+    const int num = (child_num - child_index) / (node_num - i);
+    rc = internal_node.append_children(first_child, num, disk_buffer_pool_);
+    child_index += num;
+    frame->mark_dirty();
+    disk_buffer_pool_->unpin_page(frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to append children while bulk building. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  children.swap(parents);
+  return RC::SUCCESS;
+}
+
 RC BplusTreeHandler::get_entry(const char *user_key, int key_len, std::list<RID> &rids)
 {
   BplusTreeScanner scanner(*this);
@@ -1559,6 +1916,17 @@ RC BplusTreeHandler::coalesce(LatchMemo &latch_memo, Frame *neighbor_frame, Fram
     LeafIndexNodeHandler left_leaf_node(file_header_, left_frame);
     LeafIndexNodeHandler right_leaf_node(file_header_, right_frame);
     left_leaf_node.set_next_page(right_leaf_node.next_page());
+    link_prev_page(latch_memo, left_leaf_node.next_page(), left_frame->page_num());
+
+    // 别的叶子节点上可能还留着指向这个页面的过期 prev_brother。释放页面时不会刷盘，
+    // 这里把它标记成不再链接任何页面并写回磁盘，重新加载这个页面时逆序扫描的校验才不会出错
+    right_leaf_node.set_prev_page(BP_INVALID_PAGE_NUM);
+    right_leaf_node.set_next_page(BP_INVALID_PAGE_NUM);
+    rc = disk_buffer_pool_->flush_page(*right_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush coalesced leaf page. page num=%d, rc=%s", right_frame->page_num(), strrc(rc));
+      return rc;
+    }
   }
 
   latch_memo.dispose_page(right_frame->page_num());
@@ -1661,7 +2029,7 @@ BplusTreeScanner::~BplusTreeScanner()
 }
 
 RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inclusive, 
-                          const char *right_user_key, int right_len, bool right_inclusive)
+                          const char *right_user_key, int right_len, bool right_inclusive, bool descending)
 {
   RC rc = RC::SUCCESS;
   if (inited_) {
@@ -1671,57 +2039,102 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   inited_ = true;
   first_emitted_ = false;
+  descending_ = descending;
+
+  // 组合索引的边界值可以只包含前面几个字段，这里计算边界值包含的字段个数
+  const int left_attr_num = left_user_key != nullptr ? bound_attr_num(left_len) : 0;
+  const int right_attr_num = right_user_key != nullptr ? bound_attr_num(right_len) : 0;
 
   // 校验输入的键值是否是合法范围
   if (left_user_key && right_user_key) {
-    const auto &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
+    const AttrComparator attr_comparator = 
+        tree_handler_.key_comparator_.attr_comparator().prefix(std::min(left_attr_num, right_attr_num));
     const int result = attr_comparator(left_user_key, right_user_key);
     if (result > 0 ||  // left < right
                        // left == right but is (left,right)/[left,right) or (left,right]
-        (result == 0 && (left_inclusive == false || right_inclusive == false))) {
+        (result == 0 && left_attr_num == right_attr_num && (left_inclusive == false || right_inclusive == false))) {
       return RC::INVALID_ARGUMENT;
     }
   }
 
+  // 把边界值转换成完整的键值，左边界使用最小的RID，右边界使用最大的RID
   if (nullptr == left_user_key) {
-    rc = tree_handler_.left_most_page(latch_memo_, current_frame_);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to find left most page. rc=%s", strrc(rc));
-      return rc;
+    left_key_ = nullptr;
+  } else {
+    vector<char> fixed_left_key;
+    bool should_inclusive_after_fix = false;
+    fix_user_key(left_user_key, left_len, true /*greater*/, fixed_left_key, should_inclusive_after_fix);
+    if (should_inclusive_after_fix) {
+      left_inclusive = true;
     }
 
-    iter_index_ = 0;
+    if (left_inclusive) {
+      left_key_ = tree_handler_.make_key(fixed_left_key.data(), *RID::min());
+    } else {
+      left_key_ = tree_handler_.make_key(fixed_left_key.data(), *RID::max());
+    }
+    left_comparator_ = tree_handler_.key_comparator_.prefix(left_attr_num);
+  }
+
+  // 没有指定右边界范围，那么就返回右边界最大值
+  if (nullptr == right_user_key) {
+    right_key_ = nullptr;
   } else {
+    vector<char> fixed_right_key;
+    bool should_include_after_fix = false;
+    fix_user_key(right_user_key, right_len, false /*want_greater*/, fixed_right_key, should_include_after_fix);
+    if (should_include_after_fix) {
+      right_inclusive = true;
+    }
 
-    char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == CHARS) {
-      bool should_inclusive_after_fix = false;
-      rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fix left user key. rc=%s", strrc(rc));
+    if (right_inclusive) {
+      right_key_ = tree_handler_.make_key(fixed_right_key.data(), *RID::max());
+    } else {
+      right_key_ = tree_handler_.make_key(fixed_right_key.data(), *RID::min());
+    }
+    right_comparator_ = tree_handler_.key_comparator_.prefix(right_attr_num);
+  }
+
+  if (descending_) {
+    // 逆序扫描从右边界开始，到左边界结束
+    if (nullptr == right_key_) {
+      rc = tree_handler_.right_most_page(latch_memo_, current_frame_);
+      if (rc == RC::EMPTY) {
+        current_frame_ = nullptr;
+        return RC::SUCCESS;
+      } else if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to find right most page. rc=%s", strrc(rc));
         return rc;
       }
 
-      if (should_inclusive_after_fix) {
-        left_inclusive = true;
+      iter_index_ = LeafIndexNodeHandler(tree_handler_.file_header_, current_frame_).size() - 1;
+      if (iter_index_ < 0) {  // 只有根节点是叶子节点时才可能是空的
+        latch_memo_.release();
+        current_frame_ = nullptr;
       }
-    }
-
-    MemPoolItem::unique_ptr left_pkey;
-    if (left_inclusive) {
-      left_pkey = tree_handler_.make_key(fixed_left_key, *RID::min());
     } else {
-      left_pkey = tree_handler_.make_key(fixed_left_key, *RID::max());
+      rc = locate_prev(right_comparator_, static_cast<const char *>(right_key_.get()));
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to find right page. rc=%s", strrc(rc));
+        return rc;
+      }
     }
-
-    const char *left_key = (const char *)left_pkey.get();
-
-    if (fixed_left_key != left_user_key) {
-      delete[] fixed_left_key;
-      fixed_left_key = nullptr;
+  } else if (nullptr == left_key_) {
+    rc = tree_handler_.left_most_page(latch_memo_, current_frame_);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to find left most page. rc=%s", strrc(rc));
+      return rc;
     }
 
-    rc = tree_handler_.find_leaf(latch_memo_, BplusTreeOperationType::READ, left_key, current_frame_);
+    iter_index_ = 0;
+  } else {
+    const char *left_key = static_cast<const char *>(left_key_.get());
+    const KeyComparator &left_comparator = left_comparator_;
+
+    auto child_page_getter = [&left_comparator, left_key](InternalIndexNodeHandler &internal_node) {
+      return internal_node.child_page(left_comparator, left_key);
+    };
+    rc = tree_handler_.find_leaf_internal(latch_memo_, BplusTreeOperationType::READ, child_page_getter, current_frame_);
     if (rc == RC::EMPTY) {
       rc = RC::SUCCESS;
       current_frame_ = nullptr;
@@ -1733,7 +2146,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
     
 
     LeafIndexNodeHandler left_node(tree_handler_.file_header_, current_frame_);
-    int left_index = left_node.lookup(tree_handler_.key_comparator_, left_key);
+    int left_index = left_node.lookup(left_comparator, left_key);
     // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
     if (left_index >= left_node.size()) {  // 超出了当前页，就需要向后移动一个位置
       const PageNum next_page_num = left_node.next_page();
@@ -1755,41 +2168,99 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
     iter_index_ = left_index;
   }
 
-  // 没有指定右边界范围，那么就返回右边界最大值
-  if (nullptr == right_user_key) {
-    right_key_ = nullptr;
-  } else {
+  if (current_frame_ != nullptr && touch_end()) {
+    current_frame_ = nullptr;
+  }
 
-    char *fixed_right_key = const_cast<char *>(right_user_key);
-    bool should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == CHARS) {
-      rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
-        return rc;
-      }
+  return RC::SUCCESS;
+}
 
-      if (should_include_after_fix) {
-        right_inclusive = true;
+RC BplusTreeScanner::locate_prev(const KeyComparator &comparator, const char *key)
+{
+  const IndexFileHeader &header = tree_handler_.file_header_;
+  vector<char> bound(key, key + header.key_length);
+  vector<char> separator;
+  const KeyComparator *bound_comparator = &comparator;
+  while (true) {
+    auto child_page_getter = [&bound_comparator, &bound, &separator, &header](InternalIndexNodeHandler &internal_node) {
+      // 乐观读失败时会从根节点重新开始
+      if (internal_node.parent_page_num() == BP_INVALID_PAGE_NUM) {
+        separator.clear();
       }
+      const char *separator_key = nullptr;
+      PageNum page_num = internal_node.child_page_before(*bound_comparator, bound.data(), separator_key);
+      if (separator_key != nullptr) {
+        separator.assign(separator_key, separator_key + header.key_length);
+      }
+      return page_num;
+    };
+
+    separator.clear();
+    RC rc = tree_handler_.find_leaf_internal(latch_memo_, BplusTreeOperationType::READ, child_page_getter, current_frame_);
+    if (rc == RC::EMPTY) {
+      current_frame_ = nullptr;
+      return RC::SUCCESS;
+    } else if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to find leaf page. rc=%s", strrc(rc));
+      return rc;
     }
-    if (right_inclusive) {
-      right_key_ = tree_handler_.make_key(fixed_right_key, *RID::max());
-    } else {
-      right_key_ = tree_handler_.make_key(fixed_right_key, *RID::min());
+
+    LeafIndexNodeHandler node(header, current_frame_);
+    iter_index_ = node.lookup(*bound_comparator, bound.data()) - 1;
+    if (iter_index_ >= 0) {
+      return RC::SUCCESS;
     }
 
-    if (fixed_right_key != right_user_key) {
-      delete[] fixed_right_key;
-      fixed_right_key = nullptr;
+    latch_memo_.release();
+    current_frame_ = nullptr;
+
+    // 这个叶子节点上没有比 bound 小的数据(分隔键可能是过期的)，那么要找的数据就是比最近的分隔键小的最大的键值。
+    // 分隔键是完整的键值，后面使用完整的比较器
+    if (separator.empty()) {
+      return RC::SUCCESS;
     }
+    bound.swap(separator);
+    bound_comparator = &tree_handler_.key_comparator_;
   }
+}
 
-  if (touch_end()) {
+RC BplusTreeScanner::move_to_prev_page()
+{
+  const IndexFileHeader &header = tree_handler_.file_header_;
+  LeafIndexNodeHandler node(header, current_frame_);
+  const PageNum this_page_num = current_frame_->page_num();
+  const PageNum prev_page_num = node.prev_page();
+  if (prev_page_num == BP_INVALID_PAGE_NUM) {
+    latch_memo_.release();
     current_frame_ = nullptr;
+    return RC::SUCCESS;
   }
 
-  return RC::SUCCESS;
+  // 当前页面的数据都已经返回了，要找的是比当前页面第一个键值小的最大的键值
+  vector<char> first_key(node.key_at(0), node.key_at(0) + header.key_length);
+
+  /**
+   * 这里与正向扫描一样，只能尝试加锁。
+   * prev_brother 可能是过期的，甚至指向一个已经释放的页面，所以要校验它的 next_brother 还是当前页面
+   */
+  const int memo_point = latch_memo_.memo_point();
+  Frame *prev_frame = nullptr;
+  RC rc = latch_memo_.get_page(prev_page_num, prev_frame);
+  if (rc == RC::SUCCESS && latch_memo_.try_slatch(prev_frame)) {
+    LeafIndexNodeHandler prev_node(header, prev_frame);
+    if (prev_node.is_leaf() && prev_node.next_page() == this_page_num && prev_node.size() > 0) {
+      latch_memo_.release_to(memo_point);
+      current_frame_ = prev_frame;
+      iter_index_ = prev_node.size() - 1;
+      return RC::SUCCESS;
+    }
+  }
+
+  LOG_TRACE("cannot move to prev page by link, search from root. page num=%d, prev page=%d",
+            this_page_num, prev_page_num);
+  latch_memo_.release();
+  current_frame_ = nullptr;
+  return locate_prev(tree_handler_.key_comparator_, first_key.data());
 }
 
 void BplusTreeScanner::fetch_item(RID &rid)
@@ -1800,13 +2271,22 @@ void BplusTreeScanner::fetch_item(RID &rid)
 
 bool BplusTreeScanner::touch_end()
 {
+  if (descending_) {
+    if (left_key_ == nullptr) {
+      return false;
+    }
+
+    LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+    return left_comparator_(node.key_at(iter_index_), static_cast<char *>(left_key_.get())) < 0;
+  }
+
   if (right_key_ == nullptr) {
     return false;
   }
   
   LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
   const char *this_key = node.key_at(iter_index_);
-  int compare_result = tree_handler_.key_comparator_(this_key, static_cast<char *>(right_key_.get()));
+  int compare_result = right_comparator_(this_key, static_cast<char *>(right_key_.get()));
   return compare_result > 0;
 }
 
@@ -1822,6 +2302,25 @@ RC BplusTreeScanner::next_entry(RID &rid)
     return RC::SUCCESS;
   }
 
+  if (descending_) {
+    iter_index_--;
+    if (iter_index_ < 0) {
+      RC rc = move_to_prev_page();
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      if (nullptr == current_frame_) {
+        return RC::RECORD_EOF;
+      }
+    }
+
+    if (touch_end()) {
+      return RC::RECORD_EOF;
+    }
+    fetch_item(rid);
+    return RC::SUCCESS;
+  }
+
   iter_index_++;
 
   LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
@@ -1862,6 +2361,12 @@ RC BplusTreeScanner::next_entry(RID &rid)
   return next_entry(rid);
 }
 
+const char *BplusTreeScanner::current_key() const
+{
+  LeafIndexNodeHandler node(tree_handler_.file_header_, current_frame_);
+  return node.key_at(iter_index_);
+}
+
 RC BplusTreeScanner::close()
 {
   inited_ = false;
@@ -1869,40 +2374,57 @@ RC BplusTreeScanner::close()
   return RC::SUCCESS;
 }
 
-RC BplusTreeScanner::fix_user_key(
-    const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive)
+int BplusTreeScanner::bound_attr_num(int key_len) const
 {
-  if (nullptr == fixed_key || nullptr == should_inclusive) {
-    return RC::INVALID_ARGUMENT;
+  const IndexFileHeader &header = tree_handler_.file_header_;
+  int offset = 0;
+  for (int i = 0; i < header.attr_num; i++) {
+    offset += header.attr_lengths[i];
+    if (offset >= key_len) {
+      return i + 1;
+    }
   }
+  return header.attr_num;
+}
 
-  // 这里很粗暴，变长字段才需要做调整，其它默认都不需要做调整
-  assert(tree_handler_.file_header_.attr_type == CHARS);
-  assert(strlen(user_key) >= static_cast<size_t>(key_len));
+void BplusTreeScanner::fix_user_key(
+    const char *user_key, int key_len, bool want_greater, vector<char> &fixed_key, bool &should_inclusive)
+{
+  const IndexFileHeader &header = tree_handler_.file_header_;
+  const int attr_num = bound_attr_num(key_len);
 
-  *should_inclusive = false;
+  should_inclusive = false;
+  fixed_key.assign(header.attr_length, 0);
 
-  int32_t attr_length = tree_handler_.file_header_.attr_length;
-  char *key_buf = new (std::nothrow) char[attr_length];
-  if (nullptr == key_buf) {
-    return RC::NOMEM;
+  // 除最后一个字段外，前面的字段都是完整的
+  int offset = 0;
+  for (int i = 0; i < attr_num - 1; i++) {
+    offset += header.attr_lengths[i];
   }
+  memcpy(fixed_key.data(), user_key, offset);
 
-  if (key_len <= attr_length) {
-    memcpy(key_buf, user_key, key_len);
-    memset(key_buf + key_len, 0, attr_length - key_len);
+  const int attr_length = header.attr_lengths[attr_num - 1];
+  const int last_len = key_len - offset;
+  char *key_buf = fixed_key.data() + offset;
+  user_key += offset;
 
-    *fixed_key = key_buf;
-    return RC::SUCCESS;
+  // 这里很粗暴，变长字段才需要做调整，其它默认都不需要做调整
+  if (header.attr_types[attr_num - 1] != CHARS) {
+    memcpy(key_buf, user_key, attr_length);
+    return;
+  }
+
+  if (last_len <= attr_length) {
+    memcpy(key_buf, user_key, last_len);
+    return;
   }
 
-  // key_len > attr_length
+  // last_len > attr_length
   memcpy(key_buf, user_key, attr_length);
 
   char c = user_key[attr_length];
   if (c == 0) {
-    *fixed_key = key_buf;
-    return RC::SUCCESS;
+    return;
   }
 
   // 扫描 >=/> user_key 的数据
@@ -1911,11 +2433,8 @@ RC BplusTreeScanner::fix_user_key(
   // 如果是扫描 <=/< user_key的数据
   // 示例：<=/< ABCD1  <==> <= ABCD  (attr_length=4)
   // NOTE: 假设都是普通的ASCII字符，不包含二进制字符，使用char不会溢出
-  *should_inclusive = true;
+  should_inclusive = true;
   if (want_greater) {
     key_buf[attr_length - 1]++;
   }
-
-  *fixed_key = key_buf;
-  return RC::SUCCESS;
 }
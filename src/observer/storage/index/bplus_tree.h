@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include <sstream>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "storage/record/record_manager.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -47,6 +48,8 @@ enum class BplusTreeOperationType
 
 /**
  * @brief 属性比较(BplusTree)
+ * @details 索引的键值可以由多个字段组成，多个字段按照定义的顺序紧密排列在一起，依次比较。
+ * 单个字段的索引就是只有一个字段的特例。
  * @ingroup BPlusTree
  */
 class AttrComparator 
@@ -54,18 +57,60 @@ class AttrComparator
 public:
   void init(AttrType type, int length)
   {
-    attr_type_ = type;
-    attr_length_ = length;
+    init(1, &type, &length);
   }
 
+  void init(int attr_num, const AttrType *types, const int32_t *lengths)
+  {
+    attr_types_.assign(types, types + attr_num);
+    attr_lengths_.assign(lengths, lengths + attr_num);
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      attr_length_ += lengths[i];
+    }
+  }
+
+  /**
+   * @brief 所有字段的总长度
+   */
   int attr_length() const
   {
     return attr_length_;
   }
 
+  int attr_num() const
+  {
+    return static_cast<int>(attr_types_.size());
+  }
+
+  /**
+   * @brief 只比较前 attr_num 个字段的比较器，用于按照最左前缀扫描组合索引
+   */
+  AttrComparator prefix(int attr_num) const
+  {
+    AttrComparator comparator;
+    comparator.init(attr_num, attr_types_.data(), attr_lengths_.data());
+    return comparator;
+  }
+
   int operator()(const char *v1, const char *v2) const
   {
-    switch (attr_type_) {
+    const int attr_num = static_cast<int>(attr_types_.size());
+    for (int i = 0; i < attr_num; i++) {
+      const int result = compare_attr(attr_types_[i], attr_lengths_[i], v1, v2);
+      if (result != 0) {
+        return result;
+      }
+      v1 += attr_lengths_[i];
+      v2 += attr_lengths_[i];
+    }
+    return 0;
+  }
+
+private:
+  static int compare_attr(AttrType attr_type, int attr_length, const char *v1, const char *v2)
+  {
+    switch (attr_type) {
       case INTS: {
         return common::compare_int((void *)v1, (void *)v2);
       } break;
@@ -73,18 +118,19 @@ public:
         return common::compare_float((void *)v1, (void *)v2);
       }
       case CHARS: {
-        return common::compare_string((void *)v1, attr_length_, (void *)v2, attr_length_);
+        return common::compare_string((void *)v1, attr_length, (void *)v2, attr_length);
       }
       default: {
-        ASSERT(false, "unknown attr type. %d", attr_type_);
+        ASSERT(false, "unknown attr type. %d", attr_type);
         return 0;
       }
     }
   }
 
 private:
-  AttrType attr_type_;
-  int attr_length_;
+  std::vector<AttrType> attr_types_;
+  std::vector<int32_t>  attr_lengths_;
+  int attr_length_ = 0;
 };
 
 /**
@@ -98,6 +144,13 @@ public:
   void init(AttrType type, int length)
   {
     attr_comparator_.init(type, length);
+    rid_offset_ = attr_comparator_.attr_length();
+  }
+
+  void init(int attr_num, const AttrType *types, const int32_t *lengths)
+  {
+    attr_comparator_.init(attr_num, types, lengths);
+    rid_offset_ = attr_comparator_.attr_length();
   }
 
   const AttrComparator &attr_comparator() const
@@ -105,6 +158,19 @@ public:
     return attr_comparator_;
   }
 
+  /**
+   * @brief 只比较前 attr_num 个字段和RID的比较器
+   * @details 扫描组合索引时，边界值可能只指定了前面几个字段。这时边界键值中RID取 RID::min 或 RID::max，
+   * 在前缀相同的情况下，边界键值就会比所有真实的键值都小或者都大，与单字段索引的处理方式一致。
+   */
+  KeyComparator prefix(int attr_num) const
+  {
+    KeyComparator comparator;
+    comparator.attr_comparator_ = attr_comparator_.prefix(attr_num);
+    comparator.rid_offset_ = rid_offset_;
+    return comparator;
+  }
+
   int operator()(const char *v1, const char *v2) const
   {
     int result = attr_comparator_(v1, v2);
@@ -112,17 +178,19 @@ public:
       return result;
     }
 
-    const RID *rid1 = (const RID *)(v1 + attr_comparator_.attr_length());
-    const RID *rid2 = (const RID *)(v2 + attr_comparator_.attr_length());
+    const RID *rid1 = (const RID *)(v1 + rid_offset_);
+    const RID *rid2 = (const RID *)(v2 + rid_offset_);
     return RID::compare(rid1, rid2);
   }
 
 private:
   AttrComparator attr_comparator_;
+  int rid_offset_ = 0;  ///< RID 在键值中的偏移，即所有字段的总长度
 };
 
 /**
  * @brief 属性打印,调试使用(BplusTree)
+ * @details 组合索引的多个字段打印成 (v1,v2) 的形式
  * @ingroup BPlusTree
  */
 class AttrPrinter 
@@ -130,8 +198,17 @@ class AttrPrinter
 public:
   void init(AttrType type, int length)
   {
-    attr_type_ = type;
-    attr_length_ = length;
+    init(1, &type, &length);
+  }
+
+  void init(int attr_num, const AttrType *types, const int32_t *lengths)
+  {
+    attr_types_.assign(types, types + attr_num);
+    attr_lengths_.assign(lengths, lengths + attr_num);
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      attr_length_ += lengths[i];
+    }
   }
 
   int attr_length() const
@@ -141,7 +218,27 @@ public:
 
   std::string operator()(const char *v) const
   {
-    switch (attr_type_) {
+    const int attr_num = static_cast<int>(attr_types_.size());
+    if (attr_num == 1) {
+      return print_attr(attr_types_[0], attr_lengths_[0], v);
+    }
+
+    std::string str("(");
+    for (int i = 0; i < attr_num; i++) {
+      if (i != 0) {
+        str.push_back(',');
+      }
+      str.append(print_attr(attr_types_[i], attr_lengths_[i], v));
+      v += attr_lengths_[i];
+    }
+    str.push_back(')');
+    return str;
+  }
+
+private:
+  static std::string print_attr(AttrType attr_type, int attr_length, const char *v)
+  {
+    switch (attr_type) {
       case INTS: {
         return std::to_string(*(int *)v);
       } break;
@@ -150,7 +247,7 @@ public:
       }
       case CHARS: {
         std::string str;
-        for (int i = 0; i < attr_length_; i++) {
+        for (int i = 0; i < attr_length; i++) {
           if (v[i] == 0) {
             break;
           }
@@ -159,15 +256,16 @@ public:
         return str;
       }
       default: {
-        ASSERT(false, "unknown attr type. %d", attr_type_);
+        ASSERT(false, "unknown attr type. %d", attr_type);
       }
     }
     return std::string();
   }
 
 private:
-  AttrType attr_type_;
-  int attr_length_;
+  std::vector<AttrType> attr_types_;
+  std::vector<int32_t>  attr_lengths_;
+  int attr_length_ = 0;
 };
 
 /**
@@ -182,6 +280,11 @@ public:
     attr_printer_.init(type, length);
   }
 
+  void init(int attr_num, const AttrType *types, const int32_t *lengths)
+  {
+    attr_printer_.init(attr_num, types, lengths);
+  }
+
   const AttrPrinter &attr_printer() const
   {
     return attr_printer_;
@@ -205,10 +308,18 @@ private:
  * @brief the meta information of bplus tree
  * @ingroup BPlusTree
  * @details this is the first page of bplus tree.
- * only one field can be supported, can you extend it to multi-fields?
+ * 组合索引的每个字段类型和长度记录在 attr_types/attr_lengths 中，attr_type/attr_length 记录的是第一个字段的类型
+ * 和所有字段的总长度。
+ * 索引文件的格式变化时需要增加 CURRENT_VERSION。老版本的索引文件没有 version 字段，读出来是0，
+ * 它们的叶子节点没有 prev_brother，也没有组合索引的字段信息，不能直接打开，参考 BplusTreeHandler::open
  */
 struct IndexFileHeader 
 {
+  static constexpr int MAX_ATTR_NUM = 16;  ///< 组合索引最多包含的字段个数
+
+  /// 当前的索引文件格式版本号。版本1的叶子节点有 prev_brother，并且记录了组合索引的每个字段
+  static constexpr int32_t CURRENT_VERSION = 1;
+
   IndexFileHeader()
   {
     memset(this, 0, sizeof(IndexFileHeader));
@@ -217,17 +328,23 @@ struct IndexFileHeader
   PageNum root_page;          ///< 根节点在磁盘中的页号
   int32_t internal_max_size;  ///< 内部节点最大的键值对数
   int32_t leaf_max_size;      ///< 叶子节点最大的键值对数
-  int32_t attr_length;        ///< 键值的长度
+  int32_t attr_length;        ///< 键值的长度(所有字段的总长度)
   int32_t key_length;         ///< attr length + sizeof(RID)
-  AttrType attr_type;         ///< 键值的类型
+  AttrType attr_type;         ///< 键值的类型(组合索引的第一个字段)
+  int32_t attr_num;           ///< 字段个数
+  AttrType attr_types[MAX_ATTR_NUM];   ///< 每个字段的类型
+  int32_t  attr_lengths[MAX_ATTR_NUM]; ///< 每个字段的长度
+  int32_t  version;                    ///< 索引文件的格式版本号，参考 CURRENT_VERSION
 
   const std::string to_string()
   {
     std::stringstream ss;
 
-    ss << "attr_length:" << attr_length << ","
+    ss << "version:" << version << ","
+       << "attr_length:" << attr_length << ","
        << "key_length:" << key_length << ","
        << "attr_type:" << attr_type << ","
+       << "attr_num:" << attr_num << ","
        << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
        << "leaf_max_size:" << leaf_max_size << ";";
@@ -268,8 +385,9 @@ struct IndexNode
  */
 struct LeafIndexNode : public IndexNode 
 {
-  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 4;
+  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 8;
 
+  PageNum prev_brother;
   PageNum next_brother;
   /**
    * leaf can store order keys and rids at most
@@ -350,6 +468,8 @@ public:
   void init_empty();
   void set_next_page(PageNum page_num);
   PageNum next_page() const;
+  void set_prev_page(PageNum page_num);
+  PageNum prev_page() const;
 
   char *key_at(int index);
   char *value_at(int index);
@@ -425,11 +545,37 @@ public:
              bool *found = nullptr, 
              int *insert_position = nullptr) const;
 
+  /**
+   * @brief 返回指定key所属的子节点页面号，用于从根节点向下查找叶子节点
+   * @details 乐观读时节点可能正在被修改，读到的数据可能不一致。这里不做断言检查，只保证不会越界访问，
+   * 返回的结果需要校验页帧的版本号之后才能使用。
+   * @return 节点的大小不合法时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum child_page(const KeyComparator &comparator, const char *key) const;
+
+  /**
+   * @brief 与 child_page 类似，返回指定位置的子节点页面号
+   */
+  PageNum child_page_at(int index) const;
+
+  /**
+   * @brief 返回可能包含比 key 小的最大键值的子节点页面号，用于逆序扫描时向前查找
+   * @details 选择最后一个比 key 小的分隔键对应的子节点，没有时选择第一个子节点。与 child_page 一样不做断言检查。
+   * @param[out] separator 选中的子节点对应的分隔键，选中第一个子节点时是 nullptr
+   */
+  PageNum child_page_before(const KeyComparator &comparator, const char *key, const char *&separator) const;
+
   RC move_to(InternalIndexNodeHandler &other, DiskBufferPool *disk_buffer_pool);
   RC move_first_to_end(InternalIndexNodeHandler &other, DiskBufferPool *disk_buffer_pool);
   RC move_last_to_front(InternalIndexNodeHandler &other, DiskBufferPool *bp);
   RC move_half_to(InternalIndexNodeHandler &other, DiskBufferPool *bp);
 
+  /**
+   * @brief 在最后追加一批孩子节点，同时修改孩子节点记录的父节点。批量构建B+树时使用
+   * @param items 连续存放的 key, page_num
+   */
+  RC append_children(const char *items, int num, DiskBufferPool *bp);
+
   bool validate(const KeyComparator &comparator, DiskBufferPool *bp) const;
 
   friend std::string to_string(const InternalIndexNodeHandler &handler, const KeyPrinter &printer);
@@ -461,19 +607,33 @@ public:
   /**
    * 此函数创建一个名为fileName的索引。
    * attrType描述被索引属性的类型，attrLength描述被索引属性的长度
+   * pool_name是索引文件使用的页帧管理器，参考 BufferPoolManager::create_pool
    */
   RC create(const char *file_name, 
             AttrType attr_type, 
             int attr_length, 
             int internal_max_size = -1, 
-            int leaf_max_size = -1);
+            int leaf_max_size = -1,
+            const char *pool_name = nullptr);
+
+  /**
+   * @brief 创建组合索引，键值由多个字段按顺序组成
+   * @param attr_types 每个字段的类型
+   * @param attr_lengths 每个字段的长度
+   */
+  RC create(const char *file_name, 
+            const std::vector<AttrType> &attr_types, 
+            const std::vector<int32_t> &attr_lengths, 
+            int internal_max_size = -1, 
+            int leaf_max_size = -1,
+            const char *pool_name = nullptr);
 
   /**
    * 打开名为fileName的索引文件。
    * 如果方法调用成功，则indexHandle为指向被打开的索引句柄的指针。
    * 索引句柄用于在索引中插入或删除索引项，也可用于索引的扫描
    */
-  RC open(const char *file_name);
+  RC open(const char *file_name, const char *pool_name = nullptr);
 
   /**
    * 关闭句柄indexHandle对应的索引文件
@@ -504,6 +664,20 @@ public:
    */
   RC get_entry(const char *user_key, int key_len, std::list<RID> &rids);
 
+  /**
+   * @brief 自底向上批量构建B+树，只能在空的树上调用
+   * @details 从左到右依次写叶子节点，每个节点按照填充率放入 key，然后逐层向上构建内部节点。
+   * 同一层的节点平均分配 key，除了根节点，每个节点的 key 都不少于 min_size。
+   * 这里不加锁，调用者需要保证构建时没有其它人访问这棵树
+   * @param entry_num       一共有多少个 key
+   * @param next_key        按照从小到大的顺序返回下一个 key(user key + RID)
+   * @param fill_factor_pct 节点的填充率(百分比)
+   */
+  RC bulk_build(int64_t entry_num, const std::function<RC(const char *&key)> &next_key, int fill_factor_pct);
+
+  const IndexFileHeader &file_header() const { return file_header_; }
+  const KeyComparator   &key_comparator() const { return key_comparator_; }
+
   RC sync();
 
   /**
@@ -533,9 +707,19 @@ private:
 protected:
   RC find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op, const char *key, Frame *&frame);
   RC left_most_page(LatchMemo &latch_memo, Frame *&frame);
+  RC right_most_page(LatchMemo &latch_memo, Frame *&frame);
   RC find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperationType op, 
                         const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
                         Frame *&frame);
+  /**
+   * @brief 使用乐观读的方式查找叶子节点
+   * @details 内部节点只pin住而不加锁，读取子节点的页面号之后校验页帧的版本号，到达叶子节点后再加读锁。
+   * 根节点和内部节点是最热的页面，这样读操作就不需要修改这些页面上的锁状态。
+   * @return 遇到并发修改时返回 RC::LOCKED_CONCURRENCY_CONFLICT，此时 latch_memo 中还有资源需要调用者释放
+   */
+  RC optimistic_find_leaf(LatchMemo &latch_memo, 
+                          const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, 
+                          Frame *&frame);
   RC crabing_protocal_fetch_page(LatchMemo &latch_memo, BplusTreeOperationType op, PageNum page_num, bool is_root_page,
                                  Frame *&frame);
 
@@ -555,6 +739,13 @@ protected:
 
   RC insert_entry_into_parent(LatchMemo &latch_memo, Frame *frame, Frame *new_frame, const char *key);
   RC insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *frame, const char *pkey, const RID *rid);
+
+  /**
+   * @brief 叶子节点分裂或合并后，修改右边兄弟节点的 prev_brother
+   * @details 叶子节点从左向右加锁，右边的兄弟节点可能被其它从上往下加锁的线程持有，直接加锁可能会死锁，
+   * 所以这里只尝试加锁。加锁失败时留下一个过期的 prev_brother，逆序扫描时会校验并退回到从根节点查找。
+   */
+  void link_prev_page(LatchMemo &latch_memo, PageNum page_num, PageNum prev_page_num);
   RC create_new_tree(const char *key, const RID *rid);
 
   void update_root_page_num(PageNum root_page_num);
@@ -562,6 +753,12 @@ protected:
 
   RC adjust_root(LatchMemo &latch_memo, Frame *root_frame);
 
+  /**
+   * @brief 批量构建时写一层内部节点
+   * @param children 下一层每个节点的第一个 key 和页面号，返回时是这一层的
+   */
+  RC bulk_build_internal_level(std::vector<char> &children, int fill_factor_pct);
+
 private:
   common::MemPoolItem::unique_ptr make_key(const char *user_key, const RID &rid);
   void free_key(char *key);
@@ -598,28 +795,56 @@ public:
   /**
    * @brief 扫描指定范围的数据
    * @param left_user_key 扫描范围的左边界，如果是null，则没有左边界
-   * @param left_len left_user_key 的内存大小(只有在变长字段中才会关注)
+   * @param left_len left_user_key 的内存大小(只有在变长字段中才会关注)。组合索引可以只指定前面几个字段
    * @param left_inclusive 左边界的值是否包含在内
    * @param right_user_key 扫描范围的右边界。如果是null，则没有右边界
    * @param right_len right_user_key 的内存大小(只有在变长字段中才会关注)
    * @param right_inclusive 右边界的值是否包含在内
+   * @param descending 是否按照键值从大到小的顺序扫描，此时从右边界开始沿着 prev_brother 向左扫描
    */
   RC open(const char *left_user_key, int left_len, bool left_inclusive, 
-          const char *right_user_key, int right_len, bool right_inclusive);
+          const char *right_user_key, int right_len, bool right_inclusive, bool descending = false);
 
   RC next_entry(RID &rid);
 
+  /**
+   * @brief 最近一次 next_entry 返回的数据对应的键值
+   * @details 键值前面是索引字段的值，后面是RID。在下一次调用 next_entry 之前有效
+   */
+  const char *current_key() const;
+
   RC close();
 
 private:
   /**
-   * 如果key的类型是CHARS, 扩展或缩减user_key的大小刚好是schema中定义的大小
+   * @brief 把用户输入的边界值转换成完整长度的字段值，没有指定的字段填0
+   * @details 如果最后一个字段的类型是CHARS, 扩展或缩减它的大小刚好是schema中定义的大小
    */
-  RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
+  void fix_user_key(const char *user_key, int key_len, bool want_greater, std::vector<char> &fixed_key,
+                    bool &should_inclusive);
+
+  /**
+   * @brief 边界值包含几个字段
+   * @details 组合索引的边界值是前面若干个字段的值按顺序拼接起来的，最后一个字段可以不完整(CHARS)
+   */
+  int bound_attr_num(int key_len) const;
 
   void fetch_item(RID &rid);
   bool touch_end();
 
+  /**
+   * @brief 逆序扫描时定位到比 key 小的最大的键值
+   * @details 从根节点向下查找，找不到时 current_frame_ 是 nullptr
+   */
+  RC locate_prev(const KeyComparator &comparator, const char *key);
+
+  /**
+   * @brief 逆序扫描时移动到前一个叶子节点的最后一个键值
+   * @details 优先使用 prev_brother，它可能是过期的，所以需要校验前一个节点的 next_brother 是否指向当前节点，
+   * 校验失败时从根节点重新查找
+   */
+  RC move_to_prev_page();
+
 private:
   bool inited_ = false;
   BplusTreeHandler &tree_handler_;
@@ -631,6 +856,10 @@ private:
   Frame *current_frame_ = nullptr;
 
   common::MemPoolItem::unique_ptr right_key_;
+  KeyComparator right_comparator_;  ///< 比较右边界使用的比较器，只比较右边界包含的字段
+  common::MemPoolItem::unique_ptr left_key_;  ///< 逆序扫描时的结束位置
+  KeyComparator left_comparator_;
+  bool descending_ = false;
   int iter_index_ = -1;
   bool first_emitted_ = false;
 };
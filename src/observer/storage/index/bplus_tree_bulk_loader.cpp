@@ -0,0 +1,234 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <queue>
+
+#include "storage/index/bplus_tree_bulk_loader.h"
+#include "storage/index/bplus_tree.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+/// 归并时每个有序段的读缓存
+static constexpr int RUN_READ_BUFFER_SIZE = 256 * 1024;
+
+static BplusTreeBulkLoadOptions bulk_load_default_options;
+
+namespace {
+
+/**
+ * @brief 顺序读取一个有序段
+ */
+class RunReader
+{
+public:
+  RunReader(int key_length) : key_length_(key_length) {}
+
+  RC open(const string &file_name)
+  {
+    file_.open(file_name, ios_base::in | ios_base::binary);
+    if (!file_.is_open()) {
+      LOG_WARN("failed to open sort run file. file=%s, errmsg=%s", file_name.c_str(), strerror(errno));
+      return RC::IOERR_OPEN;
+    }
+    buffer_.resize(max(1, RUN_READ_BUFFER_SIZE / key_length_) * static_cast<size_t>(key_length_));
+    return next();
+  }
+
+  /// 移动到下一个 key，读完时 current 返回 nullptr
+  RC next()
+  {
+    offset_ += key_length_;
+    if (offset_ < size_) {
+      return RC::SUCCESS;
+    }
+
+    file_.read(buffer_.data(), buffer_.size());
+    size_   = static_cast<size_t>(file_.gcount()) / key_length_ * key_length_;
+    offset_ = 0;
+    if (file_.bad()) {
+      LOG_WARN("failed to read sort run file. errmsg=%s", strerror(errno));
+      return RC::IOERR_READ;
+    }
+    return RC::SUCCESS;
+  }
+
+  const char *current() const { return offset_ < size_ ? buffer_.data() + offset_ : nullptr; }
+
+private:
+  int          key_length_;
+  ifstream     file_;
+  vector<char> buffer_;
+  size_t       offset_ = 0;
+  size_t       size_   = 0;
+};
+
+}  // namespace
+
+const BplusTreeBulkLoadOptions &BplusTreeBulkLoader::default_options() { return bulk_load_default_options; }
+
+void BplusTreeBulkLoader::set_default_options(const BplusTreeBulkLoadOptions &options)
+{
+  bulk_load_default_options = options;
+}
+
+BplusTreeBulkLoader::BplusTreeBulkLoader(
+    BplusTreeHandler &tree_handler, const char *tmp_file_prefix, const BplusTreeBulkLoadOptions &options)
+    : tree_handler_(tree_handler), tmp_file_prefix_(tmp_file_prefix), options_(options)
+{
+  key_length_ = tree_handler_.file_header().key_length;
+}
+
+BplusTreeBulkLoader::~BplusTreeBulkLoader()
+{
+  for (const string &run_file : run_files_) {
+    ::remove(run_file.c_str());
+  }
+}
+
+RC BplusTreeBulkLoader::add_entry(const char *user_key, const RID &rid)
+{
+  const size_t memory_limit = static_cast<size_t>(max(options_.sort_memory_mb, 1)) * 1024 * 1024;
+  if (buffer_.size() + key_length_ > memory_limit) {
+    RC rc = spill_run();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  const int attr_length = tree_handler_.file_header().attr_length;
+  const size_t offset = buffer_.size();
+  buffer_.resize(offset + key_length_);
+  memcpy(buffer_.data() + offset, user_key, attr_length);
+  memcpy(buffer_.data() + offset + attr_length, &rid, sizeof(rid));
+  entry_num_++;
+  return RC::SUCCESS;
+}
+
+void BplusTreeBulkLoader::sort_buffer()
+{
+  sorted_keys_.clear();
+  sorted_keys_.reserve(buffer_.size() / key_length_);
+  for (size_t offset = 0; offset < buffer_.size(); offset += key_length_) {
+    sorted_keys_.push_back(buffer_.data() + offset);
+  }
+
+  const KeyComparator &comparator = tree_handler_.key_comparator();
+  sort(sorted_keys_.begin(), sorted_keys_.end(),
+      [&comparator](const char *key1, const char *key2) { return comparator(key1, key2) < 0; });
+}
+
+RC BplusTreeBulkLoader::spill_run()
+{
+  sort_buffer();
+
+  string   run_file = tmp_file_prefix_ + ".sort." + to_string(run_files_.size());
+  ofstream out(run_file, ios_base::out | ios_base::binary | ios_base::trunc);
+  if (!out.is_open()) {
+    LOG_WARN("failed to create sort run file. file=%s, errmsg=%s", run_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  run_files_.push_back(run_file);
+
+  for (const char *key : sorted_keys_) {
+    out.write(key, key_length_);
+  }
+  out.close();
+  if (out.fail()) {
+    LOG_WARN("failed to write sort run file. file=%s, errmsg=%s", run_file.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  LOG_INFO("spill a sort run while bulk loading. file=%s, entry num=%d", run_file.c_str(), (int)sorted_keys_.size());
+  sorted_keys_.clear();
+  buffer_.clear();
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::finish()
+{
+  const int fill_factor_pct = options_.fill_factor_pct;
+
+  // 数据都在内存中时，不需要写临时文件
+  if (run_files_.empty()) {
+    sort_buffer();
+    size_t index = 0;
+    RC rc = tree_handler_.bulk_build(entry_num_, [this, &index](const char *&key) {
+      key = sorted_keys_[index++];
+      return RC::SUCCESS;
+    }, fill_factor_pct);
+    sorted_keys_.clear();
+    buffer_.clear();
+    return rc;
+  }
+
+  RC rc = spill_run();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return merge_runs();
+}
+
+RC BplusTreeBulkLoader::merge_runs()
+{
+  vector<unique_ptr<RunReader>> readers;
+  for (const string &run_file : run_files_) {
+    readers.push_back(make_unique<RunReader>(key_length_));
+    RC rc = readers.back()->open(run_file);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  // 每次从各个有序段当前最小的 key 中取出最小的一个
+  const KeyComparator &comparator = tree_handler_.key_comparator();
+  auto greater = [&comparator](const RunReader *r1, const RunReader *r2) {
+    return comparator(r1->current(), r2->current()) > 0;
+  };
+  priority_queue<RunReader *, vector<RunReader *>, decltype(greater)> heap(greater);
+  for (unique_ptr<RunReader> &reader : readers) {
+    if (reader->current() != nullptr) {
+      heap.push(reader.get());
+    }
+  }
+
+  // 返回的 key 要一直有效到下一次调用，读取下一个 key 可能会覆盖读缓存，所以要复制出来
+  vector<char> current_key(key_length_);
+  RC rc = tree_handler_.bulk_build(entry_num_, [&](const char *&key) {
+    if (heap.empty()) {
+      LOG_WARN("sort runs have less entries than expected. entry num=%ld", entry_num_);
+      return RC::INTERNAL;
+    }
+
+    RunReader *reader = heap.top();
+    heap.pop();
+    memcpy(current_key.data(), reader->current(), key_length_);
+    key = current_key.data();
+
+    RC rc = reader->next();
+    if (OB_SUCC(rc) && reader->current() != nullptr) {
+      heap.push(reader);
+    }
+    return rc;
+  }, options_.fill_factor_pct);
+
+  LOG_INFO("merged %d sort runs while bulk loading. entry num=%ld, rc=%s", run_num(), entry_num_, strrc(rc));
+  return rc;
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/rc.h"
+#include "storage/record/record.h"
+
+class BplusTreeHandler;
+
+/**
+ * @brief 批量构建B+树的参数
+ * @ingroup BPlusTree
+ */
+struct BplusTreeBulkLoadOptions
+{
+  int fill_factor_pct = 90;  ///< 节点的填充率(百分比)，给后面的插入留出一些空间
+  int sort_memory_mb  = 64;  ///< 排序使用的内存，超过之后会把排好序的数据写到临时文件中
+};
+
+/**
+ * @brief 批量构建B+树
+ * @ingroup BPlusTree
+ * @details 创建索引时，逐条插入需要每次从根节点查找叶子节点，分裂后的节点也只有一半的数据。
+ * 这里先收集所有的 (key, RID)，使用外部排序排好序，再调用 BplusTreeHandler::bulk_build
+ * 从左到右写叶子节点并自底向上构建内部节点。
+ * 收集的数据超过内存限制时，排好序写到临时文件中作为一个有序段(run)，最后多路归并所有的有序段。
+ * 临时文件在对象销毁时删除。
+ */
+class BplusTreeBulkLoader
+{
+public:
+  /**
+   * @param tmp_file_prefix 临时文件的前缀，通常就是索引文件的名字
+   */
+  BplusTreeBulkLoader(BplusTreeHandler &tree_handler, const char *tmp_file_prefix,
+      const BplusTreeBulkLoadOptions &options = default_options());
+  ~BplusTreeBulkLoader();
+
+  /**
+   * @brief 加入一个索引项
+   * @note 这里假设user_key的内存大小与attr_length 一致
+   */
+  RC add_entry(const char *user_key, const RID &rid);
+
+  /**
+   * @brief 排序并构建B+树
+   */
+  RC finish();
+
+  int64_t entry_num() const { return entry_num_; }
+  int     run_num() const { return static_cast<int>(run_files_.size()); }
+
+  static const BplusTreeBulkLoadOptions &default_options();
+  static void                            set_default_options(const BplusTreeBulkLoadOptions &options);
+
+private:
+  /// 对内存中的数据排序，结果放在 sorted_keys_ 中
+  void sort_buffer();
+  /// 把内存中的数据排好序写到一个新的临时文件中
+  RC spill_run();
+  RC merge_runs();
+
+private:
+  BplusTreeHandler        &tree_handler_;
+  std::string              tmp_file_prefix_;
+  BplusTreeBulkLoadOptions options_;
+
+  int                       key_length_ = 0;
+  std::vector<char>         buffer_;       ///< 还没有写到临时文件中的 key
+  std::vector<const char *> sorted_keys_;  ///< 排好序的 buffer_ 中的 key
+  std::vector<std::string>  run_files_;
+  int64_t                   entry_num_ = 0;
+};
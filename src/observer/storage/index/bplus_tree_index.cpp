@@ -15,12 +15,15 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/bplus_tree_index.h"
 #include "common/log/log.h"
 
+using namespace std;
+
 BplusTreeIndex::~BplusTreeIndex() noexcept
 {
   close();
 }
 
-RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas,
+    const char *pool_name /* = nullptr */)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -30,9 +33,17 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
+
+  vector<AttrType> attr_types;
+  vector<int32_t> attr_lengths;
+  for (const FieldMeta &field_meta : field_metas) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len());
+  }
 
-  RC rc = index_handler_.create(file_name, field_meta.type(), field_meta.len());
+  RC rc = index_handler_.create(file_name, attr_types, attr_lengths, -1 /*internal_max_size*/,
+      -1 /*leaf_max_size*/, pool_name);
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name,
@@ -48,7 +59,8 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
   return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas,
+    const char *pool_name /* = nullptr */)
 {
   if (inited_) {
     LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s, field:%s",
@@ -58,9 +70,9 @@ RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, cons
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
-  RC rc = index_handler_.open(file_name);
+  RC rc = index_handler_.open(file_name, pool_name);
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to open index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name,
@@ -89,19 +101,21 @@ RC BplusTreeIndex::close()
 
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  vector<char> key_buf;
+  return index_handler_.insert_entry(make_user_key(record, key_buf), rid);
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  vector<char> key_buf;
+  return index_handler_.delete_entry(make_user_key(record, key_buf), rid);
 }
 
-IndexScanner *BplusTreeIndex::create_scanner(
-    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+IndexScanner *BplusTreeIndex::create_scanner(const char *left_key, int left_len, bool left_inclusive,
+    const char *right_key, int right_len, bool right_inclusive, bool descending)
 {
   BplusTreeIndexScanner *index_scanner = new BplusTreeIndexScanner(index_handler_);
-  RC rc = index_scanner->open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+  RC rc = index_scanner->open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive, descending);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to open index scanner. rc=%d:%s", rc, strrc(rc));
     delete index_scanner;
@@ -115,6 +129,35 @@ RC BplusTreeIndex::sync()
   return index_handler_.sync();
 }
 
+RC BplusTreeIndex::begin_bulk_load(const char *tmp_file_prefix)
+{
+  if (!index_handler_.is_empty()) {
+    LOG_WARN("cannot bulk load an index that is not empty. index:%s", index_meta_.name());
+    return RC::INTERNAL;
+  }
+  bulk_loader_ = std::make_unique<BplusTreeBulkLoader>(index_handler_, tmp_file_prefix);
+  return RC::SUCCESS;
+}
+
+RC BplusTreeIndex::bulk_insert_entry(const char *record, const RID *rid)
+{
+  vector<char> key_buf;
+  return bulk_loader_->add_entry(make_user_key(record, key_buf), *rid);
+}
+
+RC BplusTreeIndex::finish_bulk_load()
+{
+  RC rc = bulk_loader_->finish();
+  LOG_INFO("bulk load index done. index:%s, entry num=%ld, sort runs=%d, rc=%s",
+           index_meta_.name(), bulk_loader_->entry_num(), bulk_loader_->run_num(), strrc(rc));
+  bulk_loader_.reset();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  // 索引的修改没有日志，构建完之后直接写到磁盘上
+  return index_handler_.sync();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BplusTreeIndexScanner::BplusTreeIndexScanner(BplusTreeHandler &tree_handler) : tree_scanner_(tree_handler)
 {}
@@ -124,10 +167,10 @@ BplusTreeIndexScanner::~BplusTreeIndexScanner() noexcept
   tree_scanner_.close();
 }
 
-RC BplusTreeIndexScanner::open(
-    const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
+RC BplusTreeIndexScanner::open(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+    int right_len, bool right_inclusive, bool descending)
 {
-  return tree_scanner_.open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
+  return tree_scanner_.open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive, descending);
 }
 
 RC BplusTreeIndexScanner::next_entry(RID *rid)
@@ -135,6 +178,11 @@ RC BplusTreeIndexScanner::next_entry(RID *rid)
   return tree_scanner_.next_entry(*rid);
 }
 
+const char *BplusTreeIndexScanner::current_key() const
+{
+  return tree_scanner_.current_key();
+}
+
 RC BplusTreeIndexScanner::destroy()
 {
   delete this;
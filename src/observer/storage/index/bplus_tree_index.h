@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/index/index.h"
 #include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_bulk_loader.h"
 
 /**
  * @brief B+树索引
@@ -27,8 +28,10 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
-  RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC create(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas,
+            const char *pool_name = nullptr);
+  RC open(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas,
+          const char *pool_name = nullptr);
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
@@ -38,13 +41,24 @@ public:
    * 扫描指定范围的数据
    */
   IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
-      int right_len, bool right_inclusive) override;
+      int right_len, bool right_inclusive, bool descending) override;
 
   RC sync() override;
 
+  /**
+   * @brief 批量构建空的索引，创建索引时使用
+   * @details 先调用 begin_bulk_load，然后使用 bulk_insert_entry 加入所有的记录，
+   * 最后调用 finish_bulk_load 排序并构建B+树。参考 BplusTreeBulkLoader
+   * @param tmp_file_prefix 外部排序的临时文件前缀
+   */
+  RC begin_bulk_load(const char *tmp_file_prefix);
+  RC bulk_insert_entry(const char *record, const RID *rid);
+  RC finish_bulk_load();
+
 private:
   bool inited_ = false;
   BplusTreeHandler index_handler_;
+  std::unique_ptr<BplusTreeBulkLoader> bulk_loader_;
 };
 
 /**
@@ -58,10 +72,11 @@ public:
   ~BplusTreeIndexScanner() noexcept override;
 
   RC next_entry(RID *rid) override;
+  const char *current_key() const override;
   RC destroy() override;
 
   RC open(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
-      bool right_inclusive);
+      bool right_inclusive, bool descending);
 
 private:
   BplusTreeScanner tree_scanner_;
@@ -14,9 +14,22 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/index/index.h"
 
-RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC Index::init(const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas)
 {
   index_meta_ = index_meta;
-  field_meta_ = field_meta;
+  field_metas_ = field_metas;
   return RC::SUCCESS;
 }
+
+const char *Index::make_user_key(const char *record, std::vector<char> &key_buf) const
+{
+  if (field_metas_.size() == 1) {
+    return record + field_metas_[0].offset();
+  }
+
+  key_buf.clear();
+  for (const FieldMeta &field_meta : field_metas_) {
+    key_buf.insert(key_buf.end(), record + field_meta.offset(), record + field_meta.offset() + field_meta.len());
+  }
+  return key_buf.data();
+}
@@ -70,9 +70,10 @@ public:
    * @param right_key 要扫描的右边界
    * @param right_len 右边界的长度
    * @param right_inclusive 是否包含右边界
+   * @param descending 是否按照索引键值从大到小的顺序返回数据
    */
   virtual IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
-      int right_len, bool right_inclusive) = 0;
+      int right_len, bool right_inclusive, bool descending) = 0;
 
   /**
    * @brief 同步索引数据到磁盘
@@ -81,11 +82,17 @@ public:
   virtual RC sync() = 0;
 
 protected:
-  RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC init(const IndexMeta &index_meta, const std::vector<FieldMeta> &field_metas);
+
+  /**
+   * @brief 从记录中取出索引的键值
+   * @details 单字段索引直接返回记录中字段的位置；组合索引把多个字段按顺序拼接到 key_buf 中
+   */
+  const char *make_user_key(const char *record, std::vector<char> &key_buf) const;
 
 protected:
-  IndexMeta index_meta_;  ///< 索引的元数据
-  FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
+  IndexMeta index_meta_;                ///< 索引的元数据
+  std::vector<FieldMeta> field_metas_;  ///< 索引包含的字段，组合索引按照定义的顺序排列
 };
 
 /**
@@ -103,5 +110,11 @@ public:
    * 如果没有更多的元素，返回RECORD_EOF
    */
   virtual RC next_entry(RID *rid) = 0;
+
+  /**
+   * @brief 最近一次 next_entry 返回的数据在索引中保存的字段值
+   * @details 各个索引字段的值按照索引字段的顺序拼接在一起，覆盖索引扫描时用来构造记录
+   */
+  virtual const char *current_key() const = 0;
   virtual RC destroy() = 0;
 };
@@ -21,23 +21,45 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_FIELD_NAMES("field_names");
 
 RC IndexMeta::init(const char *name, const FieldMeta &field)
+{
+  return init(name, std::vector<FieldMeta>{field});
+}
+
+RC IndexMeta::init(const char *name, const std::vector<FieldMeta> &fields)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
     return RC::INVALID_ARGUMENT;
   }
 
+  if (fields.empty()) {
+    LOG_ERROR("Failed to init index, no field. name=%s", name);
+    return RC::INVALID_ARGUMENT;
+  }
+
   name_ = name;
-  field_ = field.name();
+  fields_.clear();
+  for (const FieldMeta &field : fields) {
+    fields_.push_back(field.name());
+  }
   return RC::SUCCESS;
 }
 
 void IndexMeta::to_json(Json::Value &json_value) const
 {
   json_value[FIELD_NAME] = name_;
-  json_value[FIELD_FIELD_NAME] = field_;
+  // 第一个字段仍然记录在 field_name 中，与单字段索引的格式兼容
+  json_value[FIELD_FIELD_NAME] = fields_[0];
+  if (fields_.size() > 1) {
+    Json::Value field_names;
+    for (const std::string &field : fields_) {
+      field_names.append(field);
+    }
+    json_value[FIELD_FIELD_NAMES] = std::move(field_names);
+  }
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -56,13 +78,34 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::INTERNAL;
   }
 
-  const FieldMeta *field = table.field(field_value.asCString());
-  if (nullptr == field) {
-    LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_value.asCString());
-    return RC::SCHEMA_FIELD_MISSING;
+  std::vector<std::string> field_names;
+  const Json::Value &field_names_value = json_value[FIELD_FIELD_NAMES];
+  if (field_names_value.isArray()) {
+    for (int i = 0; i < static_cast<int>(field_names_value.size()); i++) {
+      const Json::Value &value = field_names_value[i];
+      if (!value.isString()) {
+        LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
+            name_value.asCString(),
+            value.toStyledString().c_str());
+        return RC::INTERNAL;
+      }
+      field_names.push_back(value.asString());
+    }
+  } else {
+    field_names.push_back(field_value.asString());
+  }
+
+  std::vector<FieldMeta> fields;
+  for (const std::string &field_name : field_names) {
+    const FieldMeta *field = table.field(field_name.c_str());
+    if (nullptr == field) {
+      LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_name.c_str());
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    fields.push_back(*field);
   }
 
-  return index.init(name_value.asCString(), *field);
+  return index.init(name_value.asCString(), fields);
 }
 
 const char *IndexMeta::name() const
@@ -72,10 +115,26 @@ const char *IndexMeta::name() const
 
 const char *IndexMeta::field() const
 {
-  return field_.c_str();
+  return fields_[0].c_str();
+}
+
+const char *IndexMeta::field(int i) const
+{
+  return fields_[i].c_str();
+}
+
+int IndexMeta::field_num() const
+{
+  return static_cast<int>(fields_.size());
 }
 
 void IndexMeta::desc(std::ostream &os) const
 {
-  os << "index name=" << name_ << ", field=" << field_;
-}
\ No newline at end of file
+  os << "index name=" << name_ << ", field=";
+  for (size_t i = 0; i < fields_.size(); i++) {
+    if (i != 0) {
+      os << ",";
+    }
+    os << fields_[i];
+  }
+}
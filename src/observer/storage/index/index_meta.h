@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <string>
+#include <vector>
 #include "common/rc.h"
 
 class TableMeta;
@@ -36,10 +37,17 @@ public:
   IndexMeta() = default;
 
   RC init(const char *name, const FieldMeta &field);
+  RC init(const char *name, const std::vector<FieldMeta> &fields);
 
 public:
   const char *name() const;
+
+  /**
+   * @brief 索引的第一个字段
+   */
   const char *field() const;
+  const char *field(int i) const;
+  int field_num() const;
 
   void desc(std::ostream &os) const;
 
@@ -48,6 +56,6 @@ public:
   static RC from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index);
 
 protected:
-  std::string name_;   // index's name
-  std::string field_;  // field's name
+  std::string name_;                 // index's name
+  std::vector<std::string> fields_;  // fields' name, 组合索引有多个字段
 };
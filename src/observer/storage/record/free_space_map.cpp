@@ -0,0 +1,302 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "storage/record/free_space_map.h"
+#include "common/io/io.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+/**
+ * @brief 空闲空间表文件的文件头，后面跟着每个页面的 level
+ */
+struct FreeSpaceMapFileHeader
+{
+  static constexpr int32_t MAGIC = 0x46534d31;  // FSM1
+
+  int32_t magic;
+  PageNum max_page_num;  ///< 保存时的最大页号，与数据文件对不上时文件就失效了
+};
+
+/**
+ * @brief 每个线程第一次插入时分配一个编号，按照编号选择自己的分区
+ */
+static int thread_index()
+{
+  static atomic<int> thread_counter{0};
+  thread_local int   index = thread_counter.fetch_add(1);
+  return index;
+}
+
+FreeSpaceMap::FreeSpaceMap()
+{
+  for (atomic<atomic<uint8_t> *> &chunk : chunks_) {
+    chunk.store(nullptr);
+  }
+}
+
+FreeSpaceMap::~FreeSpaceMap()
+{
+  for (atomic<atomic<uint8_t> *> &chunk : chunks_) {
+    delete[] chunk.load();
+  }
+}
+
+void FreeSpaceMap::init(int partition_num /* = 0 */)
+{
+  if (partition_num <= 0) {
+    partition_num = max(1, static_cast<int>(thread::hardware_concurrency()));
+  }
+
+  partitions_.clear();
+  for (int i = 0; i < partition_num; i++) {
+    partitions_.emplace_back(make_unique<Partition>());
+  }
+
+  for (atomic<atomic<uint8_t> *> &chunk : chunks_) {
+    delete[] chunk.exchange(nullptr);
+  }
+  max_page_num_.store(0);
+}
+
+atomic<uint8_t> *FreeSpaceMap::chunk(PageNum page_num, bool create) const
+{
+  const int chunk_index = page_num / CHUNK_PAGE_NUM;
+  if (page_num < 0 || chunk_index >= MAX_CHUNK_NUM) {
+    return nullptr;
+  }
+
+  atomic<uint8_t> *chunk = chunks_[chunk_index].load(memory_order_acquire);
+  if (chunk != nullptr || !create) {
+    return chunk;
+  }
+
+  // 多个线程同时分配时，只有一个能成功
+  atomic<uint8_t> *new_chunk = new atomic<uint8_t>[CHUNK_PAGE_NUM];
+  for (int i = 0; i < CHUNK_PAGE_NUM; i++) {
+    new_chunk[i].store(FULL_LEVEL, memory_order_relaxed);
+  }
+  if (chunks_[chunk_index].compare_exchange_strong(chunk, new_chunk, memory_order_acq_rel)) {
+    return new_chunk;
+  }
+  delete[] new_chunk;
+  return chunk;
+}
+
+uint8_t FreeSpaceMap::level(PageNum page_num) const
+{
+  atomic<uint8_t> *levels = chunk(page_num, false /*create*/);
+  if (nullptr == levels) {
+    return FULL_LEVEL;
+  }
+  return levels[page_num % CHUNK_PAGE_NUM].load(memory_order_relaxed);
+}
+
+void FreeSpaceMap::update(PageNum page_num, uint8_t level)
+{
+  atomic<uint8_t> *levels = chunk(page_num, true /*create*/);
+  if (nullptr == levels) {
+    LOG_WARN("page num is out of range of free space map. page num=%d", page_num);
+    return;
+  }
+
+  PageNum max_page_num = max_page_num_.load();
+  while (page_num > max_page_num && !max_page_num_.compare_exchange_weak(max_page_num, page_num)) {
+  }
+
+  const uint8_t old_level = levels[page_num % CHUNK_PAGE_NUM].exchange(level, memory_order_relaxed);
+
+  // 页面从满变成有空闲空间时，分区中的查找位置要退回来，否则就找不到这个页面了
+  if (old_level == FULL_LEVEL && level != FULL_LEVEL) {
+    Partition &partition = *partitions_[page_num % partitions_.size()];
+    lock_guard<Mutex> guard(partition.lock);
+    partition.cursor = min(partition.cursor, page_num / static_cast<int>(partitions_.size()));
+  }
+}
+
+FreeSpaceMap::Partition &FreeSpaceMap::home_partition()
+{
+  return *partitions_[thread_index() % partitions_.size()];
+}
+
+PageNum FreeSpaceMap::search_partition(int partition_index, PageNum exclude)
+{
+  Partition    &partition     = *partitions_[partition_index];
+  const int     partition_num = static_cast<int>(partitions_.size());
+  const PageNum max_page_num  = max_page_num_.load();
+  for (int i = partition.cursor; i * partition_num + partition_index <= max_page_num; i++) {
+    const PageNum page_num = i * partition_num + partition_index;
+    if (level(page_num) == FULL_LEVEL) {
+      // 前面的页面都满了，下次从后面开始找
+      if (i == partition.cursor) {
+        partition.cursor++;
+      }
+      continue;
+    }
+
+    if (page_num != exclude) {
+      return page_num;
+    }
+  }
+  return BP_INVALID_PAGE_NUM;
+}
+
+PageNum FreeSpaceMap::find_page()
+{
+  const int  partition_num = static_cast<int>(partitions_.size());
+  const int  home_index    = thread_index() % partition_num;
+  Partition &home          = *partitions_[home_index];
+
+  {
+    lock_guard<Mutex> guard(home.lock);
+    if (home.target != BP_INVALID_PAGE_NUM && level(home.target) != FULL_LEVEL) {
+      return home.target;
+    }
+
+    home.target = search_partition(home_index, BP_INVALID_PAGE_NUM);
+    if (home.target != BP_INVALID_PAGE_NUM) {
+      return home.target;
+    }
+  }
+
+  // 自己的分区中没有空闲的页面了，从其它分区中找，不使用其它分区正在插入的页面
+  for (int i = 1; i < partition_num; i++) {
+    const int  partition_index = (home_index + i) % partition_num;
+    Partition &partition       = *partitions_[partition_index];
+    PageNum    page_num        = BP_INVALID_PAGE_NUM;
+    {
+      lock_guard<Mutex> guard(partition.lock);
+      page_num = search_partition(partition_index, partition.target);
+    }
+
+    if (page_num != BP_INVALID_PAGE_NUM) {
+      set_target(page_num);
+      return page_num;
+    }
+  }
+  return BP_INVALID_PAGE_NUM;
+}
+
+void FreeSpaceMap::set_target(PageNum page_num)
+{
+  Partition        &home = home_partition();
+  lock_guard<Mutex> guard(home.lock);
+  home.target = page_num;
+}
+
+int FreeSpaceMap::free_page_num() const
+{
+  int count = 0;
+  for (PageNum page_num = 0; page_num <= max_page_num_.load(); page_num++) {
+    if (level(page_num) != FULL_LEVEL) {
+      count++;
+    }
+  }
+  return count;
+}
+
+RC FreeSpaceMap::load(const char *file_name, PageNum max_page_num)
+{
+  int fd = ::open(file_name, O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return RC::FILE_NOT_EXIST;
+    }
+    LOG_WARN("failed to open free space map file. file=%s, error=%s", file_name, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  RC rc = RC::SUCCESS;
+  FreeSpaceMapFileHeader header;
+  if (readn(fd, &header, sizeof(header)) != 0 || header.magic != FreeSpaceMapFileHeader::MAGIC) {
+    LOG_WARN("invalid free space map file. file=%s", file_name);
+    rc = RC::IOERR_READ;
+  } else if (header.max_page_num != max_page_num) {
+    LOG_INFO("free space map file is out of date. file=%s, max page num=%d, data file max page num=%d",
+             file_name, header.max_page_num, max_page_num);
+    rc = RC::INVALID_ARGUMENT;
+  }
+
+  vector<uint8_t> levels;
+  if (OB_SUCC(rc)) {
+    levels.resize(max_page_num + 1);
+    if (readn(fd, levels.data(), static_cast<int>(levels.size())) != 0) {
+      LOG_WARN("failed to read free space map file. file=%s, error=%s", file_name, strerror(errno));
+      rc = RC::IOERR_READ;
+    }
+  }
+  ::close(fd);
+
+  // 不管文件是否有效，都不能再用了。之后没有正常关闭时，下次打开就找不到这个文件
+  ::unlink(file_name);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  for (PageNum page_num = 0; page_num <= max_page_num; page_num++) {
+    if (levels[page_num] != FULL_LEVEL) {
+      update(page_num, levels[page_num]);
+    }
+  }
+  PageNum old_max_page_num = max_page_num_.load();
+  while (max_page_num > old_max_page_num && !max_page_num_.compare_exchange_weak(old_max_page_num, max_page_num)) {
+  }
+  LOG_INFO("load free space map. file=%s, max page num=%d, free page num=%d", file_name, max_page_num, free_page_num());
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::save(const char *file_name) const
+{
+  string tmp_file = string(file_name) + ".tmp";
+  int    fd       = ::open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to open free space map file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  FreeSpaceMapFileHeader header;
+  header.magic        = FreeSpaceMapFileHeader::MAGIC;
+  header.max_page_num = max_page_num_.load();
+
+  vector<uint8_t> levels(header.max_page_num + 1);
+  for (PageNum page_num = 0; page_num <= header.max_page_num; page_num++) {
+    levels[page_num] = level(page_num);
+  }
+
+  if (writen(fd, &header, sizeof(header)) != 0 || writen(fd, levels.data(), static_cast<int>(levels.size())) != 0 ||
+      fsync(fd) != 0) {
+    LOG_WARN("failed to write free space map file. file=%s, error=%s", tmp_file.c_str(), strerror(errno));
+    ::close(fd);
+    return RC::IOERR_WRITE;
+  }
+  ::close(fd);
+
+  if (::rename(tmp_file.c_str(), file_name) != 0) {
+    LOG_WARN("failed to rename free space map file. from=%s, to=%s, error=%s",
+             tmp_file.c_str(), file_name, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  LOG_INFO("save free space map. file=%s, max page num=%d", file_name, header.max_page_num);
+  return RC::SUCCESS;
+}
@@ -0,0 +1,123 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/rc.h"
+#include "common/types.h"
+#include "common/lang/mutex.h"
+#include "storage/buffer/page.h"
+
+/**
+ * @brief 记录文件的空闲空间表
+ * @ingroup RecordManager
+ * @details 记录每个页面还有多少空闲空间(level)，插入记录时根据它查找可以插入的页面，不需要逐个访问页面。
+ * 页面按照页号分成多个分区，每个分区有自己的锁、查找位置和当前插入的目标页面。每个线程优先使用自己的分区，
+ * 这样并发插入同一张表时，不同的线程会插入到不同的页面上，不会都等在同一个页面的锁上。
+ * 自己的分区中没有可用的页面时，再从其它分区中找，都没有时才分配新的页面。
+ *
+ * 正常关闭时保存到文件中，下次打开时直接加载，不需要再遍历所有的页面。加载后会把文件删掉，
+ * 如果没有正常关闭，下次打开时找不到文件，就重新遍历所有页面。
+ * 这里记录的只是提示信息，插入记录时拿到页面锁之后还要再检查页面是否真的有空间。
+ */
+class FreeSpaceMap
+{
+public:
+  static constexpr uint8_t FULL_LEVEL  = 0;    ///< 页面上放不下一条记录了
+  static constexpr uint8_t EMPTY_LEVEL = 255;  ///< 页面上没有记录
+
+  FreeSpaceMap();
+  ~FreeSpaceMap();
+
+  /**
+   * @brief 初始化，所有的页面都当做没有空闲空间
+   *
+   * @param partition_num 分区的个数，小于等于0时使用CPU核数
+   */
+  void init(int partition_num = 0);
+
+  /**
+   * @brief 从文件中加载空闲空间表，成功加载后会删除文件
+   * @details 文件中记录的最大页号与数据文件对不上时，说明文件是过期的，返回 RC::INVALID_ARGUMENT
+   *
+   * @param file_name    保存空闲空间表的文件
+   * @param max_page_num 数据文件中分配的最大页号
+   * @return 文件不存在时返回 RC::FILE_NOT_EXIST
+   */
+  RC load(const char *file_name, PageNum max_page_num);
+
+  /**
+   * @brief 保存到文件中，正常关闭时调用
+   */
+  RC save(const char *file_name) const;
+
+  /**
+   * @brief 更新页面的空闲程度，参考 RecordPageHandler::free_space_level
+   */
+  void update(PageNum page_num, uint8_t level);
+
+  uint8_t level(PageNum page_num) const;
+
+  /**
+   * @brief 给当前线程找一个可以插入记录的页面
+   * @details 优先使用当前线程的目标页面，然后是自己分区中的其它页面，最后从其它分区中找
+   * @return 没有空闲的页面时返回 BP_INVALID_PAGE_NUM，调用者需要分配新的页面
+   */
+  PageNum find_page();
+
+  /**
+   * @brief 当前线程分配了一个新的页面，后面的记录都插入到这个页面上
+   */
+  void set_target(PageNum page_num);
+
+  int partition_num() const { return static_cast<int>(partitions_.size()); }
+
+  /**
+   * @brief 有多少个页面还可以插入记录
+   */
+  int free_page_num() const;
+
+private:
+  /// 每一段记录多少个页面，段在第一次使用时分配，不需要预先知道文件有多大
+  static constexpr int CHUNK_PAGE_NUM = 64 * 1024;
+  static constexpr int MAX_CHUNK_NUM  = 1024;
+
+  struct Partition
+  {
+    common::Mutex lock;
+    PageNum       target = BP_INVALID_PAGE_NUM;  ///< 这个分区的线程当前插入的页面
+    int           cursor = 0;                    ///< 这个分区中前面的页面都没有空闲空间了
+  };
+
+  Partition &home_partition();
+
+  /**
+   * @brief 在指定的分区中从 cursor 开始找一个有空闲空间的页面，跳过 exclude 页面
+   * @details 需要拿着分区的锁
+   */
+  PageNum search_partition(int partition_index, PageNum exclude);
+
+  std::atomic<uint8_t> *chunk(PageNum page_num, bool create) const;
+
+private:
+  std::vector<std::unique_ptr<Partition>> partitions_;
+
+  mutable std::atomic<std::atomic<uint8_t> *> chunks_[MAX_CHUNK_NUM];
+  std::atomic<PageNum>                        max_page_num_{0};
+};
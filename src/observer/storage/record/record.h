@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <stddef.h>
+#include <strings.h>
+#include <functional>
 #include <vector>
 #include <limits>
 #include <sstream>
@@ -82,6 +84,57 @@ struct RID
   }
 };
 
+/**
+ * @brief 记录在数据文件页面上的存放格式
+ * @details 建表时指定，参考 RecordPageHandler。
+ * - FIXED 定长格式，每条记录都按照表的记录长度存放，可以根据槽位号直接计算出记录的位置
+ * - SLOTTED 变长格式，页面上有一个槽位目录，字符串字段只保存实际使用的部分
+ */
+enum class RecordFormat
+{
+  FIXED,
+  SLOTTED,
+};
+
+inline const char *record_format_name(RecordFormat format)
+{
+  return format == RecordFormat::SLOTTED ? "slotted" : "fixed";
+}
+
+/**
+ * @brief 根据名字找到记录格式，名字不区分大小写
+ */
+inline RC record_format_from_name(const char *name, RecordFormat &format)
+{
+  if (0 == strcasecmp(name, "fixed")) {
+    format = RecordFormat::FIXED;
+  } else if (0 == strcasecmp(name, "slotted")) {
+    format = RecordFormat::SLOTTED;
+  } else {
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+/**
+ * @brief 记录中的一个变长字段
+ * @details 变长格式的页面上，这些字段只保存实际的长度和内容。变长字段按照偏移量从小到大排列，
+ * 保存在每个页面的页头中，参考 SlottedPageHeader
+ */
+struct VarlenField
+{
+  int16_t offset;  ///< 字段在记录中的偏移量
+  int16_t len;     ///< 字段的最大长度
+};
+
+/**
+ * @brief 修改页面上的记录之后写日志的回调函数
+ * @details 调用时还拿着页面的写锁，返回的日志LSN会记录到页面上，页面写回磁盘之前一定能看到这个LSN。
+ * [begin, end) 是这个页面上刚修改的记录在这次操作中的下标，单条记录的操作是 [0, 1)。
+ * 写日志失败时页面上的修改会撤销
+ */
+using RecordLogger = std::function<RC(size_t begin, size_t end, LSN &lsn)>;
+
 /**
  * @brief 表示一个记录
  * 当前的记录都是连续存放的空间（内存或磁盘上）。
@@ -128,8 +181,12 @@ public:
 
   void set_data(char *data, int len = 0)
   {
-    this->data_ = data;
-    this->len_  = len;
+    if (owner_ && data_ != nullptr) {
+      free(data_);
+    }
+    this->data_  = data;
+    this->len_   = len;
+    this->owner_ = false;
   }
   void set_data_owner(char *data, int len)
   {
@@ -141,6 +198,29 @@ public:
     this->owner_ = true;
   }
 
+  /**
+   * @brief 将数据复制到record自己管理的内存中
+   * @details 如果当前已经管理着同样大小的内存就直接复用，避免逐条访问记录时反复申请内存
+   */
+  void copy_data(const char *data, int len)
+  {
+    memcpy(alloc_data(len), data, len);
+  }
+
+  /**
+   * @brief 准备一块由record自己管理的指定大小的内存，由调用者填充数据
+   * @details 与 copy_data 一样，已经管理着同样大小的内存时直接复用
+   */
+  char *alloc_data(int len)
+  {
+    if (!owner_ || len_ != len) {
+      char *tmp = (char *)malloc(len);
+      ASSERT(nullptr != tmp, "failed to allocate memory. size=%d", len);
+      set_data_owner(tmp, len);
+    }
+    return data_;
+  }
+
   char       *data() { return this->data_; }
   const char *data() const { return this->data_; }
   int         len() const { return this->len_; }
@@ -11,12 +11,15 @@ See the Mulan PSL v2 for more details. */
 //
 // Created by Meiyi & Longda on 2021/4/13.
 //
+#include <algorithm>
+
 #include "storage/record/record_manager.h"
 #include "common/log/log.h"
 #include "common/lang/bitmap.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
 
+using namespace std;
 using namespace common;
 
 static constexpr int PAGE_HEADER_SIZE = (sizeof(PageHeader));
@@ -50,6 +53,72 @@ int page_record_capacity(int page_size, int record_size)
  */
 int page_bitmap_size(int record_capacity) { return (record_capacity + 7) / 8; }
 
+/**
+ * @brief 变长格式的页面上，槽位目录的起始位置
+ *
+ * @param varlen_field_num 页面上记录的变长字段个数
+ */
+static int slot_dir_offset(int varlen_field_num)
+{
+  return PAGE_HEADER_SIZE + sizeof(SlottedPageHeader) + varlen_field_num * sizeof(VarlenField);
+}
+
+/**
+ * @brief 变长格式下编码后记录的最大长度。每个变长字段多了2字节的长度
+ */
+static int max_slotted_record_size(int record_size, int varlen_field_num)
+{
+  return record_size + varlen_field_num * sizeof(uint16_t);
+}
+
+/**
+ * @brief 把变长格式的记录解码成定长的格式
+ * @details 乐观读时页面可能正在被修改，页面上的数据不一定可靠，所以要检查所有的边界
+ *
+ * @param data             编码后的记录
+ * @param len              编码后记录的长度
+ * @param record_size      解码后记录的长度
+ * @param varlen_fields    记录中的变长字段
+ * @param varlen_field_num 变长字段的个数
+ * @param record           解码后的记录
+ * @return 数据不合法时返回false
+ */
+static bool decode_slotted_record(const char *data, int len, int record_size, const VarlenField *varlen_fields,
+    int varlen_field_num, char *record)
+{
+  int data_offset   = 0;
+  int record_offset = 0;
+  for (int i = 0; i < varlen_field_num; i++) {
+    const VarlenField &field     = varlen_fields[i];
+    const int          fixed_len = field.offset - record_offset;
+    if (fixed_len < 0 || field.len < 0 || field.offset + field.len > record_size ||
+        data_offset + fixed_len + (int)sizeof(uint16_t) > len) {
+      return false;
+    }
+
+    memcpy(record + record_offset, data + data_offset, fixed_len);
+    data_offset += fixed_len;
+
+    uint16_t field_len = 0;
+    memcpy(&field_len, data + data_offset, sizeof(field_len));
+    data_offset += sizeof(field_len);
+    if (field_len > field.len || data_offset + field_len > len) {
+      return false;
+    }
+
+    memcpy(record + field.offset, data + data_offset, field_len);
+    memset(record + field.offset + field_len, 0, field.len - field_len);
+    data_offset += field_len;
+    record_offset = field.offset + field.len;
+  }
+
+  if (len - data_offset != record_size - record_offset) {
+    return false;
+  }
+  memcpy(record + record_offset, data + data_offset, record_size - record_offset);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 RecordPageIterator::RecordPageIterator() {}
 RecordPageIterator::~RecordPageIterator() {}
@@ -58,14 +127,29 @@ void RecordPageIterator::init(RecordPageHandler &record_page_handler, SlotNum st
 {
   record_page_handler_ = &record_page_handler;
   page_num_            = record_page_handler.get_page_num();
-  bitmap_.init(record_page_handler.bitmap_, record_page_handler.page_header_->record_capacity);
-  next_slot_num_ = bitmap_.next_setted_bit(start_slot_num);
+  slotted_             = record_page_handler.is_slotted();
+  if (slotted_) {
+    next_slot_num_ = record_page_handler.next_used_slot(start_slot_num);
+  } else {
+    bitmap_.init(record_page_handler.bitmap_, record_page_handler.page_header_->record_capacity);
+    next_slot_num_ = bitmap_.next_setted_bit(start_slot_num);
+  }
 }
 
 bool RecordPageIterator::has_next() { return -1 != next_slot_num_; }
 
 RC RecordPageIterator::next(Record &record)
 {
+  if (slotted_) {
+    if (next_slot_num_ < 0) {
+      return RC::RECORD_EOF;
+    }
+
+    const RID rid(page_num_, next_slot_num_);
+    next_slot_num_ = record_page_handler_->next_used_slot(next_slot_num_ + 1);
+    return record_page_handler_->get_record(&rid, &record);
+  }
+
   record.set_rid(page_num_, next_slot_num_);
   record.set_data(record_page_handler_->get_record_data(record.rid().slot_num));
 
@@ -79,7 +163,8 @@ RC RecordPageIterator::next(Record &record)
 
 RecordPageHandler::~RecordPageHandler() { cleanup(); }
 
-RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool readonly)
+RC RecordPageHandler::init(
+    DiskBufferPool &buffer_pool, PageNum page_num, bool readonly, BPBufferRing *ring /* = nullptr */)
 {
   if (disk_buffer_pool_ != nullptr) {
     if (frame_->page_num() == page_num) {
@@ -91,7 +176,7 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool r
   }
 
   RC ret = RC::SUCCESS;
-  if ((ret = buffer_pool.get_this_page(page_num, &frame_)) != RC::SUCCESS) {
+  if ((ret = buffer_pool.get_this_page(page_num, &frame_, ring)) != RC::SUCCESS) {
     LOG_ERROR("Failed to get page handle from disk buffer pool. ret=%d:%s", ret, strrc(ret));
     return ret;
   }
@@ -106,7 +191,7 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num, bool r
   disk_buffer_pool_ = &buffer_pool;
   readonly_         = readonly;
   page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
+  init_page_layout();
   
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
@@ -131,7 +216,7 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool, PageNum page_num
   disk_buffer_pool_ = &buffer_pool;
   readonly_         = false;
   page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
+  init_page_layout();
 
   buffer_pool.recover_page(page_num);
 
@@ -139,9 +224,10 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool, PageNum page_num
   return ret;
 }
 
-RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size)
+RC RecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, PageNum page_num, int record_size, BPBufferRing *ring /* = nullptr */)
 {
-  RC ret = init(buffer_pool, page_num, false /*readonly*/);
+  RC ret = init(buffer_pool, page_num, false /*readonly*/, ring);
   if (ret != RC::SUCCESS) {
     LOG_ERROR("Failed to init empty page page_num:record_size %d:%d.", page_num, record_size);
     return ret;
@@ -167,16 +253,169 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, PageNum page_
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::init_empty_slotted_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size,
+    const vector<VarlenField> &varlen_fields, BPBufferRing *ring /* = nullptr */)
+{
+  const int varlen_field_num = static_cast<int>(varlen_fields.size());
+  if (record_size <= 0 ||
+      slot_dir_offset(varlen_field_num) + sizeof(RecordSlot) +
+              max_slotted_record_size(record_size, varlen_field_num) > BP_PAGE_DATA_SIZE) {
+    LOG_WARN("record is too large for slotted page. record size=%d, varlen field num=%d",
+             record_size, varlen_field_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  for (int i = 0; i < varlen_field_num; i++) {
+    const VarlenField &field = varlen_fields[i];
+    if (field.offset < (i == 0 ? 0 : varlen_fields[i - 1].offset + varlen_fields[i - 1].len) ||
+        field.len < 0 || field.offset + field.len > record_size) {
+      LOG_WARN("invalid varlen field. offset=%d, len=%d, record size=%d", field.offset, field.len, record_size);
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+
+  RC ret = init(buffer_pool, page_num, false /*readonly*/, ring);
+  if (ret != RC::SUCCESS) {
+    LOG_ERROR("Failed to init empty slotted page page_num:record_size %d:%d.", page_num, record_size);
+    return ret;
+  }
+
+  page_header_->record_num          = 0;
+  page_header_->record_real_size    = record_size;
+  page_header_->record_size         = SLOTTED_PAGE_RECORD_SIZE;
+  page_header_->record_capacity     = 0;
+  page_header_->first_record_offset = BP_PAGE_DATA_SIZE;
+
+  SlottedPageHeader *slotted_header = (SlottedPageHeader *)(frame_->data() + PAGE_HEADER_SIZE);
+  slotted_header->fragment_size     = 0;
+  slotted_header->varlen_field_num  = varlen_field_num;
+  memcpy(slotted_header + 1, varlen_fields.data(), varlen_field_num * sizeof(VarlenField));
+  init_page_layout();
+
+  if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
+    return ret;
+  }
+
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::init_page_layout()
+{
+  char *data = frame_->data();
+  bitmap_    = data + PAGE_HEADER_SIZE;
+  if (page_header_->record_size == SLOTTED_PAGE_RECORD_SIZE) {
+    slotted_header_ = (SlottedPageHeader *)(data + PAGE_HEADER_SIZE);
+    varlen_fields_  = (VarlenField *)(slotted_header_ + 1);
+    slots_          = (RecordSlot *)(data + slot_dir_offset(slotted_header_->varlen_field_num));
+  } else {
+    slotted_header_ = nullptr;
+    varlen_fields_  = nullptr;
+    slots_          = nullptr;
+  }
+}
+
+SlotNum RecordPageHandler::next_used_slot(SlotNum start_slot_num) const
+{
+  for (SlotNum slot_num = start_slot_num; slot_num < page_header_->record_capacity; slot_num++) {
+    if (slots_[slot_num].offset != 0) {
+      return slot_num;
+    }
+  }
+  return -1;
+}
+
+int RecordPageHandler::free_space() const
+{
+  const int slot_dir_end = (char *)(slots_ + page_header_->record_capacity) - frame_->data();
+  return page_header_->first_record_offset - slot_dir_end;
+}
+
+bool RecordPageHandler::reserve_space(int size)
+{
+  if (free_space() >= size) {
+    return true;
+  }
+  if (free_space() + slotted_header_->fragment_size < size) {
+    return false;
+  }
+
+  compact();
+  return true;
+}
+
+void RecordPageHandler::compact()
+{
+  char *data = frame_->data();
+  char  buffer[BP_PAGE_DATA_SIZE];
+  int   offset = BP_PAGE_DATA_SIZE;
+  for (SlotNum slot_num = 0; slot_num < page_header_->record_capacity; slot_num++) {
+    RecordSlot &slot = slots_[slot_num];
+    if (slot.offset == 0) {
+      continue;
+    }
+
+    offset -= slot.len;
+    memcpy(buffer + offset, data + slot.offset, slot.len);
+    slot.offset = offset;
+  }
+
+  memcpy(data + offset, buffer + offset, BP_PAGE_DATA_SIZE - offset);
+  page_header_->first_record_offset = offset;
+  slotted_header_->fragment_size    = 0;
+  LOG_TRACE("compact slotted page. page_num=%d, free space=%d", frame_->page_num(), free_space());
+}
+
+void RecordPageHandler::place_record(SlotNum slot_num, const char *record, int len)
+{
+  page_header_->first_record_offset -= len;
+  memcpy(frame_->data() + page_header_->first_record_offset, record, len);
+  slots_[slot_num].offset = page_header_->first_record_offset;
+  slots_[slot_num].len    = len;
+}
+
+int RecordPageHandler::encode_record(const char *data, char *buffer) const
+{
+  const int record_size   = page_header_->record_real_size;
+  int       data_offset   = 0;
+  int       buffer_offset = 0;
+  for (int i = 0; i < slotted_header_->varlen_field_num; i++) {
+    const VarlenField &field     = varlen_fields_[i];
+    const int          fixed_len = field.offset - data_offset;
+    memcpy(buffer + buffer_offset, data + data_offset, fixed_len);
+    buffer_offset += fixed_len;
+
+    const uint16_t field_len = strnlen(data + field.offset, field.len);
+    memcpy(buffer + buffer_offset, &field_len, sizeof(field_len));
+    buffer_offset += sizeof(field_len);
+    memcpy(buffer + buffer_offset, data + field.offset, field_len);
+    buffer_offset += field_len;
+    data_offset = field.offset + field.len;
+  }
+
+  memcpy(buffer + buffer_offset, data + data_offset, record_size - data_offset);
+  return buffer_offset + record_size - data_offset;
+}
+
 RC RecordPageHandler::cleanup()
 {
   if (disk_buffer_pool_ != nullptr) {
     if (readonly_) {
       frame_->read_unlatch();
     } else {
+      // 事务会直接修改记录中的事务字段(参考 RecordFileHandler::visit_record)，这里无法知道
+      // 记录是否真的被修改了，所以以写模式访问过的页面都当做脏页，否则这些修改可能不会写回磁盘
+      frame_->mark_dirty();
       frame_->write_unlatch();
     }
     disk_buffer_pool_->unpin_page(frame_);
     disk_buffer_pool_ = nullptr;
+    frame_            = nullptr;
+    page_header_      = nullptr;
+    bitmap_           = nullptr;
+    slotted_header_   = nullptr;
+    varlen_fields_    = nullptr;
+    slots_            = nullptr;
   }
 
   return RC::SUCCESS;
@@ -186,6 +425,10 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
 {
   ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
 
+  if (is_slotted()) {
+    return insert_slotted_record(data, rid);
+  }
+
   if (page_header_->record_num == page_header_->record_capacity) {
     LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
     return RC::RECORD_NOMEM;
@@ -212,8 +455,85 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
   return RC::SUCCESS;
 }
 
+int RecordPageHandler::insert_records(std::span<const char *const> datas, RID *rids)
+{
+  ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
+
+  int count = 0;
+  if (is_slotted()) {
+    // 前面的槽位刚刚都查找过了，从上一条记录的槽位之后继续找
+    SlotNum start_slot = 0;
+    for (const char *data : datas) {
+      if (insert_slotted_record(data, &rids[count], start_slot) != RC::SUCCESS) {
+        break;
+      }
+      start_slot = rids[count].slot_num + 1;
+      count++;
+    }
+    return count;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = -1;
+  for (const char *data : datas) {
+    if (page_header_->record_num == page_header_->record_capacity) {
+      break;
+    }
+
+    index = bitmap.next_unsetted_bit(index + 1);
+    bitmap.set_bit(index);
+    page_header_->record_num++;
+    memcpy(get_record_data(index), data, page_header_->record_real_size);
+
+    rids[count].page_num = get_page_num();
+    rids[count].slot_num = index;
+    count++;
+  }
+
+  if (count > 0) {
+    frame_->mark_dirty();
+  }
+  return count;
+}
+
+RC RecordPageHandler::insert_slotted_record(const char *data, RID *rid, SlotNum start_slot /* = 0 */)
+{
+  char      buffer[BP_PAGE_DATA_SIZE];
+  const int len = encode_record(data, buffer);
+
+  // 优先使用空闲的槽位，没有时在槽位目录的末尾增加一个
+  SlotNum slot_num = start_slot;
+  while (slot_num < page_header_->record_capacity && slots_[slot_num].offset != 0) {
+    slot_num++;
+  }
+
+  const bool new_slot = (slot_num == page_header_->record_capacity);
+  if (!reserve_space(len + (new_slot ? sizeof(RecordSlot) : 0))) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  if (new_slot) {
+    page_header_->record_capacity++;
+  }
+  place_record(slot_num, buffer, len);
+  page_header_->record_num++;
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = slot_num;
+  }
+  return RC::SUCCESS;
+}
+
 RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
 {
+  if (is_slotted()) {
+    return recover_insert_slotted_record(data, rid);
+  }
+
   if (rid.slot_num >= page_header_->record_capacity) {
     LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
     return RC::RECORD_INVALID_RID;
@@ -235,10 +555,73 @@ RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::recover_insert_slotted_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num < 0) {
+    LOG_WARN("slot_num illegal, slot_num=%d.", rid.slot_num);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  // 记录已经存在时，说明页面在日志之后写回过磁盘，用日志中的数据覆盖
+  if (rid.slot_num < page_header_->record_capacity && slots_[rid.slot_num].offset != 0) {
+    return update_slotted_record(rid, data);
+  }
+
+  char      buffer[BP_PAGE_DATA_SIZE];
+  const int len = encode_record(data, buffer);
+
+  // 槽位目录需要扩展到指定的槽位，中间的槽位都是空闲的
+  const int new_slot_num = max(0, rid.slot_num + 1 - page_header_->record_capacity);
+  if (!reserve_space(len + new_slot_num * sizeof(RecordSlot))) {
+    LOG_WARN("no space to recover record. page_num=%d, slot_num=%d", frame_->page_num(), rid.slot_num);
+    return RC::RECORD_NOMEM;
+  }
+
+  for (int i = 0; i < new_slot_num; i++) {
+    RecordSlot &slot = slots_[page_header_->record_capacity++];
+    slot.offset      = 0;
+    slot.len         = 0;
+  }
+  place_record(rid.slot_num, buffer, len);
+  page_header_->record_num++;
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
 RC RecordPageHandler::delete_record(const RID *rid)
 {
   ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
 
+  if (is_slotted()) {
+    if (rid->slot_num < 0 || rid->slot_num >= page_header_->record_capacity || slots_[rid->slot_num].offset == 0) {
+      LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+      return RC::RECORD_NOT_EXIST;
+    }
+
+    RecordSlot &slot = slots_[rid->slot_num];
+    slotted_header_->fragment_size += slot.len;
+    slot.offset = 0;
+    slot.len    = 0;
+
+    // 槽位目录末尾空闲的槽位可以直接回收，中间的要保留，否则其它记录的 RID 会变化
+    while (page_header_->record_capacity > 0 && slots_[page_header_->record_capacity - 1].offset == 0) {
+      page_header_->record_capacity--;
+    }
+
+    page_header_->record_num--;
+    if (page_header_->record_num == 0) {
+      page_header_->first_record_offset = BP_PAGE_DATA_SIZE;
+      slotted_header_->fragment_size    = 0;
+    }
+    frame_->mark_dirty();
+
+    if (page_header_->record_num == 0) {
+      cleanup();
+    }
+    return RC::SUCCESS;
+  }
+
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, page_num %d.", rid->slot_num, frame_->page_num());
     return RC::INVALID_ARGUMENT;
@@ -261,8 +644,80 @@ RC RecordPageHandler::delete_record(const RID *rid)
   }
 }
 
+RC RecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(readonly_ == false, "cannot update record of page while the page is readonly");
+
+  if (is_slotted()) {
+    return update_slotted_record(rid, data);
+  }
+
+  if (rid.slot_num >= page_header_->record_capacity || !Bitmap(bitmap_, page_header_->record_capacity).get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is invalid or empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // 定长格式下记录通常就是在页面上直接修改的
+  char *record_data = get_record_data(rid.slot_num);
+  if (record_data != data) {
+    memcpy(record_data, data, page_header_->record_real_size);
+  }
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::update_slotted_record(const RID &rid, const char *data)
+{
+  if (rid.slot_num < 0 || rid.slot_num >= page_header_->record_capacity || slots_[rid.slot_num].offset == 0) {
+    LOG_ERROR("Invalid slot_num:%d, slot is invalid or empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  char      buffer[BP_PAGE_DATA_SIZE];
+  const int len  = encode_record(data, buffer);
+  RecordSlot &slot = slots_[rid.slot_num];
+  if (len <= slot.len) {
+    // 原来的位置放得下，剩下的空间变成碎片
+    memcpy(frame_->data() + slot.offset, buffer, len);
+    slotted_header_->fragment_size += slot.len - len;
+    slot.len = len;
+  } else {
+    if (free_space() + slotted_header_->fragment_size + slot.len < len) {
+      LOG_WARN("no space to update record. page_num=%d, slot_num=%d, len=%d", frame_->page_num(), rid.slot_num, len);
+      return RC::RECORD_NOMEM;
+    }
+
+    // 先释放原来的记录，再重新分配空间，页面整理时不需要再搬动原来的记录
+    slotted_header_->fragment_size += slot.len;
+    slot.offset = 0;
+    slot.len    = 0;
+    reserve_space(len);
+    place_record(rid.slot_num, buffer, len);
+  }
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
 RC RecordPageHandler::get_record(const RID *rid, Record *rec)
 {
+  if (is_slotted()) {
+    if (rid->slot_num < 0 || rid->slot_num >= page_header_->record_capacity || slots_[rid->slot_num].offset == 0) {
+      LOG_ERROR("Invalid slot_num:%d, slot is invalid or empty, page_num %d.", rid->slot_num, frame_->page_num());
+      return RC::RECORD_NOT_EXIST;
+    }
+
+    const RecordSlot &slot = slots_[rid->slot_num];
+    rec->set_rid(*rid);
+    char *record_data = rec->alloc_data(page_header_->record_real_size);
+    if (!decode_slotted_record(frame_->data() + slot.offset, slot.len, page_header_->record_real_size,
+            varlen_fields_, slotted_header_->varlen_field_num, record_data)) {
+      LOG_ERROR("failed to decode record. page_num=%d, slot_num=%d", frame_->page_num(), rid->slot_num);
+      return RC::INTERNAL;
+    }
+    return RC::SUCCESS;
+  }
+
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR("Invalid slot_num:%d, exceed page's record capacity, page_num %d.", rid->slot_num, frame_->page_num());
     return RC::RECORD_INVALID_RID;
@@ -279,6 +734,134 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec)
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::get_records(SlotNum start_slot, RecordBatch &batch)
+{
+  batch.clear();
+  batch.page_num_    = get_page_num();
+  batch.record_size_ = page_header_->record_real_size;
+
+  if (!is_slotted()) {
+    batch.data_ = frame_->data();
+    // 一次把所有被占用的槽位都取出来
+    Bitmap bitmap(bitmap_, page_header_->record_capacity);
+    batch.slots_.resize(page_header_->record_num);
+    const int slot_count = bitmap.setted_bits(start_slot, batch.slots_.data(), page_header_->record_num);
+    batch.slots_.resize(slot_count);
+    batch.offsets_.resize(slot_count);
+    for (int i = 0; i < slot_count; i++) {
+      batch.offsets_[i] = page_header_->first_record_offset + page_header_->record_size * batch.slots_[i];
+    }
+    return RC::SUCCESS;
+  }
+
+  // 先把缓存分配好，解码的过程中 data_ 不能再变化
+  const int record_size = batch.record_size_;
+  batch.buffer_.resize(static_cast<size_t>(page_header_->record_num) * record_size);
+  batch.data_ = batch.buffer_.data();
+  for (SlotNum slot_num = next_used_slot(start_slot); slot_num != -1; slot_num = next_used_slot(slot_num + 1)) {
+    const RecordSlot &slot   = slots_[slot_num];
+    const int         offset = batch.size() * record_size;
+    if (!decode_slotted_record(frame_->data() + slot.offset, slot.len, record_size,
+            varlen_fields_, slotted_header_->varlen_field_num, batch.data_ + offset)) {
+      LOG_ERROR("failed to decode record. page_num=%d, slot_num=%d", frame_->page_num(), slot_num);
+      return RC::INTERNAL;
+    }
+    batch.slots_.push_back(slot_num);
+    batch.offsets_.push_back(offset);
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::optimistic_get_record(DiskBufferPool &buffer_pool, const RID &rid, Record *rec)
+{
+  Frame *frame = nullptr;
+  RC rc = buffer_pool.get_this_page(rid.page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to get page handle from disk buffer pool. page_num=%d, rc=%s", rid.page_num, strrc(rc));
+    return rc;
+  }
+
+  uint64_t version = 0;
+  if (!frame->optimistic_read_begin(version)) {
+    buffer_pool.unpin_page(frame);
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  // 页面可能正在被修改，页头也不一定可靠，访问记录之前要先检查边界
+  const PageHeader *page_header      = (const PageHeader *)frame->data();
+  const int         record_capacity  = page_header->record_capacity;
+  const int         record_real_size = page_header->record_real_size;
+  const int64_t     record_offset    = page_header->first_record_offset + 
+                                       static_cast<int64_t>(page_header->record_size) * rid.slot_num;
+  if (page_header->record_size == SLOTTED_PAGE_RECORD_SIZE) {
+    rc = optimistic_get_slotted_record(frame->data(), rid, rec);
+  } else if (rid.slot_num < 0 || rid.slot_num >= record_capacity) {
+    rc = RC::RECORD_INVALID_RID;
+  } else if (record_real_size <= 0 || record_offset < PAGE_HEADER_SIZE ||
+             record_offset + record_real_size > BP_PAGE_DATA_SIZE) {
+    rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+  } else if (!Bitmap(frame->data() + PAGE_HEADER_SIZE, record_capacity).get_bit(rid.slot_num)) {
+    rc = RC::RECORD_NOT_EXIST;
+  } else {
+    rec->copy_data(frame->data() + record_offset, record_real_size);
+    rec->set_rid(rid);
+  }
+
+  if (!frame->optimistic_read_validate(version)) {
+    rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  buffer_pool.unpin_page(frame);
+
+  if (rc == RC::RECORD_INVALID_RID || rc == RC::RECORD_NOT_EXIST) {
+    LOG_ERROR("Invalid slot_num:%d, slot is invalid or empty, page_num %d. rc=%s", 
+              rid.slot_num, rid.page_num, strrc(rc));
+  }
+  return rc;
+}
+
+RC RecordPageHandler::optimistic_get_slotted_record(const char *data, const RID &rid, Record *rec)
+{
+  const PageHeader        *page_header      = (const PageHeader *)data;
+  const SlottedPageHeader *slotted_header   = (const SlottedPageHeader *)(data + PAGE_HEADER_SIZE);
+  const int                record_capacity  = page_header->record_capacity;
+  const int                record_real_size = page_header->record_real_size;
+  const int                varlen_field_num = slotted_header->varlen_field_num;
+  if (record_real_size <= 0 || record_real_size > BP_PAGE_DATA_SIZE || varlen_field_num < 0 ||
+      record_capacity < 0 || slot_dir_offset(varlen_field_num) + record_capacity * (int64_t)sizeof(RecordSlot) > BP_PAGE_DATA_SIZE) {
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  if (rid.slot_num < 0 || rid.slot_num >= record_capacity) {
+    return RC::RECORD_INVALID_RID;
+  }
+
+  RecordSlot slot;
+  memcpy(&slot, data + slot_dir_offset(varlen_field_num) + rid.slot_num * sizeof(RecordSlot), sizeof(slot));
+  if (slot.offset == 0) {
+    return RC::RECORD_NOT_EXIST;
+  }
+  if (slot.offset < slot_dir_offset(varlen_field_num) || slot.offset + slot.len > BP_PAGE_DATA_SIZE) {
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  char *record_data = rec->alloc_data(record_real_size);
+  if (!decode_slotted_record(data + slot.offset, slot.len, record_real_size,
+          (const VarlenField *)(slotted_header + 1), varlen_field_num, record_data)) {
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  rec->set_rid(rid);
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::update_page_lsn(LSN lsn)
+{
+  ASSERT(!readonly_, "cannot update lsn of a readonly page. page num=%d", frame_->page_num());
+  if (frame_->lsn() < lsn) {
+    frame_->set_lsn(lsn);
+  }
+}
+
+LSN RecordPageHandler::page_lsn() const { return frame_->lsn(); }
+
 PageNum RecordPageHandler::get_page_num() const
 {
   if (nullptr == page_header_) {
@@ -287,13 +870,39 @@ PageNum RecordPageHandler::get_page_num() const
   return frame_->page_num();
 }
 
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+uint8_t RecordPageHandler::free_space_level() const
+{
+  if (is_full()) {
+    return FreeSpaceMap::FULL_LEVEL;
+  }
+
+  int free_size  = 0;
+  int total_size = 0;
+  if (is_slotted()) {
+    free_size  = free_space() + slotted_header_->fragment_size;
+    total_size = BP_PAGE_DATA_SIZE - slot_dir_offset(slotted_header_->varlen_field_num);
+  } else {
+    free_size  = page_header_->record_capacity - page_header_->record_num;
+    total_size = page_header_->record_capacity;
+  }
+  return 1 + (FreeSpaceMap::EMPTY_LEVEL - 1) * free_size / max(total_size, 1);
+}
+
+bool RecordPageHandler::is_full() const
+{
+  if (is_slotted()) {
+    const int max_size = max_slotted_record_size(page_header_->record_real_size, slotted_header_->varlen_field_num);
+    return free_space() + slotted_header_->fragment_size < max_size + (int)sizeof(RecordSlot);
+  }
+  return page_header_->record_num >= page_header_->record_capacity;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::~RecordFileHandler() { this->close(); }
 
-RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
+RC RecordFileHandler::init(DiskBufferPool *buffer_pool, RecordFormat format /* = RecordFormat::FIXED */,
+    const vector<VarlenField> &varlen_fields /* = {} */, const char *fsm_file /* = nullptr */)
 {
   if (disk_buffer_pool_ != nullptr) {
     LOG_ERROR("record file handler has been openned.");
@@ -301,8 +910,25 @@ RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
   }
 
   disk_buffer_pool_ = buffer_pool;
-
-  RC rc = init_free_pages();
+  format_           = format;
+  varlen_fields_    = varlen_fields;
+  fsm_file_         = fsm_file == nullptr ? "" : fsm_file;
+  free_space_map_.init();
+
+  // 上次正常关闭时保存了空闲空间表，就不需要再遍历所有页面了
+  RC rc = RC::FILE_NOT_EXIST;
+  if (!fsm_file_.empty()) {
+    PageNum            max_page_num = 0;
+    BufferPoolIterator bp_iterator;
+    bp_iterator.init(*disk_buffer_pool_);
+    while (bp_iterator.has_next()) {
+      max_page_num = bp_iterator.next();
+    }
+    rc = free_space_map_.load(fsm_file_.c_str(), max_page_num);
+  }
+  if (OB_FAIL(rc)) {
+    rc = init_free_pages();
+  }
 
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
   return RC::SUCCESS;
@@ -311,7 +937,9 @@ RC RecordFileHandler::init(DiskBufferPool *buffer_pool)
 void RecordFileHandler::close()
 {
   if (disk_buffer_pool_ != nullptr) {
-    free_pages_.clear();
+    if (!fsm_file_.empty()) {
+      free_space_map_.save(fsm_file_.c_str());
+    }
     disk_buffer_pool_ = nullptr;
   }
 }
@@ -326,11 +954,14 @@ RC RecordFileHandler::init_free_pages()
 
   BufferPoolIterator bp_iterator;
   bp_iterator.init(*disk_buffer_pool_);
+  BPReadAhead read_ahead;
+  read_ahead.init(*disk_buffer_pool_);
   RecordPageHandler record_page_handler;
   PageNum           current_page_num = 0;
 
   while (bp_iterator.has_next()) {
     current_page_num = bp_iterator.next();
+    read_ahead.access(current_page_num);
 
     rc = record_page_handler.init(*disk_buffer_pool_, current_page_num, true /*readonly*/);
     if (rc != RC::SUCCESS) {
@@ -338,93 +969,234 @@ RC RecordFileHandler::init_free_pages()
       return rc;
     }
 
-    if (!record_page_handler.is_full()) {
-      free_pages_.insert(current_page_num);
-    }
+    free_space_map_.update(current_page_num, record_page_handler.free_space_level());
     record_page_handler.cleanup();
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
+  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s",
+           free_space_map_.free_page_num(), strrc(rc));
   return rc;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+RC RecordFileHandler::find_insert_page(RecordPageHandler &record_page_handler, int record_size, BPBufferRing *ring)
 {
-  RC ret = RC::SUCCESS;
-
-  RecordPageHandler record_page_handler;
-  bool              page_found       = false;
-  PageNum           current_page_num = 0;
-
-  // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
-  lock_.lock();
-
-  // 找到没有填满的页面
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
+  RC      ret              = RC::SUCCESS;
+  PageNum current_page_num = 0;
 
-    ret = record_page_handler.init(*disk_buffer_pool_, current_page_num, false /*readonly*/);
+  // 找到没有填满的页面。空闲空间表只是提示，拿到页面的写锁之后还要再检查一下
+  while ((current_page_num = free_space_map_.find_page()) != BP_INVALID_PAGE_NUM) {
+    ret = record_page_handler.init(*disk_buffer_pool_, current_page_num, false /*readonly*/, ring);
     if (ret != RC::SUCCESS) {
-      lock_.unlock();
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
       return ret;
     }
 
     if (!record_page_handler.is_full()) {
-      page_found = true;
-      break;
+      clear_all_visible(current_page_num);
+      return RC::SUCCESS;
     }
+    free_space_map_.update(current_page_num, FreeSpaceMap::FULL_LEVEL);
     record_page_handler.cleanup();
-    free_pages_.erase(free_pages_.begin());
   }
-  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
 
   // 找不到就分配一个新的页面
-  if (!page_found) {
-    Frame *frame = nullptr;
-    if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
-      LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
-      return ret;
+  Frame *frame = nullptr;
+  if ((ret = disk_buffer_pool_->allocate_page(&frame, ring)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
+    return ret;
+  }
+
+  current_page_num = frame->page_num();
+
+  if (format_ == RecordFormat::SLOTTED) {
+    ret = record_page_handler.init_empty_slotted_page(
+        *disk_buffer_pool_, current_page_num, record_size, varlen_fields_, ring);
+  } else {
+    ret = record_page_handler.init_empty_page(*disk_buffer_pool_, current_page_num, record_size, ring);
+  }
+  if (ret != RC::SUCCESS) {
+    frame->unpin();
+    LOG_ERROR("Failed to init empty page. ret:%d", ret);
+    // this is for allocate_page
+    return ret;
+  }
+
+  // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
+  frame->unpin();
+  clear_all_visible(current_page_num);
+
+  // 当前线程后面的记录都插入到这个页面上
+  free_space_map_.set_target(current_page_num);
+  return RC::SUCCESS;
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid, BPBufferRing *ring /* = nullptr */,
+                                    const RecordLogger &logger /* = nullptr */)
+{
+  RecordPageHandler record_page_handler;
+  RC ret = find_insert_page(record_page_handler, record_size, ring);
+  if (ret != RC::SUCCESS) {
+    return ret;
+  }
+
+  const PageNum page_num = record_page_handler.get_page_num();
+
+  // 找到空闲位置
+  ret = record_page_handler.insert_record(data, rid);
+  if (OB_SUCC(ret) && logger) {
+    ret = log_page(record_page_handler, logger, 0, 1);
+    if (OB_FAIL(ret)) {
+      undo_insert(record_page_handler, rid, 1);
     }
+  }
 
-    current_page_num = frame->page_num();
+  // 撤销插入时可能删除了页面上的所有记录，这时已经释放了页面
+  const bool    page_released = record_page_handler.get_page_num() != page_num;
+  const uint8_t level         = page_released ? FreeSpaceMap::EMPTY_LEVEL : record_page_handler.free_space_level();
+  free_space_map_.update(page_num, level);
+  return ret;
+}
 
-    ret = record_page_handler.init_empty_page(*disk_buffer_pool_, current_page_num, record_size);
+RC RecordFileHandler::insert_records(std::span<const char *const> datas, int record_size, RID *rids,
+    BPBufferRing *ring /* = nullptr */, const RecordLogger &logger /* = nullptr */)
+{
+  size_t inserted = 0;
+  while (inserted < datas.size()) {
+    RecordPageHandler record_page_handler;
+    RC ret = find_insert_page(record_page_handler, record_size, ring);
     if (ret != RC::SUCCESS) {
-      frame->unpin();
-      LOG_ERROR("Failed to init empty page. ret:%d", ret);
-      // this is for allocate_page
+      LOG_WARN("failed to find a page to insert records. inserted=%d, total=%d, rc=%s",
+               (int)inserted, (int)datas.size(), strrc(ret));
       return ret;
     }
 
-    // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
-    frame->unpin();
+    const PageNum page_num = record_page_handler.get_page_num();
+    const int     count    = record_page_handler.insert_records(datas.subspan(inserted), rids + inserted);
+    if (count > 0 && logger) {
+      ret = log_page(record_page_handler, logger, inserted, inserted + count);
+      if (OB_FAIL(ret)) {
+        undo_insert(record_page_handler, rids + inserted, count);
+        const bool page_released = record_page_handler.get_page_num() != page_num;
+        free_space_map_.update(
+            page_num, page_released ? FreeSpaceMap::EMPTY_LEVEL : record_page_handler.free_space_level());
+        for (int i = 0; i < count; i++) {
+          rids[inserted + i] = RID(BP_INVALID_PAGE_NUM, -1);
+        }
+        LOG_WARN("failed to log inserted records. page num=%d, record num=%d, rc=%s", page_num, count, strrc(ret));
+        return ret;
+      }
+    }
 
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
-    // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
-    // 了页面写锁，然后加lock的锁，但是不会引起死锁。
-    // 为什么？
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
+    free_space_map_.update(page_num, record_page_handler.free_space_level());
+    if (count == 0) {
+      // 刚找到的页面一条记录都放不下，只可能是记录太大了
+      LOG_WARN("failed to insert record into a page. page num=%d, record size=%d", page_num, record_size);
+      return RC::RECORD_NOMEM;
+    }
+    inserted += count;
   }
+  return RC::SUCCESS;
+}
 
-  // 找到空闲位置
-  return record_page_handler.insert_record(data, rid);
+RC RecordFileHandler::log_page(
+    RecordPageHandler &record_page_handler, const RecordLogger &logger, size_t begin, size_t end)
+{
+  LSN lsn = 0;
+  RC  rc  = logger(begin, end, lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to log the modification of page. page num=%d, rc=%s",
+             record_page_handler.get_page_num(), strrc(rc));
+    return rc;
+  }
+
+  // 页面写回磁盘之前需要等待这条日志落盘
+  record_page_handler.update_page_lsn(lsn);
+  return RC::SUCCESS;
 }
 
-RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
+void RecordFileHandler::undo_insert(RecordPageHandler &record_page_handler, const RID *rids, int count)
 {
-  RC ret = RC::SUCCESS;
+  const PageNum page_num = record_page_handler.get_page_num();
+  for (int i = 0; i < count && record_page_handler.get_page_num() == page_num; i++) {
+    RC rc = record_page_handler.delete_record(&rids[i]);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to undo insertion. rid=%s, rc=%s", rids[i].to_string().c_str(), strrc(rc));
+    }
+  }
+}
 
-  RecordPageHandler record_page_handler;
+RC RecordFileHandler::recover_insert_records(
+    span<const char *const> datas, int record_size, const RID *rids, LSN lsn, bool &redone)
+{
+  redone = false;
+  if (datas.empty()) {
+    return RC::SUCCESS;
+  }
 
-  ret = record_page_handler.recover_init(*disk_buffer_pool_, rid.page_num);
+  const PageNum page_num = rids[0].page_num;
+
+  RecordPageHandler record_page_handler;
+  RC ret = record_page_handler.recover_init(*disk_buffer_pool_, page_num);
   if (ret != RC::SUCCESS) {
-    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", page_num, strrc(ret));
     return ret;
   }
 
-  return record_page_handler.recover_insert_record(data, rid);
+  if (record_page_handler.page_lsn() >= lsn) {
+    LOG_TRACE("skip redo insert. page num=%d, page lsn=%d, log lsn=%d",
+              page_num, record_page_handler.page_lsn(), lsn);
+    return RC::SUCCESS;
+  }
+
+  clear_all_visible(page_num);
+  for (size_t i = 0; i < datas.size() && OB_SUCC(ret); i++) {
+    ASSERT(rids[i].page_num == page_num, "records of a log should be in one page. rid=%s, page num=%d",
+           rids[i].to_string().c_str(), page_num);
+    ret = record_page_handler.recover_insert_record(datas[i], rids[i]);
+  }
+
+  if (OB_SUCC(ret)) {
+    record_page_handler.update_page_lsn(lsn);
+    redone = true;
+  }
+  free_space_map_.update(page_num, record_page_handler.free_space_level());
+  return ret;
+}
+
+RC RecordFileHandler::recover_visit_record(const RID &rid, LSN lsn, function<void(Record &)> visitor, bool &redone)
+{
+  redone = false;
+
+  RecordPageHandler page_handler;
+  RC rc = page_handler.init(*disk_buffer_pool_, rid.page_num, false /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
+    return rc;
+  }
+
+  if (page_handler.page_lsn() >= lsn) {
+    LOG_TRACE("skip redo update. rid=%s, page lsn=%d, log lsn=%d",
+              rid.to_string().c_str(), page_handler.page_lsn(), lsn);
+    return RC::SUCCESS;
+  }
+
+  Record record;
+  rc = page_handler.get_record(&rid, &record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  visitor(record);
+  clear_all_visible(rid.page_num);
+  rc = page_handler.update_record(rid, record.data());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  page_handler.update_page_lsn(lsn);
+  redone = true;
+  return rc;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
@@ -437,19 +1209,16 @@ RC RecordFileHandler::delete_record(const RID *rid)
     return rc;
   }
 
+  clear_all_visible(rid->page_num);
   rc = page_handler.delete_record(rid);
-  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
-  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
-  // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
-  page_handler.cleanup();
   if (OB_SUCC(rc)) {
-    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
-    // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+    // 页面上的记录都删除之后，page_handler 就已经释放了页面
+    const bool    page_released = page_handler.get_page_num() != rid->page_num;
+    const uint8_t level         = page_released ? FreeSpaceMap::EMPTY_LEVEL : page_handler.free_space_level();
+    free_space_map_.update(rid->page_num, level);
+    LOG_TRACE("update free space level of page %d to %d", rid->page_num, level);
   }
+  page_handler.cleanup();
   return rc;
 }
 
@@ -460,6 +1229,16 @@ RC RecordFileHandler::get_record(RecordPageHandler &page_handler, const RID *rid
     return RC::INVALID_ARGUMENT;
   }
 
+  // 只读访问先使用乐观读把记录复制出来，不用一直拿着页面的读锁
+  // 如果 page_handler 已经拿着这个页面的锁了，就直接访问页面
+  if (readonly && page_handler.get_page_num() != rid->page_num) {
+    page_handler.cleanup();
+    RC rc = RecordPageHandler::optimistic_get_record(*disk_buffer_pool_, *rid, rec);
+    if (rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+      return rc;
+    }
+  }
+
   RC ret = page_handler.init(*disk_buffer_pool_, rid->page_num, readonly);
   if (OB_FAIL(ret) && ret != RC::RECORD_OPENNED) {
     LOG_ERROR("Failed to init record page handler.page number=%d", rid->page_num);
@@ -469,7 +1248,8 @@ RC RecordFileHandler::get_record(RecordPageHandler &page_handler, const RID *rid
   return page_handler.get_record(rid, rec);
 }
 
-RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor)
+RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor,
+                                   const RecordLogger &logger /* = nullptr */)
 {
   RecordPageHandler page_handler;
 
@@ -486,10 +1266,76 @@ RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<
     return rc;
   }
 
+  // 写日志失败时要把记录恢复成原来的样子。定长格式下 visitor 直接修改的是页面上的数据
+  std::vector<char> origin;
+  if (!readonly && logger) {
+    origin.assign(record.data(), record.data() + record.len());
+  }
+
   visitor(record);
+  if (!readonly) {
+    clear_all_visible(rid.page_num);
+    rc = page_handler.update_record(rid, record.data());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    } else if (logger) {
+      rc = log_page(page_handler, logger, 0, 1);
+      if (OB_FAIL(rc)) {
+        RC rc2 = page_handler.update_record(rid, origin.data());
+        if (OB_FAIL(rc2)) {
+          LOG_ERROR("failed to restore record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc2));
+        }
+      }
+    }
+  }
   return rc;
 }
 
+bool RecordFileHandler::is_all_visible(PageNum page_num) const
+{
+  lock_guard<common::Mutex> guard(all_visible_lock_);
+  return all_visible_pages_.contains(page_num);
+}
+
+RC RecordFileHandler::mark_all_visible_if(
+    PageNum page_num, function<bool(const Record &)> visible, bool &all_visible)
+{
+  all_visible = false;
+
+  RecordPageHandler page_handler;
+  RC rc = page_handler.init(*disk_buffer_pool_, page_num, true /*readonly*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  RecordPageIterator iterator;
+  iterator.init(page_handler);
+  Record record;
+  while (iterator.has_next()) {
+    rc = iterator.next(record);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get record from page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+    if (!visible(record)) {
+      return RC::SUCCESS;
+    }
+  }
+
+  // 还拿着页面的读锁，修改页面的线程这时不会清除标记
+  lock_guard<common::Mutex> guard(all_visible_lock_);
+  all_visible_pages_.insert(page_num);
+  all_visible = true;
+  return RC::SUCCESS;
+}
+
+void RecordFileHandler::clear_all_visible(PageNum page_num)
+{
+  lock_guard<common::Mutex> guard(all_visible_lock_);
+  all_visible_pages_.erase(page_num);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileScanner::~RecordFileScanner() { close_scan(); }
@@ -509,6 +1355,9 @@ RC RecordFileScanner::open_scan(
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
+  // 表比较大时使用页帧环，扫描读入的页面只在环中循环使用页帧
+  buffer_ring_ = buffer_pool.create_scan_ring();
+  read_ahead_.init(buffer_pool, buffer_ring_.get());
   condition_filter_ = condition_filter;
 
   rc = fetch_next_record();
@@ -541,8 +1390,9 @@ RC RecordFileScanner::fetch_next_record()
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
+    read_ahead_.access(page_num);
     record_page_handler_.cleanup();
-    rc = record_page_handler_.init(*disk_buffer_pool_, page_num, readonly_);
+    rc = record_page_handler_.init(*disk_buffer_pool_, page_num, readonly_, buffer_ring_.get());
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
@@ -602,6 +1452,82 @@ RC RecordFileScanner::fetch_next_record_in_page()
   return RC::RECORD_EOF;
 }
 
+RC RecordFileScanner::next_batch(RecordBatch &batch)
+{
+  RC rc = RC::SUCCESS;
+  if (has_next()) {
+    // open_scan 已经定位到了当前页面上的第一条记录，从这条记录开始
+    const SlotNum start_slot = next_record_.rid().slot_num;
+    next_record_.rid().slot_num = -1;
+    record_page_iterator_       = RecordPageIterator();
+    rc = fill_batch(start_slot, batch);
+    if (OB_FAIL(rc) || !batch.empty()) {
+      return rc;
+    }
+  }
+
+  // 上一批记录用完了，这时才释放它们所在的页面
+  while (bp_iterator_.has_next()) {
+    PageNum page_num = bp_iterator_.next();
+    read_ahead_.access(page_num);
+    record_page_handler_.cleanup();
+    rc = record_page_handler_.init(*disk_buffer_pool_, page_num, readonly_, buffer_ring_.get());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    rc = fill_batch(0, batch);
+    if (OB_FAIL(rc) || !batch.empty()) {
+      return rc;
+    }
+  }
+
+  batch.clear();
+  record_page_handler_.cleanup();
+  return RC::RECORD_EOF;
+}
+
+RC RecordFileScanner::fill_batch(SlotNum start_slot, RecordBatch &batch)
+{
+  RC rc = record_page_handler_.get_records(start_slot, batch);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get records from page. page_num=%d, rc=%s", record_page_handler_.get_page_num(), strrc(rc));
+    return rc;
+  }
+
+  if (condition_filter_ == nullptr && trx_ == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  // 在选择向量中去掉不满足条件和不可见的记录
+  Record record;
+  int    selected = 0;
+  for (int i = 0; i < batch.size(); i++) {
+    batch.get_record(i, record);
+    if (condition_filter_ != nullptr && !condition_filter_->filter(record)) {
+      continue;
+    }
+
+    if (trx_ != nullptr) {
+      rc = trx_->visit_record(table_, record, readonly_);
+      if (rc == RC::RECORD_INVISIBLE) {
+        continue;
+      }
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    batch.slots_[selected]   = batch.slots_[i];
+    batch.offsets_[selected] = batch.offsets_[i];
+    selected++;
+  }
+  batch.slots_.resize(selected);
+  batch.offsets_.resize(selected);
+  return RC::SUCCESS;
+}
+
 RC RecordFileScanner::close_scan()
 {
   if (disk_buffer_pool_ != nullptr) {
@@ -613,6 +1539,8 @@ RC RecordFileScanner::close_scan()
   }
 
   record_page_handler_.cleanup();
+  record_page_iterator_ = RecordPageIterator();
+  buffer_ring_.reset();
 
   return RC::SUCCESS;
 }
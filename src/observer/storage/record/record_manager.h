@@ -16,9 +16,13 @@ See the Mulan PSL v2 for more details. */
 
 #include <sstream>
 #include <limits>
+#include <span>
+#include <unordered_set>
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/read_ahead.h"
 #include "storage/trx/latch_memo.h"
 #include "storage/record/record.h"
+#include "storage/record/free_space_map.h"
 #include "common/lang/bitmap.h"
 
 class ConditionFilter;
@@ -45,6 +49,10 @@ class Table;
  * 问题2：如何更有效地存放不定长数据呢？
  * 问题3：如果一个页面不能存放一个记录，那么怎么组织记录存放效果更好呢？
  *
+ * 建表时也可以选择变长格式(RecordFormat::SLOTTED)，回答了前两个问题：页面上有一个槽位目录，slot num
+ * 是槽位目录的下标，槽位中记录了记录在页面上的实际位置和长度。字符串字段只保存实际使用的部分，
+ * 访问记录时再解码成定长的格式。页面的格式记录在页头中，参考 SlottedPageHeader。
+ *
  * 按照上面的描述，这里提供了几个类，分别是：
  * - RecordFileHandler：管理整个文件/表的记录增删改查
  * - RecordPageHandler：管理单个页面上记录的增删改查
@@ -69,6 +77,86 @@ struct PageHeader
   int32_t first_record_offset;  ///< 第一条记录的偏移量
 };
 
+/**
+ * @brief 变长格式的页面，PageHeader::record_size 是这个值
+ */
+static constexpr int32_t SLOTTED_PAGE_RECORD_SIZE = -1;
+
+/**
+ * @brief 变长格式的页面上紧跟在 PageHeader 后面的页头
+ * @ingroup RecordManager
+ * @details 变长格式下 PageHeader 中各个字段的含义：
+ * - record_num          当前页面记录的个数
+ * - record_real_size    解码后每条记录的大小，与定长格式一样
+ * - record_size         固定是 SLOTTED_PAGE_RECORD_SIZE，用来区分两种格式
+ * - record_capacity     槽位目录中槽位的个数，包括空闲的槽位
+ * - first_record_offset 记录区的起始位置，记录从页尾往前分配
+ */
+struct SlottedPageHeader
+{
+  int32_t fragment_size;     ///< 删除或者移动记录留下的碎片空间，整理页面之后可以重新使用
+  int32_t varlen_field_num;  ///< 变长字段的个数，变长字段(VarlenField)紧跟在这个页头后面
+};
+
+/**
+ * @brief 变长格式页面上槽位目录中的一个槽位
+ * @ingroup RecordManager
+ */
+struct RecordSlot
+{
+  uint16_t offset;  ///< 记录在页面上的偏移量，0表示空闲的槽位
+  uint16_t len;     ///< 编码后记录的长度
+};
+
+/**
+ * @brief 一个页面上的一批记录
+ * @ingroup RecordManager
+ * @details 使用选择向量(selection vector)表示：每条记录是 data 中的一个偏移量。定长格式下 data 就是页帧的内存，
+ * 不复制记录；变长格式的记录需要解码，会解码到批次自己的缓存中。
+ * 记录的数据只在页面被pin住并加锁时有效，参考 RecordFileScanner::next_batch。
+ */
+class RecordBatch
+{
+public:
+  RecordBatch() = default;
+  ~RecordBatch() = default;
+
+  PageNum page_num() const { return page_num_; }
+  int     size() const { return static_cast<int>(slots_.size()); }
+  bool    empty() const { return slots_.empty(); }
+
+  RID   rid(int index) const { return RID(page_num_, slots_[index]); }
+  char *data(int index) { return data_ + offsets_[index]; }
+
+  /**
+   * @brief 把第 index 条记录放到 record 中，不复制数据
+   */
+  void get_record(int index, Record &record)
+  {
+    record.set_rid(page_num_, slots_[index]);
+    record.set_data(data(index), record_size_);
+  }
+
+  void clear()
+  {
+    page_num_ = BP_INVALID_PAGE_NUM;
+    data_     = nullptr;
+    slots_.clear();
+    offsets_.clear();
+  }
+
+private:
+  friend class RecordPageHandler;
+  friend class RecordFileScanner;
+
+  PageNum              page_num_    = BP_INVALID_PAGE_NUM;
+  char                *data_        = nullptr;  ///< 页帧的内存，或者变长格式下的 buffer_
+  int                  record_size_ = 0;
+  std::vector<SlotNum> slots_;                  ///< 每条记录的槽位号
+  std::vector<int>     offsets_;                ///< 选择向量，每条记录在 data_ 中的偏移量
+  std::vector<char>    buffer_;                 ///< 变长格式下解码出来的记录
+};
+
 /**
  * @brief 遍历一个页面中每条记录的iterator
  * @ingroup RecordManager
@@ -109,6 +197,7 @@ private:
   PageNum            page_num_            = BP_INVALID_PAGE_NUM;
   common::Bitmap     bitmap_;             ///< bitmap 的相关信息可以参考 RecordPageHandler 的说明
   SlotNum            next_slot_num_ = 0;  ///< 当前遍历到了哪一个slot
+  bool               slotted_       = false;  ///< 是否是变长格式的页面，变长格式下遍历槽位目录
 };
 
 /**
@@ -120,6 +209,16 @@ private:
  * |------------|------------------------|
  * | record1 | record2 | ..... | recordN |
  * @endcode
+ * 变长格式的页面是这样的，槽位目录从前往后增长，记录从页尾往前分配：
+ * @code
+ * | PageHeader | SlottedPageHeader | varlen fields | slot1 | slot2 | ... | slotN |
+ * |------------------------ free space -------------------------------------------|
+ * | recordN | ...... | record2 | record1 |
+ * @endcode
+ * 变长格式的记录编码时，定长字段原样保存，变长字段保存2字节的实际长度和实际使用的内容。
+ * 删除或者移动记录会留下碎片，连续的空闲空间不够时就整理页面，把记录挪到页尾，RID 不会变化。
+ * 变长格式下访问记录时都会解码复制出来，修改记录后需要调用 update_record 写回页面。
+ * 页面的格式在初始化页面时确定，之后根据页头自动识别。
  */
 class RecordPageHandler
 {
@@ -133,8 +232,9 @@ public:
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
    * @param readonly    是否只读。在访问页面时，需要对页面加锁
+   * @param ring        大范围扫描或批量写入时使用的页帧环，可以为空
    */
-  RC init(DiskBufferPool &buffer_pool, PageNum page_num, bool readonly);
+  RC init(DiskBufferPool &buffer_pool, PageNum page_num, bool readonly, BPBufferRing *ring = nullptr);
 
   /**
    * @brief 数据库恢复时，与普通的运行场景有所不同，不做任何并发操作，也不需要加锁
@@ -150,8 +250,21 @@ public:
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
    * @param record_size 每个记录的大小
+   * @param ring        批量写入时使用的页帧环，可以为空
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size);
+  RC init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size, BPBufferRing *ring = nullptr);
+
+  /**
+   * @brief 把一个新的页面初始化成变长格式
+   *
+   * @param buffer_pool   关联某个文件时，都通过buffer pool来做读写文件
+   * @param page_num      当前处理哪个页面
+   * @param record_size   解码后每个记录的大小
+   * @param varlen_fields 记录中的变长字段，按照偏移量从小到大排列
+   * @param ring          批量写入时使用的页帧环，可以为空
+   */
+  RC init_empty_slotted_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size,
+      const std::vector<VarlenField> &varlen_fields, BPBufferRing *ring = nullptr);
 
   /**
    * @brief 操作结束后做的清理工作，比如释放页面、解锁
@@ -166,6 +279,16 @@ public:
    */
   RC insert_record(const char *data, RID *rid);
 
+  /**
+   * @brief 在当前页面上连续插入多条记录，直到全部插入或者页面放不下为止
+   * @details 只在页面上查找一次空闲位置，后面的记录从上一条记录的位置之后继续找
+   *
+   * @param datas 要插入的记录
+   * @param rids  返回插入的位置，与 datas 一一对应，至少要有 datas.size() 个
+   * @return 插入了多少条记录，页面已经满了时返回0
+   */
+  int insert_records(std::span<const char *const> datas, RID *rids);
+
   /**
    * @brief 数据库恢复时，在指定位置插入数据
    * 
@@ -181,14 +304,55 @@ public:
    */
   RC delete_record(const RID *rid);
 
+  /**
+   * @brief 使用新的数据替换指定的记录
+   * @details 变长格式下记录变长时，页面上放不下就返回 RC::RECORD_NOMEM，原来的记录不会变化
+   *
+   * @param rid  要修改的记录
+   * @param data 新的记录数据。定长格式下可以就是页面上的记录
+   */
+  RC update_record(const RID &rid, const char *data);
+
   /**
    * @brief 获取指定位置的记录数据
    *
    * @param rid 指定的位置
-   * @param rec 返回指定的数据。这里不会将数据复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护
+   * @param rec 返回指定的数据。定长格式下不会将数据复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护。
+   *            变长格式下会把记录解码复制到rec中
    */
   RC get_record(const RID *rid, Record *rec);
 
+  /**
+   * @brief 把页面上从 start_slot 开始的所有记录放到 batch 中
+   * @details 定长格式下记录的数据直接指向页帧，调用者必须保证使用期间页面受到保护。
+   * 变长格式下会把记录解码到 batch 自己的缓存中
+   */
+  RC get_records(SlotNum start_slot, RecordBatch &batch);
+
+  /**
+   * @brief 使用乐观读的方式复制出指定位置的记录
+   * @details 只pin住页面而不加锁，复制完记录后校验页帧的版本号。复制出来的记录不再依赖页面，
+   * 也就不需要一直拿着页面的锁。
+   *
+   * @param buffer_pool 记录所在的文件
+   * @param rid         指定的位置
+   * @param rec         返回复制出来的记录
+   * @return 复制期间页面被修改时返回 RC::LOCKED_CONCURRENCY_CONFLICT，调用者需要退回到加锁的方式
+   */
+  static RC optimistic_get_record(DiskBufferPool &buffer_pool, const RID &rid, Record *rec);
+
+  /**
+   * @brief 记录修改这个页面的日志LSN，参考 Frame::lsn
+   * @details 只会增大页面的LSN。需要以修改模式初始化
+   */
+  void update_page_lsn(LSN lsn);
+
+  /**
+   * @brief 最后一次修改这个页面的日志LSN
+   * @details 恢复时页面的LSN不小于日志的LSN，说明这条日志的修改已经在页面上了
+   */
+  LSN page_lsn() const;
+
   /**
    * @brief 返回该记录页的页号
    */
@@ -196,9 +360,21 @@ public:
 
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
+   * @details 变长格式下按照最长的记录来计算
    */
   bool is_full() const;
 
+  /**
+   * @brief 当前页面还有多少空闲空间，参考 FreeSpaceMap
+   * @details 没有空间再插入一条记录时是 FreeSpaceMap::FULL_LEVEL，其它时候按照空闲的比例映射到 [1, EMPTY_LEVEL]
+   */
+  uint8_t free_space_level() const;
+
+  /**
+   * @brief 当前页面是否是变长格式
+   */
+  bool is_slotted() const { return slotted_header_ != nullptr; }
+
 protected:
   /**
    * @details 
@@ -225,6 +401,51 @@ protected:
     return frame_->data() + page_header_->first_record_offset + (page_header_->record_size * slot_num);
   }
 
+private:
+  /**
+   * @brief 根据页头设置页面上各个部分的位置
+   */
+  void init_page_layout();
+
+  /**
+   * @brief 变长格式下从指定槽位开始找到下一个有记录的槽位，没有时返回-1
+   */
+  SlotNum next_used_slot(SlotNum start_slot_num) const;
+
+  /**
+   * @brief 变长格式下槽位目录后面的连续空闲空间
+   */
+  int free_space() const;
+
+  /**
+   * @brief 变长格式下保证页面上有 size 大小的连续空闲空间，碎片空间足够时会整理页面
+   */
+  bool reserve_space(int size);
+
+  /**
+   * @brief 整理页面，把所有的记录挪到页尾，消除碎片
+   */
+  void compact();
+
+  /**
+   * @brief 把编码后的记录放到连续空闲空间的末尾，关联到指定的槽位上
+   */
+  void place_record(SlotNum slot_num, const char *record, int len);
+
+  /**
+   * @brief 把记录编码成变长格式，返回编码后的长度
+   */
+  int encode_record(const char *data, char *buffer) const;
+
+  /**
+   * @brief 乐观读变长格式页面上的记录，页面上的数据都不可靠，访问之前都要检查边界
+   */
+  static RC optimistic_get_slotted_record(const char *data, const RID &rid, Record *rec);
+
+  RC insert_slotted_record(const char *data, RID *rid, SlotNum start_slot = 0);
+  RC recover_insert_slotted_record(const char *data, const RID &rid);
+  RC update_slotted_record(const RID &rid, const char *data);
+
 protected:
   DiskBufferPool *disk_buffer_pool_ = nullptr;  ///< 当前操作的buffer pool(文件)
   Frame          *frame_            = nullptr;  ///< 当前操作页面关联的frame(frame的更多概念可以参考buffer pool和frame)
@@ -232,6 +453,10 @@ protected:
   PageHeader     *page_header_      = nullptr;  ///< 当前页面上页面头
   char           *bitmap_           = nullptr;  ///< 当前页面上record分配状态信息bitmap内存起始位置
 
+  SlottedPageHeader *slotted_header_ = nullptr;  ///< 变长格式页面的页头，定长格式时为空
+  VarlenField       *varlen_fields_  = nullptr;  ///< 变长格式页面上记录的变长字段
+  RecordSlot        *slots_          = nullptr;  ///< 变长格式页面上的槽位目录
+
 private:
   friend class RecordPageIterator;
 };
@@ -250,12 +475,16 @@ public:
   /**
    * @brief 初始化
    *
-   * @param buffer_pool 当前操作的是哪个文件
+   * @param buffer_pool   当前操作的是哪个文件
+   * @param format        新分配的页面使用什么格式存放记录
+   * @param varlen_fields 变长格式下记录中的变长字段，参考 RecordPageHandler::init_empty_slotted_page
+   * @param fsm_file      保存空闲空间表的文件，为空时不保存，每次打开都要遍历所有页面。参考 FreeSpaceMap
    */
-  RC init(DiskBufferPool *buffer_pool);
+  RC init(DiskBufferPool *buffer_pool, RecordFormat format = RecordFormat::FIXED,
+      const std::vector<VarlenField> &varlen_fields = {}, const char *fsm_file = nullptr);
 
   /**
-   * @brief 关闭，做一些资源清理的工作
+   * @brief 关闭，做一些资源清理的工作。会把空闲空间表保存下来
    */
   void close();
 
@@ -268,21 +497,51 @@ public:
 
   /**
    * @brief 插入一个新的记录到指定文件中，并返回该记录的标识符
+   * @details 根据空闲空间表找到当前线程可以插入的页面，并发插入时不同的线程会插入到不同的页面上
    * 
    * @param data        纪录内容
    * @param record_size 记录大小
    * @param rid         返回该记录的标识符
+   * @param ring        批量写入时使用的页帧环，新分配的页面放在环中，不会挤占其它的热点页面
+   * @param logger      插入之后还拿着页面写锁的时候写日志，参考 RecordLogger
    */
-  RC insert_record(const char *data, int record_size, RID *rid);
+  RC insert_record(const char *data, int record_size, RID *rid, BPBufferRing *ring = nullptr,
+                   const RecordLogger &logger = nullptr);
 
-   /**
-   * @brief 数据库恢复时，在指定文件指定位置插入数据
-   * 
-   * @param data        记录内容
+  /**
+   * @brief 批量插入记录
+   * @details 每个页面只加一次锁，在一次持有锁的过程中把页面尽量填满，再换下一个页面。
+   * 插入到同一个页面上的记录，在 rids 中是连续的
+   *
+   * @param datas       要插入的记录
    * @param record_size 记录大小
-   * @param rid         要插入记录的指定标识符
+   * @param rids        返回每条记录的标识符，与 datas 一一对应，至少要有 datas.size() 个
+   * @param ring        参考 insert_record
+   * @param logger      每个页面插入之后写一条日志，下标对应 datas
    */
-  RC recover_insert_record(const char *data, int record_size, const RID &rid);
+  RC insert_records(std::span<const char *const> datas, int record_size, RID *rids, BPBufferRing *ring = nullptr,
+                    const RecordLogger &logger = nullptr);
+
+  /**
+   * @brief 数据库恢复时，在指定文件指定位置插入一批数据
+   * @details 检查点会把未提交事务修改的页面也写回磁盘，所以重做的日志可能已经在页面上了。
+   * 页面的LSN不小于 lsn 时跳过这批记录，否则插入并把页面的LSN更新为 lsn。
+   * 一条批量插入日志只对应一个页面，要整批判断，不能一条条记录地判断
+   *
+   * @param datas       记录内容
+   * @param record_size 记录大小
+   * @param rids        每条记录的标识符，与 datas 一一对应，都在同一个页面上
+   * @param lsn         日志的LSN
+   * @param[out] redone 是否在页面上重做了这批记录
+   */
+  RC recover_insert_records(std::span<const char *const> datas, int record_size, const RID *rids, LSN lsn,
+                            bool &redone);
+
+  /**
+   * @brief 数据库恢复时修改一条记录，与 visit_record 类似
+   * @details 页面的LSN不小于 lsn 时不会修改记录，参考 recover_insert_records
+   */
+  RC recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor, bool &redone);
 
   /**
    * @brief 获取指定文件中标识符为rid的记录内容到rec指向的记录结构中
@@ -293,28 +552,78 @@ public:
    * @param rec[out] 通过这个参数返回获取到的记录
    * @note rec 参数返回的记录并不会复制数据内存。page_handler 对象会拿着相关的资源，比如 pin 住页面和加上页面锁。
    *       如果page_handler 释放了，那也不能再访问rec对象了。
+   *       只读访问时会先使用乐观读将记录复制出来，这时 page_handler 不会拿着任何资源。
    */
   RC get_record(RecordPageHandler &page_handler, const RID *rid, bool readonly, Record *rec);
 
   /**
    * @brief 与get_record类似，访问某个记录，并提供回调函数来操作相应的记录
+   * @details 不是只读访问时，回调函数返回后会把记录写回页面。变长格式下访问的是解码复制出来的记录，
+   * 修改记录都要通过这个接口
    *
    * @param rid 想要访问的记录ID
    * @param readonly 是否会修改记录
    * @param visitor  访问记录的回调函数
+   * @param logger   修改记录之后写日志，只有修改时才会调用
    */
-  RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
+  RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor,
+                  const RecordLogger &logger = nullptr);
+
+  /**
+   * @brief 页面上的记录是否对所有事务都可见(all-visible)
+   * @details 覆盖索引扫描时，页面全部可见就不需要读取记录来判断可见性。
+   * 标记只保存在内存中，重新打开后所有页面都不是全部可见的。修改页面上的记录时会清除标记
+   */
+  bool is_all_visible(PageNum page_num) const;
+
+  /**
+   * @brief 检查页面上的每条记录，都可见时把页面标记为全部可见
+   * @details 拿着页面的读锁检查，修改记录的地方拿着页面写锁清除标记，所以不会把正在修改的页面标记为全部可见
+   *
+   * @param page_num    要检查的页面
+   * @param visible     判断一条记录是否对所有事务都可见
+   * @param[out] all_visible 页面是否全部可见
+   */
+  RC mark_all_visible_if(PageNum page_num, std::function<bool(const Record &)> visible, bool &all_visible);
 
 private:
   /**
-   * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   * @brief 页面上的记录要修改了，清除全部可见的标记。调用时需要拿着页面的写锁
+   */
+  void clear_all_visible(PageNum page_num);
+
+  /**
+   * @brief 遍历所有的页面，初始化空闲空间表
    */
   RC init_free_pages();
 
+  /**
+   * @brief 找到一个可以插入记录的页面，找不到就分配一个新的页面，返回时已经拿到了页面的写锁
+   */
+  RC find_insert_page(RecordPageHandler &record_page_handler, int record_size, BPBufferRing *ring);
+
+  /**
+   * @brief 写日志并把LSN记录到页面上，失败时由调用者撤销页面上的修改
+   */
+  static RC log_page(RecordPageHandler &record_page_handler, const RecordLogger &logger, size_t begin, size_t end);
+
+  /**
+   * @brief 刚插入的记录写日志失败了，把它们从页面上删除
+   */
+  static void undo_insert(RecordPageHandler &record_page_handler, const RID *rids, int count);
+
+public:
+  const FreeSpaceMap &free_space_map() const { return free_space_map_; }
+
 private:
-  DiskBufferPool             *disk_buffer_pool_ = nullptr;
-  std::unordered_set<PageNum> free_pages_;  ///< 没有填充满的页面集合
-  common::Mutex               lock_;        ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
+  DiskBufferPool          *disk_buffer_pool_ = nullptr;
+  RecordFormat             format_           = RecordFormat::FIXED;  ///< 新分配的页面使用的格式
+  std::vector<VarlenField> varlen_fields_;   ///< 变长格式下记录中的变长字段
+  FreeSpaceMap             free_space_map_;  ///< 每个页面还有多少空闲空间
+  std::string              fsm_file_;        ///< 保存空闲空间表的文件
+
+  mutable common::Mutex       all_visible_lock_;
+  std::unordered_set<PageNum> all_visible_pages_;  ///< 全部可见的页面，参考 is_all_visible
 };
 
 /**
@@ -359,7 +668,22 @@ public:
    */
   RC   next(Record &record);
 
+  /**
+   * @brief 获取下一个页面上所有满足条件并且可见的记录
+   * @details 页面会一直pin住并加锁，直到下一次调用 next_batch 或者关闭扫描，batch 中的记录在这之前一直有效。
+   * 定长格式下不会复制记录，也不需要逐条调用 has_next。不要与 next 交替使用
+   *
+   * @param batch 返回的记录，不会为空
+   * @return 没有记录了返回 RC::RECORD_EOF
+   */
+  RC   next_batch(RecordBatch &batch);
+
 private:
+  /**
+   * @brief 获取当前页面上从 start_slot 开始的记录，过滤掉不满足条件和不可见的记录
+   */
+  RC fill_batch(SlotNum start_slot, RecordBatch &batch);
+
   /**
    * @brief 获取该文件中的下一条记录
    */
@@ -378,6 +702,8 @@ private:
   bool               readonly_         = false;    ///< 遍历出来的数据，是否可能对它做修改
 
   BufferPoolIterator bp_iterator_;                 ///< 遍历buffer pool的所有页面
+  BPReadAhead        read_ahead_;                  ///< 顺序扫描时预读后面的页面
+  std::unique_ptr<BPBufferRing> buffer_ring_;      ///< 大表扫描时使用的页帧环，不会把其它页面都淘汰出去
   ConditionFilter   *condition_filter_ = nullptr;  ///< 过滤record
   RecordPageHandler  record_page_handler_;         ///< 处理文件某页面的记录
   RecordPageIterator record_page_iterator_;        ///< 遍历某个页面上的所有record
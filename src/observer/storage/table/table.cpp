@@ -55,7 +55,8 @@ RC Table::create(int32_t table_id,
                  const char *name, 
                  const char *base_dir, 
                  int attribute_count, 
-                 const AttrInfoSqlNode attributes[])
+                 const AttrInfoSqlNode attributes[],
+                 RecordFormat row_format /* = RecordFormat::FIXED */)
 {
   if (table_id < 0) {
     LOG_WARN("invalid table id. table_id=%d, table_name=%s", table_id, name);
@@ -90,7 +91,7 @@ RC Table::create(int32_t table_id,
   close(fd);
 
   // 创建文件
-  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes)) != RC::SUCCESS) {
+  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes, row_format)) != RC::SUCCESS) {
     LOG_ERROR("Failed to init table meta. name:%s, ret:%d", name, rc);
     return rc;  // delete table file
   }
@@ -114,6 +115,9 @@ RC Table::create(int32_t table_id,
     return rc;
   }
 
+  // 同名的表以前留下的空闲空间表不能再用了
+  ::remove(table_fsm_file(base_dir, name).c_str());
+
   rc = init_record_handler(base_dir);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s due to init record handler failed.", data_file.c_str());
@@ -156,18 +160,35 @@ RC Table::open(const char *meta_file, const char *base_dir)
   const int index_num = table_meta_.index_num();
   for (int i = 0; i < index_num; i++) {
     const IndexMeta *index_meta = table_meta_.index(i);
-    const FieldMeta *field_meta = table_meta_.field(index_meta->field());
-    if (field_meta == nullptr) {
-      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
-                name(), index_meta->name(), index_meta->field());
-      // skip cleanup
-      //  do all cleanup action in destructive Table function
-      return RC::INTERNAL;
+    std::vector<FieldMeta> field_metas;
+    for (int j = 0; j < index_meta->field_num(); j++) {
+      const FieldMeta *field_meta = table_meta_.field(index_meta->field(j));
+      if (field_meta == nullptr) {
+        LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
+                  name(), index_meta->name(), index_meta->field(j));
+        // skip cleanup
+        //  do all cleanup action in destructive Table function
+        return RC::INTERNAL;
+      }
+      field_metas.push_back(*field_meta);
     }
 
     BplusTreeIndex *index = new BplusTreeIndex();
     std::string index_file = table_index_file(base_dir, name(), index_meta->name());
-    rc = index->open(index_file.c_str(), *index_meta, *field_meta);
+    std::string index_pool = BufferPoolManager::instance().table_pool(name(), true /*index*/);
+    rc = index->open(index_file.c_str(), *index_meta, field_metas, index_pool.c_str());
+    if (rc == RC::INDEX_VERSION_MISMATCH) {
+      // 老版本的索引文件不能直接使用，按照元数据重新创建索引
+      LOG_WARN("rebuilding index of old version. table=%s, index=%s, file=%s",
+               name(), index_meta->name(), index_file.c_str());
+      delete index;
+      index = new BplusTreeIndex();
+      ::remove(index_file.c_str());
+      rc = index->create(index_file.c_str(), *index_meta, field_metas, index_pool.c_str());
+      if (rc == RC::SUCCESS) {
+        rc = load_index(index, index_file.c_str(), index_meta->name());
+      }
+    }
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -182,10 +203,10 @@ RC Table::open(const char *meta_file, const char *base_dir)
   return rc;
 }
 
-RC Table::insert_record(Record &record)
+RC Table::insert_record(Record &record, BPBufferRing *ring /* = nullptr */, const RecordLogger &logger /* = nullptr */)
 {
   RC rc = RC::SUCCESS;
-  rc = record_handler_->insert_record(record.data(), table_meta_.record_size(), &record.rid());
+  rc = record_handler_->insert_record(record.data(), table_meta_.record_size(), &record.rid(), ring, logger);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
     return rc;
@@ -207,9 +228,73 @@ RC Table::insert_record(Record &record)
   return rc;
 }
 
-RC Table::visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor)
+RC Table::insert_records(
+    std::span<Record> records, BPBufferRing *ring /* = nullptr */, const RecordLogger &logger /* = nullptr */)
+{
+  std::vector<const char *> datas;
+  std::vector<RID>          rids(records.size(), RID(BP_INVALID_PAGE_NUM, -1));
+  datas.reserve(records.size());
+  for (Record &record : records) {
+    datas.push_back(record.data());
+  }
+
+  // 写日志时需要知道记录的RID
+  RecordLogger page_logger;
+  if (logger) {
+    page_logger = [&records, &rids, &logger](size_t begin, size_t end, LSN &lsn) {
+      for (size_t i = begin; i < end; i++) {
+        records[i].set_rid(rids[i]);
+      }
+      return logger(begin, end, lsn);
+    };
+  }
+
+  RC rc = record_handler_->insert_records(datas, table_meta_.record_size(), rids.data(), ring, page_logger);
+  if (rc != RC::SUCCESS) {
+    // 没有插入成功的记录的RID是无效的，这里只能逐条删除已经插入的记录
+    LOG_ERROR("Insert records failed. table name=%s, record num=%d, rc=%s",
+              table_meta_.name(), (int)records.size(), strrc(rc));
+    for (RID &rid : rids) {
+      if (rid.page_num != BP_INVALID_PAGE_NUM) {
+        record_handler_->delete_record(&rid);
+      }
+    }
+    return rc;
+  }
+
+  size_t indexed = 0;
+  for (; indexed < records.size(); indexed++) {
+    Record &record = records[indexed];
+    record.set_rid(rids[indexed]);
+    rc = insert_entry_of_indexes(record.data(), record.rid());
+    if (rc != RC::SUCCESS) {  // 可能出现了键值重复
+      break;
+    }
+  }
+
+  if (rc != RC::SUCCESS) {
+    for (size_t i = 0; i < records.size(); i++) {
+      if (i <= indexed) {
+        RC rc2 = delete_entry_of_indexes(records[i].data(), rids[i], false /*error_on_not_exists*/);
+        if (rc2 != RC::SUCCESS) {
+          LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
+                    name(), rc2, strrc(rc2));
+        }
+      }
+      RC rc2 = record_handler_->delete_record(&rids[i]);
+      if (rc2 != RC::SUCCESS) {
+        LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
+                  name(), rc2, strrc(rc2));
+      }
+    }
+  }
+  return rc;
+}
+
+RC Table::visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor,
+                       const RecordLogger &logger /* = nullptr */)
 {
-  return record_handler_->visit_record(rid, readonly, visitor);
+  return record_handler_->visit_record(rid, readonly, visitor, logger);
 }
 
 RC Table::get_record(const RID &rid, Record &record)
@@ -233,31 +318,67 @@ RC Table::get_record(const RID &rid, Record &record)
   return rc;
 }
 
-RC Table::recover_insert_record(Record &record)
+RC Table::recover_insert_record(Record &record, LSN lsn)
 {
-  RC rc = RC::SUCCESS;
-  rc = record_handler_->recover_insert_record(record.data(), table_meta_.record_size(), record.rid());
+  return recover_insert_records(std::span<Record>(&record, 1), lsn);
+}
+
+RC Table::recover_insert_records(std::span<Record> records, LSN lsn)
+{
+  std::vector<const char *> datas;
+  std::vector<RID>          rids;
+  datas.reserve(records.size());
+  rids.reserve(records.size());
+  for (const Record &record : records) {
+    datas.push_back(record.data());
+    rids.push_back(record.rid());
+  }
+
+  bool redone = false;
+  RC   rc     = record_handler_->recover_insert_records(datas, table_meta_.record_size(), rids.data(), lsn, redone);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
     return rc;
   }
 
-  rc = insert_entry_of_indexes(record.data(), record.rid());
-  if (rc != RC::SUCCESS) { // 可能出现了键值重复
-    RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false/*error_on_not_exists*/);
-    if (rc2 != RC::SUCCESS) {
-      LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
-                name(), rc2, strrc(rc2));
+  for (const Record &record : records) {
+    // 页面上已经有这次插入了，但是之后的修改可能已经删除了这条记录，甚至把位置给了其它的记录
+    if (!redone && !same_record_exists(record)) {
+      continue;
     }
-    rc2 = record_handler_->delete_record(&record.rid());
-    if (rc2 != RC::SUCCESS) {
-      LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
-                name(), rc2, strrc(rc2));
+
+    for (Index *index : indexes_) {
+      rc = index->insert_entry(record.data(), &record.rid());
+      if (rc == RC::RECORD_DUPLICATE_KEY) {
+        rc = RC::SUCCESS;
+      }
+      if (OB_FAIL(rc)) {
+        LOG_ERROR("failed to recover index entry. table name=%s, index name=%s, rid=%s, rc=%s",
+                  name(), index->index_meta().name(), record.rid().to_string().c_str(), strrc(rc));
+        return rc;
+      }
     }
   }
   return rc;
 }
 
+RC Table::recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor, bool &redone)
+{
+  return record_handler_->recover_visit_record(rid, lsn, visitor, redone);
+}
+
+bool Table::same_record_exists(const Record &record)
+{
+  Record current;
+  if (OB_FAIL(get_record(record.rid(), current))) {
+    return false;
+  }
+
+  // 事务字段在提交之后会变化，只比较用户字段
+  const int offset = table_meta_.field(table_meta_.sys_field_num())->offset();
+  return 0 == memcmp(current.data() + offset, record.data() + offset, table_meta_.record_size() - offset);
+}
+
 const char *Table::name() const
 {
   return table_meta_.name();
@@ -312,14 +433,26 @@ RC Table::init_record_handler(const char *base_dir)
 {
   std::string data_file = table_data_file(base_dir, table_meta_.name());
 
-  RC rc = BufferPoolManager::instance().open_file(data_file.c_str(), data_buffer_pool_);
+  BufferPoolManager &bpm       = BufferPoolManager::instance();
+  std::string        data_pool = bpm.table_pool(table_meta_.name(), false /*index*/);
+
+  RC rc = bpm.open_file(data_file.c_str(), data_buffer_pool_, data_pool.c_str());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to open disk buffer pool for file:%s. rc=%d:%s", data_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
+  // 变长格式下字符串字段只保存实际使用的部分
+  std::vector<VarlenField> varlen_fields;
+  for (const FieldMeta &field : *table_meta_.field_metas()) {
+    if (field.type() == CHARS) {
+      varlen_fields.push_back(VarlenField{static_cast<int16_t>(field.offset()), static_cast<int16_t>(field.len())});
+    }
+  }
+
+  std::string fsm_file = table_fsm_file(base_dir, table_meta_.name());
   record_handler_ = new RecordFileHandler();
-  rc = record_handler_->init(data_buffer_pool_);
+  rc = record_handler_->init(data_buffer_pool_, table_meta_.row_format(), varlen_fields, fsm_file.c_str());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%s", strrc(rc));
     data_buffer_pool_->close_file();
@@ -341,36 +474,26 @@ RC Table::get_record_scanner(RecordFileScanner &scanner, Trx *trx, bool readonly
   return rc;
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
+std::unique_ptr<BPBufferRing> Table::create_bulk_write_ring() const
 {
-  if (common::is_blank(index_name) || nullptr == field_meta) {
-    LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
-    return RC::INVALID_ARGUMENT;
-  }
-
-  IndexMeta new_index_meta;
-  RC rc = new_index_meta.init(index_name, *field_meta);
-  if (rc != RC::SUCCESS) {
-    LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
-             name(), index_name, field_meta->name());
-    return rc;
-  }
+  return data_buffer_pool_->create_bulk_write_ring();
+}
 
-  // 创建索引相关数据
-  BplusTreeIndex *index = new BplusTreeIndex();
-  std::string index_file = table_index_file(base_dir_.c_str(), name(), index_name);
-  rc = index->create(index_file.c_str(), new_index_meta, *field_meta);
+RC Table::load_index(BplusTreeIndex *index, const char *index_file, const char *index_name)
+{
+  // 遍历当前的所有数据，排好序之后批量构建这个索引
+  // 插入记录时不管事务是否提交都会写索引，所以这里也不按照事务的可见性过滤，每条记录都要放到索引中
+  RecordFileScanner scanner;
+  RC rc = get_record_scanner(scanner, nullptr /*trx*/, true/*readonly*/);
   if (rc != RC::SUCCESS) {
-    delete index;
-    LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    LOG_WARN("failed to create scanner while creating index. table=%s, index=%s, rc=%s", 
+             name(), index_name, strrc(rc));
     return rc;
   }
 
-  // 遍历当前的所有数据，插入这个索引
-  RecordFileScanner scanner;
-  rc = get_record_scanner(scanner, trx, true/*readonly*/);
+  rc = index->begin_bulk_load(index_file);
   if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to create scanner while creating index. table=%s, index=%s, rc=%s", 
+    LOG_WARN("failed to begin bulk load while creating index. table=%s, index=%s, rc=%s",
              name(), index_name, strrc(rc));
     return rc;
   }
@@ -383,7 +506,7 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
                name(), index_name, strrc(rc));
       return rc;
     }
-    rc = index->insert_entry(record.data(), &record.rid());
+    rc = index->bulk_insert_entry(record.data(), &record.rid());
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
                name(), index_name, strrc(rc));
@@ -391,6 +514,46 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
     }
   }
   scanner.close_scan();
+
+  rc = index->finish_bulk_load();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to bulk load index while creating index. table=%s, index=%s, rc=%s",
+             name(), index_name, strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC Table::create_index(Trx *trx, const std::vector<FieldMeta> &field_metas, const char *index_name)
+{
+  if (common::is_blank(index_name) || field_metas.empty()) {
+    LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  IndexMeta new_index_meta;
+  RC rc = new_index_meta.init(index_name, field_metas);
+  if (rc != RC::SUCCESS) {
+    LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
+             name(), index_name, field_metas[0].name());
+    return rc;
+  }
+
+  // 创建索引相关数据
+  BplusTreeIndex *index = new BplusTreeIndex();
+  std::string index_file = table_index_file(base_dir_.c_str(), name(), index_name);
+  std::string index_pool = BufferPoolManager::instance().table_pool(name(), true /*index*/);
+  rc = index->create(index_file.c_str(), new_index_meta, field_metas, index_pool.c_str());
+  if (rc != RC::SUCCESS) {
+    delete index;
+    LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    return rc;
+  }
+
+  rc = load_index(index, index_file.c_str(), index_name);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
   LOG_INFO("inserted all records into new index. table=%s, index=%s", name(), index_name);
   
   indexes_.push_back(index);
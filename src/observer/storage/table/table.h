@@ -15,17 +15,23 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <span>
+#include "common/types.h"
+#include "storage/record/record.h"
 #include "storage/table/table_meta.h"
 
 struct RID;
 class Record;
 class DiskBufferPool;
+class BPBufferRing;
 class RecordFileHandler;
 class RecordFileScanner;
 class ConditionFilter;
 class DefaultConditionFilter;
 class Index;
 class IndexScanner;
+class BplusTreeIndex;
 class RecordDeleter;
 class Trx;
 
@@ -46,13 +52,15 @@ public:
    * @param base_dir 表数据存放的路径
    * @param attribute_count 字段个数
    * @param attributes 字段
+   * @param row_format 记录在数据文件中的存放格式
    */
   RC create(int32_t table_id, 
             const char *path, 
             const char *name, 
             const char *base_dir, 
             int attribute_count, 
-            const AttrInfoSqlNode attributes[]);
+            const AttrInfoSqlNode attributes[],
+            RecordFormat row_format = RecordFormat::FIXED);
 
   /**
    * 打开一个表
@@ -74,19 +82,52 @@ public:
    * @brief 在当前的表中插入一条记录
    * @details 在表文件和索引中插入关联数据。这里只管在表中插入数据，不关心事务相关操作。
    * @param record[in/out] 传入的数据包含具体的数据，插入成功会通过此字段返回RID
+   * @param ring 批量导入数据时使用的页帧环，参考 create_bulk_write_ring
+   * @param logger 记录放到页面上之后，还拿着页面写锁的时候写日志，参考 RecordLogger。
+   * 写完日志之后插入索引失败时，记录会从表中删除，日志需要调用者处理
    */
-  RC insert_record(Record &record);
+  RC insert_record(Record &record, BPBufferRing *ring = nullptr, const RecordLogger &logger = nullptr);
+
+  /**
+   * @brief 在当前的表中插入多条记录
+   * @details 每个页面只加一次锁，参考 RecordFileHandler::insert_records。
+   * 任何一条记录插入失败(比如索引键值重复)时，这一批记录都不会插入
+   * @param records[in/out] 要插入的记录，插入成功会返回每条记录的RID
+   * @param ring 参考 insert_record
+   * @param logger 每个页面写一条日志，调用时 records 中对应的记录已经有了RID
+   */
+  RC insert_records(std::span<Record> records, BPBufferRing *ring = nullptr, const RecordLogger &logger = nullptr);
   RC delete_record(const Record &record);
-  RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
+  RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor,
+                  const RecordLogger &logger = nullptr);
   RC get_record(const RID &rid, Record &record);
 
-  RC recover_insert_record(Record &record);
+  /**
+   * @brief 数据库恢复时重做插入日志，参考 RecordFileHandler::recover_insert_records
+   * @details 一条日志中的记录都在同一个页面上。索引不记日志，崩溃前可能已经写回了磁盘，
+   * 所以重做时已经存在的索引项会忽略
+   * @param lsn 日志的LSN
+   */
+  RC recover_insert_records(std::span<Record> records, LSN lsn);
+  RC recover_insert_record(Record &record, LSN lsn);
+  RC recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor, bool &redone);
 
   // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name);
+  /**
+   * @brief 创建索引
+   * @param field_metas 索引包含的字段，多个字段时创建的是组合索引
+   */
+  RC create_index(Trx *trx, const std::vector<FieldMeta> &field_metas, const char *index_name);
 
   RC get_record_scanner(RecordFileScanner &scanner, Trx *trx, bool readonly);
 
+  /**
+   * @brief 创建批量写入数据文件时使用的页帧环
+   * @details 导入大量数据时，新分配的页面只在环中循环使用页帧，不会把其它的热点页面都淘汰出去。
+   * 没有开启页帧环时返回空
+   */
+  std::unique_ptr<BPBufferRing> create_bulk_write_ring() const;
+
   RecordFileHandler *record_handler() const
   {
     return record_handler_;
@@ -104,12 +145,26 @@ private:
   RC insert_entry_of_indexes(const char *record, const RID &rid);
   RC delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists);
 
+  /**
+   * @brief 表中 record.rid() 位置上是否还是同样的记录，不比较事务字段
+   */
+  bool same_record_exists(const Record &record);
+
 private:
   RC init_record_handler(const char *base_dir);
 
+  /**
+   * @brief 把表中所有的记录批量放到一个刚创建的空索引中
+   */
+  RC load_index(BplusTreeIndex *index, const char *index_file, const char *index_name);
+
 public:
   Index *find_index(const char *index_name) const;
   Index *find_index_by_field(const char *field_name) const;
+  const std::vector<Index *> &indexes() const
+  {
+    return indexes_;
+  }
 
 private:
   std::string base_dir_;
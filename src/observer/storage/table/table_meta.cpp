@@ -26,13 +26,15 @@ static const Json::StaticString FIELD_TABLE_ID("table_id");
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_ROW_FORMAT("row_format");
 
 TableMeta::TableMeta(const TableMeta &other)
     : table_id_(other.table_id_),
     name_(other.name_),
     fields_(other.fields_),
     indexes_(other.indexes_),
-    record_size_(other.record_size_)
+    record_size_(other.record_size_),
+    row_format_(other.row_format_)
 {}
 
 void TableMeta::swap(TableMeta &other) noexcept
@@ -41,9 +43,11 @@ void TableMeta::swap(TableMeta &other) noexcept
   fields_.swap(other.fields_);
   indexes_.swap(other.indexes_);
   std::swap(record_size_, other.record_size_);
+  std::swap(row_format_, other.row_format_);
 }
 
-RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[])
+RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+    RecordFormat row_format /* = RecordFormat::FIXED */)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Name cannot be empty");
@@ -87,6 +91,7 @@ RC TableMeta::init(int32_t table_id, const char *name, int field_num, const Attr
   }
 
   record_size_ = field_offset;
+  row_format_  = row_format;
 
   table_id_ = table_id;
   name_     = name;
@@ -196,6 +201,7 @@ int TableMeta::serialize(std::ostream &ss) const
   Json::Value table_value;
   table_value[FIELD_TABLE_ID]   = table_id_;
   table_value[FIELD_TABLE_NAME] = name_;
+  table_value[FIELD_ROW_FORMAT] = record_format_name(row_format_);
 
   Json::Value fields_value;
   for (const FieldMeta &field : fields_) {
@@ -253,6 +259,15 @@ int TableMeta::deserialize(std::istream &is)
 
   std::string table_name = table_name_value.asString();
 
+  // 没有记录格式的是早期创建的表，都是定长格式
+  RecordFormat row_format = RecordFormat::FIXED;
+  const Json::Value &row_format_value = table_value[FIELD_ROW_FORMAT];
+  if (!row_format_value.isNull() &&
+      (!row_format_value.isString() || record_format_from_name(row_format_value.asCString(), row_format) != RC::SUCCESS)) {
+    LOG_ERROR("Invalid row format. json value=%s", row_format_value.toStyledString().c_str());
+    return -1;
+  }
+
   const Json::Value &fields_value = table_value[FIELD_FIELDS];
   if (!fields_value.isArray() || fields_value.size() <= 0) {
     LOG_ERROR("Invalid table meta. fields is not array, json value=%s", fields_value.toStyledString().c_str());
@@ -279,6 +294,7 @@ int TableMeta::deserialize(std::istream &is)
   table_id_ = table_id;
   name_.swap(table_name);
   fields_.swap(fields);
+  row_format_  = row_format;
   record_size_ = fields_.back().offset() + fields_.back().len() - fields_.begin()->offset();
 
   const Json::Value &indexes_value = table_value[FIELD_INDEXES];
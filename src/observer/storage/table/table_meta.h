@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/rc.h"
 #include "storage/field/field_meta.h"
 #include "storage/index/index_meta.h"
+#include "storage/record/record.h"
 #include "common/lang/serializable.h"
 
 /**
@@ -36,7 +37,8 @@ public:
 
   void swap(TableMeta &other) noexcept;
 
-  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[]);
+  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+      RecordFormat row_format = RecordFormat::FIXED);
 
   RC add_index(const IndexMeta &index);
 
@@ -63,6 +65,11 @@ public:
 
   int record_size() const;
 
+  /**
+   * @brief 记录在数据文件中的存放格式，参考 RecordPageHandler
+   */
+  RecordFormat row_format() const { return row_format_; }
+
 public:
   int serialize(std::ostream &os) const override;
   int deserialize(std::istream &is) override;
@@ -77,4 +84,5 @@ protected:
   std::vector<IndexMeta> indexes_;
 
   int record_size_ = 0;
+  RecordFormat row_format_ = RecordFormat::FIXED;
 };
@@ -106,6 +106,15 @@ bool LatchMemo::try_slatch(Frame *frame)
   return ret;
 }
 
+bool LatchMemo::try_xlatch(Frame *frame)
+{
+  bool ret = frame->try_write_latch();
+  if (ret) {
+    items_.emplace_back(LatchMemoType::EXCLUSIVE, frame);
+  }
+  return ret;
+}
+
 void LatchMemo::xlatch(common::SharedMutex *lock)
 {
   lock->lock();
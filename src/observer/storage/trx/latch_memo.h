@@ -62,6 +62,7 @@ public:
   void xlatch(Frame *frame);
   void slatch(Frame *frame);
   bool try_slatch(Frame *frame);
+  bool try_xlatch(Frame *frame);
 
   void xlatch(common::SharedMutex *lock);
   void slatch(common::SharedMutex *lock);
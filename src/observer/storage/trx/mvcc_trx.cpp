@@ -52,6 +52,27 @@ int32_t MvccTrxKit::next_trx_id()
   return ++current_trx_id_;
 }
 
+int32_t MvccTrxKit::begin_trx_id()
+{
+  lock_guard<common::Mutex> guard(lock_);
+  const int32_t trx_id = next_trx_id();
+  active_trx_ids_.insert(trx_id);
+  return trx_id;
+}
+
+void MvccTrxKit::end_trx_id(int32_t trx_id)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  active_trx_ids_.erase(trx_id);
+}
+
+int32_t MvccTrxKit::min_active_trx_id()
+{
+  // 与 begin_trx_id 使用同一把锁，不会漏掉刚分配了事务号的事务
+  lock_guard<common::Mutex> guard(lock_);
+  return active_trx_ids_.empty() ? current_trx_id_.load() : *active_trx_ids_.begin();
+}
+
 int32_t MvccTrxKit::max_trx_id() const
 {
   return numeric_limits<int32_t>::max();
@@ -82,6 +103,15 @@ Trx *MvccTrxKit::create_trx(int32_t trx_id)
   return trx;
 }
 
+void MvccTrxKit::recover_trx_id(int32_t trx_id)
+{
+  lock_.lock();
+  if (current_trx_id_ < trx_id) {
+    current_trx_id_ = trx_id;
+  }
+  lock_.unlock();
+}
+
 void MvccTrxKit::destroy_trx(Trx *trx)
 {
   lock_.lock();
@@ -141,16 +171,24 @@ RC MvccTrx::insert_record(Table *table, Record &record)
   begin_field.set_int(record, -trx_id_);
   end_field.set_int(record, trx_kit_.max_trx_id());
 
-  RC rc = table->insert_record(record);
+  // 记录放到页面上之后，在放开页面写锁之前写日志并更新页面的LSN，页面写回磁盘时一定能看到这条日志
+  bool logged = false;
+  auto logger = [this, table, &record, &logged](size_t, size_t, LSN &lsn) {
+    RC rc = log_manager_->append_log(CLogType::INSERT, trx_id_, table->table_id(), record.rid(), record.len(),
+                                     0/*offset*/, record.data(), &lsn);
+    logged = OB_SUCC(rc);
+    return rc;
+  };
+
+  RC rc = table->insert_record(record, nullptr/*ring*/, logger);
   if (rc != RC::SUCCESS) {
+    if (logged) {
+      log_removed_inserts(table, span<const Record>(&record, 1));
+    }
     LOG_WARN("failed to insert record into table. rc=%s", strrc(rc));
     return rc;
   }
 
-  rc = log_manager_->append_log(CLogType::INSERT, trx_id_, table->table_id(), record.rid(), record.len(), 0/*offset*/, record.data());
-  ASSERT(rc == RC::SUCCESS, "failed to append insert record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
-      trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
-
   pair<OperationSet::iterator, bool> ret = 
         operations_.insert(Operation(Operation::Type::INSERT, table, record.rid()));
   if (!ret.second) {
@@ -160,6 +198,79 @@ RC MvccTrx::insert_record(Table *table, Record &record)
   return rc;
 }
 
+RC MvccTrx::insert_records(Table *table, span<Record> records)
+{
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  for (Record &record : records) {
+    begin_field.set_int(record, -trx_id_);
+    end_field.set_int(record, trx_kit_.max_trx_id());
+  }
+
+  // 插入到同一个页面上的记录是连续的，每个页面写一条日志。与单条插入一样，在放开页面写锁之前写日志
+  size_t       logged_num = 0;
+  vector<char> log_data;
+  auto logger = [this, table, records, &logged_num, &log_data](size_t begin, size_t end, LSN &lsn) {
+    const int32_t record_num = static_cast<int32_t>(end - begin);
+    const int32_t record_len = records[begin].len();
+    log_data.resize(CLogBatchInsertHeader::data_len(record_num, record_len));
+
+    CLogBatchInsertHeader header;
+    header.record_num_ = record_num;
+    header.record_len_ = record_len;
+    memcpy(log_data.data(), &header, sizeof(header));
+
+    char *slot_data   = log_data.data() + sizeof(header);
+    char *record_data = slot_data + record_num * sizeof(SlotNum);
+    for (size_t i = begin; i < end; i++) {
+      memcpy(slot_data, &records[i].rid().slot_num, sizeof(SlotNum));
+      memcpy(record_data, records[i].data(), record_len);
+      slot_data += sizeof(SlotNum);
+      record_data += record_len;
+    }
+
+    RC rc = log_manager_->append_log(CLogType::BATCH_INSERT, trx_id_, table->table_id(), records[begin].rid(),
+        static_cast<int32_t>(log_data.size()), 0/*offset*/, log_data.data(), &lsn);
+    if (OB_SUCC(rc)) {
+      logged_num = end;
+    }
+    return rc;
+  };
+
+  RC rc = table->insert_records(records, nullptr/*ring*/, logger);
+  if (OB_FAIL(rc)) {
+    if (logged_num > 0) {
+      log_removed_inserts(table, records.first(logged_num));
+    }
+    LOG_WARN("failed to insert records into table. record num=%d, rc=%s", (int)records.size(), strrc(rc));
+    return rc;
+  }
+
+  for (Record &record : records) {
+    pair<OperationSet::iterator, bool> ret = 
+          operations_.insert(Operation(Operation::Type::INSERT, table, record.rid()));
+    if (!ret.second) {
+      LOG_WARN("failed to insert operation(insertion) into operation set: duplicate");
+      return RC::INTERNAL;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void MvccTrx::log_removed_inserts(Table *table, span<const Record> records)
+{
+  for (const Record &record : records) {
+    LSN lsn = 0;
+    RC  rc  = log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr, &lsn);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to append delete log for removed record. trx id=%d, table id=%d, rid=%s, rc=%s",
+                trx_id_, table->table_id(), record.rid().to_string().c_str(), strrc(rc));
+    }
+  }
+}
+
 RC MvccTrx::delete_record(Table * table, Record &record)
 {
   Field begin_field;
@@ -176,10 +287,21 @@ RC MvccTrx::delete_record(Table * table, Record &record)
     return RC::SUCCESS;
   }
   
+  // 变长格式下扫描出来的记录是复制出来的，要通过 visit_record 把修改写回页面
+  auto record_updater = [this, &end_field](Record &record) {
+    end_field.set_int(record, -trx_id_);
+  };
+  // 与插入一样，在放开页面写锁之前写日志并更新页面的LSN
+  auto logger = [this, table, &record](size_t, size_t, LSN &lsn) {
+    return log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr, &lsn);
+  };
+  RC rc = table->visit_record(record.rid(), false/*readonly*/, record_updater, logger);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update end xid of record. rid=%s, rc=%s", record.rid().to_string().c_str(), strrc(rc));
+    return rc;
+  }
   end_field.set_int(record, -trx_id_);
-  RC rc = log_manager_->append_log(CLogType::DELETE, trx_id_, table->table_id(), record.rid(), 0, 0, nullptr);
-  ASSERT(rc == RC::SUCCESS, "failed to append delete record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
-      trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
+
   if (begin_xid == -trx_id_) {
     // fix：此处是为了修复由当前事务插入而又被当前事务删除时无法正确删除的问题：
     // 在当前事务中创建的记录从来未对外暴露过，未来方便今后添加垃圾回收功能，这里选择直接删除真实记录
@@ -203,6 +325,14 @@ RC MvccTrx::delete_record(Table * table, Record &record)
   return RC::SUCCESS;
 }
 
+bool MvccTrx::inserted_by_this_trx(Table *table, const Record &record) const
+{
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+  return begin_field.get_int(record) == -trx_id_;
+}
+
 RC MvccTrx::visit_record(Table *table, Record &record, bool readonly)
 {
   Field begin_field;
@@ -256,11 +386,39 @@ void MvccTrx::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_fi
   end_xid_field.set_field(&trx_fields.first[1]);
 }
 
+bool MvccTrx::is_page_all_visible(Table *table, PageNum page_num)
+{
+  RecordFileHandler *record_handler = table->record_handler();
+  if (record_handler->is_all_visible(page_num)) {
+    return true;
+  }
+
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  const int32_t min_active_trx_id = trx_kit_.min_active_trx_id();
+  const int32_t max_trx_id        = trx_kit_.max_trx_id();
+  auto visible_to_all = [&](const Record &record) {
+    const int32_t begin_xid = begin_field.get_int(record);
+    const int32_t end_xid   = end_field.get_int(record);
+    return begin_xid > 0 && begin_xid <= min_active_trx_id && end_xid == max_trx_id;
+  };
+
+  bool all_visible = false;
+  RC rc = record_handler->mark_all_visible_if(page_num, visible_to_all, all_visible);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to check visibility of page. page num=%d, rc=%s", page_num, strrc(rc));
+    return false;
+  }
+  return all_visible;
+}
+
 RC MvccTrx::start_if_need()
 {
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
-    trx_id_ = trx_kit_.next_trx_id();
+    trx_id_ = trx_kit_.begin_trx_id();
     LOG_DEBUG("current thread change to new trx with %d", trx_id_);
     RC rc = log_manager_->begin_trx(trx_id_);
     ASSERT(rc == RC::SUCCESS, "failed to append log to clog. rc=%s", strrc(rc));
@@ -292,6 +450,10 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
         auto record_updater = [ this, &begin_xid_field, commit_xid](Record &record) {
           LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s",
                     trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
+          if (recovering_ && begin_xid_field.get_int(record) != -trx_id_) {
+            // 恢复时页面可能在提交之后写回过磁盘，已经是提交之后的样子了
+            return;
+          }
           ASSERT(begin_xid_field.get_int(record) == -this->trx_id_, 
                  "got an invalid record while committing. begin xid=%d, this trx id=%d", 
                  begin_xid_field.get_int(record), trx_id_);
@@ -300,6 +462,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
         };
 
         rc = operation.table()->visit_record(rid, false/*readonly*/, record_updater);
+        if (recovering_ && rc == RC::RECORD_NOT_EXIST) {
+          rc = RC::SUCCESS;
+        }
         ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
                rid.to_string().c_str(), strrc(rc));
       } break;
@@ -313,6 +478,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
 
         auto record_updater = [this, &end_xid_field, commit_xid](Record &record) {
           (void)this;
+          if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
+            return;
+          }
           ASSERT(end_xid_field.get_int(record) == -trx_id_, 
                  "got an invalid record while committing. end xid=%d, this trx id=%d", 
                  end_xid_field.get_int(record), trx_id_);
@@ -321,6 +489,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
         };
 
         rc = operation.table()->visit_record(rid, false/*readonly*/, record_updater);
+        if (recovering_ && rc == RC::RECORD_NOT_EXIST) {
+          rc = RC::SUCCESS;
+        }
         ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
                rid.to_string().c_str(), strrc(rc));
       } break;
@@ -332,6 +503,7 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
   }
 
   operations_.clear();
+  trx_kit_.end_trx_id(trx_id_);
 
   if (!recovering_) {
     rc = log_manager_->commit_trx(trx_id_, commit_xid);
@@ -356,6 +528,11 @@ RC MvccTrx::rollback()
         // 也就是不需要从table中获取这条数据，可以直接从当前内存中获取
         // 这里也可以不删除，仅仅给数据加个标识位，等垃圾回收器来收割也行
         rc = table->get_record(rid, record); 
+        if (recovering_ && (rc == RC::RECORD_NOT_EXIST || (OB_SUCC(rc) && !inserted_by_this_trx(table, record)))) {
+          // 恢复时页面可能在回滚之后写回过磁盘，记录已经删除了，位置甚至已经给了其它的记录
+          rc = RC::SUCCESS;
+          break;
+        }
         ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s", 
                rid.to_string().c_str(), strrc(rc));
         rc = table->delete_record(record);
@@ -373,6 +550,9 @@ RC MvccTrx::rollback()
         trx_fields(table, begin_xid_field, end_xid_field);
 
         auto record_updater = [this, &end_xid_field](Record &record) {
+          if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
+            return;
+          }
           ASSERT(end_xid_field.get_int(record) == -trx_id_, 
                 "got an invalid record while rollback. end xid=%d, this trx id=%d", 
                 end_xid_field.get_int(record), trx_id_);
@@ -381,6 +561,9 @@ RC MvccTrx::rollback()
         };
         
         rc = table->visit_record(rid, false/*readonly*/, record_updater);
+        if (recovering_ && rc == RC::RECORD_NOT_EXIST) {
+          rc = RC::SUCCESS;
+        }
         ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
                rid.to_string().c_str(), strrc(rc));
       } break;
@@ -392,6 +575,7 @@ RC MvccTrx::rollback()
   }
 
   operations_.clear();
+  trx_kit_.end_trx_id(trx_id_);
 
   if (!recovering_) {
     rc = log_manager_->rollback_trx(trx_id_);
@@ -404,7 +588,8 @@ RC find_table(Db *db, const CLogRecord &log_record, Table *&table)
 {
   switch (clog_type_from_integer(log_record.header().type_)) {
     case CLogType::INSERT:
-    case CLogType::DELETE: {
+    case CLogType::DELETE:
+    case CLogType::BATCH_INSERT: {
       const CLogRecordData &data_record = log_record.data_record();
       table = db->find_table(data_record.table_id_);
       if (nullptr == table) {
@@ -428,13 +613,15 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
     return rc;
   }
 
+  // 检查点会把未提交事务修改过的页面也写回磁盘，页面的LSN不小于日志的LSN时，这条日志已经在页面上了
+  const LSN lsn = log_record.header().lsn_;
   switch (log_record.log_type()) {
     case CLogType::INSERT: {
       const CLogRecordData &data_record = log_record.data_record();
       Record record;
       record.set_data(const_cast<char *>(data_record.data_), data_record.data_len_);
       record.set_rid(data_record.rid_);
-      RC rc = table->recover_insert_record(record);
+      RC rc = table->recover_insert_record(record, lsn);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to recover insert. table=%s, log record=%s, rc=%s",
                  table->name(), log_record.to_string().c_str(), strrc(rc));
@@ -443,6 +630,35 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
       operations_.insert(Operation(Operation::Type::INSERT, table, record.rid()));
     } break;
 
+    case CLogType::BATCH_INSERT: {
+      const CLogRecordData &data_record = log_record.data_record();
+      CLogBatchInsertHeader header;
+      memcpy(&header, data_record.data_, sizeof(header));
+      ASSERT(data_record.data_len_ == CLogBatchInsertHeader::data_len(header.record_num_, header.record_len_),
+             "invalid batch insert log. log record=%s", log_record.to_string().c_str());
+
+      const char *slot_data   = data_record.data_ + sizeof(header);
+      const char *record_data = slot_data + header.record_num_ * sizeof(SlotNum);
+      vector<Record> records(header.record_num_);
+      for (int i = 0; i < header.record_num_; i++) {
+        SlotNum slot_num = 0;
+        memcpy(&slot_num, slot_data + i * sizeof(SlotNum), sizeof(SlotNum));
+
+        records[i].set_data(const_cast<char *>(record_data + i * header.record_len_), header.record_len_);
+        records[i].set_rid(data_record.rid_.page_num, slot_num);
+      }
+
+      RC rc = table->recover_insert_records(records, lsn);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to recover batch insert. table=%s, log record=%s, rc=%s",
+                 table->name(), log_record.to_string().c_str(), strrc(rc));
+        return rc;
+      }
+      for (const Record &record : records) {
+        operations_.insert(Operation(Operation::Type::INSERT, table, record.rid()));
+      }
+    } break;
+
     case CLogType::DELETE: {
       const CLogRecordData &data_record = log_record.data_record();
       Field begin_field;
@@ -458,11 +674,32 @@ RC MvccTrx::redo(Db *db, const CLogRecord &log_record)
         end_field.set_int(record, -trx_id_);
       };
 
-      RC rc = table->visit_record(data_record.rid_, false/*readonly*/, record_updater);
-      ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-             data_record.rid_.to_string().c_str(), strrc(rc));
-      
-      operations_.insert(Operation(Operation::Type::DELETE, table, data_record.rid_));
+      bool redone = false;
+      RC rc = table->recover_visit_record(data_record.rid_, lsn, record_updater, redone);
+      if (OB_FAIL(rc) && rc != RC::RECORD_NOT_EXIST) {
+        LOG_WARN("failed to recover delete. table=%s, log record=%s, rc=%s",
+                 table->name(), log_record.to_string().c_str(), strrc(rc));
+        return rc;
+      }
+
+      // 与 delete_record 一样，删除当前事务自己插入的记录时直接删除真实的记录。
+      // 运行时删除记录不会更新页面的LSN，所以不管这条日志是否重做过都要检查一下
+      auto insert_operation = operations_.find(Operation(Operation::Type::INSERT, table, data_record.rid_));
+      if (insert_operation != operations_.end() && insert_operation->type() == Operation::Type::INSERT) {
+        operations_.erase(insert_operation);
+
+        Record record;
+        if (OB_SUCC(table->get_record(data_record.rid_, record)) && inserted_by_this_trx(table, record)) {
+          rc = table->delete_record(record);
+          if (OB_FAIL(rc)) {
+            LOG_WARN("failed to delete record inserted by current trx. table=%s, log record=%s, rc=%s",
+                     table->name(), log_record.to_string().c_str(), strrc(rc));
+            return rc;
+          }
+        }
+      } else if (rc != RC::RECORD_NOT_EXIST) {
+        operations_.insert(Operation(Operation::Type::DELETE, table, data_record.rid_));
+      }
     } break;
 
     case CLogType::MTR_COMMIT: {
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <set>
 #include <vector>
 
 #include "storage/trx/trx.h"
@@ -38,10 +39,27 @@ public:
    */
   Trx *find_trx(int32_t trx_id) override;
   void all_trxes(std::vector<Trx *> &trxes) override;
+  void recover_trx_id(int32_t trx_id) override;
 
 public:
   int32_t next_trx_id();
 
+  /**
+   * @brief 给新开始的事务分配事务号，并记录到活跃事务中
+   */
+  int32_t begin_trx_id();
+
+  /**
+   * @brief 事务提交或回滚之后，从活跃事务中删除
+   */
+  void end_trx_id(int32_t trx_id);
+
+  /**
+   * @brief 活跃事务中最小的事务号，没有活跃事务时返回当前最大的事务号
+   * @details 提交事务号不大于它的数据，对所有活跃的事务和以后开始的事务都是可见的
+   */
+  int32_t min_active_trx_id();
+
 public:
   int32_t max_trx_id() const;
 
@@ -52,6 +70,7 @@ private:
 
   common::Mutex      lock_;
   std::vector<Trx *> trxes_;
+  std::set<int32_t>  active_trx_ids_;  ///< 已经开始还没有结束的事务
 };
 
 /**
@@ -67,6 +86,12 @@ public:
   virtual ~MvccTrx();
 
   RC insert_record(Table *table, Record &record) override;
+
+  /**
+   * @brief 批量插入记录
+   * @details 插入到同一个页面上的记录只写一条 BATCH_INSERT 日志，参考 CLogBatchInsertHeader
+   */
+  RC insert_records(Table *table, std::span<Record> records) override;
   RC delete_record(Table *table, Record &record) override;
 
   /**
@@ -81,6 +106,12 @@ public:
    */
   RC visit_record(Table *table, Record &record, bool readonly) override;
 
+  /**
+   * @brief 页面上没有未提交的数据和已经删除的数据，并且所有数据对所有活跃事务都可见时，页面全部可见
+   * @details 检查通过的页面会记录在 RecordFileHandler 中，下次不用再检查，直到页面被修改
+   */
+  bool is_page_all_visible(Table *table, PageNum page_num) override;
+
   RC start_if_need() override;
   RC commit() override;
   RC rollback() override;
@@ -93,6 +124,18 @@ private:
   RC commit_with_trx_id(int32_t commit_id);
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
+  /**
+   * @brief 记录是否是当前事务插入而且还没有提交的
+   * @details 恢复时用来判断页面上的记录是否还是当前事务插入的那条
+   */
+  bool inserted_by_this_trx(Table *table, const Record &record) const;
+
+  /**
+   * @brief 插入记录的日志已经写了，但是之后插入索引失败，表又删除了这些记录
+   * @details 补写删除日志，重做时重新插入的这些记录对其它事务不可见
+   */
+  void log_removed_inserts(Table *table, std::span<const Record> records);
+
 private:
   static const int32_t MAX_TRX_ID = std::numeric_limits<int32_t>::max();
 
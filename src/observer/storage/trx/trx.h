@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include <unordered_set>
 #include <mutex>
 #include <utility>
+#include <span>
 
 #include "sql/parser/parse.h"
 #include "storage/record/record_manager.h"
@@ -128,6 +129,12 @@ public:
 
   virtual void destroy_trx(Trx *trx) = 0;
 
+  /**
+   * @brief 恢复时设置日志中出现过的最大事务编号，之后分配的事务编号都要比它大
+   * @details 从检查点开始恢复时，检查点之前的事务不会再创建出来，所以需要单独恢复事务编号
+   */
+  virtual void recover_trx_id(int32_t trx_id) {}
+
 public:
   static TrxKit *create(const char *name);
   static RC init_global(const char *name);
@@ -145,9 +152,21 @@ public:
   virtual ~Trx() = default;
 
   virtual RC insert_record(Table *table, Record &record) = 0;
+
+  /**
+   * @brief 批量插入记录，参考 Table::insert_records
+   * @details 任何一条记录插入失败时，这一批记录都不会插入
+   */
+  virtual RC insert_records(Table *table, std::span<Record> records) = 0;
   virtual RC delete_record(Table *table, Record &record) = 0;
   virtual RC visit_record(Table *table, Record &record, bool readonly) = 0;
 
+  /**
+   * @brief 页面上的记录是否对当前事务全部可见
+   * @details 覆盖索引扫描时使用。页面全部可见时可以直接使用索引中的数据，否则需要读取记录调用 visit_record
+   */
+  virtual bool is_page_all_visible(Table *table, PageNum page_num) = 0;
+
   virtual RC start_if_need() = 0;
   virtual RC commit() = 0;
   virtual RC rollback() = 0;
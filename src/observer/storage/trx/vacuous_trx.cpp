@@ -56,6 +56,11 @@ RC VacuousTrx::insert_record(Table *table, Record &record)
   return table->insert_record(record);
 }
 
+RC VacuousTrx::insert_records(Table *table, std::span<Record> records)
+{
+  return table->insert_records(records);
+}
+
 RC VacuousTrx::delete_record(Table *table, Record &record)
 {
   return table->delete_record(record);
@@ -42,8 +42,10 @@ public:
   virtual ~VacuousTrx() = default;
 
   RC insert_record(Table *table, Record &record) override;
+  RC insert_records(Table *table, std::span<Record> records) override;
   RC delete_record(Table *table, Record &record) override;
   RC visit_record(Table *table, Record &record, bool readonly) override;
+  bool is_page_all_visible(Table *table, PageNum page_num) override { return true; }
   RC start_if_need() override;
   RC commit() override;
   RC rollback() override;
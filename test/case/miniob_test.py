@@ -111,6 +111,7 @@ class MiniObServer:
     self.__config = config_file
     self.__server_port = server_port
     self.__server_socket = server_socket.strip()
+    self.__extra_args = []
 
     self.__process = None
 
@@ -179,6 +180,7 @@ class MiniObServer:
     else:
       observer_command.append('-p')
       observer_command.append(str(self.__server_port))
+    observer_command.extend(self.__extra_args)
 
     process = subprocess.Popen(observer_command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, cwd=self.__data_dir)
     return_code = process.poll()
@@ -221,6 +223,18 @@ class MiniObServer:
     _logger.info("miniob-server exit with code %d. pid=%s", return_code, str(self.__process.pid))
     return True
 
+  def restart_server(self, extra_args: List[str]) -> bool:
+    '''
+    重启服务端程序，数据目录保留，用来测试重启之后数据是否还在
+    extra_args 是追加到observer启动命令中的参数，比如 ['-t', 'mvcc']
+    '''
+    if not self.stop_server():
+      return False
+
+    self.__process = None
+    self.__extra_args = extra_args
+    return self.start_server()
+
   def clean(self):
     ''' 
     清理数据目录（如果没有配置调试模式）
@@ -346,8 +360,8 @@ class MiniObClient:
   def run_sql(self, sql: str) -> Tuple[bool, str]:
     try:
       data = str.encode(sql, GlobalConfig.default_encoding)
-      self.__socket.sendall(data)
-      self.__socket.sendall(b'\0')
+      # 语句和结束符'\0'一起发送。分开发送时，服务端可能把单独的'\0'当成一条新的请求
+      self.__socket.sendall(data + b'\0')
       _logger.debug("send command to server(size=%d) '%s'", len(data) + 1, sql)
       result = self.__recv_response()
       _logger.debug("receive result from server '%s'", result)
@@ -366,8 +380,9 @@ class CommandRunner:
   __command_prefix = "--"
   __comment_prefix = "#"
 
-  def __init__(self, result_writer: ResultWriter, server_port: int, unix_socket: str):
+  def __init__(self, result_writer: ResultWriter, server_port: int, unix_socket: str, restart_server = None):
     self.__result_writer = result_writer
+    self.__restart_server = restart_server
     self.__clients = {}
 
     # create default client
@@ -402,7 +417,7 @@ class CommandRunner:
     切换当前连接
     '''
 
-    client = self.__clients[name]
+    client = self.__clients.get(name)
     if client == None:
       _logger.error("No such client named %s", name)
       return False
@@ -419,7 +434,7 @@ class CommandRunner:
       _logger.error("Found empty client name")
       return False
 
-    client = self.__clients[name]
+    client = self.__clients.get(name)
     if client != None:
       _logger.error("Client with name %s already exists", name)
       return False
@@ -432,6 +447,36 @@ class CommandRunner:
     self.__clients[name] = client
     return True
 
+  def run_restart(self, arg: str):
+    '''
+    重启服务端，数据目录保留。参数会追加到observer的启动参数中，比如 restart -t mvcc
+    重启之后所有的连接都会重新建立
+    '''
+    if self.__restart_server is None:
+      _logger.error("Cannot restart a server that is not started by the test")
+      return False
+
+    # 先停止服务端再关闭连接。服务端处理完请求之前就关闭连接，可能导致服务端异常退出而来不及写回数据
+    if not self.__restart_server(arg.split()):
+      _logger.error("Failed to restart server")
+      return False
+
+    current_name = None
+    for name, client in self.__clients.items():
+      if client is self.__current_client:
+        current_name = name
+      client.close()
+
+    for name in self.__clients.keys():
+      client = MiniObClient(self.__server_port, self.__unix_socket)
+      if not(client.is_valid()):
+        _logger.error("Failed to reconnect client with name: %s", name)
+        return False
+      self.__clients[name] = client
+
+    self.__current_client = self.__clients[current_name]
+    return True
+
   def run_echo(self, arg: str):
     '''
     echo 命令。参数可以是#开头的注释，这里不关心
@@ -481,6 +526,8 @@ class CommandRunner:
       result = self.run_connection(command_arg)
     elif 'sort' == command:
       result = self.run_sort(command_arg)
+    elif 'restart' == command:
+      result = self.run_restart(command_arg)
     else:
       _logger.error("No such command %s", command)
       result = False
@@ -708,7 +755,7 @@ class TestSuite:
     with open(result_tmp_file_name, mode='wb') as result_file:
       result_writer = ResultWriter(result_file)
 
-      with CommandRunner(result_writer, self.__server_port, unix_socket) as command_runner:
+      with CommandRunner(result_writer, self.__server_port, unix_socket, self.__restart_server) as command_runner:
         if command_runner.is_valid() == False:
           return False
 
@@ -829,6 +876,11 @@ class TestSuite:
 
     return True
 
+  def __restart_server(self, extra_args: List[str]) -> bool:
+    if self.__miniob_server is None:
+      return False
+    return self.__miniob_server.restart_server(extra_args)
+
   def __clean_server_if_need(self):
     if self.__miniob_server is not None:
       self.__miniob_server.stop_server()
@@ -13,6 +13,8 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <string.h>
+#include <random>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "common/lang/bitmap.h"
@@ -65,6 +67,97 @@ TEST(test_bitmap, test_bitmap)
   buf3[1] = 0;
   ASSERT_EQ(8, bitmap3.next_unsetted_bit(0));
   ASSERT_EQ(16, bitmap3.next_setted_bit(8));
+
+  // 跳过整个字节之后，要从下一个字节的第0位开始查找
+  buf3[0] = -1;
+  buf3[1] = -1;
+  buf3[2] = 0;
+  ASSERT_EQ(16, bitmap3.next_unsetted_bit(3));
+  buf3[0] = 0;
+  buf3[1] = 0;
+  buf3[2] = 1;
+  ASSERT_EQ(16, bitmap3.next_setted_bit(3));
+}
+
+TEST(test_bitmap, test_bitmap_words)
+{
+  // 与逐位查找的结果对比，位图的长度覆盖不满一个字节、一个字和AVX2一次处理的256位的情况
+  std::mt19937 random_generator(20261017);
+  for (int size : {1, 7, 22, 63, 64, 65, 200, 256, 300, 1000, 4096}) {
+    for (int density : {0, 1, 50, 99, 100}) {
+      std::vector<char> buf((size + 7) / 8);
+      Bitmap bitmap(buf.data(), size);
+      for (int i = 0; i < size; i++) {
+        if (static_cast<int>(random_generator() % 100) < density) {
+          bitmap.set_bit(i);
+        }
+      }
+      // 最后一个字节中超出 size 的位不能被查找到
+      if (size % 8 != 0) {
+        buf.back() |= static_cast<char>(0xFF << (size % 8));
+      }
+
+      std::vector<int> setted;
+      for (int i = 0; i < size; i++) {
+        if (bitmap.get_bit(i)) {
+          setted.push_back(i);
+        }
+      }
+      ASSERT_EQ(static_cast<int>(setted.size()), bitmap.count_setted_bits());
+
+      for (int start = 0; start <= size; start++) {
+        int next_setted = -1;
+        int next_unsetted = -1;
+        for (int i = start; i < size && (next_setted == -1 || next_unsetted == -1); i++) {
+          if (bitmap.get_bit(i) && next_setted == -1) {
+            next_setted = i;
+          } else if (!bitmap.get_bit(i) && next_unsetted == -1) {
+            next_unsetted = i;
+          }
+        }
+        ASSERT_EQ(next_setted, bitmap.next_setted_bit(start)) << "size=" << size << ", start=" << start;
+        ASSERT_EQ(next_unsetted, bitmap.next_unsetted_bit(start)) << "size=" << size << ", start=" << start;
+      }
+
+      std::vector<int> indexes(size);
+      ASSERT_EQ(static_cast<int>(setted.size()), bitmap.setted_bits(0, indexes.data(), size));
+      indexes.resize(setted.size());
+      ASSERT_EQ(setted, indexes);
+    }
+  }
+}
+
+TEST(test_bitmap, test_bitmap_bulk)
+{
+  char buf[32];
+  memset(buf, 0, sizeof(buf));
+  Bitmap bitmap(buf, 250);
+
+  for (int i : {3, 64, 65, 130, 249}) {
+    bitmap.set_bit(i);
+  }
+  ASSERT_EQ(5, bitmap.count_setted_bits());
+
+  int indexes[8];
+  ASSERT_EQ(4, bitmap.setted_bits(4, indexes, 8));
+  ASSERT_EQ(64, indexes[0]);
+  ASSERT_EQ(65, indexes[1]);
+  ASSERT_EQ(130, indexes[2]);
+  ASSERT_EQ(249, indexes[3]);
+  ASSERT_EQ(2, bitmap.setted_bits(65, indexes, 2));
+  ASSERT_EQ(65, indexes[0]);
+  ASSERT_EQ(130, indexes[1]);
+  ASSERT_EQ(0, bitmap.setted_bits(250, indexes, 8));
+
+  ASSERT_EQ(0, bitmap.next_unsetted_run(0, 3));
+  ASSERT_EQ(4, bitmap.next_unsetted_run(0, 4));
+  ASSERT_EQ(4, bitmap.next_unsetted_run(4, 60));
+  ASSERT_EQ(66, bitmap.next_unsetted_run(4, 61));
+  ASSERT_EQ(131, bitmap.next_unsetted_run(66, 100));
+  ASSERT_EQ(131, bitmap.next_unsetted_run(66, 118));
+  ASSERT_EQ(-1, bitmap.next_unsetted_run(66, 119));
+  ASSERT_EQ(-1, bitmap.next_unsetted_run(249, 1));
+  ASSERT_EQ(-1, bitmap.next_unsetted_run(0, 0));
 }
 
 int main(int argc, char **argv)
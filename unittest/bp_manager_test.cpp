@@ -12,7 +12,15 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021
 //
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "storage/buffer/buffer_ring.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/read_ahead.h"
 #include "gtest/gtest.h"
 
 void test_get(BPFrameManager &frame_manager)
@@ -125,6 +133,1095 @@ TEST(test_frame_manager, test_frame_manager_simple_lru)
   frame_manager.cleanup();
 }
 
+TEST(test_frame_manager, test_frame_manager_sharded)
+{
+  const int shard_num = 4;
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(1, shard_num));
+  ASSERT_EQ(shard_num, frame_manager.shard_num());
+  ASSERT_EQ(static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL), frame_manager.total_frame_num());
+
+  test_get(frame_manager);
+
+  const int file_desc = 0;
+  std::list<Frame *> used_list;
+  for (PageNum page_num = 0; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    Frame *frame = frame_manager.alloc(file_desc, page_num);
+    ASSERT_NE(frame, nullptr);
+    frame->set_file_desc(file_desc);
+    used_list.push_back(frame);
+  }
+  ASSERT_EQ(used_list.size(), frame_manager.frame_num());
+
+  // 所有分片都已经用完了
+  ASSERT_EQ(nullptr, frame_manager.alloc(file_desc, DEFAULT_ITEM_NUM_PER_POOL));
+  ASSERT_EQ(used_list.size(), frame_manager.find_list(file_desc).size());
+  for (Frame *frame : used_list) {
+    frame->unpin(); // for find_list
+    ASSERT_EQ(frame, frame_manager.get(file_desc, frame->page_num()));
+    frame->unpin(); // for get
+    frame->unpin(); // for alloc
+  }
+
+  // 淘汰只会发生在指定页面所在的分片中
+  PageNum new_page_num = DEFAULT_ITEM_NUM_PER_POOL;
+  ASSERT_EQ(1, frame_manager.purge_frames(file_desc, new_page_num, 1, [](Frame *) { return RC::SUCCESS; }));
+  Frame *new_frame = frame_manager.alloc(file_desc, new_page_num);
+  ASSERT_NE(nullptr, new_frame);
+  new_frame->set_file_desc(file_desc);
+  new_frame->unpin();
+  ASSERT_EQ(used_list.size(), frame_manager.frame_num());
+
+  for (Frame *frame : frame_manager.find_list(file_desc)) {
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(file_desc, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0UL, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_replacers)
+{
+  for (const char *replacer : {"clock", "2q"}) {
+    BPFrameManager frame_manager("Test");
+    ASSERT_EQ(RC::SUCCESS, frame_manager.init(2, 1, replacer));
+    ASSERT_STREQ(replacer, frame_manager.replacer_name());
+
+    test_get(frame_manager);
+
+    test_alloc(frame_manager);
+
+    for (Frame *frame : frame_manager.find_list(0)) {
+      frame->unpin();
+      frame_manager.free(0, frame->page_num(), frame);
+    }
+    frame_manager.cleanup();
+  }
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_NE(RC::SUCCESS, frame_manager.init(2, 1, "unknown"));
+}
+
+/**
+ * @brief 访问一批页面，返回命中的次数
+ */
+int access_pages(BPFrameManager &frame_manager, PageNum begin, PageNum end)
+{
+  const int file_desc = 0;
+  int hit_count = 0;
+  for (PageNum page_num = begin; page_num < end; page_num++) {
+    Frame *frame = frame_manager.get(file_desc, page_num);
+    if (frame != nullptr) {
+      hit_count++;
+    } else {
+      while ((frame = frame_manager.alloc(file_desc, page_num)) == nullptr) {
+        frame_manager.purge_frames(file_desc, page_num, 1, [](Frame *) { return RC::SUCCESS; });
+      }
+    }
+    frame->unpin();
+  }
+  return hit_count;
+}
+
+TEST(test_frame_manager, test_frame_manager_scan_resistance)
+{
+  const int hot_page_num = 16;
+  const int scan_page_num = DEFAULT_ITEM_NUM_PER_POOL * 4;
+
+  int hit_counts[2] = {0, 0};
+  const char *replacers[2] = {"lru", "2q"};
+  for (int i = 0; i < 2; i++) {
+    BPFrameManager frame_manager("Test");
+    ASSERT_EQ(RC::SUCCESS, frame_manager.init(1, 1, replacers[i]));
+
+    // 热点页面在被淘汰后很快又被访问到，2Q会把它们放到Am队列中
+    access_pages(frame_manager, 0, hot_page_num);
+    access_pages(frame_manager, hot_page_num, hot_page_num + DEFAULT_ITEM_NUM_PER_POOL);
+
+    PageNum scan_begin = hot_page_num + DEFAULT_ITEM_NUM_PER_POOL;
+    for (int round = 0; round < 10; round++) {
+      hit_counts[i] += access_pages(frame_manager, 0, hot_page_num);
+      access_pages(frame_manager, scan_begin, scan_begin + scan_page_num);
+      scan_begin += scan_page_num;
+    }
+
+    for (Frame *frame : frame_manager.find_list(0)) {
+      frame_manager.free(0, frame->page_num(), frame);
+    }
+    frame_manager.cleanup();
+  }
+
+  // 每次扫描都会把LRU中的热点页面淘汰掉，而2Q可以保留热点页面
+  ASSERT_EQ(0, hit_counts[0]);
+  ASSERT_GT(hit_counts[1], hot_page_num * 5);
+}
+
+TEST(test_frame_manager, test_frame_manager_purge_clean_first)
+{
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(1, 1, "lru"));
+
+  const int file_desc = 0;
+  const int dirty_page_num = 10;
+  std::vector<Frame *> frames;
+  for (PageNum page_num = 0; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    Frame *frame = frame_manager.alloc(file_desc, page_num);
+    ASSERT_NE(frame, nullptr);
+    if (page_num < dirty_page_num) {
+      frame->mark_dirty();
+    }
+    frame->unpin();
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(frame_manager.alloc(file_desc, DEFAULT_ITEM_NUM_PER_POOL), nullptr);
+
+  // 最久没有访问的是脏页，但是淘汰时会先选择干净的页面
+  int purger_count = 0;
+  auto purger = [&purger_count](Frame *) {
+    purger_count++;
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(1, frame_manager.purge_frames(file_desc, 0, 1, purger));
+  ASSERT_EQ(0, purger_count);
+  ASSERT_EQ(nullptr, frame_manager.get(file_desc, dirty_page_num));
+
+  // 空闲页帧和干净页帧不足的时候，后台线程需要刷新即将被淘汰的脏页
+  ASSERT_TRUE(frame_manager.find_dirty_victims(0, 0).empty());
+  std::vector<Frame *> dirty_frames = frame_manager.find_dirty_victims(0, 10);
+  ASSERT_EQ(dirty_page_num, static_cast<int>(dirty_frames.size()));
+  for (Frame *frame : dirty_frames) {
+    ASSERT_TRUE(frame->dirty());
+    ASSERT_EQ(1, frame->pin_count());
+    frame->clear_dirty();
+    frame->unpin();
+  }
+  ASSERT_TRUE(frame_manager.find_dirty_victims(0, 10).empty());
+
+  for (Frame *frame : frame_manager.find_list(file_desc)) {
+    frame_manager.free(file_desc, frame->page_num(), frame);
+  }
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_load_failed)
+{
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(1, 1, "lru"));
+
+  const int     file_desc = 0;
+  const PageNum page_num  = 1;
+
+  // 分配出来的页帧处于读取状态，其它线程拿到它之后要等待读取结束
+  Frame *frame = frame_manager.alloc(file_desc, page_num);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_TRUE(frame->loading());
+
+  Frame *waiter_frame = frame_manager.get(file_desc, page_num);
+  ASSERT_EQ(frame, waiter_frame);
+  bool        waiter_loaded = true;
+  std::thread waiter([waiter_frame, &waiter_loaded]() {
+    waiter_loaded = waiter_frame->wait_loaded();
+    waiter_frame->unpin();
+  });
+
+  // 读取失败的页帧马上从哈希表中删除，等待的线程放开之后才回到空闲列表
+  frame_manager.discard(file_desc, page_num, frame);
+  waiter.join();
+  ASSERT_FALSE(waiter_loaded);
+  ASSERT_EQ(nullptr, frame_manager.get(file_desc, page_num));
+  ASSERT_EQ(0, frame->pin_count());
+
+  for (PageNum i = 0; i < DEFAULT_ITEM_NUM_PER_POOL; i++) {
+    Frame *new_frame = frame_manager.alloc(file_desc, i);
+    ASSERT_NE(new_frame, nullptr);
+    new_frame->end_load(true /*success*/);
+    ASSERT_TRUE(new_frame->wait_loaded());
+    new_frame->unpin();
+  }
+
+  for (Frame *frame : frame_manager.find_list(file_desc)) {
+    frame_manager.free(file_desc, frame->page_num(), frame);
+  }
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_arena)
+{
+  for (bool huge_page : {false, true}) {
+    BPFrameArena arena;
+    ASSERT_EQ(RC::SUCCESS, arena.init(100, huge_page));
+    ASSERT_EQ(100, arena.frame_num());
+    ASSERT_GE(arena.page_memory_size(), 100 * sizeof(Page));
+
+    for (int i = 0; i < arena.frame_num(); i++) {
+      Frame *frame = arena.frame(i);
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(frame) % 64);
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(&frame->page()) % 4096);
+      ASSERT_EQ(0, frame->pin_count());
+      if (i > 0) {
+        ASSERT_EQ(reinterpret_cast<char *>(&arena.frame(i - 1)->page()) + sizeof(Page),
+                  reinterpret_cast<char *>(&frame->page()));
+      }
+    }
+  }
+}
+
+TEST(test_frame_manager, test_frame_optimistic_read)
+{
+  Frame frame;
+  frame.pin();
+
+  uint64_t version = 0;
+  ASSERT_TRUE(frame.optimistic_read_begin(version));
+  ASSERT_TRUE(frame.optimistic_read_validate(version));
+
+  // 读锁不会修改版本号
+  frame.read_latch();
+  frame.read_unlatch();
+  ASSERT_TRUE(frame.optimistic_read_validate(version));
+
+  // 持有写锁时不能开始乐观读，重入的写锁只修改一次版本号
+  frame.write_latch();
+  frame.write_latch();
+  uint64_t version_in_write = 0;
+  ASSERT_FALSE(frame.optimistic_read_begin(version_in_write));
+  ASSERT_FALSE(frame.optimistic_read_validate(version));
+  frame.write_unlatch();
+  ASSERT_FALSE(frame.optimistic_read_begin(version_in_write));
+  frame.write_unlatch();
+
+  ASSERT_FALSE(frame.optimistic_read_validate(version));
+  ASSERT_TRUE(frame.optimistic_read_begin(version));
+  ASSERT_EQ(version, 2UL);
+  ASSERT_TRUE(frame.optimistic_read_validate(version));
+
+  frame.unpin();
+}
+
+TEST(test_frame_manager, test_space_map)
+{
+  // 只测试位图的维护，位图页面都放在内存中
+  std::vector<std::unique_ptr<Page>> pages;
+  pages.push_back(std::make_unique<Page>());
+  BPFileHeader *header = reinterpret_cast<BPFileHeader *>(pages[0]->data);
+  header->page_count      = 1;
+  header->allocated_pages = 1;
+  header->bitmap[0]       = 0x01;
+
+  BPSpaceMap space_map;
+  space_map.init(header);
+
+  auto allocate = [&]() {
+    PageNum page_num = space_map.allocate_free();
+    if (page_num != BP_INVALID_PAGE_NUM) {
+      return page_num;
+    }
+    if (space_map.need_new_group()) {
+      pages.push_back(std::make_unique<Page>());
+      space_map.add_group(pages.back()->data, true /*created*/);
+      EXPECT_TRUE(space_map.mark_allocated(BPSpaceMap::group_start(space_map.group_num() - 1)));
+    }
+    return space_map.allocate_new();
+  };
+
+  // 超过文件头中位图的限制，需要两个位图页面
+  const int data_page_num = BPSpaceMap::HEADER_GROUP_PAGE_NUM + BPSpaceMap::GROUP_PAGE_NUM + 100;
+  for (int i = 0; i < data_page_num; i++) {
+    PageNum page_num = allocate();
+    ASSERT_FALSE(BPSpaceMap::is_map_page(page_num));
+    ASSERT_TRUE(space_map.allocated(page_num));
+  }
+  ASSERT_EQ(3, space_map.group_num());
+  ASSERT_EQ(data_page_num + 3, header->page_count);
+  ASSERT_EQ(header->page_count, header->allocated_pages);
+  ASSERT_TRUE(space_map.allocated(BPSpaceMap::group_start(1)));
+  ASSERT_TRUE(space_map.allocated(BPSpaceMap::group_start(2)));
+
+  // 遍历时跳过文件头和位图页面
+  int     iterated_count = 0;
+  PageNum page_num       = 0;
+  while ((page_num = space_map.next_allocated(page_num + 1)) != BP_INVALID_PAGE_NUM) {
+    iterated_count++;
+  }
+  ASSERT_EQ(data_page_num, iterated_count);
+
+  // 释放的页面会优先分配出去，位图页面不能释放
+  const PageNum freed_pages[] = {BPSpaceMap::group_start(2) + 10, 100, BPSpaceMap::group_start(1) + 1};
+  for (PageNum freed_page : freed_pages) {
+    ASSERT_TRUE(space_map.mark_free(freed_page));
+  }
+  ASSERT_FALSE(space_map.mark_free(BPSpaceMap::group_start(1)));
+  ASSERT_FALSE(space_map.mark_free(0));
+  ASSERT_EQ(header->page_count - 3, header->allocated_pages);
+
+  ASSERT_EQ(100, allocate());
+  ASSERT_EQ(BPSpaceMap::group_start(1) + 1, allocate());
+  ASSERT_EQ(BPSpaceMap::group_start(2) + 10, allocate());
+  const PageNum new_page = header->page_count;
+  ASSERT_EQ(new_page, allocate());
+
+  // 日志回放时可能直接标记文件末尾之后的页面，中间的页面都是空闲的
+  const PageNum old_count = header->page_count;
+  ASSERT_TRUE(space_map.mark_allocated(old_count + 2));
+  ASSERT_FALSE(space_map.mark_allocated(old_count + 2));
+  ASSERT_EQ(old_count + 3, header->page_count);
+  ASSERT_EQ(old_count, allocate());
+  ASSERT_EQ(old_count + 1, allocate());
+  ASSERT_EQ(old_count + 3, allocate());
+}
+
+TEST(test_buffer_pool, test_page_cleaner)
+{
+  const char *file_name = "test_page_cleaner.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 除了文件头页面，所有的页帧都是脏页
+  for (int i = 1; i < DEFAULT_ITEM_NUM_PER_POOL; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+
+  int cleaned_count = bpm.page_cleaner().clean(50);
+  ASSERT_GE(cleaned_count, DEFAULT_ITEM_NUM_PER_POOL / 2 - 1);
+  ASSERT_EQ(0, bpm.page_cleaner().clean(50));
+
+  bpm.close_file(file_name);
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_read_ahead)
+{
+  const char *file_name = "test_read_ahead.bp";
+  const int   page_num  = 200;
+  ::remove(file_name);
+
+  {
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+      frame->mark_dirty();
+      bp->unpin_page(frame);
+    }
+    bpm.close_file(file_name);
+  }
+
+  BufferPoolManager bpm;
+  BPReadAheadOptions options;
+  options.min_pages = 4;
+  options.max_pages = 16;
+  bpm.set_read_ahead_options(options);
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 顺序扫描所有的页面，除了开始的几个页面，其它的页面都是预读进来的
+  BufferPoolIterator iterator;
+  iterator.init(*bp);
+  BPReadAhead read_ahead;
+  read_ahead.init(*bp);
+  while (iterator.has_next()) {
+    PageNum page_num = iterator.next();
+    read_ahead.access(page_num);
+
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+    ASSERT_EQ(page_num, frame->page_num());
+    bp->unpin_page(frame);
+  }
+
+  const BPReadAheadStats &stats = bpm.read_ahead_stats();
+  ASSERT_EQ(options.max_pages, read_ahead.window());
+  ASSERT_EQ(page_num - 3, stats.prefetch_count.load());
+  ASSERT_EQ(stats.prefetch_count.load(), stats.hit_count.load());
+  ASSERT_EQ(0, stats.wasted_count.load());
+
+  bpm.close_file(file_name);
+
+  // 预读进来的页面没有被访问就随着文件关闭被释放了
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  PageNum pages[] = {1, 2, 3};
+  ASSERT_EQ(3, bp->prefetch_pages(pages, 3));
+  ASSERT_EQ(3, bp->prefetch_pages(pages, 3));  // 已经在内存中了
+  bpm.close_file(file_name);
+  ASSERT_EQ(3, stats.wasted_count.load());
+
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_buffer_ring)
+{
+  const char *file_name = "test_buffer_ring.bp";
+  const int   page_num  = DEFAULT_ITEM_NUM_PER_POOL * 4;
+  const int   hot_page_num = 16;
+  ::remove(file_name);
+
+  for (int ring_size : {0, 16}) {
+    BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+    BPBufferRingOptions options;
+    options.size = ring_size;
+    bpm.set_buffer_ring_options(options);
+
+    ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+    // 批量写入，页帧环回收的脏页要写到磁盘上
+    std::unique_ptr<BPBufferRing> write_ring = bp->create_bulk_write_ring();
+    ASSERT_EQ(ring_size > 0, write_ring != nullptr);
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame, write_ring.get()));
+      *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+      frame->mark_dirty();
+      bp->unpin_page(frame);
+    }
+    if (write_ring != nullptr) {
+      ASSERT_LE(write_ring->size(), ring_size);
+      ASSERT_GT(write_ring->recycled_count(), 0);
+    }
+
+    // 在热点页面上做一个不写回磁盘的标记，页面被淘汰之后标记就没有了
+    for (PageNum i = 1; i <= hot_page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      *reinterpret_cast<PageNum *>(frame->data()) = -i;
+      bp->unpin_page(frame);
+    }
+
+    std::unique_ptr<BPBufferRing> scan_ring = bp->create_scan_ring();
+    ASSERT_EQ(ring_size > 0, scan_ring != nullptr);
+    for (PageNum i = hot_page_num + 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame, scan_ring.get()));
+      ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+      bp->unpin_page(frame);
+    }
+
+    int marked_count = 0;
+    for (PageNum i = 1; i <= hot_page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      if (*reinterpret_cast<PageNum *>(frame->data()) == -i) {
+        marked_count++;
+      }
+      bp->unpin_page(frame);
+    }
+
+    // 不使用页帧环时，一次大范围的扫描会把热点页面都淘汰掉
+    if (ring_size > 0) {
+      ASSERT_EQ(hot_page_num, marked_count);
+    } else {
+      ASSERT_EQ(0, marked_count);
+    }
+
+    // 文件不够大时不使用页帧环
+    options.threshold_pct = page_num * 100 / bpm.frame_capacity() + 1;
+    bpm.set_buffer_ring_options(options);
+    ASSERT_EQ(nullptr, bp->create_scan_ring());
+
+    bpm.close_file(file_name);
+    ::remove(file_name);
+  }
+}
+
+TEST(test_buffer_pool, test_direct_io)
+{
+  const char *file_name = "test_direct_io.bp";
+  const int   page_num  = DEFAULT_ITEM_NUM_PER_POOL * 2;
+  ::remove(file_name);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, 1, "lru", "sync", true /*huge_page*/);
+  bpm.set_direct_io(true);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  for (int i = 1; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  // 页面比页帧多，前面的页面已经被淘汰写到磁盘上了
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  for (int i = 1; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_space_map_pages)
+{
+  const char *file_name = "test_space_map_pages.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 回放一个位于第二组中的页面，需要创建位图页面。中间的页面都是空闲的，文件是稀疏的
+  const PageNum far_page = BPSpaceMap::group_start(1) + 5;
+  ASSERT_EQ(RC::SUCCESS, bp->recover_page(far_page));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  BufferPoolIterator iterator;
+  iterator.init(*bp);
+  ASSERT_TRUE(iterator.has_next());
+  ASSERT_EQ(far_page, iterator.next());
+  ASSERT_FALSE(iterator.has_next());
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(1, frame->page_num());
+  bp->unpin_page(frame);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_dispose_pinned_page)
+{
+  const char *file_name = "test_dispose_pinned_page.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  bp->unpin_page(frame);
+
+  // 模拟一个乐观读者还pin着页面的时候删除了这个页面
+  Frame *reader_frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &reader_frame));
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(page_num));
+  ASSERT_EQ(1, reader_frame->pin_count());
+  bp->unpin_page(reader_frame);
+
+  // 页面已经释放了，可以重新分配出来
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(page_num, frame->page_num());
+  bp->unpin_page(frame);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_dispose_evicted_page)
+{
+  const char *file_name = "test_dispose_evicted_page.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+
+  // 分配更多的页面，把第一个页面从缓存中淘汰出去
+  for (int i = 0; i < DEFAULT_ITEM_NUM_PER_POOL * 2; i++) {
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+
+  // 页面不在缓存中也要能释放，之后可以重新分配出来
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(page_num));
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(page_num, frame->page_num());
+  bp->unpin_page(frame);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+class TestLogHandler : public BPLogHandler
+{
+public:
+  LSN next_lsn() const override { return lsn; }
+  RC  flush_log(LSN lsn) override
+  {
+    if (flush_rc == RC::SUCCESS) {
+      flushed_lsn = std::max(flushed_lsn, lsn);
+    }
+    return flush_rc;
+  }
+
+  LSN lsn         = 1;
+  LSN flushed_lsn = 0;
+  RC  flush_rc    = RC::SUCCESS;
+};
+
+TEST(test_buffer_pool, test_dirty_page_table)
+{
+  const char *file_name = "test_dirty_page_table.bp";
+  ::remove(file_name);
+
+  TestLogHandler    log_handler;
+  BufferPoolManager bpm;
+  bpm.set_log_handler(&log_handler);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+
+  // 新分配的页面写过一次磁盘，恢复LSN就是当时日志的位置
+  log_handler.lsn = 10;
+  Frame *frame1 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame1));
+  ASSERT_EQ(10, frame1->recovery_lsn());
+
+  log_handler.lsn = 20;
+  Frame *frame2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame2));
+  ASSERT_EQ(20, frame2->recovery_lsn());
+
+  // 分配页面时文件头和空间位图页面也变脏了，它们的恢复LSN是打开文件时的位置
+  frame1->mark_dirty();
+  frame2->mark_dirty();
+  std::map<PageNum, LSN> dirty_pages;
+  for (const auto &[frame_id, lsn] : bpm.dirty_page_table()) {
+    dirty_pages[frame_id.page_num()] = lsn;
+  }
+  ASSERT_EQ(10, dirty_pages[frame1->page_num()]);
+  ASSERT_EQ(20, dirty_pages[frame2->page_num()]);
+  ASSERT_EQ(1, dirty_pages[BP_HEADER_PAGE]);
+
+  // 只写回恢复LSN早于15的页面
+  log_handler.lsn = 30;
+  ASSERT_EQ(RC::SUCCESS, bpm.flush_dirty_pages(15));
+  ASSERT_FALSE(frame1->dirty());
+  ASSERT_EQ(30, frame1->recovery_lsn());
+  ASSERT_TRUE(frame2->dirty());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.flush_dirty_pages(25));
+  ASSERT_TRUE(bpm.dirty_page_table().empty());
+  ASSERT_EQ(RC::SUCCESS, bpm.sync_files());
+
+  bp->unpin_page(frame1);
+  bp->unpin_page(frame2);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  bpm.set_log_handler(nullptr);
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_flush_log_before_page)
+{
+  const char *file_name = "test_flush_log_before_page.bp";
+  ::remove(file_name);
+
+  TestLogHandler    log_handler;
+  BufferPoolManager bpm;
+  bpm.set_log_handler(&log_handler);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 没有日志的修改不需要等待日志落盘
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(0, log_handler.flushed_lsn);
+
+  // 日志没有落盘时页面不能写回
+  frame->set_lsn(5);
+  frame->mark_dirty();
+  log_handler.flush_rc = RC::IOERR_SYNC;
+  ASSERT_NE(RC::SUCCESS, bp->flush_page(*frame));
+  ASSERT_TRUE(frame->dirty());
+
+  log_handler.flush_rc = RC::SUCCESS;
+  ASSERT_EQ(RC::SUCCESS, bp->flush_page(*frame));
+  ASSERT_FALSE(frame->dirty());
+  ASSERT_EQ(5, log_handler.flushed_lsn);
+
+  // 批量写回时等待最大的LSN
+  Frame *frame2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame2));
+  frame->set_lsn(8);
+  frame->mark_dirty();
+  frame2->set_lsn(7);
+  frame2->mark_dirty();
+  bp->unpin_page(frame);
+  bp->unpin_page(frame2);
+  int remain_count = 0;
+  bpm.page_cleaner().clean_before(100, remain_count);
+  ASSERT_EQ(0, remain_count);
+  ASSERT_EQ(8, log_handler.flushed_lsn);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  bpm.set_log_handler(nullptr);
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_warm_up)
+{
+  const char *file_name    = "test_warm_up.bp";
+  const char *warm_up_file = "test_warm_up.warm_up";
+  const int   page_num     = 100;
+  ::remove(file_name);
+  ::remove(warm_up_file);
+
+  {
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+      *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+      frame->mark_dirty();
+      bp->unpin_page(frame);
+    }
+
+    // 最后访问的页面记录在最前面
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(7, &frame));
+    bp->unpin_page(frame);
+    ASSERT_EQ(RC::SUCCESS, bpm.warm_up().dump(warm_up_file));
+    ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  }
+
+  std::ifstream fs(warm_up_file);
+  std::string   line;
+  ASSERT_TRUE(std::getline(fs, line));
+  ASSERT_EQ(std::string("F 0 ") + file_name, line);
+  ASSERT_TRUE(std::getline(fs, line));
+  ASSERT_EQ("P 0 7", line);
+  fs.close();
+
+  {
+    // 文件没有打开时不加载
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.warm_up().load(warm_up_file));
+    ASSERT_EQ(page_num, bpm.warm_up().total_page_count());
+    ASSERT_EQ(page_num, bpm.warm_up().done_page_count());
+    ASSERT_EQ(0, bpm.warm_up().loaded_page_count());
+  }
+
+  {
+    BufferPoolManager bpm;
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+    ASSERT_EQ(RC::SUCCESS, bpm.warm_up().load(warm_up_file));
+    ASSERT_FALSE(bpm.warm_up().loading());
+    ASSERT_EQ(page_num, bpm.warm_up().loaded_page_count());
+    // 文件头页面在打开文件时就已经读进来了
+    ASSERT_EQ(page_num - 1, bpm.read_ahead_stats().prefetch_count.load());
+
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+      bp->unpin_page(frame);
+    }
+    ASSERT_EQ(page_num - 1, bpm.read_ahead_stats().hit_count.load());
+    ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  }
+
+  ASSERT_EQ(RC::FILE_NOT_EXIST, BufferPoolManager().warm_up().load("test_warm_up.not_exist"));
+  ::remove(file_name);
+  ::remove(warm_up_file);
+}
+
+TEST(test_buffer_pool, test_resize)
+{
+  const char *file_name = "test_resize.bp";
+  ::remove(file_name);
+
+  for (const char *replacer : {"lru", "clock", "2q"}) {
+    BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, 2 /*frame_shard_num*/, replacer);
+    const int init_frame_num = bpm.frame_capacity();
+    ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+    // 变大立即生效，页面都能放在内存中，不需要淘汰
+    ASSERT_EQ(RC::SUCCESS, bpm.resize(4L * init_frame_num * BP_PAGE_SIZE));
+    ASSERT_EQ(4 * init_frame_num, bpm.frame_capacity());
+    ASSERT_EQ(0, bpm.pending_shrink_frames());
+
+    const int page_num = 3 * init_frame_num;
+    std::vector<Frame *> frames;
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+      *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+      frame->mark_dirty();
+      frames.push_back(frame);
+    }
+
+    // 页帧都被pin住了，不能回收
+    ASSERT_EQ(RC::SUCCESS, bpm.resize(init_frame_num * BP_PAGE_SIZE));
+    ASSERT_EQ(init_frame_num, bpm.target_frame_capacity());
+    ASSERT_EQ(page_num - init_frame_num, bpm.pending_shrink_frames());
+    ASSERT_EQ(page_num, bpm.frame_capacity());
+
+    for (Frame *frame : frames) {
+      bp->unpin_page(frame);
+    }
+
+    // 脏页写到磁盘之后再回收
+    while (bpm.pending_shrink_frames() > 0) {
+      ASSERT_GT(bpm.shrink_frames(64), 0);
+    }
+    ASSERT_EQ(init_frame_num, bpm.frame_capacity());
+
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+      bp->unpin_page(frame);
+    }
+
+    // 再变大时先使用回收的页帧
+    ASSERT_EQ(RC::SUCCESS, bpm.resize(2L * init_frame_num * BP_PAGE_SIZE));
+    ASSERT_EQ(2 * init_frame_num, bpm.frame_capacity());
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+      bp->unpin_page(frame);
+    }
+
+    ASSERT_EQ(RC::INVALID_ARGUMENT, bpm.resize(0));
+    ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+    ::remove(file_name);
+  }
+}
+
+TEST(test_buffer_pool, test_resize_named_pool)
+{
+  const char *file_name = "test_resize_named_pool.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("hot", 2L * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, "lru"));
+  BPFrameManager *pool = bpm.find_pool("hot");
+  ASSERT_NE(nullptr, pool);
+  const int init_frame_num = bpm.frame_capacity();
+  const int pool_frame_num = static_cast<int>(pool->total_frame_num());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp, "hot"));
+
+  // 只调整有名字的页帧管理器，默认的页帧管理器不变
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(2L * pool_frame_num * BP_PAGE_SIZE, "hot"));
+  ASSERT_EQ(2 * pool_frame_num, static_cast<int>(pool->total_frame_num()));
+  ASSERT_EQ(init_frame_num, bpm.frame_capacity());
+
+  const int page_num = 2 * pool_frame_num - 1;
+  for (int i = 1; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+
+  // 缩小时回收的是这个页帧管理器中的页帧，脏页写到磁盘之后再回收
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(static_cast<int64_t>(pool_frame_num) * BP_PAGE_SIZE, "hot"));
+  ASSERT_EQ(0, static_cast<int>(pool->pending_shrink_frame_num()));
+  ASSERT_EQ(pool_frame_num, static_cast<int>(pool->total_frame_num()));
+  ASSERT_EQ(init_frame_num, bpm.frame_capacity());
+
+  for (int i = 1; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+    bp->unpin_page(frame);
+  }
+
+  ASSERT_EQ(RC::NOTFOUND, bpm.resize(static_cast<int64_t>(pool_frame_num) * BP_PAGE_SIZE, "not_exist"));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_buffer_pool, test_named_pools)
+{
+  const char *hot_file     = "test_named_pools_hot.bp";
+  const char *archive_file = "test_named_pools_archive.bp";
+  const char *other_file   = "test_named_pools_other.bp";
+  ::remove(hot_file);
+  ::remove(archive_file);
+  ::remove(other_file);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("archive", DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, "2q"));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm.create_pool("archive", DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, "lru"));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm.create_pool(BufferPoolManager::DEFAULT_POOL_NAME, BP_PAGE_SIZE, "lru"));
+
+  BPFrameManager *default_pool = bpm.find_pool(nullptr);
+  BPFrameManager *archive_pool = bpm.find_pool("archive");
+  ASSERT_NE(nullptr, archive_pool);
+  ASSERT_EQ(nullptr, bpm.find_pool("not_exist"));
+  ASSERT_EQ(default_pool, bpm.find_pool(BufferPoolManager::DEFAULT_POOL_NAME));
+  ASSERT_EQ(2, (int)bpm.frame_managers().size());
+  ASSERT_STREQ("2q", archive_pool->replacer_name());
+
+  bpm.set_table_pool("orders", "archive", false /*index*/);
+  ASSERT_EQ("archive", bpm.table_pool("orders", false /*index*/));
+  ASSERT_EQ("", bpm.table_pool("orders", true /*index*/));
+
+  DiskBufferPool *hot_bp     = nullptr;
+  DiskBufferPool *archive_bp = nullptr;
+  DiskBufferPool *other_bp   = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(hot_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(archive_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(other_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(hot_file, hot_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(archive_file, archive_bp, "archive"));
+  // 没有这个名字的页帧管理器时使用默认的
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(other_file, other_bp, "not_exist"));
+
+  const int hot_page_num = 16;
+  for (int i = 1; i <= hot_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, hot_bp->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = -frame->page_num();
+    hot_bp->unpin_page(frame);
+  }
+
+  // 大量访问归档文件只会淘汰归档页帧管理器中的页面
+  const int archive_page_num = DEFAULT_ITEM_NUM_PER_POOL * 3;
+  for (int i = 1; i < archive_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, archive_bp->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+    frame->mark_dirty();
+    archive_bp->unpin_page(frame);
+  }
+  for (int i = 1; i < archive_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, archive_bp->get_this_page(i, &frame));
+    ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+    archive_bp->unpin_page(frame);
+  }
+  ASSERT_GT(archive_pool->stats().miss_count.load(), 0);
+  ASSERT_GT(archive_pool->stats().evict_count.load(), 0);
+  ASSERT_EQ(0, default_pool->stats().evict_count.load());
+
+  // 热点页面没有被淘汰，修改后没有写回的内容还在
+  const int64_t hit_count = default_pool->stats().hit_count.load();
+  for (int i = 1; i <= hot_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, hot_bp->get_this_page(i, &frame));
+    ASSERT_EQ(-i, *reinterpret_cast<PageNum *>(frame->data()));
+    hot_bp->unpin_page(frame);
+  }
+  ASSERT_EQ(hit_count + hot_page_num, default_pool->stats().hit_count.load());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(hot_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(archive_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(other_file));
+  ::remove(hot_file);
+  ::remove(archive_file);
+  ::remove(other_file);
+}
+
+TEST(test_buffer_pool, test_secondary_cache)
+{
+  const char *file_name  = "test_secondary_cache.bp";
+  const char *cache_name = "test_secondary_cache.cache";
+  const int   page_num   = DEFAULT_ITEM_NUM_PER_POOL * 3;
+  ::remove(file_name);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.init_secondary_cache(cache_name, 4L * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE));
+  BPSecondaryCache &cache = bpm.secondary_cache();
+  ASSERT_TRUE(cache.enabled());
+  ASSERT_EQ(4 * DEFAULT_ITEM_NUM_PER_POOL, cache.capacity());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 脏页直接写数据文件，不写二级缓存
+  for (int i = 1; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(0, cache.stats().write_count.load());
+
+  // 第一遍从数据文件读，淘汰的干净页面放到二级缓存中，第二遍就可以从二级缓存读了
+  for (int round = 0; round < 2; round++) {
+    for (int i = 1; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      ASSERT_EQ(i, *reinterpret_cast<PageNum *>(frame->data()));
+      bp->unpin_page(frame);
+    }
+  }
+  ASSERT_GT(cache.stats().write_count.load(), 0);
+  ASSERT_GT(cache.stats().hit_count.load(), 0);
+  ASSERT_GT(cache.size(), 0);
+
+  // 页面写回数据文件之后，二级缓存中的旧页面就失效了
+  std::unique_ptr<Page> page = std::make_unique<Page>();
+  for (PageNum i = 1; i < page_num; i++) {
+    if (!cache.read_page(bp->file_desc(), i, page.get())) {
+      continue;
+    }
+
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = -i;
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, bp->flush_page(*frame));
+    bp->unpin_page(frame);
+    ASSERT_FALSE(cache.read_page(bp->file_desc(), i, page.get()));
+
+    for (PageNum j = 1; j < page_num; j++) {
+      Frame *other_frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(j, &other_frame));
+      ASSERT_EQ(j == i ? -j : j, *reinterpret_cast<PageNum *>(other_frame->data()));
+      bp->unpin_page(other_frame);
+    }
+    break;
+  }
+
+  // 文件描述符会被复用，关闭文件时这个文件的页面都失效
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ASSERT_EQ(0, cache.size());
+
+  cache.close();
+  ::remove(file_name);
+  ::remove(cache_name);
+}
+
 int main(int argc, char **argv)
 {
 
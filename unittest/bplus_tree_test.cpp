@@ -14,8 +14,12 @@ See the Mulan PSL v2 for more details. */
 
 #include <list>
 #include <iostream>
+#include <algorithm>
+#include <random>
+#include <vector>
 
 #include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_bulk_loader.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
@@ -737,6 +741,332 @@ TEST(test_bplus_tree, test_bplus_tree_insert)
   handler = nullptr;
 }
 
+TEST(test_bplus_tree, test_bulk_load)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "bulk_load.btree";
+
+  // 节点很小的时候树比较高。数据量超过排序内存时会写临时文件再归并，这时使用正常大小的节点
+  for (int entry_num : {0, 1, 3, 5, 17, 200, 120000}) {
+    for (int fill_factor_pct : {50, 90, 100}) {
+      ::remove(index_name);
+      BplusTreeHandler tree;
+      const int node_size = entry_num > 1000 ? -1 : ORDER;
+      ASSERT_EQ(RC::SUCCESS, tree.create(index_name, INTS, sizeof(int), node_size, node_size));
+
+      std::vector<int> values(entry_num);
+      for (int i = 0; i < entry_num; i++) {
+        values[i] = i / 2;  // 每个值有两条记录
+      }
+      std::shuffle(values.begin(), values.end(), std::mt19937(entry_num));
+
+      BplusTreeBulkLoadOptions options;
+      options.fill_factor_pct = fill_factor_pct;
+      options.sort_memory_mb  = 1;
+      {
+        BplusTreeBulkLoader loader(tree, index_name, options);
+        for (int i = 0; i < entry_num; i++) {
+          RID rid(i, values[i]);
+          ASSERT_EQ(RC::SUCCESS, loader.add_entry((const char *)&values[i], rid));
+        }
+        ASSERT_EQ(RC::SUCCESS, loader.finish());
+        ASSERT_EQ(entry_num > 100000 ? 2 : 0, loader.run_num());
+      }
+      ASSERT_EQ(entry_num == 0, tree.is_empty());
+      if (entry_num == 0) {
+        tree.close();
+        continue;
+      }
+      ASSERT_TRUE(tree.validate_tree()) << "entry num=" << entry_num << ", fill factor=" << fill_factor_pct;
+
+      {
+        // 扫描器析构时才会放开叶子节点的读锁，后面修改B+树之前需要先销毁它
+        BplusTreeScanner scanner(tree);
+        ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true));
+        int  count = 0;
+        RID  rid;
+        RC   rc  = RC::SUCCESS;
+        while ((rc = scanner.next_entry(rid)) == RC::SUCCESS) {
+          ASSERT_EQ(count / 2, rid.slot_num);
+          count++;
+        }
+        scanner.close();
+        ASSERT_EQ(RC::RECORD_EOF, rc);
+        ASSERT_EQ(entry_num, count);
+      }
+
+      // 构建之后还可以正常地查找、插入和删除
+      const int last_value = (entry_num - 1) / 2;
+      std::list<RID> rids;
+      ASSERT_EQ(RC::SUCCESS, tree.get_entry((const char *)&last_value, sizeof(last_value), rids));
+      ASSERT_EQ(entry_num % 2 == 0 ? 2 : 1, (int)rids.size());
+      for (int i = 0; i < 50; i++) {
+        const int value = i * 7;
+        RID rid(entry_num + i, value);
+        ASSERT_EQ(RC::SUCCESS, tree.insert_entry((const char *)&value, &rid));
+      }
+      ASSERT_TRUE(tree.validate_tree());
+      for (int i = 0; i < std::min(entry_num, 100); i++) {
+        const int value = values[i];
+        RID rid(i, value);
+        ASSERT_EQ(RC::SUCCESS, tree.delete_entry((const char *)&value, &rid));
+      }
+      ASSERT_TRUE(tree.validate_tree());
+      tree.close();
+    }
+  }
+  ::remove(index_name);
+}
+
+TEST(test_bplus_tree, test_composite_key)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "composite.btree";
+  ::remove(index_name);
+
+  // 键值由 (int a, char(8) b) 两个字段组成
+  const int chars_len = 8;
+  const int key_len = sizeof(int) + chars_len;
+  auto make_key = [](int a, int b, char *key) {
+    memset(key, 0, key_len);
+    memcpy(key, &a, sizeof(a));
+    snprintf(key + sizeof(int), chars_len, "b%02d", b);
+  };
+
+  BplusTreeHandler tree;
+  ASSERT_EQ(RC::SUCCESS, tree.create(index_name, {INTS, CHARS}, {sizeof(int), chars_len}, ORDER, ORDER));
+
+  // b 倒序插入，a 的值有20个，每个 a 有10个 b，RID 记录了 a 和 b 的值
+  char key[key_len];
+  for (int b = 9; b >= 0; b--) {
+    for (int a = 0; a < 20; a++) {
+      make_key(a, b, key);
+      RID rid(a, b);
+      ASSERT_EQ(RC::SUCCESS, tree.insert_entry(key, &rid));
+    }
+  }
+  ASSERT_TRUE(tree.validate_tree());
+
+  // 返回扫描到的记录，同时检查是按照 (a, b) 的顺序返回的
+  auto scan = [&tree](const char *left, int left_len, bool left_inclusive, 
+                      const char *right, int right_len, bool right_inclusive) {
+    std::vector<RID> rids;
+    BplusTreeScanner scanner(tree);
+    EXPECT_EQ(RC::SUCCESS, scanner.open(left, left_len, left_inclusive, right, right_len, right_inclusive));
+    RID rid;
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      if (!rids.empty()) {
+        EXPECT_LT(RID::compare(&rids.back(), &rid), 0);
+      }
+      rids.push_back(rid);
+    }
+    scanner.close();
+    return rids;
+  };
+
+  // 只指定第一个字段: a = 5
+  int a = 5;
+  std::vector<RID> rids = scan((const char *)&a, sizeof(a), true, (const char *)&a, sizeof(a), true);
+  ASSERT_EQ(10, static_cast<int>(rids.size()));
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(RID(5, i), rids[i]);
+  }
+
+  // a = 5 and b >= 'b03' and b < 'b06'
+  char left_key[key_len];
+  char right_key[key_len];
+  make_key(5, 3, left_key);
+  make_key(5, 6, right_key);
+  rids = scan(left_key, key_len, true, right_key, key_len, false);
+  ASSERT_EQ(3, static_cast<int>(rids.size()));
+  ASSERT_EQ(RID(5, 3), rids.front());
+  ASSERT_EQ(RID(5, 5), rids.back());
+
+  // a > 3 and a <= 6
+  int left_a = 3;
+  int right_a = 6;
+  rids = scan((const char *)&left_a, sizeof(int), false, (const char *)&right_a, sizeof(int), true);
+  ASSERT_EQ(30, static_cast<int>(rids.size()));
+  ASSERT_EQ(RID(4, 0), rids.front());
+  ASSERT_EQ(RID(6, 9), rids.back());
+
+  // a = 7 and b > 'b08', 最后一个字段的字符串长度可以小于字段长度
+  make_key(7, 8, left_key);
+  a = 7;
+  rids = scan(left_key, sizeof(int) + 3, false, (const char *)&a, sizeof(a), true);
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(RID(7, 9), rids.front());
+
+  // 左右边界的前缀相同，但是字段个数不同
+  rids = scan((const char *)&a, sizeof(a), true, left_key, key_len, true);
+  ASSERT_EQ(9, static_cast<int>(rids.size()));
+
+  // 删除 a = 5 的所有数据
+  for (int b = 0; b < 10; b++) {
+    make_key(5, b, key);
+    RID rid(5, b);
+    ASSERT_EQ(RC::SUCCESS, tree.delete_entry(key, &rid));
+  }
+  ASSERT_TRUE(tree.validate_tree());
+  a = 5;
+  rids = scan((const char *)&a, sizeof(a), true, (const char *)&a, sizeof(a), true);
+  ASSERT_EQ(0, static_cast<int>(rids.size()));
+
+  // 重新打开后，组合键值的字段信息从文件头中读取
+  ASSERT_EQ(RC::SUCCESS, tree.sync());
+  ASSERT_EQ(RC::SUCCESS, tree.close());
+  ASSERT_EQ(RC::SUCCESS, tree.open(index_name));
+  ASSERT_EQ(2, tree.file_header().attr_num);
+  ASSERT_EQ(key_len, tree.file_header().attr_length);
+  rids = scan((const char *)&left_a, sizeof(int), false, (const char *)&right_a, sizeof(int), true);
+  ASSERT_EQ(20, static_cast<int>(rids.size()));
+  ASSERT_TRUE(tree.validate_tree());
+
+  tree.close();
+  ::remove(index_name);
+}
+
+TEST(test_bplus_tree, test_file_version)
+{
+  const char *index_name = "test_file_version.btree";
+  ::remove(index_name);
+
+  BplusTreeHandler tree;
+  ASSERT_EQ(RC::SUCCESS, tree.create(index_name, INTS, sizeof(int)));
+  ASSERT_EQ(IndexFileHeader::CURRENT_VERSION, tree.file_header().version);
+  ASSERT_EQ(RC::SUCCESS, tree.close());
+
+  // 把文件头改成没有版本号的老格式，打开时要拒绝
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(index_name, bp));
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(1 /*索引文件头页面*/, &frame));
+  reinterpret_cast<IndexFileHeader *>(frame->data())->version = 0;
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(index_name));
+
+  ASSERT_EQ(RC::INDEX_VERSION_MISMATCH, tree.open(index_name));
+  ::remove(index_name);
+}
+
+/**
+ * @brief 修改B+树内部的数据，模拟并发修改时留下的过期链接
+ */
+class BplusTreeTester
+{
+public:
+  static void set_prev_pages(BplusTreeHandler &tree, PageNum prev_page_num)
+  {
+    LatchMemo latch_memo(tree.disk_buffer_pool_);
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, tree.left_most_page(latch_memo, frame));
+    while (true) {
+      LeafIndexNodeHandler leaf_node(tree.file_header_, frame);
+      const PageNum next_page_num = leaf_node.next_page();
+      if (next_page_num == BP_INVALID_PAGE_NUM) {
+        break;
+      }
+      ASSERT_EQ(RC::SUCCESS, latch_memo.get_page(next_page_num, frame));
+      LeafIndexNodeHandler(tree.file_header_, frame).set_prev_page(prev_page_num);
+      frame->mark_dirty();
+    }
+  }
+
+  static PageNum root_page(BplusTreeHandler &tree) { return tree.file_header_.root_page; }
+};
+
+TEST(test_bplus_tree, test_descending_scanner)
+{
+  LoggerFactory::init_default("test.log");
+
+  const char *index_name = "descending.btree";
+  ::remove(index_name);
+
+  BplusTreeHandler tree;
+  ASSERT_EQ(RC::SUCCESS, tree.create(index_name, INTS, sizeof(int), ORDER, ORDER));
+
+  // 逆序扫描的结果应该与正序扫描的结果顺序相反
+  auto scan = [&tree](const int *left, bool left_inclusive, const int *right, bool right_inclusive, bool descending) {
+    std::vector<RID> rids;
+    BplusTreeScanner scanner(tree);
+    EXPECT_EQ(RC::SUCCESS, scanner.open((const char *)left, sizeof(int), left_inclusive,
+                                        (const char *)right, sizeof(int), right_inclusive, descending));
+    RID rid;
+    RC rc = RC::SUCCESS;
+    while (RC::SUCCESS == (rc = scanner.next_entry(rid))) {
+      rids.push_back(rid);
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    scanner.close();
+    return rids;
+  };
+  auto check_all_ranges = [&scan](int max_value) {
+    for (int left = -1; left <= max_value + 1; left += 7) {
+      for (int right = left; right <= max_value + 1; right += 11) {
+        for (bool left_inclusive : {true, false}) {
+          for (bool right_inclusive : {true, false}) {
+            if (left == right && !(left_inclusive && right_inclusive)) {
+              continue;
+            }
+            std::vector<RID> rids = scan(&left, left_inclusive, &right, right_inclusive, false);
+            std::reverse(rids.begin(), rids.end());
+            ASSERT_EQ(rids, scan(&left, left_inclusive, &right, right_inclusive, true))
+                << "left=" << left << ", right=" << right;
+          }
+        }
+      }
+      std::vector<RID> rids = scan(&left, true, nullptr, true, false);
+      std::reverse(rids.begin(), rids.end());
+      ASSERT_EQ(rids, scan(&left, true, nullptr, true, true)) << "left=" << left;
+
+      rids = scan(nullptr, true, &left, false, false);
+      std::reverse(rids.begin(), rids.end());
+      ASSERT_EQ(rids, scan(nullptr, true, &left, false, true)) << "right=" << left;
+    }
+  };
+
+  // 空树
+  std::vector<RID> rids = scan(nullptr, true, nullptr, true, true);
+  ASSERT_TRUE(rids.empty());
+
+  // 乱序插入 [0, 200)，每个值有两条记录，叶子节点会多次分裂
+  std::vector<int> values;
+  for (int i = 0; i < 400; i++) {
+    values.push_back(i / 2);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(25));
+  for (int i = 0; i < 400; i++) {
+    RID rid(values[i], i);
+    ASSERT_EQ(RC::SUCCESS, tree.insert_entry((const char *)&values[i], &rid));
+  }
+  ASSERT_TRUE(tree.validate_tree());
+
+  rids = scan(nullptr, true, nullptr, true, true);
+  ASSERT_EQ(400, static_cast<int>(rids.size()));
+  for (int i = 1; i < 400; i++) {
+    ASSERT_GT(RID::compare(&rids[i - 1], &rids[i]), 0);
+  }
+  check_all_ranges(200);
+
+  // 删除一半的数据，叶子节点会合并
+  for (int i = 0; i < 400; i += 2) {
+    RID rid(values[i], i);
+    ASSERT_EQ(RC::SUCCESS, tree.delete_entry((const char *)&values[i], &rid));
+  }
+  ASSERT_TRUE(tree.validate_tree());
+  check_all_ranges(200);
+
+  // prev_brother 过期时，会从根节点重新查找前一个叶子节点
+  BplusTreeTester::set_prev_pages(tree, BplusTreeTester::root_page(tree));
+  check_all_ranges(200);
+
+  tree.close();
+  ::remove(index_name);
+}
+
 int main(int argc, char **argv)
 {
 
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <string.h>
+#include <vector>
 
 #include "common/log/log.h"
 #include "storage/clog/clog.h"
@@ -45,6 +46,91 @@ TEST(test_clog, test_clog)
   */
 }
 
+TEST(test_clog, test_checkpoint)
+{
+  const char *path = ".";
+  remove("./clog");
+  remove("./clog.ctl");
+
+  {
+    CLogManager log_mgr;
+    ASSERT_EQ(RC::SUCCESS, log_mgr.init(path));
+    ASSERT_EQ(1, log_mgr.next_lsn());
+    ASSERT_EQ(0, log_mgr.last_checkpoint().lsn_);
+
+    // 事务1已经结束，事务2还没有结束，检查点不能超过事务2开始的位置
+    ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(1));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, 1, 0, RID(1, 0), 4, 0, "abcd"));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(2));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, 2, 0, RID(1, 1), 4, 0, "efgh"));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(1, 3));
+    ASSERT_EQ(6, log_mgr.next_lsn());
+    ASSERT_EQ(3, log_mgr.checkpoint_lsn_limit());
+
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint(log_mgr.checkpoint_lsn_limit()));
+    ASSERT_EQ(3, log_mgr.last_checkpoint().lsn_);
+    ASSERT_EQ(3, log_mgr.last_checkpoint().max_trx_id_);
+
+    // 检查点的位置之后可以读到所有LSN不小于检查点的日志
+    CLogFile log_file;
+    ASSERT_EQ(RC::SUCCESS, log_file.init(path));
+    ASSERT_EQ(RC::SUCCESS, log_file.seek(log_mgr.last_checkpoint().offset_));
+    CLogRecordIterator iterator;
+    ASSERT_EQ(RC::SUCCESS, iterator.init(log_file));
+    std::vector<int32_t> lsns;
+    for (RC rc = iterator.next(); OB_SUCC(rc) && iterator.valid(); rc = iterator.next()) {
+      lsns.push_back(iterator.log_record().header().lsn_);
+    }
+    ASSERT_FALSE(lsns.empty());
+    ASSERT_LE(lsns.front(), 3);
+    ASSERT_EQ(5, lsns.back());
+
+    ASSERT_EQ(RC::SUCCESS, log_mgr.rollback_trx(2));
+    ASSERT_EQ(7, log_mgr.checkpoint_lsn_limit());
+    ASSERT_EQ(RC::SUCCESS, log_mgr.sync());
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint(log_mgr.checkpoint_lsn_limit()));
+  }
+
+  // 重新打开时读取上次的检查点
+  CLogManager log_mgr;
+  ASSERT_EQ(RC::SUCCESS, log_mgr.init(path));
+  ASSERT_EQ(7, log_mgr.last_checkpoint().lsn_);
+  ASSERT_EQ(7, log_mgr.next_lsn());
+  ASSERT_EQ(3, log_mgr.last_checkpoint().max_trx_id_);
+
+  CLogFile log_file;
+  ASSERT_EQ(RC::SUCCESS, log_file.init(path));
+  ASSERT_EQ(log_file.write_offset(), log_mgr.last_checkpoint().offset_);
+}
+
+TEST(test_clog, test_flush_log)
+{
+  const char *path = ".";
+  remove("./clog");
+  remove("./clog.ctl");
+
+  CLogManager log_mgr;
+  ASSERT_EQ(RC::SUCCESS, log_mgr.init(path));
+  ASSERT_EQ(1, log_mgr.flushed_lsn());
+
+  LSN lsn = 0;
+  ASSERT_EQ(RC::SUCCESS, log_mgr.begin_trx(1));
+  ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::INSERT, 1, 0, RID(1, 0), 4, 0, "abcd", &lsn));
+  ASSERT_EQ(2, lsn);
+  ASSERT_EQ(1, log_mgr.flushed_lsn());
+
+  // 写回页面之前日志落盘，已经落盘的日志不需要再同步
+  ASSERT_EQ(RC::SUCCESS, log_mgr.flush_log(lsn));
+  ASSERT_EQ(3, log_mgr.flushed_lsn());
+  ASSERT_EQ(RC::SUCCESS, log_mgr.append_log(CLogType::DELETE, 1, 0, RID(1, 0), 0, 0, nullptr, &lsn));
+  ASSERT_EQ(3, lsn);
+  ASSERT_EQ(RC::SUCCESS, log_mgr.flush_log(2));
+  ASSERT_EQ(3, log_mgr.flushed_lsn());
+
+  ASSERT_EQ(RC::SUCCESS, log_mgr.commit_trx(1, 2));
+  ASSERT_EQ(5, log_mgr.flushed_lsn());
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
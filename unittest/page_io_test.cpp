@@ -0,0 +1,99 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by agent on 2026/10/17.
+//
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "storage/buffer/page_io.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+void test_page_io(PageIO &page_io)
+{
+  const char *file_name = "test_page_io.bp";
+  ::remove(file_name);
+  int fd = ::open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
+  ASSERT_GE(fd, 0);
+
+  // 倒序写入一批页面，每个页面的内容都不同
+  const int page_num = 100;
+  vector<Page> pages(page_num);
+  vector<PageIORequest> requests(page_num);
+  for (int i = 0; i < page_num; i++) {
+    pages[i].page_num = page_num - 1 - i;
+    memset(pages[i].data, 'a' + i % 26, sizeof(pages[i].data));
+    requests[i].file_desc = fd;
+    requests[i].page_num  = pages[i].page_num;
+    requests[i].page      = &pages[i];
+  }
+  ASSERT_EQ(RC::SUCCESS, page_io.write_pages(requests.data(), page_num));
+  for (const PageIORequest &request : requests) {
+    ASSERT_EQ(RC::SUCCESS, request.rc);
+  }
+
+  vector<Page> read_pages(page_num);
+  for (int i = 0; i < page_num; i++) {
+    requests[i].page_num = i;
+    requests[i].page     = &read_pages[i];
+  }
+  ASSERT_EQ(RC::SUCCESS, page_io.read_pages(requests.data(), page_num));
+  for (int i = 0; i < page_num; i++) {
+    const Page &expected = pages[page_num - 1 - i];
+    ASSERT_EQ(i, read_pages[i].page_num);
+    ASSERT_EQ(0, memcmp(&expected, &read_pages[i], sizeof(Page)));
+  }
+
+  // 读取文件末尾之后的页面会失败，但是不影响同一批中的其它请求
+  Page page;
+  ASSERT_EQ(RC::SUCCESS, page_io.read_page(fd, 0, &page));
+  requests[0].page_num = page_num;
+  requests[1].page_num = 1;
+  ASSERT_NE(RC::SUCCESS, page_io.read_pages(requests.data(), 2));
+  ASSERT_NE(RC::SUCCESS, requests[0].rc);
+  ASSERT_EQ(RC::SUCCESS, requests[1].rc);
+
+  ::close(fd);
+  ::remove(file_name);
+}
+
+TEST(test_page_io, test_sync)
+{
+  unique_ptr<PageIO> page_io = PageIO::create("sync");
+  ASSERT_NE(page_io, nullptr);
+  ASSERT_STREQ("sync", page_io->name());
+  test_page_io(*page_io);
+}
+
+TEST(test_page_io, test_io_uring)
+{
+  // 没有编译 io_uring 时会使用同步的方式
+  unique_ptr<PageIO> page_io = PageIO::create("io_uring");
+  ASSERT_NE(page_io, nullptr);
+  test_page_io(*page_io);
+}
+
+TEST(test_page_io, test_unknown)
+{
+  ASSERT_EQ(PageIO::create("unknown"), nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -13,7 +13,10 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <string.h>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <unistd.h>
 
 #include "gtest/gtest.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -184,6 +187,615 @@ TEST(test_record_page_handler, test_record_file_iterator)
   delete bpm;
 }
 
+TEST(test_record_page_handler, test_slotted_record_page_handler)
+{
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+
+  // 记录是 | int | char(200) | int |，字符串只保存实际使用的部分
+  const int record_size = 208;
+  const std::vector<VarlenField> varlen_fields{{4, 200}};
+  RecordPageHandler record_page_handle;
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.init_empty_slotted_page(*bp, page_num, record_size, varlen_fields));
+  ASSERT_TRUE(record_page_handle.is_slotted());
+
+  auto make_record = [](char *data, int id, int str_len) {
+    memset(data, 0, record_size);
+    memcpy(data, &id, sizeof(id));
+    memset(data + 4, 'a' + id % 26, str_len);
+    memcpy(data + 204, &id, sizeof(id));
+  };
+
+  char data[record_size];
+  std::vector<RID> rids;
+  while (!record_page_handle.is_full()) {
+    const int id = static_cast<int>(rids.size());
+    make_record(data, id, id % 10);
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, record_page_handle.insert_record(data, &rid));
+    ASSERT_EQ(id, rid.slot_num);
+    rids.push_back(rid);
+  }
+  // 定长格式下一个页面最多只能放下 BP_PAGE_DATA_SIZE / 208 条记录
+  ASSERT_GT(rids.size(), static_cast<size_t>(BP_PAGE_DATA_SIZE / record_size));
+
+  Record record;
+  for (size_t i = 0; i < rids.size(); i++) {
+    ASSERT_EQ(RC::SUCCESS, record_page_handle.get_record(&rids[i], &record));
+    make_record(data, i, i % 10);
+    ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+  }
+
+  // 删除一半的记录，留下的碎片足够插入长的记录，插入时会整理页面
+  for (size_t i = 0; i < rids.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, record_page_handle.delete_record(&rids[i]));
+  }
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, record_page_handle.get_record(&rids[0], &record));
+
+  int count = 0;
+  RecordPageIterator iterator;
+  iterator.init(record_page_handle);
+  while (iterator.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, iterator.next(record));
+    ASSERT_EQ(1, record.rid().slot_num % 2);
+    count++;
+  }
+  ASSERT_EQ(static_cast<int>(rids.size() / 2), count);
+
+  make_record(data, 1000, 200);
+  RID long_rid;
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.insert_record(data, &long_rid));
+  ASSERT_EQ(0, long_rid.slot_num);
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.get_record(&long_rid, &record));
+  ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+
+  // 记录变长之后 RID 不变
+  make_record(data, 1001, 150);
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.update_record(rids[1], data));
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.get_record(&rids[1], &record));
+  ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+  make_record(data, 3, 3);
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.get_record(&rids[3], &record));
+  ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+  record_page_handle.cleanup();
+
+  // 重做日志时在指定的位置插入记录，槽位目录会扩展到这个位置
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.recover_init(*bp, page_num));
+  const RID recover_rid(page_num, static_cast<SlotNum>(rids.size() + 3));
+  make_record(data, 2000, 20);
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.recover_insert_record(data, recover_rid));
+  ASSERT_EQ(RC::SUCCESS, record_page_handle.get_record(&recover_rid, &record));
+  ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+  const RID free_rid(page_num, static_cast<SlotNum>(rids.size() + 1));
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, record_page_handle.get_record(&free_rid, &record));
+  record_page_handle.cleanup();
+
+  // 乐观读也可以解码变长格式的记录
+  ASSERT_EQ(RC::SUCCESS, RecordPageHandler::optimistic_get_record(*bp, recover_rid, &record));
+  ASSERT_EQ(0, memcmp(data, record.data(), record_size));
+
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(test_record_page_handler, test_slotted_record_file)
+{
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  const int record_size = 40;
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, RecordFormat::SLOTTED, {{8, 32}}));
+
+  char record_data[record_size];
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    memset(record_data, 0, sizeof(record_data));
+    memcpy(record_data, &i, sizeof(i));
+    snprintf(record_data + 8, 32, "%d", i);
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+    rids.push_back(rid);
+  }
+
+  // 不是只读访问时，修改的记录会写回页面
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rids[11], false /*readonly*/, [](Record &record) {
+    snprintf(record.data() + 8, 32, "a longer updated string");
+  }));
+
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+
+  VacuousTrx trx;
+  RecordFileScanner file_scanner;
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(nullptr/*table*/, *bp, &trx, true/*readonly*/, nullptr));
+
+  int count = 0;
+  Record record;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    int id = 0;
+    memcpy(&id, record.data(), sizeof(id));
+    ASSERT_EQ(1, id % 2);
+    count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(500, count);
+
+  RecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rids[13], true /*readonly*/, &record));
+  ASSERT_STREQ("13", record.data() + 8);
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rids[11], true /*readonly*/, &record));
+  ASSERT_STREQ("a longer updated string", record.data() + 8);
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, file_handler.get_record(page_handler, &rids[10], true /*readonly*/, &record));
+  page_handler.cleanup();
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(test_record_page_handler, test_insert_records)
+{
+  const char *record_manager_file = "record_manager.bp";
+
+  for (RecordFormat format : {RecordFormat::FIXED, RecordFormat::SLOTTED}) {
+    ::remove(record_manager_file);
+    BufferPoolManager *bpm = new BufferPoolManager();
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+    const int record_size = 40;
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, format, {{8, 32}}));
+
+    // 先插入一条记录，批量插入时要接着使用这个页面
+    const int record_num = 1000;
+    std::vector<std::vector<char>> record_datas(record_num + 1, std::vector<char>(record_size, 0));
+    for (int i = 0; i <= record_num; i++) {
+      memcpy(record_datas[i].data(), &i, sizeof(i));
+      snprintf(record_datas[i].data() + 8, 32, "%d", i);
+    }
+    RID first_rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_datas[0].data(), record_size, &first_rid));
+
+    std::vector<const char *> datas;
+    for (int i = 1; i <= record_num; i++) {
+      datas.push_back(record_datas[i].data());
+    }
+    std::vector<RID> rids(record_num);
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_records(datas, record_size, rids.data()));
+
+    // 同一个页面上的记录是连续插入的
+    ASSERT_EQ(first_rid.page_num, rids[0].page_num);
+    std::set<PageNum> pages;
+    for (int i = 0; i < record_num; i++) {
+      if (i > 0 && rids[i].page_num != rids[i - 1].page_num) {
+        ASSERT_EQ(0, pages.count(rids[i].page_num));
+      }
+      pages.insert(rids[i].page_num);
+    }
+    ASSERT_GT(pages.size(), 1);
+
+    RecordPageHandler page_handler;
+    Record record;
+    for (int i = 0; i < record_num; i += 97) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rids[i], true /*readonly*/, &record));
+      int id = 0;
+      memcpy(&id, record.data(), sizeof(id));
+      ASSERT_EQ(i + 1, id);
+      ASSERT_EQ(std::to_string(i + 1), record.data() + 8);
+      page_handler.cleanup();
+    }
+
+    file_handler.close();
+    bpm->close_file(record_manager_file);
+    delete bpm;
+  }
+}
+
+TEST(test_record_page_handler, test_record_file_scan_batch)
+{
+  const char *record_manager_file = "record_manager.bp";
+
+  for (RecordFormat format : {RecordFormat::FIXED, RecordFormat::SLOTTED}) {
+    ::remove(record_manager_file);
+    BufferPoolManager *bpm = new BufferPoolManager();
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+    const int record_size = 40;
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, format, {{8, 32}}));
+
+    char record_data[record_size];
+    std::vector<RID> rids;
+    for (int i = 0; i < 1000; i++) {
+      memset(record_data, 0, sizeof(record_data));
+      memcpy(record_data, &i, sizeof(i));
+      snprintf(record_data + 8, 32, "%d", i);
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+      rids.push_back(rid);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    }
+
+    VacuousTrx trx;
+    RecordFileScanner file_scanner;
+    ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(nullptr/*table*/, *bp, &trx, true/*readonly*/, nullptr));
+
+    // 每一批都是同一个页面上的记录，按照槽位的顺序返回
+    int count = 0;
+    RecordBatch batch;
+    RC rc = RC::SUCCESS;
+    std::set<PageNum> pages;
+    while (RC::SUCCESS == (rc = file_scanner.next_batch(batch))) {
+      ASSERT_FALSE(batch.empty());
+      ASSERT_EQ(0, pages.count(batch.page_num()));
+      pages.insert(batch.page_num());
+
+      Record record;
+      for (int i = 0; i < batch.size(); i++) {
+        batch.get_record(i, record);
+        int id = 0;
+        memcpy(&id, record.data(), sizeof(id));
+        ASSERT_EQ(rids[id], batch.rid(i));
+        ASSERT_EQ(std::to_string(id), record.data() + 8);
+        ASSERT_EQ(1, id % 2);
+        count++;
+      }
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(500, count);
+    file_scanner.close_scan();
+
+    file_handler.close();
+    bpm->close_file(record_manager_file);
+    delete bpm;
+  }
+}
+
+TEST(test_record_page_handler, test_free_space_map)
+{
+  const char *fsm_file = "record_manager.fsm";
+  ::remove(fsm_file);
+
+  FreeSpaceMap fsm;
+  fsm.init(4);
+  ASSERT_EQ(4, fsm.partition_num());
+  ASSERT_EQ(BP_INVALID_PAGE_NUM, fsm.find_page());
+
+  for (PageNum page_num = 1; page_num <= 8; page_num++) {
+    fsm.update(page_num, FreeSpaceMap::EMPTY_LEVEL);
+  }
+  ASSERT_EQ(8, fsm.free_page_num());
+
+  // 不同的线程会找到不同的页面
+  PageNum pages[2] = {BP_INVALID_PAGE_NUM, BP_INVALID_PAGE_NUM};
+  for (int i = 0; i < 2; i++) {
+    std::thread t([&fsm, &pages, i]() { pages[i] = fsm.find_page(); });
+    t.join();
+  }
+  ASSERT_NE(BP_INVALID_PAGE_NUM, pages[0]);
+  ASSERT_NE(BP_INVALID_PAGE_NUM, pages[1]);
+  ASSERT_NE(pages[0], pages[1]);
+
+  // 自己分区的页面都满了之后，会从其它分区中找
+  for (PageNum page_num = 1; page_num <= 7; page_num++) {
+    fsm.update(page_num, FreeSpaceMap::FULL_LEVEL);
+  }
+  ASSERT_EQ(8, fsm.find_page());
+  fsm.update(3, 100);
+  ASSERT_EQ(2, fsm.free_page_num());
+
+  ASSERT_EQ(RC::SUCCESS, fsm.save(fsm_file));
+  FreeSpaceMap loaded;
+  loaded.init(2);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, loaded.load(fsm_file, 16));
+  ASSERT_EQ(RC::FILE_NOT_EXIST, loaded.load(fsm_file, 8));
+
+  ASSERT_EQ(RC::SUCCESS, fsm.save(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, loaded.load(fsm_file, 8));
+  ASSERT_EQ(100, loaded.level(3));
+  ASSERT_EQ(FreeSpaceMap::EMPTY_LEVEL, loaded.level(8));
+  ASSERT_EQ(FreeSpaceMap::FULL_LEVEL, loaded.level(1));
+  ASSERT_EQ(2, loaded.free_page_num());
+}
+
+TEST(test_record_page_handler, test_record_file_free_space_map)
+{
+  const char *record_manager_file = "record_manager.bp";
+  const char *fsm_file = "record_manager.fsm";
+  ::remove(record_manager_file);
+  ::remove(fsm_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  const int record_size = 64;
+  char record_data[record_size];
+  memset(record_data, 0, sizeof(record_data));
+  std::vector<RID> rids;
+  {
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, RecordFormat::FIXED, {}, fsm_file));
+    for (int i = 0; i < 2000; i++) {
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+      rids.push_back(rid);
+    }
+    ASSERT_EQ(1, file_handler.free_space_map().free_page_num());
+
+    // 删除第一个页面上的一条记录，这个页面又可以插入了
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[0]));
+    ASSERT_EQ(2, file_handler.free_space_map().free_page_num());
+    file_handler.close();
+  }
+
+  // 正常关闭后，重新打开时直接加载空闲空间表
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, RecordFormat::FIXED, {}, fsm_file));
+  ASSERT_NE(0, ::access(fsm_file, F_OK));
+  ASSERT_EQ(2, file_handler.free_space_map().free_page_num());
+  ASSERT_NE(FreeSpaceMap::FULL_LEVEL, file_handler.free_space_map().level(rids[0].page_num));
+
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+  ASSERT_TRUE(rid.page_num == rids[0].page_num || rid.page_num == rids.back().page_num);
+  file_handler.close();
+
+  bpm->close_file(record_manager_file);
+  delete bpm;
+  ::remove(fsm_file);
+}
+
+TEST(test_record_page_handler, test_record_file_all_visible)
+{
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp));
+
+  // 记录的第一个字节表示是否可见
+  const int record_size = 16;
+  char record_data[record_size];
+  memset(record_data, 1, sizeof(record_data));
+  std::vector<RID> rids;
+  for (int i = 0; i < 10; i++) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+    rids.push_back(rid);
+  }
+
+  const PageNum page_num = rids[0].page_num;
+  auto visible = [](const Record &record) { return record.data()[0] == 1; };
+  bool all_visible = false;
+  ASSERT_FALSE(file_handler.is_all_visible(page_num));
+  ASSERT_EQ(RC::SUCCESS, file_handler.mark_all_visible_if(page_num, visible, all_visible));
+  ASSERT_TRUE(all_visible);
+  ASSERT_TRUE(file_handler.is_all_visible(page_num));
+
+  // 修改页面上的记录会清除标记
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rids[3], false /*readonly*/, [](Record &record) {
+    record.data()[0] = 0;
+  }));
+  ASSERT_FALSE(file_handler.is_all_visible(page_num));
+  ASSERT_EQ(RC::SUCCESS, file_handler.mark_all_visible_if(page_num, visible, all_visible));
+  ASSERT_FALSE(all_visible);
+  ASSERT_FALSE(file_handler.is_all_visible(page_num));
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[3]));
+  ASSERT_EQ(RC::SUCCESS, file_handler.mark_all_visible_if(page_num, visible, all_visible));
+  ASSERT_TRUE(all_visible);
+
+  // 只读访问不会清除标记，插入会
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rids[4], true /*readonly*/, [](Record &) {}));
+  ASSERT_TRUE(file_handler.is_all_visible(page_num));
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+  ASSERT_EQ(page_num, rid.page_num);
+  ASSERT_FALSE(file_handler.is_all_visible(page_num));
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(test_record_page_handler, test_record_file_logger)
+{
+  const char *record_manager_file = "record_manager.bp";
+
+  for (RecordFormat format : {RecordFormat::FIXED, RecordFormat::SLOTTED}) {
+    ::remove(record_manager_file);
+    BufferPoolManager *bpm = new BufferPoolManager();
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+    const int record_size = 40;
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, format, {{8, 32}}));
+
+    LSN  next_lsn = 100;
+    RC   log_rc   = RC::SUCCESS;
+    auto logger   = [&next_lsn, &log_rc](size_t, size_t, LSN &lsn) {
+      lsn = next_lsn++;
+      return log_rc;
+    };
+    auto page_lsn = [bp](const RID &rid) {
+      Frame *frame = nullptr;
+      EXPECT_EQ(RC::SUCCESS, bp->get_this_page(rid.page_num, &frame));
+      const LSN lsn = frame->lsn();
+      bp->unpin_page(frame);
+      return lsn;
+    };
+
+    char record_data[record_size];
+    memset(record_data, 0, sizeof(record_data));
+    snprintf(record_data + 8, 32, "%d", 1);
+
+    // 写完日志之后页面的LSN就是这条日志的LSN
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid, nullptr, logger));
+    ASSERT_EQ(100, page_lsn(rid));
+
+    ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rid, false /*readonly*/, [](Record &record) {
+      record.data()[0] = 1;
+    }, logger));
+    ASSERT_EQ(101, page_lsn(rid));
+
+    // 写日志失败时撤销页面上的修改，页面的LSN不变
+    log_rc = RC::LOGBUF_FULL;
+    ASSERT_EQ(RC::LOGBUF_FULL, file_handler.visit_record(rid, false /*readonly*/, [](Record &record) {
+      record.data()[0] = 2;
+      snprintf(record.data() + 8, 32, "a longer updated string");
+    }, logger));
+    ASSERT_EQ(101, page_lsn(rid));
+
+    RecordPageHandler page_handler;
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rid, true /*readonly*/, &record));
+    ASSERT_EQ(1, record.data()[0]);
+    ASSERT_STREQ("1", record.data() + 8);
+    page_handler.cleanup();
+
+    RID failed_rid;
+    ASSERT_EQ(RC::LOGBUF_FULL, file_handler.insert_record(record_data, record_size, &failed_rid, nullptr, logger));
+    ASSERT_NE(RC::SUCCESS, file_handler.get_record(page_handler, &failed_rid, true /*readonly*/, &record));
+    page_handler.cleanup();
+    ASSERT_EQ(101, page_lsn(rid));
+
+    // 批量插入时每个页面写一条日志，写日志失败的页面上的记录都会撤销
+    const int record_num = 1000;
+    std::vector<const char *> datas(record_num, record_data);
+    std::vector<RID> rids(record_num);
+    log_rc = RC::SUCCESS;
+    int log_count = 0;
+    auto batch_logger = [&](size_t begin, size_t end, LSN &lsn) {
+      EXPECT_EQ(rids[begin].page_num, rids[end - 1].page_num);
+      lsn = next_lsn++;
+      return ++log_count > 1 ? RC::LOGBUF_FULL : RC::SUCCESS;
+    };
+    ASSERT_EQ(RC::LOGBUF_FULL, file_handler.insert_records(datas, record_size, rids.data(), nullptr, batch_logger));
+    ASSERT_EQ(2, log_count);
+    ASSERT_EQ(rid.page_num, rids[0].page_num);
+    ASSERT_EQ(next_lsn - 2, page_lsn(rids[0]));
+
+    int inserted = 0;
+    while (inserted < record_num && rids[inserted].page_num == rids[0].page_num) {
+      inserted++;
+    }
+    ASSERT_LT(inserted, record_num);
+    ASSERT_EQ(BP_INVALID_PAGE_NUM, rids[inserted].page_num);
+
+    int count = 0;
+    VacuousTrx trx;
+    RecordFileScanner file_scanner;
+    ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(nullptr /*table*/, *bp, &trx, true /*readonly*/, nullptr));
+    while (file_scanner.has_next()) {
+      ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+      count++;
+    }
+    file_scanner.close_scan();
+    ASSERT_EQ(inserted + 1, count);
+
+    file_handler.close();
+    bpm->close_file(record_manager_file);
+    delete bpm;
+  }
+}
+
+TEST(test_record_page_handler, test_record_file_recover_lsn)
+{
+  const char *record_manager_file = "record_manager.bp";
+
+  for (RecordFormat format : {RecordFormat::FIXED, RecordFormat::SLOTTED}) {
+    ::remove(record_manager_file);
+    BufferPoolManager *bpm = new BufferPoolManager();
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+    const int record_size = 40;
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, format, {{8, 32}}));
+
+    auto logger = [](size_t, size_t, LSN &lsn) {
+      lsn = 100;
+      return RC::SUCCESS;
+    };
+
+    char record_data[record_size];
+    memset(record_data, 0, sizeof(record_data));
+    snprintf(record_data + 8, 32, "%d", 1);
+
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid, nullptr, logger));
+
+    RecordPageHandler page_handler;
+    Record record;
+
+    // 页面的LSN不小于日志的LSN时，日志已经在页面上了，不再重做
+    RID recover_rid(rid.page_num, rid.slot_num + 1);
+    std::vector<const char *> datas{record_data};
+    bool redone = true;
+    ASSERT_EQ(RC::SUCCESS, file_handler.recover_insert_records(datas, record_size, &recover_rid, 100, redone));
+    ASSERT_FALSE(redone);
+    ASSERT_NE(RC::SUCCESS, file_handler.get_record(page_handler, &recover_rid, true /*readonly*/, &record));
+    page_handler.cleanup();
+
+    ASSERT_EQ(RC::SUCCESS, file_handler.recover_insert_records(datas, record_size, &recover_rid, 101, redone));
+    ASSERT_TRUE(redone);
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &recover_rid, true /*readonly*/, &record));
+    ASSERT_STREQ("1", record.data() + 8);
+    page_handler.cleanup();
+
+    auto updater = [](Record &record) { record.data()[0] = 1; };
+    ASSERT_EQ(RC::SUCCESS, file_handler.recover_visit_record(rid, 101, updater, redone));
+    ASSERT_FALSE(redone);
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rid, true /*readonly*/, &record));
+    ASSERT_EQ(0, record.data()[0]);
+    page_handler.cleanup();
+
+    ASSERT_EQ(RC::SUCCESS, file_handler.recover_visit_record(rid, 102, updater, redone));
+    ASSERT_TRUE(redone);
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(page_handler, &rid, true /*readonly*/, &record));
+    ASSERT_EQ(1, record.data()[0]);
+    page_handler.cleanup();
+
+    file_handler.close();
+    bpm->close_file(record_manager_file);
+    delete bpm;
+  }
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数